@@ -7,12 +7,15 @@
 //
 
 #include "adm.h"
+#include <sys/mman.h>
 
 // Private structure
 typedef struct _adm_mem {
     char data_path[1024];
     ADMTable table[256];
     int count;
+    char *maps[256];          // Coefficients mapped from the table files, NULL if read through stdio
+    size_t map_sizes[256];
 } ADMMem;
 
 // Private functions
@@ -138,6 +141,10 @@ void ADM_free(ADMHandle i) {
         ADMTable *table = &h->table[i];
         free(table->data.a);
         free(table->data.b);
+        if (h->maps[i] != NULL) {
+            munmap(h->maps[i], h->map_sizes[i]);
+            continue;
+        }
         free(table->data.cdx);
         free(table->data.cdy);
         free(table->data.cdz);
@@ -185,12 +192,34 @@ ADMTable *ADM_get_table(const ADMHandle in, const ADMConfig config) {
     // Allocate the space needed
     table->data.b = (float *)malloc(table->nb * sizeof(float));
     table->data.a = (float *)malloc(table->na * sizeof(float));
-    table->data.cdx = (float *)malloc(table->nn * sizeof(float));
-    table->data.cdy = (float *)malloc(table->nn * sizeof(float));
-    table->data.cdz = (float *)malloc(table->nn * sizeof(float));
-    table->data.cmx = (float *)malloc(table->nn * sizeof(float));
-    table->data.cmy = (float *)malloc(table->nn * sizeof(float));
-    table->data.cmz = (float *)malloc(table->nn * sizeof(float));
+    // Coefficients are used straight from the page cache, which all processes on a node share
+    const size_t map_size = 2 * sizeof(uint16_t) + 6 * (size_t)table->nn * sizeof(float);
+    struct stat file_stat;
+    char *map = NULL;
+    if (fstat(fileno(fid), &file_stat) == 0 && (size_t)file_stat.st_size >= map_size) {
+        map = (char *)mmap(NULL, map_size, PROT_READ, MAP_SHARED, fileno(fid), 0);
+        if (map == MAP_FAILED) {
+            map = NULL;
+        }
+    }
+    h->maps[h->count] = map;
+    h->map_sizes[h->count] = map_size;
+    if (map != NULL) {
+        float *coef = (float *)(map + 2 * sizeof(uint16_t));
+        table->data.cdx = coef;
+        table->data.cdy = coef + table->nn;
+        table->data.cdz = coef + 2 * table->nn;
+        table->data.cmx = coef + 3 * table->nn;
+        table->data.cmy = coef + 4 * table->nn;
+        table->data.cmz = coef + 5 * table->nn;
+    } else {
+        table->data.cdx = (float *)malloc(table->nn * sizeof(float));
+        table->data.cdy = (float *)malloc(table->nn * sizeof(float));
+        table->data.cdz = (float *)malloc(table->nn * sizeof(float));
+        table->data.cmx = (float *)malloc(table->nn * sizeof(float));
+        table->data.cmy = (float *)malloc(table->nn * sizeof(float));
+        table->data.cmz = (float *)malloc(table->nn * sizeof(float));
+    }
 
     // Fill in with values
     snprintf(table->name, 1024, "%s", config);
@@ -201,12 +230,14 @@ ADMTable *ADM_get_table(const ADMHandle in, const ADMConfig config) {
     for (i = 0; i < table->na; i++) {
         table->data.a[i] = (float)i / (float)(table->na - 1) * 180.0f;
     }
-    fread(table->data.cdx, sizeof(float), table->nn, fid);
-    fread(table->data.cdy, sizeof(float), table->nn, fid);
-    fread(table->data.cdz, sizeof(float), table->nn, fid);
-    fread(table->data.cmx, sizeof(float), table->nn, fid);
-    fread(table->data.cmy, sizeof(float), table->nn, fid);
-    fread(table->data.cmz, sizeof(float), table->nn, fid);
+    if (map == NULL) {
+        fread(table->data.cdx, sizeof(float), table->nn, fid);
+        fread(table->data.cdy, sizeof(float), table->nn, fid);
+        fread(table->data.cdz, sizeof(float), table->nn, fid);
+        fread(table->data.cmx, sizeof(float), table->nn, fid);
+        fread(table->data.cmy, sizeof(float), table->nn, fid);
+        fread(table->data.cmz, sizeof(float), table->nn, fid);
+    }
     
     h->count++;
     
@@ -0,0 +1,631 @@
+//
+//  iq.c
+//  Radar Simulation Framework
+//
+//  Streams the pulses of a simulation into an IQ file from a background thread
+//  so that the memory needed does not grow with the number of pulses
+//
+
+#include "iq.h"
+#include "rle.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <math.h>
+#include <sys/mman.h>
+
+#define IQ_writer_buffer_size      (32 * 1024 * 1024)   // Bytes of pulses the simulation may run ahead of the file
+#define IQ_writer_min_depth        4
+#define IQ_writer_staging_size     (4 * 1024 * 1024)    // Bytes of encoded blocks per write
+
+#define IQ_reader_max_threads      16
+
+#define IQ_align(x)                (((x) + IQFileAlignment - 1) / IQFileAlignment * IQFileAlignment)
+
+// Private structure
+
+typedef struct _iq_writer {
+    char            filename[1024];
+    int             fd;
+    IQFileHeader    header;
+    IQPulseHeader   *headers;        // Ring of pulse headers ...
+    char            *samples;        // ... and their samples
+    uint32_t        capacity;        // Pulses the sections have room for
+    uint32_t        depth;           // Pulses in the ring
+    uint64_t        head;            // Pulses added by the simulation
+    uint64_t        tail;            // Pulses written to the file
+    bool            active;
+    bool            ok;              // Cleared at the first write error
+    bool            full;            // Set at the first pulse beyond the capacity
+    IQSweep         *sweeps;         // Sweep table, kept by the simulation thread
+    uint32_t        sweeps_size;
+    uint64_t        *offsets;        // Offset of the samples of each pulse & the end, kept by the writer thread
+    uint64_t        end;
+    uint8_t         *staging;        // Encoded blocks waiting to be written
+    size_t          staging_size;
+    uint32_t        *words;          // Scratch of the encoder
+    pthread_t       tid;
+    pthread_mutex_t lock;            // Guards head, tail, active & ok
+    pthread_cond_t  added;           // Simulation -> writer: a pulse has been added or the file is closing
+    pthread_cond_t  written;         // Writer -> simulation: pulses have been written
+} IQWriter;
+
+typedef struct _iq_reader {
+    char            filename[1024];
+    char            *map;            // The whole file, read only
+    size_t          size;
+    uint32_t        version;
+    uint32_t        codec;
+    uint32_t        pulse_count;
+    uint32_t        range_count;
+    uint32_t        pulse_size;      // Bytes of the decoded samples of a pulse
+    uint32_t        sweep_count;
+    const char      *headers;        // First pulse header & the distance to the next
+    size_t          header_stride;
+    const char      *samples;        // Samples of the first pulse & the distance to the next, NULL with a codec
+    size_t          sample_stride;
+    const uint64_t  *index;          // Offsets of the pulses & the end, from the file or found by walking the blocks
+    uint64_t        *own_index;
+    const IQSweep   *sweeps;
+} IQReader;
+
+typedef struct _iq_decode_job {
+    const IQReader  *r;
+    float           *dst;
+    uint32_t        first;
+    uint32_t        count;
+    bool            ok;
+} IQDecodeJob;
+
+// Private functions
+void *IQ_writer_run(void *in);
+bool IQ_write_at(const int fd, const void *buffer, const size_t size, const uint64_t offset);
+size_t IQ_encode_pulse(uint8_t *dst, uint32_t *words, const float *samples, const uint32_t count, const uint32_t codec, const uint32_t mantissa_bits);
+
+#pragma mark - Codecs
+
+// Upper bound of the block of count words
+static size_t IQ_block_bound(const uint32_t count, const uint32_t codec) {
+    if (codec == IQCodecInt16) {
+        return sizeof(IQBlockHeader) + count * sizeof(int16_t);
+    }
+    return sizeof(IQBlockHeader) + 4 * (count + count / 128 + 1) + 7;
+}
+
+// Encodes count floats into a block at dst, words is scratch of count words. Returns the size of the block.
+size_t IQ_encode_pulse(uint8_t *dst, uint32_t *words, const float *samples, const uint32_t count, const uint32_t codec, const uint32_t mantissa_bits) {
+    IQBlockHeader *block = (IQBlockHeader *)dst;
+    uint8_t *payload = dst + sizeof(IQBlockHeader);
+    size_t size = 0;
+
+    memset(block, 0, sizeof(IQBlockHeader));
+    block->codec = codec;
+    block->scale = 1.0f;
+    if (codec == IQCodecInt16) {
+        float peak = 0.0f;
+        for (uint32_t i = 0; i < count; i++) {
+            if (isfinite(samples[i])) {
+                peak = MAX(peak, fabsf(samples[i]));
+            }
+        }
+        if (peak > 0.0f) {
+            block->scale = peak / 32767.0f;
+        }
+        int16_t *v = (int16_t *)payload;
+        for (uint32_t i = 0; i < count; i++) {
+            const float x = samples[i] / block->scale;
+            v[i] = isnan(x) ? 0 : (int16_t)lrintf(MIN(MAX(x, -32767.0f), 32767.0f));
+        }
+        size = count * sizeof(int16_t);
+    } else {
+        memcpy(words, samples, count * sizeof(uint32_t));
+        RLE_round_mantissa(words, count, mantissa_bits);
+        size = RLE_pack(payload, words, count);
+        // Noise-like samples may not pack, those are kept as they are
+        if (size >= count * sizeof(uint32_t)) {
+            block->codec = IQCodecNone;
+            size = count * sizeof(uint32_t);
+            memcpy(payload, words, size);
+        }
+    }
+    block->size = (uint32_t)size;
+    // Blocks are padded to 8 bytes to keep the next header aligned
+    while (size % 8) {
+        payload[size++] = 0;
+    }
+    return sizeof(IQBlockHeader) + size;
+}
+
+
+// Decodes the block of size bytes at src into count floats
+bool IQ_decode_pulse(float *samples, const uint32_t count, const void *src, const size_t size) {
+    const IQBlockHeader *block = (const IQBlockHeader *)src;
+    const uint8_t *payload = (const uint8_t *)src + sizeof(IQBlockHeader);
+
+    if (size < sizeof(IQBlockHeader) || block->size > size - sizeof(IQBlockHeader)) {
+        return false;
+    }
+    switch (block->codec) {
+        case IQCodecNone:
+            if (block->size != count * sizeof(float)) {
+                return false;
+            }
+            memcpy(samples, payload, block->size);
+            return true;
+        case IQCodecShuffleRLE:
+            return RLE_unpack((uint32_t *)samples, count, payload, block->size);
+        case IQCodecInt16:
+            if (block->size != count * sizeof(int16_t)) {
+                return false;
+            }
+            const int16_t *v = (const int16_t *)payload;
+            for (uint32_t i = 0; i < count; i++) {
+                samples[i] = (float)v[i] * block->scale;
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+#pragma mark - Writer
+
+bool IQ_write_at(const int fd, const void *buffer, const size_t size, const uint64_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t r = pwrite(fd, (const char *)buffer + done, size - done, (off_t)(offset + done));
+        if (r <= 0) {
+            return false;
+        }
+        done += r;
+    }
+    return true;
+}
+
+
+void *IQ_writer_run(void *in) {
+    IQWriter *w = (IQWriter *)in;
+    const size_t pulse_size = w->header.pulse_size;
+
+    pthread_mutex_lock(&w->lock);
+    while (true) {
+        while (w->tail == w->head && w->active) {
+            pthread_cond_wait(&w->added, &w->lock);
+        }
+        if (w->tail == w->head) {
+            break;
+        }
+        // Pulses up to the end of the ring go out in one write per section
+        const uint64_t k = w->tail;
+        const uint32_t first = (uint32_t)(k % w->depth);
+        const uint32_t count = (uint32_t)MIN(w->head - k, w->depth - first);
+        pthread_mutex_unlock(&w->lock);
+
+        bool ok = IQ_write_at(w->fd, &w->headers[first], count * sizeof(IQPulseHeader), w->header.pulse_header_offset + k * sizeof(IQPulseHeader));
+        if (w->header.codec == IQCodecNone) {
+            ok = ok && IQ_write_at(w->fd, w->samples + first * pulse_size, count * pulse_size, w->end);
+            for (uint32_t j = 0; j < count; j++) {
+                w->offsets[k + j] = w->end + j * pulse_size;
+            }
+            w->end += count * pulse_size;
+        } else {
+            // Blocks are gathered in the staging buffer, which goes out whenever the next one may not fit
+            const size_t bound = IQ_block_bound(pulse_size / sizeof(float), w->header.codec);
+            size_t used = 0;
+            for (uint32_t j = 0; j < count && ok; j++) {
+                if (used + bound > w->staging_size) {
+                    ok = IQ_write_at(w->fd, w->staging, used, w->end);
+                    w->end += used;
+                    used = 0;
+                }
+                w->offsets[k + j] = w->end + used;
+                used += IQ_encode_pulse(w->staging + used, w->words, (const float *)(w->samples + (first + j) * pulse_size),
+                                        pulse_size / sizeof(float), w->header.codec, w->header.mantissa_bits);
+            }
+            ok = ok && IQ_write_at(w->fd, w->staging, used, w->end);
+            w->end += used;
+        }
+        // The count follows the data so that a file cut short is still consistent
+        const uint32_t pulse_count = (uint32_t)(k + count);
+        ok = ok && IQ_write_at(w->fd, &pulse_count, sizeof(uint32_t), offsetof(IQFileHeader, pulse_count));
+
+        pthread_mutex_lock(&w->lock);
+        if (!ok && w->ok) {
+            fprintf(stderr, "IQ : Unable to write %s.\n", w->filename);
+            w->ok = false;
+        }
+        w->tail += count;
+        pthread_cond_signal(&w->written);
+    }
+    pthread_mutex_unlock(&w->lock);
+    return NULL;
+}
+
+
+IQWriterHandle IQ_writer_init(const char *filename, const IQFileHeader *header, const uint32_t range_count, const uint32_t capacity) {
+    IQWriter *w = (IQWriter *)malloc(sizeof(IQWriter));
+    if (w == NULL) {
+        fprintf(stderr, "IQ : Unable to allocate resources for the writer.\n");
+        return NULL;
+    }
+    memset(w, 0, sizeof(IQWriter));
+    snprintf(w->filename, sizeof(w->filename), "%s", filename);
+
+    // Sections are laid out for the capacity, the tables go after the samples once the count is known
+    memcpy(&w->header, header, sizeof(IQFileHeader));
+    w->header.version = IQFileVersion;
+    w->header.pulse_count = 0;
+    w->header.sweep_count = 0;
+    w->header.pulse_size = range_count * 4 * sizeof(float);
+    w->header.pulse_header_offset = IQ_align(sizeof(IQFileHeader));
+    w->header.pulse_index_offset = 0;
+    w->header.sweep_offset = 0;
+    w->header.iq_offset = IQ_align(w->header.pulse_header_offset + (uint64_t)capacity * sizeof(IQPulseHeader));
+    w->header.codec = IQCodecNone;
+    w->header.mantissa_bits = 23;
+    w->capacity = capacity;
+    w->end = w->header.iq_offset;
+
+    w->depth = (uint32_t)MAX(IQ_writer_min_depth, IQ_writer_buffer_size / (sizeof(IQPulseHeader) + w->header.pulse_size));
+    w->offsets = (uint64_t *)malloc(((size_t)capacity + 1) * sizeof(uint64_t));
+    if (w->offsets == NULL ||
+        posix_memalign((void **)&w->headers, IQFileAlignment, w->depth * sizeof(IQPulseHeader)) ||
+        posix_memalign((void **)&w->samples, IQFileAlignment, (size_t)w->depth * w->header.pulse_size)) {
+        fprintf(stderr, "IQ : Unable to allocate a ring of %u pulses.\n", w->depth);
+        free(w->offsets);
+        free(w->headers);
+        free(w);
+        return NULL;
+    }
+
+    w->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (w->fd < 0) {
+        fprintf(stderr, "IQ : Unable to create %s.\n", filename);
+        free(w->offsets);
+        free(w->headers);
+        free(w->samples);
+        free(w);
+        return NULL;
+    }
+    if (!IQ_write_at(w->fd, &w->header, sizeof(IQFileHeader), 0)) {
+        fprintf(stderr, "IQ : Unable to write %s.\n", filename);
+        close(w->fd);
+        free(w->offsets);
+        free(w->headers);
+        free(w->samples);
+        free(w);
+        return NULL;
+    }
+
+    w->active = true;
+    w->ok = true;
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->added, NULL);
+    pthread_cond_init(&w->written, NULL);
+    if (pthread_create(&w->tid, NULL, IQ_writer_run, w)) {
+        fprintf(stderr, "IQ : Error. Unable to create thread.\n");
+        exit(EXIT_FAILURE);
+    }
+    return (IQWriterHandle)w;
+}
+
+
+// Must come before the first pulse, mantissa_bits < 23 only applies to IQCodecShuffleRLE
+void IQ_writer_set_codec(IQWriterHandle in, const uint32_t codec, const uint32_t mantissa_bits) {
+    IQWriter *w = (IQWriter *)in;
+    if (w->head) {
+        fprintf(stderr, "IQ : Codec must be set before the first pulse.\n");
+        return;
+    }
+    if (codec != IQCodecNone) {
+        w->staging_size = MAX(IQ_writer_staging_size, IQ_block_bound(w->header.pulse_size / sizeof(float), codec));
+        w->staging = (uint8_t *)realloc(w->staging, w->staging_size);
+        w->words = (uint32_t *)realloc(w->words, w->header.pulse_size);
+        if (w->staging == NULL || w->words == NULL) {
+            fprintf(stderr, "IQ : Unable to allocate the staging buffer.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    w->header.codec = codec;
+    w->header.mantissa_bits = codec == IQCodecShuffleRLE ? MIN(mantissa_bits, 23) : 23;
+    if (!IQ_write_at(w->fd, &w->header, sizeof(IQFileHeader), 0)) {
+        fprintf(stderr, "IQ : Unable to write %s.\n", w->filename);
+    }
+}
+
+
+void IQ_writer_add_pulse(IQWriterHandle in, const IQPulseHeader *header, const float *samples) {
+    IQWriter *w = (IQWriter *)in;
+
+    if (w->head == w->capacity) {
+        if (!w->full) {
+            fprintf(stderr, "IQ : %s has room for %u pulses only.\n", w->filename, w->capacity);
+            w->full = true;
+        }
+        return;
+    }
+
+    // A new sweep number starts a new entry in the sweep table
+    IQSweep *sweep = w->header.sweep_count ? &w->sweeps[w->header.sweep_count - 1] : NULL;
+    if (sweep == NULL || w->headers[(w->head - 1) % w->depth].sweep != header->sweep) {
+        if (w->header.sweep_count == w->sweeps_size) {
+            w->sweeps_size = MAX(64, 2 * w->sweeps_size);
+            w->sweeps = (IQSweep *)realloc(w->sweeps, w->sweeps_size * sizeof(IQSweep));
+            if (w->sweeps == NULL) {
+                fprintf(stderr, "IQ : Unable to grow the sweep table.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        sweep = &w->sweeps[w->header.sweep_count++];
+        memset(sweep, 0, sizeof(IQSweep));
+        sweep->first = (uint32_t)w->head;
+        sweep->el_start = header->el_deg;
+        sweep->az_start = header->az_deg;
+    }
+    sweep->count++;
+    sweep->el_end = header->el_deg;
+    sweep->az_end = header->az_deg;
+
+    // Wait for a free slot if the file falls behind
+    pthread_mutex_lock(&w->lock);
+    while (w->head - w->tail == w->depth) {
+        pthread_cond_wait(&w->written, &w->lock);
+    }
+    const uint32_t slot = (uint32_t)(w->head % w->depth);
+    pthread_mutex_unlock(&w->lock);
+
+    memcpy(&w->headers[slot], header, sizeof(IQPulseHeader));
+    memcpy(w->samples + (size_t)slot * w->header.pulse_size, samples, w->header.pulse_size);
+
+    pthread_mutex_lock(&w->lock);
+    w->head++;
+    pthread_cond_signal(&w->added);
+    pthread_mutex_unlock(&w->lock);
+}
+
+
+long IQ_writer_free(IQWriterHandle in) {
+    IQWriter *w = (IQWriter *)in;
+
+    // The writer drains the ring before it exits
+    pthread_mutex_lock(&w->lock);
+    w->active = false;
+    pthread_cond_signal(&w->added);
+    pthread_mutex_unlock(&w->lock);
+    pthread_join(w->tid, NULL);
+
+    // Then the tables & the final header
+    IQFileHeader *header = &w->header;
+    header->pulse_count = (uint32_t)w->tail;
+    header->pulse_index_offset = IQ_align(w->end);
+    header->sweep_offset = IQ_align(header->pulse_index_offset + (w->tail + 1) * sizeof(uint64_t));
+    w->offsets[w->tail] = w->end;
+    bool ok = w->ok && IQ_write_at(w->fd, w->offsets, (w->tail + 1) * sizeof(uint64_t), header->pulse_index_offset);
+    ok = ok && IQ_write_at(w->fd, w->sweeps, header->sweep_count * sizeof(IQSweep), header->sweep_offset) &&
+         IQ_write_at(w->fd, header, sizeof(IQFileHeader), 0);
+    long size = (long)(header->sweep_offset + header->sweep_count * sizeof(IQSweep));
+    if (!ok) {
+        fprintf(stderr, "IQ : Unable to write %s.\n", w->filename);
+        size = -1;
+    }
+    if (close(w->fd)) {
+        size = -1;
+    }
+
+    pthread_mutex_destroy(&w->lock);
+    pthread_cond_destroy(&w->added);
+    pthread_cond_destroy(&w->written);
+    free(w->headers);
+    free(w->samples);
+    free(w->sweeps);
+    free(w->offsets);
+    free(w->staging);
+    free(w->words);
+    free(w);
+    return size;
+}
+
+#pragma mark - Reader
+
+// Offsets of the samples of each pulse & the end, walking the blocks of a file that was not closed
+static bool IQ_reader_make_index(IQReader *r, const uint64_t iq_offset) {
+    r->own_index = (uint64_t *)malloc(((size_t)r->pulse_count + 1) * sizeof(uint64_t));
+    if (r->own_index == NULL) {
+        return false;
+    }
+    uint64_t offset = iq_offset;
+    uint32_t k;
+    for (k = 0; k < r->pulse_count; k++) {
+        r->own_index[k] = offset;
+        if (r->codec == IQCodecNone) {
+            offset += r->pulse_size;
+        } else if (offset + sizeof(IQBlockHeader) <= r->size) {
+            const IQBlockHeader *block = (const IQBlockHeader *)(r->map + offset);
+            offset += sizeof(IQBlockHeader) + (block->size + 7) / 8 * 8;
+        } else {
+            break;
+        }
+        if (offset > r->size) {
+            break;
+        }
+    }
+    // Only the pulses that are all there
+    r->pulse_count = k;
+    r->own_index[k] = offset;
+    r->index = r->own_index;
+    return true;
+}
+
+
+IQReaderHandle IQ_reader_init(const char *filename) {
+    IQReader *r = (IQReader *)malloc(sizeof(IQReader));
+    if (r == NULL) {
+        fprintf(stderr, "IQ : Unable to allocate resources for the reader.\n");
+        return NULL;
+    }
+    memset(r, 0, sizeof(IQReader));
+    snprintf(r->filename, sizeof(r->filename), "%s", filename);
+
+    struct stat st;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) || st.st_size < sizeof(IQFileHeader)) {
+        fprintf(stderr, "IQ : Unable to open %s.\n", filename);
+        if (fd >= 0) {
+            close(fd);
+        }
+        free(r);
+        return NULL;
+    }
+    r->size = st.st_size;
+    r->map = (char *)mmap(NULL, r->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (r->map == MAP_FAILED) {
+        fprintf(stderr, "IQ : Unable to map %s.\n", filename);
+        free(r);
+        return NULL;
+    }
+    madvise(r->map, r->size, MADV_SEQUENTIAL);
+
+    const IQFileHeader *header = (const IQFileHeader *)r->map;
+    r->version = header->version;
+    r->range_count = r->version == IQFileVersion ? header->pulse_size / (4 * sizeof(float)) : header->params.range_count;
+    r->pulse_size = r->range_count * 4 * sizeof(float);
+    bool ok = r->range_count > 0;
+    if (ok && r->version == 0) {
+        // Version 1, a pulse header & the samples for each pulse
+        r->codec = IQCodecNone;
+        r->header_stride = sizeof(IQPulseHeader) + r->pulse_size;
+        r->sample_stride = r->header_stride;
+        r->pulse_count = (uint32_t)((r->size - sizeof(IQFileHeader)) / r->header_stride);
+        r->headers = r->map + sizeof(IQFileHeader);
+        r->samples = r->headers + sizeof(IQPulseHeader);
+    } else if (ok && r->version == IQFileVersion) {
+        r->codec = header->codec;
+        r->pulse_count = header->pulse_count;
+        r->header_stride = sizeof(IQPulseHeader);
+        r->sample_stride = r->pulse_size;
+        ok = header->pulse_size == r->pulse_size &&
+             header->pulse_header_offset + (uint64_t)r->pulse_count * sizeof(IQPulseHeader) <= r->size &&
+             header->iq_offset <= r->size;
+        if (ok && header->pulse_index_offset) {
+            ok = header->pulse_index_offset + ((uint64_t)r->pulse_count + 1) * sizeof(uint64_t) <= r->size &&
+                 header->sweep_offset + (uint64_t)header->sweep_count * sizeof(IQSweep) <= r->size;
+            r->index = (const uint64_t *)(r->map + header->pulse_index_offset);
+            r->sweep_count = header->sweep_count;
+            r->sweeps = (const IQSweep *)(r->map + header->sweep_offset);
+            ok = ok && r->index[r->pulse_count] <= r->size;
+        } else if (ok) {
+            ok = IQ_reader_make_index(r, header->iq_offset);
+        }
+        r->headers = r->map + header->pulse_header_offset;
+        r->samples = r->codec == IQCodecNone ? r->map + header->iq_offset : NULL;
+    } else {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "IQ : %s is not a valid IQ file.\n", filename);
+        IQ_reader_free(r);
+        return NULL;
+    }
+    return (IQReaderHandle)r;
+}
+
+
+void IQ_reader_free(IQReaderHandle in) {
+    IQReader *r = (IQReader *)in;
+    munmap(r->map, r->size);
+    free(r->own_index);
+    free(r);
+}
+
+
+const IQFileHeader *IQ_reader_get_header(const IQReaderHandle in) {
+    return (const IQFileHeader *)((IQReader *)in)->map;
+}
+
+
+uint32_t IQ_reader_get_pulse_count(const IQReaderHandle in) {
+    return ((IQReader *)in)->pulse_count;
+}
+
+
+uint32_t IQ_reader_get_range_count(const IQReaderHandle in) {
+    return ((IQReader *)in)->range_count;
+}
+
+
+const IQPulseHeader *IQ_reader_get_pulse_headers(const IQReaderHandle in, size_t *stride) {
+    IQReader *r = (IQReader *)in;
+    *stride = r->header_stride;
+    return (const IQPulseHeader *)r->headers;
+}
+
+
+// Samples are right in the file, (hi, hq, vi, vq) x range_count per pulse, unless there is a codec, which gives NULL
+const float *IQ_reader_get_samples(const IQReaderHandle in, size_t *stride) {
+    IQReader *r = (IQReader *)in;
+    *stride = r->sample_stride;
+    return (const float *)r->samples;
+}
+
+
+const IQSweep *IQ_reader_get_sweeps(const IQReaderHandle in, uint32_t *count) {
+    IQReader *r = (IQReader *)in;
+    *count = r->sweep_count;
+    return r->sweeps;
+}
+
+
+static void *IQ_reader_decode(void *in) {
+    IQDecodeJob *job = (IQDecodeJob *)in;
+    const IQReader *r = job->r;
+    const uint32_t count = r->range_count * 4;
+    for (uint32_t k = job->first; k < job->first + job->count && job->ok; k++) {
+        float *dst = job->dst + (size_t)(k - job->first) * count;
+        if (r->samples) {
+            memcpy(dst, r->samples + (size_t)k * r->sample_stride, r->pulse_size);
+        } else {
+            job->ok = r->index[k] < r->index[k + 1] && r->index[k + 1] <= r->size &&
+                      IQ_decode_pulse(dst, count, r->map + r->index[k], r->index[k + 1] - r->index[k]);
+        }
+    }
+    return NULL;
+}
+
+
+// Copies the samples of count pulses from first into dst, decoding them if needed, with the pulses shared among threads
+long IQ_reader_read_samples(const IQReaderHandle in, float *dst, const uint32_t first, const uint32_t count) {
+    IQReader *r = (IQReader *)in;
+    IQDecodeJob jobs[IQ_reader_max_threads];
+    pthread_t tids[IQ_reader_max_threads];
+
+    if (first > r->pulse_count || count > r->pulse_count - first) {
+        fprintf(stderr, "IQ : Pulses %u to %u are beyond the %u pulses of %s.\n", first, first + count, r->pulse_count, r->filename);
+        return -1;
+    }
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    const uint32_t n = (uint32_t)MAX(1, MIN(MIN(cores, IQ_reader_max_threads), count / 16));
+    const uint32_t share = (count + n - 1) / n;
+    uint32_t t;
+    for (t = 0; t < n; t++) {
+        jobs[t].r = r;
+        jobs[t].first = first + MIN(count, t * share);
+        jobs[t].count = MIN(count, (t + 1) * share) - MIN(count, t * share);
+        jobs[t].dst = dst + (size_t)(jobs[t].first - first) * r->range_count * 4;
+        jobs[t].ok = true;
+        if (t > 0 && pthread_create(&tids[t], NULL, IQ_reader_decode, &jobs[t])) {
+            jobs[t].ok = false;
+            break;
+        }
+    }
+    IQ_reader_decode(&jobs[0]);
+    bool ok = jobs[0].ok;
+    for (uint32_t j = 1; j < t; j++) {
+        pthread_join(tids[j], NULL);
+        ok &= jobs[j].ok;
+    }
+    if (!ok || t < n) {
+        fprintf(stderr, "IQ : Unable to read pulses %u to %u of %s.\n", first, first + count, r->filename);
+        return -1;
+    }
+    return count;
+}
@@ -10,6 +10,28 @@
 
 #include "rs_types.h"
 
+#define IQFileVersion          2
+#define IQFileAlignment        4096
+#define IQCodecNone            0      // Samples as they are
+#define IQCodecShuffleRLE      1      // Words XOR'ed with the previous gate, split into byte planes with zero runs
+#define IQCodecInt16           2      // Samples scaled to int16 by the peak of each pulse, like the output of an ADC
+
+// Version 2 files are made of sections, each aligned to IQFileAlignment so that they can be mapped:
+//
+//   IQFileHeader
+//   IQPulseHeader[pulse_count]                     @ pulse_header_offset
+//   Samples of each pulse, (hi, hq, vi, vq) x range_count   @ iq_offset
+//   uint64_t[pulse_count + 1]                      @ pulse_index_offset, file offsets of the samples of each pulse & the end
+//   IQSweep[sweep_count]                           @ sweep_offset
+//
+// Version 1 files, which have version = 0, are the file header followed by an IQPulseHeader and the samples for each pulse.
+// The index & sweep tables are written as the file is closed, until then pulse_count is kept up to date, pulse k is at
+// iq_offset + k * pulse_size and both table offsets are 0.
+//
+// With a codec, the samples of each pulse are a block of its own: an IQBlockHeader and the encoded samples, padded to
+// 8 bytes. The blocks follow one another from iq_offset, the index points to each of them so that they can be decoded in parallel, and
+// until the file is closed they can be found by walking the sizes.
+
 // Basic structure of a complex sample
 typedef struct iq_complex {
     float i;
@@ -27,6 +49,16 @@ typedef union fileheader {
         float     scan_end;
         float     scan_delta;
         uint32_t  simulation_seed;
+        uint32_t  version;              // 0 for version 1, IQFileVersion otherwise
+        uint32_t  pulse_count;          // Pulses in the file
+        uint32_t  sweep_count;          // Entries of the sweep table
+        uint32_t  pulse_size;           // Bytes of samples of each pulse
+        uint32_t  codec;                // IQCodecNone, IQCodecShuffleRLE, IQCodecInt16
+        uint64_t  pulse_header_offset;  // Offset of the pulse headers
+        uint64_t  pulse_index_offset;   // Offset of the pulse index, 0 until the file is closed
+        uint64_t  sweep_offset;         // Offset of the sweep table, 0 until the file is closed
+        uint64_t  iq_offset;            // Offset of the samples
+        uint32_t  mantissa_bits;        // Mantissa bits kept by IQCodecShuffleRLE, 23 is lossless
     };
 } IQFileHeader;
 
@@ -37,7 +69,49 @@ typedef union pulseheader {
         float      time;
         float      el_deg;
         float      az_deg;
+        uint32_t   sweep;         // Sweeps started before this pulse, a new value starts a new sweep
     };
 } IQPulseHeader;
 
+// A run of pulses of the same sweep
+typedef union sweepheader {
+    char raw[32];
+    struct {
+        uint32_t   first;         // First pulse of the sweep
+        uint32_t   count;         // Number of pulses
+        float      el_start;      // Angles of the first & the last pulse
+        float      el_end;
+        float      az_start;
+        float      az_end;
+    };
+} IQSweep;
+
+// Header of each block of samples when there is a codec
+typedef struct blockheader {
+    uint32_t   size;          // Bytes of encoded samples that follow
+    uint32_t   codec;         // Codec of this block, IQCodecNone when encoding would not make it smaller
+    float      scale;         // Value of one step of IQCodecInt16, 1 otherwise
+    uint32_t   reserved;
+} IQBlockHeader;
+
+typedef void * IQWriterHandle;
+typedef void * IQReaderHandle;
+
+IQWriterHandle IQ_writer_init(const char *filename, const IQFileHeader *header, const uint32_t range_count, const uint32_t capacity);
+void IQ_writer_set_codec(IQWriterHandle, const uint32_t codec, const uint32_t mantissa_bits);
+void IQ_writer_add_pulse(IQWriterHandle, const IQPulseHeader *header, const float *samples);
+long IQ_writer_free(IQWriterHandle);
+
+bool IQ_decode_pulse(float *samples, const uint32_t count, const void *block, const size_t size);
+
+IQReaderHandle IQ_reader_init(const char *filename);
+void IQ_reader_free(IQReaderHandle);
+const IQFileHeader *IQ_reader_get_header(const IQReaderHandle);
+uint32_t IQ_reader_get_pulse_count(const IQReaderHandle);
+uint32_t IQ_reader_get_range_count(const IQReaderHandle);
+const IQPulseHeader *IQ_reader_get_pulse_headers(const IQReaderHandle, size_t *stride);
+const float *IQ_reader_get_samples(const IQReaderHandle, size_t *stride);
+const IQSweep *IQ_reader_get_sweeps(const IQReaderHandle, uint32_t *count);
+long IQ_reader_read_samples(const IQReaderHandle, float *dst, const uint32_t first, const uint32_t count);
+
 #endif /* iq_h */
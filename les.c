@@ -7,16 +7,66 @@
 //
 
 #include "les.h"
+#include "rle.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <sys/mman.h>
+
+#if defined (__F16C__)
+#include <immintrin.h>
+#elif defined (__SSE__)
+#include <xmmintrin.h>
+#endif
 
-#define LES_num                     4
+#define LES_default_depth           3      // Frames read ahead of the consumer
+#define LES_max_depth               31
 #define LES_file_nblock             10
 #define LES_FMT                     "%+8.4f"
 #define LES_CFMT                    "%s" LES_FMT " " LES_FMT "  " LES_FMT " .. " LES_FMT "%s"
 #define LES_FRAME_TIME_STAMP_BYTES  4
 #define LES_FRAME_PADDING_BYTES     8
+#define LES_remap_max_threads       8
+#define LES_window_depth            1      // Frames read ahead of each process that maps a window
+#define LES_window_max_slots        256
 
 // Private structure
 
+enum LESWindowSlotState {
+    LESWindowSlotEmpty,
+    LESWindowSlotFilling,
+    LESWindowSlotReady
+};
+
+typedef struct _les_window_slot {
+    int32_t   frame;          // Frame in the slot, -1 if empty
+    uint32_t  state;          // LESWindowSlotState
+    uint32_t  refs;           // Boxes of all the processes that point into the slot
+    uint32_t  stamp;          // Last use, the least recently used slot is refilled first
+    uint32_t  velocity_only;  // Filled without p & t
+} LESWindowSlot;
+
+// Header of a window, mapped by every process of the node, the slots of time stamp, uvwt[nn] & cpxx[nn] follow at slot_offset
+typedef struct _les_window {
+    char            magic[8];       // LESWindowMagic
+    uint32_t        version;        // LESWindowVersion
+    uint32_t        nx;             // Full LES grid
+    uint32_t        ny;
+    uint32_t        nz;
+    uint32_t        nc;             // Number of frames
+    float           v0;             // Scales applied to the raw u, v, w, p & t
+    float           p0;
+    float           t0;
+    uint32_t        depth;          // Prefetch depth of each process, the slots cover all of them at this depth
+    uint32_t        slot_count;
+    uint32_t        clock;          // Stamp of the last use
+    uint64_t        slot_offset;    // Offset of the first slot
+    uint64_t        slot_size;      // Bytes from one slot to the next
+    char            config[256];    // LES configuration
+    pthread_mutex_t lock;           // Process-shared, guards the slot descriptions & the clock
+    pthread_cond_t  changed;        // Process-shared, a slot was filled or let go
+    LESWindowSlot   slots[LES_window_max_slots];
+} LESWindow;
+
 typedef struct _les_mem {
     char      config[256];
     char      data_path[1024];
@@ -26,7 +76,6 @@ typedef struct _les_mem {
     size_t    ncubes;
 	LESGrid   *enclosing_grid;
 	LESGrid   *data_grid;
-	int       ibuf;
 	float     tr;
     float     tp;
     float     v0;
@@ -38,16 +87,81 @@ typedef struct _les_mem {
     float     rx;             // Ratio value "r" in the geometric series in x direction
     float     ry;             // Ratio value "r" in the geometric series in y direction
     float     rz;             // Ratio value "r" in the geometric series in z direction
-	int       data_id[LES_num];
-	LESTable  *data_boxes[LES_num];
+	int       data_id[LES_max_depth + 1];
+	LESTable  *data_boxes[LES_max_depth + 1];
+    int       slot_id[LES_max_depth + 1];   // Window slot each box points into, -1 if none
+    int       nbuf;           // Boxes in the ring, one more than the prefetch depth
+    int       held;           // Box last handed to the consumer, valid until the next LES_get_frame()
+    bool      reading;        // A box is being filled outside the lock
+    bool      waiting;        // The consumer is stalled on req
+    pthread_mutex_t lock;     // Guards the ring, req & the counters
+    pthread_cond_t  ready;    // Reader -> consumer: a frame has been ingested
+    pthread_cond_t  wanted;   // Consumer -> reader: req or the depth has changed
+    LESStats  stats;
     pthread_t tid;
     bool      active;
     bool      delayed_read;
+    bool      velocity_only;  // Skip p & t when no kernel samples the cpxx table
+    bool      half_precision; // Also produce half-precision copies of uvwt & cpxx
     int       req;
+    uint32_t  crop_ox;        // Sub-box of the LES grid to read: origin ...
+    uint32_t  crop_oy;
+    uint32_t  crop_oz;
+    uint32_t  crop_nx;        // ... and size
+    uint32_t  crop_ny;
+    uint32_t  crop_nz;
+    pthread_mutex_t crop_lock;
+    char      *maps[1024];    // Files mapped on first use, unmapped in LES_free()
+    size_t    map_sizes[1024];
+    int       remap_threads;
+    char      *cache;         // Pre-converted frames, see LESCacheHeader, NULL if there is no usable cache
+    size_t    cache_size;
+    uint32_t  cache_codec;    // Codec & mantissa bits of the caches written by LES_write_cache()
+    uint32_t  cache_mantissa_bits;
+    uint32_t  *scratch[LES_remap_max_threads];  // A decoded plane for each thread
+    LESWindow *window;        // Frames shared by the processes of the node, NULL if there is no window
+    size_t    window_size;
+    struct _les_mem *root;    // Handle that owns the grids, maps & cache, itself unless shared
+    struct _les_mem *next;    // Next root in LES_roots
+    int       refs;           // Handles using this one as their root
 } LESMem;
 
+// Roots of the handles in this process, a handle of the same data path shares the grids, maps & cache of its root
+static LESMem *LES_roots = NULL;
+static pthread_mutex_t LES_share_lock = PTHREAD_MUTEX_INITIALIZER;   // Guards LES_roots, refs & the maps of the roots
+
+// A share of the planes of a frame, remapped straight from the mapped file
+typedef struct _les_remap {
+    const LESMem  *h;
+    LESTable      *table;
+    const char    *src;           // Variable u of the frame in the mapped file
+    long          stride;         // Bytes from one variable to the next
+    uint32_t      z0;             // Planes [z0, z1) of the table
+    uint32_t      z1;
+    bool          velocity_only;
+    bool          p_for_cn2;
+    const uint64_t *index;        // Chunks of the frame in the compressed cache
+    uint32_t      *scratch;       // A decoded plane
+    bool          ok;             // Cleared if a chunk cannot be decoded
+} LESRemap;
+
 // Private functions
 void *LES_background_read(LESHandle i);
+int LES_grow_ring(LESMem *h, const int nbuf);
+void LES_read_box(FILE *fid, float *dst, const long base, const LESGrid *grid, const LESTable *table);
+bool LES_read_frame_stdio(LESMem *h, LESTable *table, const int file_id, const long offset, const long stride, const bool velocity_only, const bool p_for_cn2);
+const char *LES_map_file(LESMem *h, const int file_id);
+void LES_remap_frame(LESMem *h, LESTable *table, const char *src, const long stride, const bool velocity_only, const bool p_for_cn2);
+bool LES_share_planes(LESMem *h, const LESRemap *job, void *(*worker)(void *));
+void LES_open_cache(LESMem *h);
+LESHandle LES_start(LESMem *h);
+bool LES_read_frame_cache(LESMem *h, LESTable *table, const int frame, const bool velocity_only);
+bool LES_read_frame(LESMem *h, LESTable *table, const int frame, const bool velocity_only);
+void LES_open_window(LESMem *h);
+int LES_window_acquire(LESMem *h, const int frame, const bool velocity_only);
+void LES_window_release(LESMem *h, const int k);
+void LES_window_point_table(const LESMem *h, LESTable *table, const int s);
+void LES_attach_icdf(const LESMem *h, LESTable *table, const int frame);
 
 void LES_show_row(const char *prefix, const char *posfix, const float *f, const int n);
 void LES_show_slice(const float *values, const int nx, const int ny, const int nz);
@@ -61,8 +175,9 @@ LESGrid *LES_data_grid_create_from_enclosing_grid(LESGrid *grid, const int ox, c
 void LES_grid_free(LESGrid *grid);
 void LES_show_grid_summary(const LESGrid *grid);
 
-LESTable *LES_table_create(const LESGrid *grid);
+LESTable *LES_table_create(const LESGrid *grid, const bool with_data);
 void LES_table_free(LESTable *table);
+void LES_table_make_half(LESTable *table, const bool with_cpxx);
 
 //void LES_table_fill(LESTable *table, const LESGrid *grid, const char *filename);
 
@@ -135,7 +250,29 @@ LESHandle LES_init_with_config_path(const LESConfig config, const char *path) {
 
     snprintf(h->config, sizeof(h->config), "%s", config);
     snprintf(h->data_path, sizeof(h->data_path), "%s/les/%s", les_path, config);
-    h->ibuf = 0;
+
+    // Another handle of this process already has the data, everything but the ring is shared
+    pthread_mutex_lock(&LES_share_lock);
+    LESMem *root = LES_roots;
+    while (root != NULL && strcmp(root->data_path, h->data_path)) {
+        root = root->next;
+    }
+    if (root != NULL) {
+        root->refs++;
+    }
+    pthread_mutex_unlock(&LES_share_lock);
+    if (root != NULL) {
+        // Everything up to data_id describes the data set
+        memcpy(h, root, offsetof(LESMem, data_id));
+        h->cache = root->cache;
+        h->cache_size = root->cache_size;
+        h->window = root->window;
+        h->window_size = root->window_size;
+        h->root = root;
+        return LES_start(h);
+    }
+    h->root = h;
+    h->refs = 1;
     h->tr = 50.0f;
 
     //    char grid_file[1024];
@@ -238,25 +375,67 @@ LESHandle LES_init_with_config_path(const LESConfig config, const char *path) {
     }
 
     h->ncubes = h->nfiles * h->nvol;
+    if (h->ncubes == 0) {
+        fprintf(stderr, "No LES data files in %s.\n", h->data_path);
+        return NULL;
+    }
 
     #ifdef DEBUG
     rsprint("LES file count = %zu    nvol = %zu    ncubes = %zu\n", h->nfiles, h->nvol, h->ncubes);
     #endif
 
+    if (LES_start(h) == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&LES_share_lock);
+    h->next = LES_roots;
+    LES_roots = h;
+    pthread_mutex_unlock(&LES_share_lock);
+
+    return (LESHandle)h;
+}
+
+
+// The ring & the reader of a handle, whether it is a root or shares one
+LESHandle LES_start(LESMem *h) {
+    // Boxes of a window only point into it, so the window is attached first
+    if (h->root == h) {
+        LES_open_window(h);
+    }
+    const int depth = h->window == NULL ? LES_default_depth : (int)MIN(LES_default_depth, h->window->depth);
+
     // Allocate data boxes
-    for (int i = 0; i < LES_num; i++) {
-        h->data_boxes[i] = LES_table_create(h->data_grid);
-        if (h->data_boxes[i] == NULL) {
-            fprintf(stderr, "[LES] LES_table_create() returned a NULL.\n");
-            return NULL;
-        }
-        h->data_boxes[i]->tr = h->tr;
-        h->data_boxes[i]->nc = (uint32_t)h->ncubes;
-        h->data_id[i] = -1;
+    h->held = -1;
+    if (LES_grow_ring(h, depth + 1)) {
+        return NULL;
     }
+    h->stats.depth = depth;
 
     // Other non-zero parameters
     h->active = true;
+    h->crop_nx = h->data_grid->nx;
+    h->crop_ny = h->data_grid->ny;
+    h->crop_nz = h->data_grid->nz;
+    pthread_mutex_init(&h->crop_lock, NULL);
+    pthread_mutex_init(&h->lock, NULL);
+    pthread_cond_init(&h->ready, NULL);
+    pthread_cond_init(&h->wanted, NULL);
+    h->remap_threads = (int)MIN(MAX(1, sysconf(_SC_NPROCESSORS_ONLN)), LES_remap_max_threads);
+    h->cache_mantissa_bits = 23;
+
+    // Frames come from the cache when there is one that matches this configuration
+    if (h->root == h) {
+        LES_open_cache(h);
+    } else if (h->cache != NULL && ((const LESCacheHeader *)h->cache)->codec != LESCacheCodecNone) {
+        for (int k = 0; k < h->remap_threads; k++) {
+            h->scratch[k] = (uint32_t *)malloc((size_t)h->data_grid->nx * h->data_grid->ny * sizeof(LESFloat4));
+            if (h->scratch[k] == NULL) {
+                fprintf(stderr, "LES : Unable to allocate a decoded plane.\n");
+                return NULL;
+            }
+        }
+    }
 
     // Background read
     pthread_attr_t attr;
@@ -270,9 +449,16 @@ LESHandle LES_init_with_config_path(const LESConfig config, const char *path) {
         exit(EXIT_FAILURE);
     }
     // Wait until one frame is ingested.
-    do {
-        usleep(10000);
-    } while (h->ibuf == 0);
+    pthread_mutex_lock(&h->lock);
+    while (h->stats.frames_read == 0 && h->active) {
+        pthread_cond_wait(&h->ready, &h->lock);
+    }
+    const uint32_t frames_read = h->stats.frames_read;
+    pthread_mutex_unlock(&h->lock);
+    if (frames_read == 0) {
+        fprintf(stderr, "LES : Unable to read the first frame.\n");
+        return NULL;
+    }
 #ifdef DEBUG_HEAVY
     int policy = -1;
     if (pthread_attr_getschedparam(&attr, &param) == 0 &&
@@ -296,14 +482,57 @@ LESHandle LES_init() {
 
 void LES_free(LESHandle i) {
     LESMem *h = (LESMem *)i;
+    pthread_mutex_lock(&h->lock);
     h->active = false;
+    pthread_cond_broadcast(&h->wanted);
+    pthread_mutex_unlock(&h->lock);
     pthread_join(h->tid, NULL);
-    LES_grid_free(h->enclosing_grid);
-    LES_grid_free(h->data_grid);
-    for (int i=0; i<LES_num; i++) {
+    for (int i=0; i<h->nbuf; i++) {
+        LES_window_release(h, i);
         LES_table_free(h->data_boxes[i]);
     }
-    free(h);
+    for (int k = 0; k < LES_remap_max_threads; k++) {
+        free(h->scratch[k]);
+    }
+    pthread_mutex_destroy(&h->crop_lock);
+    pthread_mutex_destroy(&h->lock);
+    pthread_cond_destroy(&h->ready);
+    pthread_cond_destroy(&h->wanted);
+
+    // The root outlives its ring until the last handle that shares it is gone
+    LESMem *root = h->root;
+    pthread_mutex_lock(&LES_share_lock);
+    const int refs = --root->refs;
+    if (refs == 0) {
+        LESMem **r = &LES_roots;
+        while (*r != NULL && *r != root) {
+            r = &(*r)->next;
+        }
+        if (*r != NULL) {
+            *r = root->next;
+        }
+    }
+    pthread_mutex_unlock(&LES_share_lock);
+    if (h != root) {
+        free(h);
+    }
+    if (refs > 0) {
+        return;
+    }
+    LES_grid_free(root->enclosing_grid);
+    LES_grid_free(root->data_grid);
+    for (int i=0; i<root->nfiles; i++) {
+        if (root->maps[i] != NULL) {
+            munmap(root->maps[i], root->map_sizes[i]);
+        }
+    }
+    if (root->cache != NULL) {
+        munmap(root->cache, root->cache_size);
+    }
+    if (root->window != NULL) {
+        munmap(root->window, root->window_size);
+    }
+    free(root);
 }
 
 #pragma mark -
@@ -313,29 +542,243 @@ void LES_set_delayed_read(LESHandle i) {
     h->delayed_read = true;
 }
 
+void LES_set_velocity_only(LESHandle i, const bool velocity_only) {
+    LESMem *h = (LESMem *)i;
+    h->velocity_only = velocity_only;
+}
+
+void LES_set_half_precision(LESHandle i, const bool half_precision) {
+    LESMem *h = (LESMem *)i;
+    h->half_precision = half_precision;
+}
+
+void LES_set_crop(LESHandle i, const uint32_t ox, const uint32_t oy, const uint32_t oz, const uint32_t nx, const uint32_t ny, const uint32_t nz) {
+    LESMem *h = (LESMem *)i;
+    if (nx == 0 || ny == 0 || nz == 0 ||
+        ox + nx > h->data_grid->nx || oy + ny > h->data_grid->ny || oz + nz > h->data_grid->nz) {
+        fprintf(stderr, "LES : Invalid crop box [%u, %u, %u] + [%u, %u, %u] of %u x %u x %u.\n",
+                ox, oy, oz, nx, ny, nz, h->data_grid->nx, h->data_grid->ny, h->data_grid->nz);
+        return;
+    }
+    // Frames already ingested keep the box they were read with, see LESTable ox/oy/oz
+    pthread_mutex_lock(&h->crop_lock);
+    h->crop_ox = ox;
+    h->crop_oy = oy;
+    h->crop_oz = oz;
+    h->crop_nx = nx;
+    h->crop_ny = ny;
+    h->crop_nz = nz;
+    pthread_mutex_unlock(&h->crop_lock);
+}
+
+void LES_clear_crop(LESHandle i) {
+    LESMem *h = (LESMem *)i;
+    LES_set_crop(i, 0, 0, 0, h->data_grid->nx, h->data_grid->ny, h->data_grid->nz);
+}
+
+int LES_grow_ring(LESMem *h, const int nbuf) {
+    for (int k = h->nbuf; k < nbuf; k++) {
+        // With a window the boxes point into its slots
+        h->data_boxes[k] = LES_table_create(h->data_grid, h->window == NULL);
+        if (h->data_boxes[k] == NULL) {
+            fprintf(stderr, "[LES] LES_table_create() returned a NULL.\n");
+            return 1;
+        }
+        h->data_boxes[k]->tr = h->tr;
+        h->data_boxes[k]->nc = (uint32_t)h->ncubes;
+        h->data_id[k] = -1;
+        h->slot_id[k] = -1;
+        h->nbuf = k + 1;
+    }
+    return 0;
+}
+
+void LES_set_prefetch_depth(LESHandle i, const uint32_t depth) {
+    LESMem *h = (LESMem *)i;
+    // The slots of a window are only enough for its depth
+    const int nbuf = (int)MIN(MAX(depth, 1), h->window == NULL ? LES_max_depth : h->window->depth) + 1;
+    pthread_mutex_lock(&h->lock);
+    // Boxes are only added or removed while none of them is being filled
+    while (h->reading) {
+        pthread_cond_wait(&h->ready, &h->lock);
+    }
+    if (nbuf > h->nbuf) {
+        LES_grow_ring(h, nbuf);
+    } else {
+        // The box of the consumer is kept
+        if (h->held >= nbuf) {
+            LESTable *table = h->data_boxes[0];
+            int id = h->data_id[0];
+            int slot = h->slot_id[0];
+            h->data_boxes[0] = h->data_boxes[h->held];
+            h->data_id[0] = h->data_id[h->held];
+            h->slot_id[0] = h->slot_id[h->held];
+            h->data_boxes[h->held] = table;
+            h->data_id[h->held] = id;
+            h->slot_id[h->held] = slot;
+            h->held = 0;
+        }
+        for (int k = nbuf; k < h->nbuf; k++) {
+            LES_window_release(h, k);
+            LES_table_free(h->data_boxes[k]);
+            h->data_boxes[k] = NULL;
+            h->data_id[k] = -1;
+        }
+        h->nbuf = nbuf;
+    }
+    h->stats.depth = h->nbuf - 1;
+    pthread_cond_broadcast(&h->wanted);
+    pthread_mutex_unlock(&h->lock);
+}
+
+#pragma mark -
+
+LESStats LES_get_stats(const LESHandle i) {
+    LESMem *h = (LESMem *)i;
+    pthread_mutex_lock(&h->lock);
+    LESStats stats = h->stats;
+    pthread_mutex_unlock(&h->lock);
+    return stats;
+}
+
+void LES_reset_stats(LESHandle i) {
+    LESMem *h = (LESMem *)i;
+    pthread_mutex_lock(&h->lock);
+    const uint32_t depth = h->stats.depth;
+    memset(&h->stats, 0, sizeof(LESStats));
+    h->stats.depth = depth;
+    pthread_mutex_unlock(&h->lock);
+}
+
+void LES_show_stats(const LESHandle i) {
+    LESStats stats = LES_get_stats(i);
+    const uint32_t count = stats.hits + stats.stalls;
+    rsprint("LES prefetch depth %u:  %u frames read in %.2f s   %u / %u requests stalled for %.3f s   reader idle %.2f s\n",
+            stats.depth, stats.frames_read, stats.read_time,
+            stats.stalls, count, stats.stall_time, stats.idle_time);
+}
+
 #pragma mark -
 
+static double LES_dtime(const struct timeval *t0, const struct timeval *t1) {
+    return (double)(t1->tv_sec - t0->tv_sec) + 1.0e-6 * (double)(t1->tv_usec - t0->tv_usec);
+}
+
+// Box that holds a frame, -1 if it is not in the ring
+static int LES_find_frame(const LESMem *h, const int frame) {
+    for (int k = 0; k < h->nbuf; k++) {
+        if (h->data_id[k] == frame) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+// First frame of the prefetch window [req, req + depth) that is not in the ring, -1 if there is none
+static int LES_next_missing_frame(const LESMem *h) {
+    const int count = (int)MIN(h->nbuf - 1, h->ncubes);
+    for (int j = 0; j < count; j++) {
+        const int frame = (int)((h->req + j) % h->ncubes);
+        if (LES_find_frame(h, frame) < 0) {
+            return frame;
+        }
+    }
+    return -1;
+}
+
+// Box that is neither held by the consumer nor part of the prefetch window, there is always one with nbuf = depth + 1
+static int LES_free_box(const LESMem *h) {
+    const int count = (int)MIN(h->nbuf - 1, h->ncubes);
+    for (int k = 0; k < h->nbuf; k++) {
+        if (k == h->held) {
+            continue;
+        }
+        if (h->data_id[k] < 0 || (h->data_id[k] - h->req + h->ncubes) % h->ncubes >= count) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+// A frame into the sub-box of a table
+bool LES_read_frame(LESMem *h, LESTable *table, const int frame, const bool velocity_only) {
+    const bool p_for_cn2 = !strcmp(h->config, LESConfigFlat);
+
+    // The file number of the list of files to read
+    const int file_id = frame / LES_file_nblock;
+
+    // Each variable in the file is a full volume, along with the record markers
+    const long nn = (long)h->data_grid->nx * h->data_grid->ny * h->data_grid->nz;
+    const long stride = nn * sizeof(float) + 2 * sizeof(uint32_t);
+
+    long offset = sizeof(uint32_t) +                     // version number
+    (frame % LES_file_nblock) *
+    (sizeof(float) + 2 * sizeof(uint32_t)                // time
+     + 5 * stride                                        // u, v, w, p, t
+     );
+    const long base = offset + sizeof(float) + 2 * sizeof(uint32_t);
+
+    // Only the cache carries a pre-computed flux ICDF
+    table->flux_icdf = NULL;
+    table->flux_icdf_count = 0;
+
+    // Convert straight from the mapped pages, the stdio path is only for files that cannot be mapped
+    const char *src = h->cache == NULL ? LES_map_file(h, file_id) : NULL;
+    if (h->cache != NULL) {
+        return LES_read_frame_cache(h, table, frame, velocity_only);
+    } else if (src != NULL && base + 4 * stride + nn * sizeof(float) <= h->map_sizes[file_id]) {
+        // Timestamp of the frame
+        memcpy(table->data.a, src + offset, sizeof(float));
+        LES_remap_frame(h, table, src + base, stride, velocity_only, p_for_cn2);
+        return true;
+    }
+    return LES_read_frame_stdio(h, table, file_id, offset, stride, velocity_only, p_for_cn2);
+}
+
 void *LES_background_read(LESHandle i) {
     LESMem *h = (LESMem *)i;
-    int frame;
+    int frame = -1, k;
     LESTable *table;
+    bool velocity_only;
+    bool throttled = false;
+    struct timeval t0, t1;
+    struct timespec until;
 
-    bool p_for_cn2 = !strcmp(h->config, LESConfigFlat);
-    //rsprint("==> p_for_cn2 = %d\n", p_for_cn2);
-    
-    // Read ahead
+    // Read ahead, the lock is only let go while a box is filled or while waiting
+    pthread_mutex_lock(&h->lock);
     while (h->active) {
-        frame = h->req;
-
-        // The file number of the list of files to read
-        int file_id = frame / LES_file_nblock;
+        gettimeofday(&t0, NULL);
+        while (h->active && (frame = LES_next_missing_frame(h)) < 0) {
+            pthread_cond_wait(&h->wanted, &h->lock);
+        }
+        // The GUI throttles the frames that are only read ahead, never the one the consumer waits for
+        if (h->active && h->delayed_read && !h->waiting && !throttled && h->stats.frames_read > 0) {
+            until.tv_sec = t0.tv_sec + (t0.tv_usec + 200000) / 1000000;
+            until.tv_nsec = ((t0.tv_usec + 200000) % 1000000) * 1000;
+            pthread_cond_timedwait(&h->wanted, &h->lock, &until);
+            throttled = true;
+        }
+        gettimeofday(&t1, NULL);
+        h->stats.idle_time += LES_dtime(&t0, &t1);
+        if (!h->active) {
+            break;
+        }
+        if (throttled && LES_next_missing_frame(h) != frame) {
+            // The window moved while waiting
+            continue;
+        }
+        throttled = false;
+        k = LES_free_box(h);
+        h->data_id[k] = -1;
+        h->reading = true;
+        pthread_mutex_unlock(&h->lock);
 
         #ifdef DEBUG
-        rsprint("Background ingest %s %d -> %d\n", h->files[file_id], h->req, h->ibuf);
+        rsprint("Background ingest %s %d -> %d\n", h->files[frame / LES_file_nblock], frame, k);
         #endif
 
         // The table in collection of data boxes
-        table = h->data_boxes[h->ibuf];
+        table = h->data_boxes[k];
 
         // Copy over some base parameters
         table->ax = h->ax;
@@ -348,79 +791,589 @@ void *LES_background_read(LESHandle i) {
         table->tr = h->tr;
         //rsprint("ax = %.2f   ay = %.2f\n", h->ax, h->ay);
 
-        long offset = sizeof(uint32_t) +                     // version number
-        (frame % LES_file_nblock) *
-        (sizeof(float) + 2 * sizeof(uint32_t)                // time
-         + table->nn * sizeof(float) + 2 * sizeof(uint32_t)  // u
-         + table->nn * sizeof(float) + 2 * sizeof(uint32_t)  // v
-         + table->nn * sizeof(float) + 2 * sizeof(uint32_t)  // w
-         + table->nn * sizeof(float) + 2 * sizeof(uint32_t)  // p
-         + table->nn * sizeof(float) + 2 * sizeof(uint32_t)  // t
-         );
-
-        // Derive filename to ingest a set of LESTables
-        FILE *fid = fopen(h->files[file_id], "r");
-        if (fid == NULL) {
-            fprintf(stderr, "Error opening LES table file %s %d\n", h->files[file_id], file_id);
+        // Latch the option so that all of this frame is handled consistently
+        velocity_only = h->velocity_only;
+
+        bool ok = true;
+        if (h->window != NULL) {
+            // The box points into the slot of the frame, full frames since the other processes may crop differently
+            LES_window_release(h, k);
+            const int s = LES_window_acquire(h, frame, velocity_only);
+            if (s >= 0) {
+                LES_window_point_table(h, table, s);
+                LES_attach_icdf(h, table, frame);
+                h->slot_id[k] = s;
+            }
+            ok = s >= 0;
+        } else {
+            // Latch the sub-box so that all of this frame is read consistently
+            pthread_mutex_lock(&h->crop_lock);
+            table->ox = h->crop_ox;
+            table->oy = h->crop_oy;
+            table->oz = h->crop_oz;
+            table->nx = h->crop_nx;
+            table->ny = h->crop_ny;
+            table->nz = h->crop_nz;
+            pthread_mutex_unlock(&h->crop_lock);
+            table->nn = table->nx * table->ny * table->nz;
+            ok = LES_read_frame(h, table, frame, velocity_only);
+        }
+        if (!ok) {
+            pthread_mutex_lock(&h->lock);
+            h->active = false;
+            h->reading = false;
+            pthread_cond_broadcast(&h->ready);
+            pthread_mutex_unlock(&h->lock);
             return NULL;
         }
-        fseek(fid, offset, SEEK_SET);
+
+        // Half-precision copies for the CL_HALF_FLOAT images, done here so the consumer does not pay for it
+        if (h->half_precision) {
+            LES_table_make_half(table, !velocity_only);
+        } else {
+            table->has_half = false;
+        }
+
+        gettimeofday(&t0, NULL);
+
+        // Record down the frame id
+        pthread_mutex_lock(&h->lock);
+        h->data_id[k] = frame;
+        h->reading = false;
+        h->stats.frames_read++;
+        h->stats.read_time += LES_dtime(&t1, &t0);
+        pthread_cond_broadcast(&h->ready);
+    }
+    pthread_mutex_unlock(&h->lock);
+    return NULL;
+}
+
+// Files are mapped once by the root, the handles that share it take the same mapping
+static const char *LES_map_root_file(LESMem *r, const int file_id) {
+    if (r->maps[file_id] != NULL) {
+        return r->maps[file_id];
+    }
+    int fd = open(r->files[file_id], O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) || file_stat.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping holds its own reference to the file
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "LES : Unable to map %s. Reading through stdio.\n", r->files[file_id]);
+        return NULL;
+    }
+    r->map_sizes[file_id] = file_stat.st_size;
+    r->maps[file_id] = (char *)map;
+    return r->maps[file_id];
+}
+
+const char *LES_map_file(LESMem *h, const int file_id) {
+    pthread_mutex_lock(&LES_share_lock);
+    const char *map = LES_map_root_file(h->root, file_id);
+    if (h != h->root) {
+        h->maps[file_id] = h->root->maps[file_id];
+        h->map_sizes[file_id] = h->root->map_sizes[file_id];
+    }
+    pthread_mutex_unlock(&LES_share_lock);
+    return map;
+}
+
+// Name of a file derived from the configuration, false if it does not fit
+static bool LES_filename_in(char *filename, const size_t size, const LESMem *h, const char *path, const char *extension) {
+    const int length = snprintf(filename, size, "%s/%s-v%.0f.%s", path, h->config, h->v0, extension);
+    if (length < 0 || (size_t)length >= size) {
+        fprintf(stderr, "LES : File name under %s is too long.\n", path);
+        return false;
+    }
+    return true;
+}
+
+static bool LES_map_cache(LESMem *h, const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) || file_stat.st_size < sizeof(LESCacheHeader)) {
+        close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "LES : Unable to map %s.\n", filename);
+        return false;
+    }
+    // Only a cache made from this very configuration is used
+    const LESCacheHeader *header = (const LESCacheHeader *)map;
+    const size_t nn = (size_t)h->data_grid->nx * h->data_grid->ny * h->data_grid->nz;
+    bool ok = !memcmp(header->magic, LESCacheMagic, sizeof(header->magic)) &&
+              header->version == LESCacheVersion &&
+              !strncmp(header->config, h->config, sizeof(header->config)) &&
+              header->nx == h->data_grid->nx && header->ny == h->data_grid->ny && header->nz == h->data_grid->nz &&
+              header->nc == h->ncubes &&
+              header->v0 == h->v0 && header->p0 == h->p0 && header->t0 == h->t0;
+    if (ok && header->codec == LESCacheCodecNone) {
+        ok = header->frame_size >= 4 * sizeof(float) + 2 * nn * sizeof(LESFloat4) + header->icdf_count * sizeof(float) &&
+             header->frame_offset + header->nc * header->frame_size <= file_stat.st_size;
+    } else if (ok && header->codec == LESCacheCodecShuffleRLE) {
+        // Chunks are checked as they are decoded, only the index itself here
+        const size_t count = (size_t)header->nc * (2 * header->nz + 2);
+        ok = header->index_offset % sizeof(uint64_t) == 0 &&
+             header->index_offset + count * sizeof(uint64_t) <= file_stat.st_size &&
+             ((const uint64_t *)((const char *)map + header->index_offset))[count - 1] <= file_stat.st_size;
+        // A decoded plane for each thread
+        for (int k = 0; k < h->remap_threads && ok; k++) {
+            if (h->scratch[k] == NULL) {
+                h->scratch[k] = (uint32_t *)malloc((size_t)header->nx * header->ny * sizeof(LESFloat4));
+            }
+            ok = h->scratch[k] != NULL;
+        }
+    } else {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "LES : Ignoring stale cache %s.\n", filename);
+        munmap(map, file_stat.st_size);
+        return false;
+    }
+    h->cache = (char *)map;
+    h->cache_size = file_stat.st_size;
+    #ifdef DEBUG
+    rsprint("LES cache @ %s\n", filename);
+    #endif
+    return true;
+}
+
+void LES_open_cache(LESMem *h) {
+    char filename[1280];
+    // A cache published under LES_CACHE_PATH, e.g., on a node-local tmpfs, comes before the one next to the data
+    const char *path = getenv(LESCachePathVariable);
+    if (path != NULL && *path != '\0' && LES_filename_in(filename, sizeof(filename), h, path, LESCacheExtension) &&
+        LES_map_cache(h, filename)) {
+        return;
+    }
+    if (LES_filename_in(filename, sizeof(filename), h, h->data_path, LESCacheExtension)) {
+        LES_map_cache(h, filename);
+    }
+}
+
+// A window published under LES_WINDOW_PATH by LES_create_window(), the frames of this configuration are then shared
+void LES_open_window(LESMem *h) {
+    char filename[1280];
+    const char *path = getenv(LESWindowPathVariable);
+    if (path == NULL || *path == '\0' || !LES_filename_in(filename, sizeof(filename), h, path, LESWindowExtension)) {
+        return;
+    }
+    int fd = open(filename, O_RDWR);
+    if (fd < 0) {
+        return;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) || file_stat.st_size < sizeof(LESWindow)) {
+        close(fd);
+        return;
+    }
+    void *map = mmap(NULL, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "LES : Unable to map %s.\n", filename);
+        return;
+    }
+    const LESWindow *w = (const LESWindow *)map;
+    const size_t nn = (size_t)h->data_grid->nx * h->data_grid->ny * h->data_grid->nz;
+    bool ok = !memcmp(w->magic, LESWindowMagic, sizeof(w->magic)) &&
+              w->version == LESWindowVersion &&
+              !strncmp(w->config, h->config, sizeof(w->config)) &&
+              w->nx == h->data_grid->nx && w->ny == h->data_grid->ny && w->nz == h->data_grid->nz &&
+              w->nc == h->ncubes &&
+              w->v0 == h->v0 && w->p0 == h->p0 && w->t0 == h->t0 &&
+              w->depth >= 1 && w->slot_count <= LES_window_max_slots &&
+              w->slot_size >= 4 * sizeof(float) + 2 * nn * sizeof(LESFloat4) &&
+              w->slot_offset + w->slot_count * w->slot_size <= file_stat.st_size;
+    if (!ok) {
+        fprintf(stderr, "LES : Ignoring stale window %s.\n", filename);
+        munmap(map, file_stat.st_size);
+        return;
+    }
+    h->window = (LESWindow *)map;
+    h->window_size = file_stat.st_size;
+    #ifdef DEBUG
+    rsprint("LES window @ %s\n", filename);
+    #endif
+}
+
+// Time stamp, uvwt & cpxx of a table in a slot of the window, always the full grid
+void LES_window_point_table(const LESMem *h, LESTable *table, const int s) {
+    const LESWindow *w = h->window;
+    char *slot = (char *)w + w->slot_offset + (size_t)s * w->slot_size;
+    table->ox = 0;
+    table->oy = 0;
+    table->oz = 0;
+    table->nx = w->nx;
+    table->ny = w->ny;
+    table->nz = w->nz;
+    table->nn = table->nx * table->ny * table->nz;
+    table->data.a = (float *)slot;
+    table->uvwt = (LESFloat4 *)(slot + 4 * sizeof(float));
+    table->cpxx = table->uvwt + table->nn;
+}
+
+// Slot that holds the frame, filled here when no process of the node has it yet, -1 if it cannot be read
+int LES_window_acquire(LESMem *h, const int frame, const bool velocity_only) {
+    LESWindow *w = h->window;
+    LESWindowSlot *slot;
+    int s, k;
+    pthread_mutex_lock(&w->lock);
+    while (true) {
+        for (s = 0; s < w->slot_count; s++) {
+            if (w->slots[s].state != LESWindowSlotEmpty && w->slots[s].frame == frame && w->slots[s].velocity_only == velocity_only) {
+                break;
+            }
+        }
+        if (s < w->slot_count) {
+            slot = &w->slots[s];
+            if (slot->state == LESWindowSlotReady) {
+                slot->refs++;
+                slot->stamp = ++w->clock;
+                pthread_mutex_unlock(&w->lock);
+                return s;
+            }
+            // Another process is filling it
+            pthread_cond_wait(&w->changed, &w->lock);
+            continue;
+        }
+        // The least recently used slot that no box points into, the slots cover every process at the window depth
+        s = -1;
+        for (k = 0; k < w->slot_count; k++) {
+            if (w->slots[k].refs == 0 && w->slots[k].state != LESWindowSlotFilling && (s < 0 || w->slots[k].stamp < w->slots[s].stamp)) {
+                s = k;
+            }
+        }
+        if (s >= 0) {
+            break;
+        }
+        pthread_cond_wait(&w->changed, &w->lock);
+    }
+    slot = &w->slots[s];
+    slot->frame = frame;
+    slot->state = LESWindowSlotFilling;
+    slot->refs = 1;
+    slot->velocity_only = velocity_only;
+    pthread_mutex_unlock(&w->lock);
+
+    LESTable table;
+    memset(&table, 0, sizeof(LESTable));
+    LES_window_point_table(h, &table, s);
+    const bool ok = LES_read_frame(h, &table, frame, velocity_only);
+
+    pthread_mutex_lock(&w->lock);
+    if (ok) {
+        slot->state = LESWindowSlotReady;
+    } else {
+        slot->state = LESWindowSlotEmpty;
+        slot->frame = -1;
+        slot->refs = 0;
+    }
+    slot->stamp = ++w->clock;
+    pthread_cond_broadcast(&w->changed);
+    pthread_mutex_unlock(&w->lock);
+    return ok ? s : -1;
+}
+
+// Lets go of the slot box k points into
+void LES_window_release(LESMem *h, const int k) {
+    LESWindow *w = h->window;
+    LESTable *table = h->data_boxes[k];
+    if (w == NULL || h->slot_id[k] < 0) {
+        return;
+    }
+    pthread_mutex_lock(&w->lock);
+    w->slots[h->slot_id[k]].refs--;
+    pthread_cond_broadcast(&w->changed);
+    pthread_mutex_unlock(&w->lock);
+    h->slot_id[k] = -1;
+    table->data.a = NULL;
+    table->uvwt = NULL;
+    table->cpxx = NULL;
+}
+
+static void *LES_unpack_planes(void *in) {
+    LESRemap *r = (LESRemap *)in;
+    const LESGrid *grid = r->h->data_grid;
+    LESTable *table = r->table;
+    const size_t count = (size_t)grid->nx * grid->ny * 4;
+    const LESFloat4 *plane = (const LESFloat4 *)r->scratch;
+    for (uint32_t iz = r->z0; iz < r->z1; iz++) {
+        // The uvwt chunk of the plane, then cpxx unless velocity only
+        const uint64_t *chunk = r->index + 1 + 2 * (iz + table->oz);
+        for (int c = 0; c < (r->velocity_only ? 1 : 2); c++) {
+            if (chunk[c] > chunk[c + 1] || chunk[c + 1] > r->h->cache_size ||
+                !RLE_unpack(r->scratch, count, (const uint8_t *)r->src + chunk[c], chunk[c + 1] - chunk[c])) {
+                r->ok = false;
+                return NULL;
+            }
+            LESFloat4 *dst = c == 0 ? table->uvwt : table->cpxx;
+            for (uint32_t iy = 0; iy < table->ny; iy++) {
+                const size_t k = ((size_t)iz * table->ny + iy) * table->nx;
+                memcpy(dst + k, plane + (size_t)(iy + table->oy) * grid->nx + table->ox, table->nx * sizeof(LESFloat4));
+                if (c == 0 && r->velocity_only) {
+                    for (uint32_t i = 0; i < table->nx; i++) {
+                        dst[k + i][3] = 0.0f;
+                    }
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+// The ICDF is of the full grid, the debris flux is only derived from frames that are not cropped
+void LES_attach_icdf(const LESMem *h, LESTable *table, const int frame) {
+    const LESCacheHeader *header = (const LESCacheHeader *)h->cache;
+    const size_t nn = (size_t)h->data_grid->nx * h->data_grid->ny * h->data_grid->nz;
+    table->flux_icdf = NULL;
+    table->flux_icdf_count = 0;
+    if (header == NULL || header->icdf_count == 0) {
+        return;
+    }
+    if (header->codec == LESCacheCodecShuffleRLE) {
+        const uint64_t *index = (const uint64_t *)(h->cache + header->index_offset) + (size_t)frame * (2 * header->nz + 2);
+        if (index[1] < index[0] || index[1] - index[0] < (4 + header->icdf_count) * sizeof(float) || index[1] > h->cache_size) {
+            return;
+        }
+        table->flux_icdf = (const float *)(h->cache + index[0]) + 4;
+    } else {
+        table->flux_icdf = (const float *)(h->cache + header->frame_offset + (size_t)frame * header->frame_size +
+                                           4 * sizeof(float) + 2 * nn * sizeof(LESFloat4));
+    }
+    table->flux_icdf_count = header->icdf_count;
+}
+
+bool LES_read_frame_cache(LESMem *h, LESTable *table, const int frame, const bool velocity_only) {
+    const LESCacheHeader *header = (const LESCacheHeader *)h->cache;
+    const LESGrid *grid = h->data_grid;
+    const size_t nn = (size_t)grid->nx * grid->ny * grid->nz;
+    size_t k = 0, o;
+
+    if (header->codec == LESCacheCodecShuffleRLE) {
+        // Planes are decoded on the remap threads, straight into the sub-box
+        const uint64_t *index = (const uint64_t *)(h->cache + header->index_offset) + (size_t)frame * (2 * grid->nz + 2);
+        if (index[1] < index[0] || index[1] - index[0] < (4 + header->icdf_count) * sizeof(float) || index[1] > h->cache_size) {
+            fprintf(stderr, "LES : Corrupted frame %d in the cache.\n", frame);
+            return false;
+        }
+        LESRemap job = {.h = h, .table = table, .src = h->cache, .index = index, .velocity_only = velocity_only};
+        if (!LES_share_planes(h, &job, LES_unpack_planes)) {
+            fprintf(stderr, "LES : Unable to decode frame %d of the cache.\n", frame);
+            return false;
+        }
+        memcpy(table->data.a, h->cache + index[0], sizeof(float));
+    } else {
+        const char *src = h->cache + header->frame_offset + (size_t)frame * header->frame_size;
+        const LESFloat4 *uvwt = (const LESFloat4 *)(src + 4 * sizeof(float));
+        const LESFloat4 *cpxx = uvwt + nn;
+
         // Timestamp of the frame
-        fread(table->data.a, sizeof(float), 1, fid);
-        fseek(fid, 2 * sizeof(uint32_t), SEEK_CUR);
-        // Wind u
-        fread(table->data.u, sizeof(float), table->nn, fid);
-        fseek(fid, 2 * sizeof(int32_t), SEEK_CUR);
-        // Wind v
-        fread(table->data.v, sizeof(float), table->nn, fid);
-        fseek(fid, 2 * sizeof(int32_t), SEEK_CUR);
-        // Wind w
-        fread(table->data.w, sizeof(float), table->nn, fid);
-        fseek(fid, 2 * sizeof(int32_t), SEEK_CUR);
-        // Pressure p
-        fread(table->data.p, sizeof(float), table->nn, fid);
-        fseek(fid, 2 * sizeof(int32_t), SEEK_CUR);
-        // Something t
-        fread(table->data.t, sizeof(float), table->nn, fid);
-        fseek(fid, 2 * sizeof(int32_t), SEEK_CUR);
-        fclose(fid);
-
-        // Scale back & remap
-        for (int k = 0; k < table->nn; k++) {
-            table->data.u[k] *= h->v0;
-            table->data.v[k] *= h->v0;
-            table->data.w[k] *= h->v0;
-            table->data.p[k] *= h->p0;
-            table->data.t[k] *= h->t0;
-            table->uvwt[k][0] = table->data.u[k];
-            table->uvwt[k][1] = table->data.v[k];
-            table->uvwt[k][2] = table->data.w[k];
-            table->uvwt[k][3] = table->data.t[k];
-            if (p_for_cn2) {
-                table->cpxx[k][0] = table->data.p[k];
-                table->cpxx[k][1] = 0.0f;
-            } else {
-                table->cpxx[k][0] = 0.0f;
-                table->cpxx[k][1] = table->data.p[k];
+        memcpy(table->data.a, src, sizeof(float));
+
+        // Already scaled and interleaved, only the rows of the sub-box are gathered
+        for (uint32_t iz = table->oz; iz < table->oz + table->nz; iz++) {
+            for (uint32_t iy = table->oy; iy < table->oy + table->ny; iy++) {
+                o = ((size_t)iz * grid->ny + iy) * grid->nx + table->ox;
+                memcpy(table->uvwt + k, uvwt + o, table->nx * sizeof(LESFloat4));
+                if (velocity_only) {
+                    // Same as the raw readers, t is left out
+                    for (uint32_t i = 0; i < table->nx; i++) {
+                        table->uvwt[k + i][3] = 0.0f;
+                    }
+                } else {
+                    memcpy(table->cpxx + k, cpxx + o, table->nx * sizeof(LESFloat4));
+                }
+                k += table->nx;
             }
         }
+    }
 
-        // Record down the frame id
-        h->data_id[h->ibuf] = frame;
+    LES_attach_icdf(h, table, frame);
+    return true;
+}
 
-        // Update the index
-        h->ibuf = h->ibuf == LES_num - 1 ? 0 : h->ibuf + 1;
+static void LES_remap_row(LESFloat4 *uvwt, LESFloat4 *cpxx,
+                          const float *u, const float *v, const float *w, const float *p, const float *t, const uint32_t n,
+                          const float v0, const float p0, const float t0, const bool velocity_only, const bool p_for_cn2) {
+    uint32_t i = 0;
+#if defined (__SSE__)
+    // Four cells at a time: scale the planar rows, then transpose into (u, v, w, t) and (cn2, p, _, _)
+    const __m128 sv = _mm_set1_ps(v0);
+    const __m128 sp = _mm_set1_ps(p0);
+    const __m128 st = _mm_set1_ps(t0);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 a, b, c, d;
+    for (; i + 4 <= n; i += 4) {
+        a = _mm_mul_ps(_mm_loadu_ps(u + i), sv);
+        b = _mm_mul_ps(_mm_loadu_ps(v + i), sv);
+        c = _mm_mul_ps(_mm_loadu_ps(w + i), sv);
+        d = velocity_only ? zero : _mm_mul_ps(_mm_loadu_ps(t + i), st);
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        _mm_storeu_ps(uvwt[i    ], a);
+        _mm_storeu_ps(uvwt[i + 1], b);
+        _mm_storeu_ps(uvwt[i + 2], c);
+        _mm_storeu_ps(uvwt[i + 3], d);
+        if (velocity_only) {
+            continue;
+        }
+        a = _mm_mul_ps(_mm_loadu_ps(p + i), sp);
+        b = zero;
+        if (!p_for_cn2) {
+            b = a;
+            a = zero;
+        }
+        c = zero;
+        d = zero;
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        _mm_storeu_ps(cpxx[i    ], a);
+        _mm_storeu_ps(cpxx[i + 1], b);
+        _mm_storeu_ps(cpxx[i + 2], c);
+        _mm_storeu_ps(cpxx[i + 3], d);
+    }
+#endif
+    for (; i < n; i++) {
+        uvwt[i][0] = u[i] * v0;
+        uvwt[i][1] = v[i] * v0;
+        uvwt[i][2] = w[i] * v0;
+        if (velocity_only) {
+            uvwt[i][3] = 0.0f;
+            continue;
+        }
+        uvwt[i][3] = t[i] * t0;
+        cpxx[i][0] = p_for_cn2 ? p[i] * p0 : 0.0f;
+        cpxx[i][1] = p_for_cn2 ? 0.0f : p[i] * p0;
+        cpxx[i][2] = 0.0f;
+        cpxx[i][3] = 0.0f;
+    }
+}
 
-        do {
-            usleep(100000);
-        } while (h->active && frame == h->req);
-        if (h->delayed_read) {
-            usleep(200000);
+static void *LES_remap_planes(void *in) {
+    LESRemap *r = (LESRemap *)in;
+    const LESGrid *grid = r->h->data_grid;
+    LESTable *table = r->table;
+    const long s = r->stride / sizeof(float);
+    for (uint32_t iz = r->z0; iz < r->z1; iz++) {
+        for (uint32_t iy = 0; iy < table->ny; iy++) {
+            const long o = ((long)(iz + table->oz) * grid->ny + iy + table->oy) * grid->nx + table->ox;
+            const float *u = (const float *)r->src + o;
+            const size_t k = ((size_t)iz * table->ny + iy) * table->nx;
+            LES_remap_row(table->uvwt + k, table->cpxx + k, u, u + s, u + 2 * s, u + 3 * s, u + 4 * s, table->nx,
+                          r->h->v0, r->h->p0, r->h->t0, r->velocity_only, r->p_for_cn2);
         }
     }
     return NULL;
 }
 
+bool LES_share_planes(LESMem *h, const LESRemap *job, void *(*worker)(void *)) {
+    // Planes are shared out to a few threads, the calling thread takes the first share
+    const int count = (int)MIN(h->remap_threads, job->table->nz);
+    LESRemap remaps[LES_remap_max_threads];
+    pthread_t tids[LES_remap_max_threads];
+    bool ok = true;
+    int k;
+    for (k = 0; k < count; k++) {
+        remaps[k] = *job;
+        remaps[k].z0 = (uint32_t)((size_t)job->table->nz * k / count);
+        remaps[k].z1 = (uint32_t)((size_t)job->table->nz * (k + 1) / count);
+        remaps[k].scratch = h->scratch[k];
+        remaps[k].ok = true;
+    }
+    for (k = 1; k < count; k++) {
+        if (pthread_create(&tids[k], NULL, worker, &remaps[k])) {
+            // Not enough resources, do this share here
+            worker(&remaps[k]);
+            tids[k] = 0;
+        }
+    }
+    worker(&remaps[0]);
+    for (k = 1; k < count; k++) {
+        if (tids[k]) {
+            pthread_join(tids[k], NULL);
+        }
+    }
+    for (k = 0; k < count; k++) {
+        ok &= remaps[k].ok;
+    }
+    return ok;
+}
+
+void LES_remap_frame(LESMem *h, LESTable *table, const char *src, const long stride, const bool velocity_only, const bool p_for_cn2) {
+    LESRemap job = {.h = h, .table = table, .src = src, .stride = stride, .velocity_only = velocity_only, .p_for_cn2 = p_for_cn2};
+    LES_share_planes(h, &job, LES_remap_planes);
+}
+
+bool LES_read_frame_stdio(LESMem *h, LESTable *table, const int file_id, const long offset, const long stride, const bool velocity_only, const bool p_for_cn2) {
+    const long base = offset + sizeof(float) + 2 * sizeof(uint32_t);
+
+    // The raw u, v, w, p & t of the box only live for this read
+    float *u = (float *)malloc(5 * (size_t)table->nn * sizeof(float));
+    if (u == NULL) {
+        fprintf(stderr, "LES : Unable to allocate the raw planes of a frame.\n");
+        return false;
+    }
+    float *v = u + table->nn;
+    float *w = v + table->nn;
+    float *p = w + table->nn;
+    float *t = p + table->nn;
+
+    // Derive filename to ingest a set of LESTables
+    FILE *fid = fopen(h->files[file_id], "r");
+    if (fid == NULL) {
+        fprintf(stderr, "Error opening LES table file %s %d\n", h->files[file_id], file_id);
+        free(u);
+        return false;
+    }
+    fseek(fid, offset, SEEK_SET);
+    // Timestamp of the frame
+    fread(table->data.a, sizeof(float), 1, fid);
+    // Wind u, v, w
+    LES_read_box(fid, u, base, h->data_grid, table);
+    LES_read_box(fid, v, base + stride, h->data_grid, table);
+    LES_read_box(fid, w, base + 2 * stride, h->data_grid, table);
+    if (!velocity_only) {
+        // Pressure p & something t
+        LES_read_box(fid, p, base + 3 * stride, h->data_grid, table);
+        LES_read_box(fid, t, base + 4 * stride, h->data_grid, table);
+    }
+    fclose(fid);
+
+    // Scale back & remap, the box is contiguous so it goes as one long row; cpxx is left untouched when velocity only
+    LES_remap_row(table->uvwt, table->cpxx, u, v, w, p, t, table->nn, h->v0, h->p0, h->t0, velocity_only, p_for_cn2);
+    free(u);
+    return true;
+}
+
+void LES_read_box(FILE *fid, float *dst, const long base, const LESGrid *grid, const LESTable *table) {
+    // Whole xy-planes are contiguous in the file, otherwise go row by row
+    if (table->nx == grid->nx && table->ny == grid->ny) {
+        fseek(fid, base + (long)table->oz * grid->nx * grid->ny * sizeof(float), SEEK_SET);
+        fread(dst, sizeof(float), table->nn, fid);
+        return;
+    }
+    for (uint32_t iz = 0; iz < table->nz; iz++) {
+        for (uint32_t iy = 0; iy < table->ny; iy++) {
+            long o = ((long)(iz + table->oz) * grid->ny + iy + table->oy) * grid->nx + table->ox;
+            fseek(fid, base + o * sizeof(float), SEEK_SET);
+            fread(dst, sizeof(float), table->nx, fid);
+            dst += table->nx;
+        }
+    }
+}
+
 #pragma mark -
 
 void LES_show_row(const char *prefix, const char *posfix, const float *f, const int n) {
@@ -574,7 +1527,7 @@ void LES_show_grid_summary(const LESGrid *grid) {
 }
 
 
-LESTable *LES_table_create(const LESGrid *grid) {
+LESTable *LES_table_create(const LESGrid *grid, const bool with_data) {
 	LESTable *table = (LESTable *)malloc(sizeof(LESTable));
 	if (table == NULL) {
 		fprintf(stderr, "Error allocating table (LESTable).\n");
@@ -584,6 +1537,12 @@ LESTable *LES_table_create(const LESGrid *grid) {
 	table->ny = grid->ny;
 	table->nz = grid->nz;
 	table->nn = grid->nz * grid->ny * grid->nx;
+    table->ox = 0;
+    table->oy = 0;
+    table->oz = 0;
+    table->gx = grid->nx;
+    table->gy = grid->ny;
+    table->gz = grid->nz;
 	table->nt = LES_file_nblock;
     table->nc = 0;
     table->tr = 1.0f;
@@ -591,67 +1550,149 @@ LESTable *LES_table_create(const LESGrid *grid) {
 	table->data.x = grid->x;
 	table->data.y = grid->y;
 	table->data.z = grid->z;
-    table->data.a = (float *)malloc(4 * sizeof(float));
-	table->data.u = (float *)malloc(table->nn * sizeof(float));
-	table->data.v = (float *)malloc(table->nn * sizeof(float));
-	table->data.w = (float *)malloc(table->nn * sizeof(float));
-	table->data.p = (float *)malloc(table->nn * sizeof(float));
-	table->data.t = (float *)malloc(table->nn * sizeof(float));
-    table->uvwt = (LESFloat4 *)malloc(table->nn * sizeof(LESFloat4));
-    table->cpxx = (LESFloat4 *)malloc(table->nn * sizeof(LESFloat4));
     table->flux = (float *)malloc(table->nn * sizeof(float));
-	if (table->data.u == NULL || table->data.v == NULL || table->data.w == NULL || table->data.p == NULL || table->data.t == NULL ||
-        table->uvwt == NULL || table->cpxx == NULL || table->flux == NULL) {
+    // Without data, the time stamp, uvwt & cpxx are pointed somewhere else, e.g., a slot of a window
+    if (with_data) {
+        table->data.a = (float *)malloc(4 * sizeof(float));
+        table->uvwt = (LESFloat4 *)malloc(table->nn * sizeof(LESFloat4));
+        table->cpxx = (LESFloat4 *)malloc(table->nn * sizeof(LESFloat4));
+    } else {
+        table->data.a = NULL;
+        table->uvwt = NULL;
+        table->cpxx = NULL;
+    }
+	if ((with_data && (table->data.a == NULL || table->uvwt == NULL || table->cpxx == NULL)) || table->flux == NULL) {
         fprintf(stderr, "Error allocating memory for [LESTable] values.\n");
         free(table);
         return NULL;
 	}
-    memset(table->data.u, 0, table->nn * sizeof(float));
-    memset(table->data.v, 0, table->nn * sizeof(float));
-    memset(table->data.w, 0, table->nn * sizeof(float));
-    memset(table->data.p, 0, table->nn * sizeof(float));
-    memset(table->data.t, 0, table->nn * sizeof(float));
-    memset(table->uvwt, 0, table->nn * sizeof(LESFloat4));
-    memset(table->cpxx, 0, table->nn * sizeof(LESFloat4));
+    if (with_data) {
+        memset(table->data.a, 0, 4 * sizeof(float));
+        memset(table->uvwt, 0, table->nn * sizeof(LESFloat4));
+        memset(table->cpxx, 0, table->nn * sizeof(LESFloat4));
+    }
     memset(table->flux, 0, table->nn * sizeof(float));
+    table->uvwt_half = NULL;
+    table->cpxx_half = NULL;
+    table->has_half = false;
+    table->flux_icdf = NULL;
+    table->flux_icdf_count = 0;
 	return table;
 }
 
 
 void LES_table_free(LESTable *table) {
-	// NOTE: table->data.u, table->data.v & table->data.w are allocated but
+	// NOTE: table->data.a is allocated but
 	//       table->data.x, table->data.y & table->data.z are assigned to grid->data.x, grid->data.y & grid->data.z
     free(table->data.a);
-	free(table->data.u);
-	free(table->data.v);
-	free(table->data.w);
-	free(table->data.p);
-	free(table->data.t);
     free(table->uvwt);
     free(table->cpxx);
     free(table->flux);
+    free(table->uvwt_half);
+    free(table->cpxx_half);
 	free(table);
 }
 
 
-void LES_show_table_summary(const LESTable *table) {
+static inline uint16_t LES_float_to_half(const float f) {
+    // IEEE 754 binary32 to binary16, round to nearest even
+    uint32_t x;
+    memcpy(&x, &f, sizeof(uint32_t));
+    uint16_t sign = (x >> 16) & 0x8000;
+    int32_t e = (int32_t)((x >> 23) & 0xff) - 127 + 15;
+    uint32_t m = x & 0x007fffff;
+    uint32_t h, r, s;
+    if (((x >> 23) & 0xff) == 0xff) {
+        // Inf or NaN
+        return sign | 0x7c00 | (m ? 0x0200 : 0);
+    } else if (e >= 31) {
+        // Overflow to Inf
+        return sign | 0x7c00;
+    } else if (e <= 0) {
+        // Subnormal or zero
+        if (e < -10) {
+            return sign;
+        }
+        m |= 0x00800000;
+        s = 14 - e;
+        h = m >> s;
+        r = m & ((1 << s) - 1);
+        if (r > (1 << (s - 1)) || (r == (1 << (s - 1)) && (h & 1))) {
+            h++;
+        }
+        return sign | h;
+    }
+    h = (e << 10) | (m >> 13);
+    r = m & 0x1fff;
+    if (r > 0x1000 || (r == 0x1000 && (h & 1))) {
+        // A carry into the exponent is the correct result
+        h++;
+    }
+    return sign | h;
+}
 
-    printf(" time = %.4f   nx = %d   ny = %d   nz = %d   nt = %d\n\n", table->data.a[0], table->nx, table->ny, table->nz, table->nt);
-    
-	printf(" u =\n");
-	LES_show_volume(table->data.u, table->nx, table->ny, table->nz);
 
-	printf(" v =\n");
-	LES_show_volume(table->data.v, table->nx, table->ny, table->nz);
+void LES_float4_to_half4(LESHalf4 *dst, const LESFloat4 *src, const size_t count) {
+#if defined (__F16C__)
+    for (size_t k = 0; k < count; k++) {
+        _mm_storel_epi64((__m128i *)dst[k], _mm_cvtps_ph(_mm_loadu_ps(src[k]), _MM_FROUND_TO_NEAREST_INT));
+    }
+#else
+    for (size_t k = 0; k < count; k++) {
+        dst[k][0] = LES_float_to_half(src[k][0]);
+        dst[k][1] = LES_float_to_half(src[k][1]);
+        dst[k][2] = LES_float_to_half(src[k][2]);
+        dst[k][3] = LES_float_to_half(src[k][3]);
+    }
+#endif
+}
+
 
-	printf(" w =\n");
-	LES_show_volume(table->data.w, table->nx, table->ny, table->nz);
+void LES_table_make_half(LESTable *table, const bool with_cpxx) {
+    // Sized for the full grid since the crop box may change from frame to frame
+    const size_t capacity = (size_t)table->gx * table->gy * table->gz;
+    if (table->uvwt_half == NULL) {
+        table->uvwt_half = (LESHalf4 *)malloc(capacity * sizeof(LESHalf4));
+    }
+    if (table->cpxx_half == NULL) {
+        table->cpxx_half = (LESHalf4 *)malloc(capacity * sizeof(LESHalf4));
+        if (table->cpxx_half != NULL) {
+            memset(table->cpxx_half, 0, capacity * sizeof(LESHalf4));
+        }
+    }
+    if (table->uvwt_half == NULL || table->cpxx_half == NULL) {
+        fprintf(stderr, "Error allocating memory for [LESTable] half-precision values.\n");
+        table->has_half = false;
+        return;
+    }
+    LES_float4_to_half4(table->uvwt_half, (const LESFloat4 *)table->uvwt, table->nn);
+    if (with_cpxx) {
+        LES_float4_to_half4(table->cpxx_half, (const LESFloat4 *)table->cpxx, table->nn);
+    }
+    table->has_half = true;
+}
 
-	printf(" p =\n");
-	LES_show_volume(table->data.p, table->nx, table->ny, table->nz);
 
-	printf(" t =\n");
-	LES_show_volume(table->data.t, table->nx, table->ny, table->nz);
+// Every reader fills uvwt & cpxx, so the summary is taken from those: u, v, w & t, then cn2 & p
+void LES_show_table_summary(const LESTable *table) {
+    static const char *names[] = {"u", "v", "w", "t", "cn2", "p"};
+    float *values = (float *)malloc(table->nn * sizeof(float));
+    if (values == NULL) {
+        fprintf(stderr, "LES : Unable to allocate the table summary.\n");
+        return;
+    }
+
+    printf(" time = %.4f   nx = %d   ny = %d   nz = %d   nt = %d\n\n", table->data.a[0], table->nx, table->ny, table->nz, table->nt);
+
+    for (int c = 0; c < 6; c++) {
+        const LESFloat4 *src = c < 4 ? table->uvwt : table->cpxx;
+        for (uint32_t k = 0; k < table->nn; k++) {
+            values[k] = src[k][c % 4];
+        }
+        printf(" %s =\n", names[c]);
+        LES_show_volume(values, table->nx, table->ny, table->nz);
+    }
+    free(values);
 }
 
 
@@ -666,34 +1707,294 @@ void LES_show_handle_summary(const LESHandle i) {
 LESTable *LES_get_frame(const LESHandle i, const int n) {
     LESTable *table = NULL;
     LESMem *h = (LESMem *)i;
-    int k = LES_num;
-    do {
-        k--;
-    } while (n != h->data_id[k] && k > 0);
-    if (n == h->data_id[k]) {
+    struct timeval t0, t1;
+    pthread_mutex_lock(&h->lock);
+    int k = LES_find_frame(h, n);
+    if (k >= 0) {
         #ifdef DEBUG_LES
-        printf("Found n = %d vs data_id = %d @ k = %d / %d\n", n, h->data_id[k], k, LES_num);
+        printf("Found n = %d vs data_id = %d @ k = %d / %d\n", n, h->data_id[k], k, h->nbuf);
         #endif
-        table = h->data_boxes[k];
-        // What to read in next
-        h->req = n == h->ncubes - 1 ? 0 : n + 1;
+        h->stats.hits++;
     } else {
         // Let background read ingest the desired frame.
-        int ibuf = h->ibuf;
         h->req = n;
-        //printf("Wait for background read.\n");
-        do {
-            usleep(10000);
-        } while (ibuf == h->ibuf);
-        table = h->data_boxes[ibuf];
-        // What to read in next
-        h->req = n == h->ncubes - 1 ? 0 : n + 1;
+        h->waiting = true;
+        pthread_cond_broadcast(&h->wanted);
+        gettimeofday(&t0, NULL);
+        while ((k = LES_find_frame(h, n)) < 0 && h->active) {
+            pthread_cond_wait(&h->ready, &h->lock);
+        }
+        h->waiting = false;
+        gettimeofday(&t1, NULL);
+        h->stats.stall_time += LES_dtime(&t0, &t1);
+        h->stats.stalls++;
+        if (k < 0) {
+            pthread_mutex_unlock(&h->lock);
+            fprintf(stderr, "LES : Background read stopped before frame %d.\n", n);
+            exit(EXIT_FAILURE);
+        }
     }
+    // The box stays with the consumer until the next call
+    table = h->data_boxes[k];
+    h->held = k;
+    // What to read in next
+    h->req = n == h->ncubes - 1 ? 0 : n + 1;
+    pthread_cond_broadcast(&h->wanted);
+    pthread_mutex_unlock(&h->lock);
     table->is_stretched = h->data_grid->is_stretched;
+    // Frames ingested before half precision was requested, e.g., the very first one, are converted here
+    if (h->half_precision && !table->has_half) {
+        LES_table_make_half(table, !h->velocity_only);
+    }
     return table;
 }
 
 
+bool LES_cache_filename(char *filename, const size_t size, const LESHandle i) {
+    LESMem *h = (LESMem *)i;
+    const char *path = getenv(LESCachePathVariable);
+    return LES_filename_in(filename, size, h, path != NULL && *path != '\0' ? path : h->data_path, LESCacheExtension);
+}
+
+
+bool LES_window_filename(char *filename, const size_t size, const LESHandle i, const char *path) {
+    LESMem *h = (LESMem *)i;
+    return LES_filename_in(filename, size, h, path, LESWindowExtension);
+}
+
+
+bool LES_create_window(const LESHandle i, const char *filename, const uint32_t process_count) {
+    LESMem *h = (LESMem *)i;
+    const size_t nn = (size_t)h->data_grid->nx * h->data_grid->ny * h->data_grid->nz;
+
+    // Every process holds the box of its consumer and reads up to depth ahead, one more slot is always free to fill
+    const uint32_t slot_count = process_count * (LES_window_depth + 1) + 1;
+    if (slot_count > LES_window_max_slots) {
+        fprintf(stderr, "LES : A window for %u processes needs more than %d slots.\n", process_count, LES_window_max_slots);
+        return false;
+    }
+    const uint64_t slot_offset = (sizeof(LESWindow) + LESCacheAlignment - 1) / LESCacheAlignment * LESCacheAlignment;
+    const uint64_t slot_size = (4 * sizeof(float) + 2 * nn * sizeof(LESFloat4) + LESCacheAlignment - 1) / LESCacheAlignment * LESCacheAlignment;
+
+    int fd = open(filename, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        fprintf(stderr, "LES : Unable to create %s.\n", filename);
+        return false;
+    }
+    // The file is sparse, on tmpfs only the slots that get filled take memory
+    if (ftruncate(fd, slot_offset + slot_count * slot_size)) {
+        fprintf(stderr, "LES : Unable to size %s.\n", filename);
+        close(fd);
+        unlink(filename);
+        return false;
+    }
+    LESWindow *w = (LESWindow *)mmap(NULL, slot_offset, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (w == MAP_FAILED) {
+        fprintf(stderr, "LES : Unable to map %s.\n", filename);
+        unlink(filename);
+        return false;
+    }
+    w->version = LESWindowVersion;
+    w->nx = h->data_grid->nx;
+    w->ny = h->data_grid->ny;
+    w->nz = h->data_grid->nz;
+    w->nc = (uint32_t)h->ncubes;
+    w->v0 = h->v0;
+    w->p0 = h->p0;
+    w->t0 = h->t0;
+    w->depth = LES_window_depth;
+    w->slot_count = slot_count;
+    w->slot_offset = slot_offset;
+    w->slot_size = slot_size;
+    memcpy(w->config, h->config, strlen(h->config) + 1);
+    for (int k = 0; k < slot_count; k++) {
+        w->slots[k].frame = -1;
+    }
+
+    // The lock & the condition are used by all the processes that map the window
+    pthread_mutexattr_t mutex_attr;
+    pthread_condattr_t cond_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_condattr_init(&cond_attr);
+    bool ok = !pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED) &&
+              !pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED) &&
+              !pthread_mutex_init(&w->lock, &mutex_attr) &&
+              !pthread_cond_init(&w->changed, &cond_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+    pthread_condattr_destroy(&cond_attr);
+    if (ok) {
+        // The magic goes in last, a window without it is never opened
+        memcpy(w->magic, LESWindowMagic, sizeof(w->magic));
+    } else {
+        fprintf(stderr, "LES : Process-shared locks are not available for %s.\n", filename);
+        unlink(filename);
+    }
+    munmap(w, slot_offset);
+    return ok;
+}
+
+
+bool LES_has_cache(const LESHandle i) {
+    LESMem *h = (LESMem *)i;
+    return h->cache != NULL;
+}
+
+
+void LES_set_cache_codec(LESHandle i, const uint32_t codec, const uint32_t mantissa_bits) {
+    LESMem *h = (LESMem *)i;
+    h->cache_codec = codec;
+    h->cache_mantissa_bits = MIN(mantissa_bits, 23);
+}
+
+
+static bool LES_write_cache_frames_packed(LESMem *h, FILE *fid, LESCacheHeader *header,
+                                          void (*derive_icdf)(float *icdf, const uint32_t count, const LESTable *table)) {
+    const size_t plane = (size_t)header->nx * header->ny;
+    const size_t count = plane * 4;
+    const size_t entries = 2 * (size_t)header->nz + 2;
+    const size_t head_size = (4 + header->icdf_count) * sizeof(float);
+    uint64_t *index = (uint64_t *)malloc(header->nc * entries * sizeof(uint64_t));
+    float *head = (float *)malloc(head_size);
+    uint32_t *words = (uint32_t *)malloc(count * sizeof(uint32_t));
+    uint8_t *packed = (uint8_t *)malloc(4 * (count + count / 128 + 1));
+    uint64_t offset = header->frame_offset;
+    bool ok = index != NULL && head != NULL && words != NULL && packed != NULL && !fseeko(fid, offset, SEEK_SET);
+    size_t e = 0, size;
+
+    for (int n = 0; n < header->nc && ok; n++) {
+        LESTable *table = LES_get_frame((LESHandle)h, n);
+        if (table->nn != plane * header->nz) {
+            fprintf(stderr, "LES : Cache needs full frames, frame %d is cropped.\n", n);
+            ok = false;
+            break;
+        }
+        // Time stamp & ICDF as they are
+        memset(head, 0, head_size);
+        head[0] = table->data.a[0];
+        if (header->icdf_count) {
+            derive_icdf(head + 4, header->icdf_count, table);
+        }
+        index[e++] = offset;
+        ok = fwrite(head, head_size, 1, fid) == 1;
+        offset += head_size;
+        // Then the uvwt & cpxx planes
+        for (uint32_t iz = 0; iz < header->nz && ok; iz++) {
+            for (int c = 0; c < 2 && ok; c++) {
+                memcpy(words, (c == 0 ? table->uvwt : table->cpxx) + iz * plane, count * sizeof(uint32_t));
+                RLE_round_mantissa(words, count, header->mantissa_bits);
+                size = RLE_pack(packed, words, count);
+                index[e++] = offset;
+                ok = fwrite(packed, size, 1, fid) == 1;
+                offset += size;
+            }
+        }
+        index[e++] = offset;
+    }
+    if (ok) {
+        ok = !fseeko(fid, header->index_offset, SEEK_SET) &&
+             fwrite(index, header->nc * entries * sizeof(uint64_t), 1, fid) == 1;
+    }
+    free(index);
+    free(head);
+    free(words);
+    free(packed);
+    return ok;
+}
+
+
+// Frames must come in full, i.e., no crop & not velocity only. Existing frames are taken from the cache if there is one.
+bool LES_write_cache(const LESHandle i, const char *filename, const uint32_t icdf_count,
+                     void (*derive_icdf)(float *icdf, const uint32_t count, const LESTable *table)) {
+    LESMem *h = (LESMem *)i;
+    const size_t nn = (size_t)h->data_grid->nx * h->data_grid->ny * h->data_grid->nz;
+
+    if (h->velocity_only) {
+        fprintf(stderr, "LES : Cache needs all variables, velocity only is set.\n");
+        return false;
+    }
+
+    LESCacheHeader header;
+    memset(&header, 0, sizeof(LESCacheHeader));
+    memcpy(header.magic, LESCacheMagic, sizeof(header.magic));
+    header.version = LESCacheVersion;
+    header.nx = h->data_grid->nx;
+    header.ny = h->data_grid->ny;
+    header.nz = h->data_grid->nz;
+    header.nc = (uint32_t)h->ncubes;
+    header.icdf_count = derive_icdf == NULL ? 0 : icdf_count;
+    header.v0 = h->v0;
+    header.p0 = h->p0;
+    header.t0 = h->t0;
+    header.codec = h->cache_codec;
+    header.mantissa_bits = h->cache_codec == LESCacheCodecNone ? 23 : h->cache_mantissa_bits;
+    if (header.codec == LESCacheCodecNone) {
+        header.frame_offset = LESCacheAlignment;
+        header.frame_size = 4 * sizeof(float) + 2 * nn * sizeof(LESFloat4) + header.icdf_count * sizeof(float);
+        header.frame_size = (header.frame_size + LESCacheAlignment - 1) / LESCacheAlignment * LESCacheAlignment;
+    } else {
+        header.index_offset = LESCacheAlignment;
+        header.frame_offset = header.index_offset + (size_t)header.nc * (2 * header.nz + 2) * sizeof(uint64_t);
+        header.frame_offset = (header.frame_offset + LESCacheAlignment - 1) / LESCacheAlignment * LESCacheAlignment;
+    }
+    memcpy(header.config, h->config, strlen(h->config) + 1);
+
+    char *frame = (char *)malloc(MAX(header.frame_size, LESCacheAlignment));
+    if (frame == NULL) {
+        fprintf(stderr, "LES : Unable to allocate a cache frame.\n");
+        return false;
+    }
+
+    // Written under a different name so that a partial cache is never picked up
+    char part[1280];
+    snprintf(part, sizeof(part), "%s.part", filename);
+    FILE *fid = fopen(part, "wb");
+    if (fid == NULL) {
+        fprintf(stderr, "LES : Unable to create %s.\n", part);
+        free(frame);
+        return false;
+    }
+    memset(frame, 0, MAX(header.frame_size, LESCacheAlignment));
+    bool ok = fwrite(&header, sizeof(LESCacheHeader), 1, fid) == 1 &&
+              fwrite(frame, LESCacheAlignment - sizeof(LESCacheHeader), 1, fid) == 1;
+
+    LESFloat4 *uvwt = (LESFloat4 *)(frame + 4 * sizeof(float));
+    if (header.codec != LESCacheCodecNone) {
+        ok = ok && LES_write_cache_frames_packed(h, fid, &header, derive_icdf);
+    } else {
+        for (int n = 0; n < h->ncubes && ok; n++) {
+            LESTable *table = LES_get_frame(i, n);
+            if (table->nn != nn) {
+                fprintf(stderr, "LES : Cache needs full frames, frame %d is cropped.\n", n);
+                ok = false;
+                break;
+            }
+            memset(frame, 0, header.frame_size);
+            memcpy(frame, table->data.a, sizeof(float));
+            memcpy(uvwt, table->uvwt, nn * sizeof(LESFloat4));
+            memcpy(uvwt + nn, table->cpxx, nn * sizeof(LESFloat4));
+            if (header.icdf_count) {
+                derive_icdf((float *)(uvwt + 2 * nn), header.icdf_count, table);
+            }
+            ok = fwrite(frame, header.frame_size, 1, fid) == 1;
+        }
+    }
+    free(frame);
+
+    if (fclose(fid) || !ok) {
+        fprintf(stderr, "LES : Unable to write %s.\n", part);
+        unlink(part);
+        return false;
+    }
+    if (rename(part, filename)) {
+        fprintf(stderr, "LES : Unable to rename %s to %s.\n", part, filename);
+        unlink(part);
+        return false;
+    }
+    return true;
+}
+
+
 char *LES_data_path(const LESHandle i) {
     LESMem *h = (LESMem *)i;
     return h->data_path;
@@ -17,9 +17,22 @@
 #define LESConfigSuctionVortices       "suctvort"
 #define LESConfigSuctionVorticesLarge  "suctvort_large"
 
+#define LESCacheMagic                  "LESCACHE"
+#define LESCacheVersion                2
+#define LESCacheAlignment              4096
+#define LESCacheExtension              "lesc"
+#define LESCachePathVariable           "LES_CACHE_PATH"   // Directory searched for a cache before the data path
+#define LESCacheCodecNone              0      // Frames as they are uploaded
+#define LESCacheCodecShuffleRLE        1      // Planes XOR'ed with the previous cell, split into byte planes with zero runs
+#define LESWindowMagic                 "LESWINDW"
+#define LESWindowVersion               1
+#define LESWindowExtension             "lesw"
+#define LESWindowPathVariable          "LES_WINDOW_PATH"  // Directory of a window of frames shared by the processes of a node
+
 typedef void * LESHandle;
 typedef char * LESConfig;
 typedef float LESFloat4[4];
+typedef uint16_t LESHalf4[4];
 
 typedef struct les_grid {
 	uint32_t  rev;            // Revision number, perhaps?
@@ -37,11 +50,6 @@ typedef struct _les_value {
 	float *x;
 	float *y;
 	float *z;
-	float *u;
-	float *v;
-	float *w;
-	float *p;
-	float *t;
 } LESValue;
 
 typedef struct _les_table {
@@ -49,6 +57,12 @@ typedef struct _les_table {
 	uint32_t  ny;             // Number of cells in y direction
 	uint32_t  nz;             // Number of cells in z direction
 	uint32_t  nn;             // Number of cells in all directions combined
+    uint32_t  ox;             // Offset of this (cropped) table in the full LES grid in x direction
+    uint32_t  oy;             // Offset of this (cropped) table in the full LES grid in y direction
+    uint32_t  oz;             // Offset of this (cropped) table in the full LES grid in z direction
+    uint32_t  gx;             // Number of cells of the full LES grid in x direction
+    uint32_t  gy;             // Number of cells of the full LES grid in y direction
+    uint32_t  gz;             // Number of cells of the full LES grid in z direction
 	uint32_t  nt;             // Number of time steps in a file
     uint32_t  nc;             // Number of cubes in this set
     bool      is_stretched;   // Uniform or stretched
@@ -64,14 +78,75 @@ typedef struct _les_table {
     LESFloat4 *uvwt;          // Remapped (u, v, w, t) data for efficient transfer in RS framework
     LESFloat4 *cpxx;          // Remapped (cn2, p, _, _) data for efficient transfer in RS framework
     float     *flux;          // Flux PDF
+    LESHalf4  *uvwt_half;     // Half-precision copy of uvwt, only allocated when requested
+    LESHalf4  *cpxx_half;     // Half-precision copy of cpxx, only allocated when requested
+    bool      has_half;       // Half-precision copies are current for this frame
+    const float *flux_icdf;   // Pre-computed flux ICDF from the cache, NULL when the flux PDF has to be derived
+    uint32_t  flux_icdf_count;
 } LESTable;
 
+//
+// Cache file: this header, padded to frame_offset, then nc frames of frame_size bytes each.
+// A frame is the time stamp padded to 16 bytes, uvwt[nn], cpxx[nn] and flux_icdf[icdf_count],
+// i.e., already scaled and in the layout uploaded to the devices.
+//
+// With a codec, frames are of variable size and located through the index at index_offset,
+// 2 * nz + 2 offsets per frame: the time stamp padded to 16 bytes with flux_icdf[icdf_count],
+// then the uvwt & cpxx planes of each z, each compressed on its own, and the end of the frame.
+//
+typedef struct les_cache_header {
+    char      magic[8];       // LESCacheMagic
+    uint32_t  version;        // LESCacheVersion
+    uint32_t  nx;             // Number of cells of the full LES grid in x direction
+    uint32_t  ny;             // Number of cells of the full LES grid in y direction
+    uint32_t  nz;             // Number of cells of the full LES grid in z direction
+    uint32_t  nc;             // Number of frames
+    uint32_t  icdf_count;     // Number of flux ICDF entries of a frame, 0 if none
+    float     v0;             // Scales applied to the raw u, v, w, p & t
+    float     p0;
+    float     t0;
+    uint32_t  codec;          // LESCacheCodecNone, LESCacheCodecShuffleRLE
+    uint64_t  frame_offset;   // Offset of the first frame
+    uint64_t  frame_size;     // Bytes from one frame to the next, a multiple of LESCacheAlignment, 0 with a codec
+    char      config[256];    // LES configuration, as long as the one of the handle so it is never cut
+    uint32_t  mantissa_bits;  // Mantissa bits kept, 23 is lossless
+    uint32_t  reserved;
+    uint64_t  index_offset;   // Offset of the frame index, 0 without a codec
+} LESCacheHeader;
+
+typedef struct les_stats {
+    uint32_t  depth;          // Frames read ahead of the consumer
+    uint32_t  frames_read;    // Frames ingested by the background reader
+    uint32_t  hits;           // Requests that found their frame ready
+    uint32_t  stalls;         // Requests that had to wait for the reader
+    double    stall_time;     // Seconds the consumer spent waiting
+    double    idle_time;      // Seconds the reader had nothing to read
+    double    read_time;      // Seconds the reader spent ingesting frames
+} LESStats;
+
 
 LESHandle LES_init_with_config_path(const LESConfig config, const char *path);
 LESHandle LES_init(void);
 void LES_free(LESHandle);
 
 void LES_set_delayed_read(LESHandle);
+void LES_set_velocity_only(LESHandle, const bool);
+void LES_set_half_precision(LESHandle, const bool);
+void LES_set_crop(LESHandle, const uint32_t ox, const uint32_t oy, const uint32_t oz, const uint32_t nx, const uint32_t ny, const uint32_t nz);
+void LES_clear_crop(LESHandle);
+void LES_set_prefetch_depth(LESHandle, const uint32_t depth);
+
+LESStats LES_get_stats(const LESHandle);
+void LES_reset_stats(LESHandle);
+void LES_show_stats(const LESHandle);
+
+bool LES_has_cache(const LESHandle);
+void LES_set_cache_codec(LESHandle, const uint32_t codec, const uint32_t mantissa_bits);
+bool LES_write_cache(const LESHandle, const char *filename, const uint32_t icdf_count,
+                     void (*derive_icdf)(float *icdf, const uint32_t count, const LESTable *table));
+bool LES_cache_filename(char *filename, const size_t size, const LESHandle);
+bool LES_window_filename(char *filename, const size_t size, const LESHandle, const char *path);
+bool LES_create_window(const LESHandle, const char *filename, const uint32_t process_count);
 
 LESTable *LES_get_frame_0(const LESHandle, const int n);
 LESTable *LES_get_frame(const LESHandle, const int n);
@@ -80,6 +155,7 @@ float LES_get_table_period(const LESHandle);
 size_t LES_get_table_count(const LESHandle);
 
 void LES_show_table_summary(const LESTable *table);
+void LES_float4_to_half4(LESHalf4 *dst, const LESFloat4 *src, const size_t count);
 
 void LES_show_handle_summary(const LESHandle);
 
@@ -0,0 +1,161 @@
+//
+//  lescache.c
+//  Radar Simulation Framework
+//
+//  Converts the raw LES tables into the cache that LES_init_with_config_path()
+//  picks up, frames already scaled, interleaved and with the flux ICDF
+//
+
+#include "rs.h"
+#include <getopt.h>
+
+static void show_help() {
+    char name[] = __FILE__;
+    *strrchr(name, '.') = '\0';
+    printf("LES Cache Converter\n\n"
+           "%s [options]\n\n"
+           "OPTIONS:\n"
+           "  -c (--compress)\n"
+           "         Compresses the frames losslessly. Each plane is XOR'ed with the previous\n"
+           "         cell and split into byte planes with zero runs, which are decoded on the\n"
+           "         reader threads straight into the uvwt & cpxx layout.\n"
+           "\n"
+           "  -f (--force)\n"
+           "         Rebuilds the cache even if there is one for the configuration.\n"
+           "\n"
+           "  -h (--help)\n"
+           "         Shows this help text.\n"
+           "\n"
+           "  -L (--les-config) " UNDERLINE("config") "\n"
+           "         Converts the LES configuration " UNDERLINE("config") ", e.g., suctvort (default), twocell,\n"
+           "         etc. This option can be repeated for several configurations.\n"
+           "\n"
+           "  -q (--mantissa-bits) " UNDERLINE("bits") "\n"
+           "         Compresses the frames, keeping only " UNDERLINE("bits") " bits of the mantissa. The\n"
+           "         relative error is bounded by 2 ^ -(" UNDERLINE("bits") " + 1), e.g., 10 bits for 0.05%%.\n"
+           "\n"
+           "  -v (--verbose)\n"
+           "         Increases verbosity level.\n"
+           "\n"
+           "\n\n"
+           "%s (SimRadar %s)\n\n",
+           name,
+           name,
+           RS_VERSION_STRING);
+}
+
+
+static int convert(const char *config, const bool force, const uint32_t codec, const uint32_t mantissa_bits, const int verbose) {
+    char filename[1280];
+    struct timeval t1, t2;
+
+    LESHandle L = LES_init_with_config_path((LESConfig)config, NULL);
+    if (L == NULL) {
+        fprintf(stderr, "%s : Unable to load LES configuration '%s'.\n", now(), config);
+        return EXIT_FAILURE;
+    }
+    LES_cache_filename(filename, sizeof(filename), L);
+    if (LES_has_cache(L)) {
+        if (!force) {
+            printf("%s : %s is up to date.\n", now(), filename);
+            LES_free(L);
+            return EXIT_SUCCESS;
+        }
+        // Start over so that the frames come from the raw files
+        LES_free(L);
+        unlink(filename);
+        L = LES_init_with_config_path((LESConfig)config, NULL);
+        if (L == NULL) {
+            return EXIT_FAILURE;
+        }
+    }
+    LES_set_prefetch_depth(L, 8);
+    LES_set_cache_codec(L, codec, mantissa_bits);
+
+    gettimeofday(&t1, NULL);
+    bool ok = LES_write_cache(L, filename, RS_DFF_ICDF_COUNT, RS_derive_flux_icdf_from_LES);
+    gettimeofday(&t2, NULL);
+
+    if (ok) {
+        printf("%s : %s  (%zu frames in %.2f s)\n", now(), filename, LES_get_table_count(L), DTIME(t1, t2));
+    }
+    if (verbose) {
+        LES_show_stats(L);
+    }
+    LES_free(L);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+//
+//
+//  M A I N
+//
+//
+
+int main(int argc, const char **argv) {
+    int k, s;
+    int verbose = 0;
+    bool force = false;
+    uint32_t codec = LESCacheCodecNone;
+    uint32_t mantissa_bits = 23;
+    char str[1024];
+    char configs[16][256];
+    int nconfigs = 0;
+
+    // Command line options
+    struct option long_options[] = {
+        {"compress"          , no_argument      , NULL, 'c'},
+        {"force"             , no_argument      , NULL, 'f'},
+        {"help"              , no_argument      , NULL, 'h'},
+        {"les-config"        , required_argument, NULL, 'L'},
+        {"mantissa-bits"     , required_argument, NULL, 'q'},
+        {"verbose"           , no_argument      , NULL, 'v'},
+        {0, 0, 0, 0}
+    };
+
+    // Go through the options
+    s = 0;
+    for (k = 0; k < sizeof(long_options) / sizeof(struct option); k++) {
+        struct option *o = &long_options[k];
+        s += snprintf(str + s, 1023 - s, "%c%s", o->val, o->has_arg == required_argument ? ":" : (o->has_arg == optional_argument ? "::" : ""));
+    }
+    optind = 1;
+    int opt, long_index = 0;
+    while ((opt = getopt_long(argc, (char * const *)argv, str, long_options, &long_index)) != -1) {
+        switch (opt) {
+            case 'c':
+                codec = LESCacheCodecShuffleRLE;
+                break;
+            case 'f':
+                force = true;
+                break;
+            case 'h':
+                show_help();
+                exit(EXIT_SUCCESS);
+            case 'L':
+                if (nconfigs < sizeof(configs) / sizeof(configs[0])) {
+                    snprintf(configs[nconfigs++], sizeof(configs[0]), "%s", optarg);
+                }
+                break;
+            case 'q':
+                codec = LESCacheCodecShuffleRLE;
+                mantissa_bits = (uint32_t)MIN(MAX(atoi(optarg), 0), 23);
+                break;
+            case 'v':
+                verbose++;
+                break;
+            default:
+                break;
+        }
+    }
+    if (nconfigs == 0) {
+        snprintf(configs[nconfigs++], sizeof(configs[0]), "%s", LESConfigSuctionVortices);
+    }
+
+    int ret = EXIT_SUCCESS;
+    for (k = 0; k < nconfigs; k++) {
+        ret |= convert(configs[k], force, codec, mantissa_bits, verbose);
+    }
+    return ret;
+}
@@ -32,10 +32,6 @@ int main(int argc, char **argv) {
     DIR *d;
     char path[1024];
     char filename[1024];
-    
-    FILE *f;
-    
-    IQFileHeader file_header;
 
     if (argc > 1) {
         printf("argv[1] =  %s\n", argv[1]);
@@ -100,16 +96,24 @@ int main(int argc, char **argv) {
         if (stat(filename, &file_stat) < 0) {
             printf("%s\n", strerror(errno));
         }
-        f = fopen(filename, "r+");
-        fread(&file_header, sizeof(file_header), 1, f);
-        printf("%s   %6s B   %d  (+%u)\n", filelist[k], commaint(file_stat.st_size), file_header.simulation_seed, file_header.simulation_seed - prev_seed);
-//        file_header.simulation_seed = k + 1825;
-//        rewind(f);
-//        fwrite(&file_header, sizeof(file_header), 1, f);
-//        fseek(f, 0, SEEK_END);
+        // The reader finds the counts of v1 files & of those that were not closed
+        IQReaderHandle r = IQ_reader_init(filename);
+        if (r == NULL) {
+            printf("%s   unable to read\n", filelist[k]);
+            free(filelist[k]);
+            continue;
+        }
+        const IQFileHeader *file_header = IQ_reader_get_header(r);
+        uint32_t sweep_count;
+        IQ_reader_get_sweeps(r, &sweep_count);
+        const char *codec = file_header->version < 2 || file_header->codec == IQCodecNone ? "raw" :
+                            (file_header->codec == IQCodecShuffleRLE ? "rle" : (file_header->codec == IQCodecInt16 ? "int16" : "?"));
+        printf("%s   %6s B   v%u   %-5s   %6u pulses   %3u sweeps   %d  (+%u)\n", filelist[k], commaint(file_stat.st_size),
+               MAX(1, file_header->version), codec, IQ_reader_get_pulse_count(r), sweep_count,
+               file_header->simulation_seed, file_header->simulation_seed - prev_seed);
+        prev_seed = file_header->simulation_seed;
         free(filelist[k]);
-        fclose(f);
-        prev_seed = file_header.simulation_seed;
+        IQ_reader_free(r);
     }
     
     
@@ -1,7 +1,10 @@
 % SimRadar IQ Reader
 %
 % dat = simradariq(filename) returns a structure that contains the raw I/Q
-% data produced by the radar simulator.
+% data produced by the radar simulator. Version 2 files are read section by
+% section, which also gives the sweep table, version 1 files pulse by pulse.
+% Blocks of the int16 codec are scaled back, those of the rle codec need the
+% C reader.
 %
 % Boon Leng Cheong
 % Advanced Radar Research Center
@@ -14,7 +17,7 @@ if ~exist('filename', 'var')
     error('I need at least a filename.\n')
 end
 
-dat = struct('filenam', filename, 'params', [], 'debris_counts', [], 'iqh', [], 'iqv', [], 'az_deg', [], 'el_deg', [], 'scan_time', []);
+dat = struct('filenam', filename, 'params', [], 'debris_counts', [], 'iqh', [], 'iqv', [], 'az_deg', [], 'el_deg', [], 'scan_time', [], 'sweep', [], 'sweeps', []);
 
 fid = fopen(filename, 'r');
 if (fid < 0 )
@@ -27,7 +30,8 @@ debris_counts = fread(fid, 8, 'uint');
 scan_mode = fread(fid, 16, 'char=>char');
 scan_mode = deblank(scan_mode.');
 tmpf2 = fread(fid, 3, 'float');
-tmpi2 = fread(fid, 1, 'uint');
+tmpi2 = fread(fid, 6, 'uint');
+tmpl2 = fread(fid, 4, 'uint64');
 
 hdr = struct(...
     'c', tmpf(1), ...
@@ -59,7 +63,70 @@ hdr = struct(...
     'scan_start', tmpf2(1), ...
     'scan_end', tmpf2(2), ...
     'scan_delta', tmpf2(3), ...
-    'seed', tmpi2(1));
+    'seed', tmpi2(1), ...
+    'version', tmpi2(2), ...
+    'codec', tmpi2(6));
+
+dat.params = hdr;
+dat.debris_counts = debris_counts;
+
+if hdr.version >= 2
+    pulse_count = tmpi2(3);
+    sweep_count = tmpi2(4);
+    pulse_header_offset = tmpl2(1);
+    sweep_offset = tmpl2(3);
+    iq_offset = tmpl2(4);
+    fprintf('Data file contains %d pulses in %d sweeps. D = %.2f\n', pulse_count, sweep_count, hdr.body_per_cell);
+
+    % Pulse headers, 32 bytes each
+    fseek(fid, pulse_header_offset, 'bof');
+    phdr = fread(fid, [8, pulse_count], 'float');
+    dat.scan_time = phdr(1, :);
+    dat.el_deg = phdr(2, :);
+    dat.az_deg = phdr(3, :);
+    fseek(fid, pulse_header_offset + 12, 'bof');
+    dat.sweep = fread(fid, [1, pulse_count], 'uint', 28);
+
+    if hdr.codec == 0
+        % The samples of all pulses are contiguous
+        fseek(fid, iq_offset, 'bof');
+        tmpf = fread(fid, [hdr.range_count * 4, pulse_count], 'float=>float');
+    else
+        % One block per pulse: size, codec, scale & reserved, then the samples padded to 8 bytes
+        fseek(fid, iq_offset, 'bof');
+        tmpf = zeros(hdr.range_count * 4, pulse_count, 'single');
+        for ii = 1 : pulse_count
+            blk = fread(fid, 2, 'uint');
+            scale = fread(fid, 1, 'float');
+            fseek(fid, 4, 'cof');
+            if blk(2) == 0
+                tmpf(:, ii) = fread(fid, hdr.range_count * 4, 'float=>float');
+            elseif blk(2) == 2
+                tmpf(:, ii) = single(fread(fid, hdr.range_count * 4, 'int16')) * scale;
+            else
+                fclose(fid);
+                error('Blocks of codec %d are not supported, use the C reader.', blk(2))
+            end
+            fseek(fid, mod(-blk(1), 8), 'cof');
+        end
+    end
+    dat.iqh = tmpf(1 : 4 : end, :) + 1i * tmpf(2 : 4 : end, :);
+    dat.iqv = tmpf(3 : 4 : end, :) + 1i * tmpf(4 : 4 : end, :);
+
+    % Sweep table, 32 bytes each, only there once the file is closed
+    if sweep_offset > 0
+        fseek(fid, sweep_offset, 'bof');
+        tmpi = fread(fid, [8, sweep_count], 'uint');
+        fseek(fid, sweep_offset, 'bof');
+        tmpf = fread(fid, [8, sweep_count], 'float');
+        dat.sweeps = struct('first', num2cell(tmpi(1, :) + 1), 'count', num2cell(tmpi(2, :)), ...
+            'el_start', num2cell(tmpf(3, :)), 'el_end', num2cell(tmpf(4, :)), ...
+            'az_start', num2cell(tmpf(5, :)), 'az_end', num2cell(tmpf(6, :)));
+    end
+
+    fclose(fid);
+    return
+end
 
 % Move to the end of file
 fseek(fid, 0, 'eof');
@@ -74,8 +141,6 @@ fprintf('Data file contains %d pulses. D = %.2f\n', pulse_count, hdr.body_per_ce
 % Return to the end of file header
 fseek(fid, 1024, 'bof');
 
-dat.params = hdr;
-dat.debris_counts = debris_counts;
 dat.scan_time = zeros(1, pulse_count);
 dat.az_deg = zeros(1, pulse_count);
 dat.el_deg = zeros(1, pulse_count);
@@ -0,0 +1,213 @@
+//
+//  mom.c
+//  Radar Simulation Framework
+//
+//  Accumulates the covariances of the pulses as they are made and writes the
+//  moments of each radial, a file per sweep
+//
+
+#include "mom.h"
+
+// Private structure
+
+typedef struct _mom_accumulator {
+    char            prefix[1024];
+    MOMFileHeader   header;
+    FILE            *fid;            // File of the current sweep
+    uint32_t        range_count;
+    uint32_t        pulses_per_radial;
+    uint32_t        count;           // Pulses in the current radial
+    MOMRadialHeader radial;
+    double          *sums;           // R0h, R0v, R1h (re, im) & Rhv (re, im) of each gate
+    float           *last;           // H of the previous pulse
+    float           *products;       // MOMProductCount x range_count
+    long            size;            // Bytes of all files
+    bool            ok;              // Cleared at the first write error
+} MOMAccumulator;
+
+#define MOM_sums_per_gate          6
+
+// Private functions
+void MOM_write_radial(MOMAccumulator *m);
+void MOM_close_sweep(MOMAccumulator *m);
+bool MOM_open_sweep(MOMAccumulator *m, const uint32_t sweep);
+
+#pragma mark -
+
+void MOM_write_radial(MOMAccumulator *m) {
+    const RSParams *params = &m->header.iq.params;
+    const double n = (double)m->count;
+    const double va = params->va;
+    float *p = m->products;
+
+    // A radial needs two pulses for the lag-1
+    if (m->count < 2) {
+        m->count = 0;
+        return;
+    }
+    for (uint32_t g = 0; g < m->range_count; g++) {
+        const double *s = &m->sums[g * MOM_sums_per_gate];
+        const double sh = s[0] / n;
+        const double sv = s[1] / n;
+        const double r1 = sqrt(s[2] * s[2] + s[3] * s[3]) / (n - 1.0);
+        const double rhv = sqrt(s[4] * s[4] + s[5] * s[5]) / n;
+        const double r = (params->range_start + g * params->range_delta) * 1.0e-3;
+        if (sh > 0.0) {
+            p[MOMProductZ * m->range_count + g] = (float)(10.0 * log10(sh) + (r > 0.0 ? 20.0 * log10(r) : 0.0));
+            p[MOMProductV * m->range_count + g] = (float)(-va / M_PI * atan2(s[3], s[2]));
+            p[MOMProductW * m->range_count + g] = r1 > 0.0 ? (float)(va * M_SQRT2 / M_PI * sqrt(fabs(log(sh / r1)))) : NAN;
+        } else {
+            p[MOMProductZ * m->range_count + g] = NAN;
+            p[MOMProductV * m->range_count + g] = NAN;
+            p[MOMProductW * m->range_count + g] = NAN;
+        }
+        if (sh > 0.0 && sv > 0.0) {
+            p[MOMProductZDR * m->range_count + g] = (float)(10.0 * log10(sh / sv));
+            p[MOMProductPhiDP * m->range_count + g] = (float)(atan2(s[5], s[4]) * 180.0 / M_PI);
+            p[MOMProductRhoHV * m->range_count + g] = (float)(rhv / sqrt(sh * sv));
+        } else {
+            p[MOMProductZDR * m->range_count + g] = NAN;
+            p[MOMProductPhiDP * m->range_count + g] = NAN;
+            p[MOMProductRhoHV * m->range_count + g] = NAN;
+        }
+    }
+    m->radial.pulse_count = m->count;
+    m->count = 0;
+    if (m->ok && (fwrite(&m->radial, sizeof(MOMRadialHeader), 1, m->fid) != 1 ||
+                  fwrite(p, sizeof(float), MOMProductCount * m->range_count, m->fid) != MOMProductCount * m->range_count)) {
+        fprintf(stderr, "MOM : Unable to write the moments of sweep %u.\n", m->header.sweep);
+        m->ok = false;
+        return;
+    }
+    m->header.radial_count++;
+}
+
+
+// The partial radial, then the header with the count
+void MOM_close_sweep(MOMAccumulator *m) {
+    if (m->fid == NULL) {
+        return;
+    }
+    MOM_write_radial(m);
+    if (m->ok && (fseek(m->fid, 0, SEEK_SET) || fwrite(&m->header, sizeof(MOMFileHeader), 1, m->fid) != 1)) {
+        fprintf(stderr, "MOM : Unable to write the header of sweep %u.\n", m->header.sweep);
+        m->ok = false;
+    }
+    m->size += m->header.radial_offset + m->header.radial_count * m->header.radial_size;
+    if (fclose(m->fid)) {
+        m->ok = false;
+    }
+    m->fid = NULL;
+}
+
+
+bool MOM_open_sweep(MOMAccumulator *m, const uint32_t sweep) {
+    char filename[1100];
+    snprintf(filename, sizeof(filename), "%s-S%03u." MOMFileExtension, m->prefix, sweep);
+    m->fid = fopen(filename, "wb");
+    if (m->fid == NULL) {
+        fprintf(stderr, "MOM : Unable to create %s.\n", filename);
+        m->ok = false;
+        return false;
+    }
+    m->header.sweep = sweep;
+    m->header.radial_count = 0;
+    if (fwrite(&m->header, sizeof(MOMFileHeader), 1, m->fid) != 1) {
+        fprintf(stderr, "MOM : Unable to write %s.\n", filename);
+        m->ok = false;
+        return false;
+    }
+    m->count = 0;
+    return true;
+}
+
+
+MOMHandle MOM_init(const char *prefix, const IQFileHeader *header, const uint32_t range_count, const uint32_t pulses_per_radial) {
+    MOMAccumulator *m = (MOMAccumulator *)malloc(sizeof(MOMAccumulator));
+    if (m == NULL) {
+        fprintf(stderr, "MOM : Unable to allocate resources for the moments.\n");
+        return NULL;
+    }
+    memset(m, 0, sizeof(MOMAccumulator));
+    snprintf(m->prefix, sizeof(m->prefix), "%s", prefix);
+    m->range_count = range_count;
+    m->pulses_per_radial = MAX(2, pulses_per_radial);
+    m->sums = (double *)malloc(range_count * MOM_sums_per_gate * sizeof(double));
+    m->last = (float *)malloc(range_count * 2 * sizeof(float));
+    m->products = (float *)malloc(range_count * MOMProductCount * sizeof(float));
+    if (m->sums == NULL || m->last == NULL || m->products == NULL) {
+        fprintf(stderr, "MOM : Unable to allocate the accumulators.\n");
+        free(m->sums);
+        free(m->last);
+        free(m->products);
+        free(m);
+        return NULL;
+    }
+
+    memcpy(&m->header.iq, header, sizeof(IQFileHeader));
+    memcpy(m->header.magic, MOMFileMagic, sizeof(m->header.magic));
+    m->header.version = MOMFileVersion;
+    m->header.range_count = range_count;
+    m->header.product_count = MOMProductCount;
+    m->header.pulses_per_radial = m->pulses_per_radial;
+    m->header.radial_offset = sizeof(MOMFileHeader);
+    m->header.radial_size = sizeof(MOMRadialHeader) + MOMProductCount * range_count * sizeof(float);
+    m->ok = true;
+    return (MOMHandle)m;
+}
+
+
+void MOM_add_pulse(MOMHandle in, const IQPulseHeader *header, const float *samples) {
+    MOMAccumulator *m = (MOMAccumulator *)in;
+
+    // A new sweep number starts a new file
+    if (m->fid == NULL || header->sweep != m->header.sweep) {
+        MOM_close_sweep(m);
+        if (!m->ok || !MOM_open_sweep(m, header->sweep)) {
+            return;
+        }
+    }
+    if (m->count == 0) {
+        memset(m->sums, 0, m->range_count * MOM_sums_per_gate * sizeof(double));
+    }
+    // Angles & time of the radial are those of the middle pulse
+    if (m->count == 0 || m->count == m->pulses_per_radial / 2) {
+        m->radial.time = header->time;
+        m->radial.el_deg = header->el_deg;
+        m->radial.az_deg = header->az_deg;
+        m->radial.sweep = header->sweep;
+    }
+    for (uint32_t g = 0; g < m->range_count; g++) {
+        const float hi = samples[4 * g], hq = samples[4 * g + 1];
+        const float vi = samples[4 * g + 2], vq = samples[4 * g + 3];
+        double *s = &m->sums[g * MOM_sums_per_gate];
+        s[0] += (double)hi * hi + (double)hq * hq;
+        s[1] += (double)vi * vi + (double)vq * vq;
+        if (m->count) {
+            // h(n) conj(h(n - 1))
+            const float pi = m->last[2 * g], pq = m->last[2 * g + 1];
+            s[2] += (double)hi * pi + (double)hq * pq;
+            s[3] += (double)hq * pi - (double)hi * pq;
+        }
+        // conj(h) v
+        s[4] += (double)hi * vi + (double)hq * vq;
+        s[5] += (double)hi * vq - (double)hq * vi;
+        m->last[2 * g] = hi;
+        m->last[2 * g + 1] = hq;
+    }
+    if (++m->count == m->pulses_per_radial) {
+        MOM_write_radial(m);
+    }
+}
+
+
+long MOM_free(MOMHandle in) {
+    MOMAccumulator *m = (MOMAccumulator *)in;
+    MOM_close_sweep(m);
+    long size = m->ok ? m->size : -1;
+    free(m->sums);
+    free(m->last);
+    free(m->products);
+    free(m);
+    return size;
+}
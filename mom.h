@@ -0,0 +1,68 @@
+//
+//  mom.h
+//  Radar Simulation Framework
+//
+//  Moments of the pulses, accumulated as they are made
+//
+
+#ifndef mom_h
+#define mom_h
+
+#include "iq.h"
+
+#define MOMFileMagic           "SIMRMOM"
+#define MOMFileVersion         1
+#define MOMFileExtension       "mom"
+
+// A file for each sweep:
+//
+//   MOMFileHeader
+//   radial_count x (MOMRadialHeader, float[MOMProductCount][range_count])   @ radial_offset
+//
+// Each radial is made of pulses_per_radial pulses of the same sweep, or fewer at the end of a sweep. Products are
+// from the covariances of the pulses, with the lag-1 from H. Gates without signal are NAN.
+
+enum MOMProduct {
+    MOMProductZ,               // 10 log10(S_h r ^ 2), r in km, dB of range corrected power, there is no radar constant
+    MOMProductV,               // Radial velocity (m/s), positive away from the radar
+    MOMProductW,               // Spectrum width (m/s)
+    MOMProductZDR,             // Differential reflectivity (dB)
+    MOMProductPhiDP,           // Differential phase (deg)
+    MOMProductRhoHV,           // Cross-correlation coefficient
+    MOMProductCount
+};
+
+typedef union momfileheader {
+    char raw[4096];
+    struct {
+        IQFileHeader  iq;                 // Header of the simulation, as in the IQ files
+        char          magic[8];           // MOMFileMagic
+        uint32_t      version;            // MOMFileVersion
+        uint32_t      radial_count;       // Radials in the file
+        uint32_t      range_count;        // Gates of each product
+        uint32_t      product_count;      // MOMProductCount
+        uint32_t      pulses_per_radial;  // Pulses of a full radial
+        uint32_t      sweep;              // Sweep number of the pulses
+        uint64_t      radial_offset;      // Offset of the first radial
+        uint64_t      radial_size;        // Bytes from one radial to the next
+    };
+} MOMFileHeader;
+
+typedef union momradialheader {
+    char raw[32];
+    struct {
+        float      time;          // Time of the middle pulse
+        float      el_deg;        // Angles of the middle pulse
+        float      az_deg;
+        uint32_t   sweep;
+        uint32_t   pulse_count;   // Pulses in this radial
+    };
+} MOMRadialHeader;
+
+typedef void * MOMHandle;
+
+MOMHandle MOM_init(const char *prefix, const IQFileHeader *header, const uint32_t range_count, const uint32_t pulses_per_radial);
+void MOM_add_pulse(MOMHandle, const IQPulseHeader *header, const float *samples);
+long MOM_free(MOMHandle);
+
+#endif /* mom_h */
@@ -12,10 +12,32 @@ typedef struct _obj_mem {
     ADMHandle adm_h;
     RCSHandle rcs_h;
     OBJTable obj_table[256];
+    OBJConfig obj_type[256];
     int count;
+    char path[1024];              // Path given to OBJ_init_with_path(), empty for NULL
+    int refs;                     // Users of this handle, see OBJ_init_with_path()
+    pthread_mutex_t lock;         // Guards the tables
+    struct _obj_mem *next;
 } OBJMem;
 
+// Handles in this process, tables are read-only once loaded so a handle of the same path is shared
+static OBJMem *OBJ_handles = NULL;
+static pthread_mutex_t OBJ_handles_lock = PTHREAD_MUTEX_INITIALIZER;
+
 OBJHandle OBJ_init_with_path(const char *path) {
+    // Share a handle of the same path, if any
+    pthread_mutex_lock(&OBJ_handles_lock);
+    OBJMem *s = OBJ_handles;
+    while (s != NULL && strcmp(s->path, path == NULL ? "" : path)) {
+        s = s->next;
+    }
+    if (s != NULL) {
+        s->refs++;
+        pthread_mutex_unlock(&OBJ_handles_lock);
+        return (OBJHandle *)s;
+    }
+    pthread_mutex_unlock(&OBJ_handles_lock);
+
     // Find the path
     char cwd[1024];
     if (getcwd(cwd, sizeof(cwd)) == NULL)
@@ -83,7 +105,15 @@ OBJHandle OBJ_init_with_path(const char *path) {
         return NULL;
     }
     h->count = 0;
-    
+    snprintf(h->path, sizeof(h->path), "%s", path == NULL ? "" : path);
+    h->refs = 1;
+    pthread_mutex_init(&h->lock, NULL);
+
+    pthread_mutex_lock(&OBJ_handles_lock);
+    h->next = OBJ_handles;
+    OBJ_handles = h;
+    pthread_mutex_unlock(&OBJ_handles_lock);
+
     return (OBJHandle *)h;
 }
 
@@ -93,7 +123,23 @@ OBJHandle OBJ_init(void) {
 
 void OBJ_free(OBJHandle in) {
     OBJMem *h = (OBJMem *)in;
-    
+
+    // Only the last user releases the tables
+    pthread_mutex_lock(&OBJ_handles_lock);
+    if (--h->refs > 0) {
+        pthread_mutex_unlock(&OBJ_handles_lock);
+        return;
+    }
+    OBJMem **s = &OBJ_handles;
+    while (*s != NULL && *s != h) {
+        s = &(*s)->next;
+    }
+    if (*s != NULL) {
+        *s = h->next;
+    }
+    pthread_mutex_unlock(&OBJ_handles_lock);
+
+    pthread_mutex_destroy(&h->lock);
     ADM_free(h->adm_h);
     RCS_free(h->rcs_h);
     free(h);
@@ -101,7 +147,18 @@ void OBJ_free(OBJHandle in) {
 
 OBJTable *OBJ_get_table(const OBJHandle in, OBJConfig type) {
     OBJMem *O = (OBJMem *)in;
+    pthread_mutex_lock(&O->lock);
+    // A type that has been loaded is shared
+    for (int k = 0; k < O->count; k++) {
+        if (O->obj_type[k] == type && O->obj_table[k].adm_table != NULL) {
+            pthread_mutex_unlock(&O->lock);
+            return &O->obj_table[k];
+        }
+    }
     OBJTable *obj_table = &O->obj_table[O->count];
+    obj_table->adm_table = NULL;
+    obj_table->rcs_table = NULL;
+    O->obj_type[O->count] = type;
     switch (type) {
         case OBJConfigWoodboard2x4:
             obj_table->adm_table = ADM_get_table(O->adm_h, ADMConfigSquarePlate);
@@ -144,15 +201,20 @@ OBJTable *OBJ_get_table(const OBJHandle in, OBJConfig type) {
     
     O->count++;
     //printf("OBJ count : %d \n", O->count);
+    pthread_mutex_unlock(&O->lock);
     return obj_table;
 }
 
 OBJTable *OBJ_get_table_using_config_file(const OBJHandle in, const char *config) {
     OBJMem *O = (OBJMem *)in;
+    pthread_mutex_lock(&O->lock);
     OBJTable *obj_table = &O->obj_table[O->count];
-    
-    
+    obj_table->adm_table = NULL;
+    obj_table->rcs_table = NULL;
+    O->obj_type[O->count] = OBJConfigUnknown;
+
     O->count++;
     //printf("OBJ count : %d \n", O->count);
+    pthread_mutex_unlock(&O->lock);
     return obj_table;
 }
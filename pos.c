@@ -36,6 +36,19 @@ int POS_get_next_angles(POSPattern *scan) {
     // Current azimuth and elevation
     scan->az = scan->positions[k].az;
     scan->el = scan->positions[k].el;
+    // A new dwell starts with a position that repeats, after one, or with a new sweep. Positions visited once,
+    // i.e., a scanning beam, make up one dwell until the sweep ends
+    if (scan->positions[k].index == 0 && scan->tic &&
+        (k == 0 || scan->positions[k].sweep != scan->sweepIndex || scan->positions[k].count > 1 || scan->positions[k - 1].count > 1)) {
+        scan->dwellTic++;
+    }
+    // A new sweep starts when the position comes from another sweep or when the pattern starts over
+    if (scan->positions[k].index == 0 && (k == 0 || scan->positions[k].sweep != scan->sweepIndex)) {
+        if (scan->tic) {
+            scan->sweepTic++;
+        }
+        scan->sweepIndex = scan->positions[k].sweep;
+    }
     #if defined(DEBUG_POS)
     rsprint("%d / %d   %d / %d  %.2f %.2f\n",
             scan->index, scan->count,
@@ -91,6 +104,7 @@ int POS_parse_from_string(POSPattern *scan, const char *string) {
                     scan->positions[j].az = f2;
                     scan->positions[j].index = 0;
                     scan->positions[j].count = 1;
+                    scan->positions[j].sweep = i;
                     #if defined(DEBUG_POS)
                     rsprint("POS: j = %d   el = %5.2f   az = %6.2f   count = %u \n",
                             j, scan->positions[j].el, scan->positions[j].az, scan->positions[j].count);
@@ -129,6 +143,7 @@ int POS_parse_from_string(POSPattern *scan, const char *string) {
                     scan->positions[j].el = f2;
                     scan->positions[j].index = 0;
                     scan->positions[j].count = 1;
+                    scan->positions[j].sweep = i;
                     #if defined(DEBUG_POS)
                     rsprint("POS: j = %d   el = %5.2f   az = %6.2f   count = %u \n",
                             j, scan->positions[j].el, scan->positions[j].az, scan->positions[j].count);
@@ -160,6 +175,7 @@ int POS_parse_from_string(POSPattern *scan, const char *string) {
                 scan->positions[j].el = f2;
                 scan->positions[j].index = 0;
                 scan->positions[j].count = (uint32_t)f3;
+                scan->positions[j].sweep = j;
                 #if defined(DEBUG_POS)
                 rsprint("POS: j = %d   el = %5.2f   az = %6.2f   count = %u \n",
                         j, scan->positions[j].el, scan->positions[j].az, scan->positions[j].count);
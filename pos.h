@@ -25,6 +25,7 @@ typedef struct pos_pos {
     float       el;
     uint32_t    index;                                 // Iteration of this position
     uint32_t    count;                                 // Repetition of this position
+    uint32_t    sweep;                                 // The index of POSSweep this position belongs to
 } POSPosition;
 
 typedef struct pos_sweep {
@@ -50,6 +51,8 @@ typedef struct pos_pattern {
     float       az;                                    // Current azimuth to use
     float       el;                                    // Current elevation to use
     uint32_t    tic;
+    uint32_t    sweepTic;                              // Sweeps started before the current position
+    uint32_t    dwellTic;                              // Dwells started before the current position
 } POSPattern;
 
 POSPattern *POS_init(void);
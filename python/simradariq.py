@@ -0,0 +1,158 @@
+#
+#  simradariq.py
+#  Radar Simulation Framework
+#
+#  Reads IQ files through lib/libiq.so (make lib/libiq.so). The file is mapped, the header, the pulse
+#  headers & the samples are numpy arrays on the mapped pages so nothing is copied until it is used.
+#
+#      import simradariq
+#      with simradariq.IQFile('sim-20160229-143941-E03.0.iq') as f:
+#          f.header['range_count'], f.pulses['az_deg']
+#          f.iq            # pulse_count x range_count x (hi, hq, vi, vq), float32
+#          f.h, f.v        # complex64 views of H & V
+#
+#  Files with a codec are decoded on all cores the first time f.iq is used, f.read(first, count) gets a
+#  few pulses only. The library is looked up in SIMRADAR_LIB, then ../lib next to this file.
+#
+
+import ctypes
+import os
+
+import numpy as np
+
+# IQFileHeader, IQPulseHeader & IQSweep of iq.h
+_params = ['c', 'prt', 'loss', 'lambda', 'tx_power_watt', 'antenna_gain_dbi', 'antenna_bw_deg', 'tau',
+           'range_start', 'range_end', 'range_delta',
+           'azimuth_start_deg', 'azimuth_end_deg', 'azimuth_delta_deg',
+           'elevation_start_deg', 'elevation_end_deg', 'elevation_delta_deg',
+           'domain_pad_factor', 'body_per_cell', 'prf', 'va', 'fn', 'antenna_bw_rad', 'dr']
+
+header_dtype = np.dtype({
+    'names': _params + ['range_count', 'counts', 'scan_mode', 'scan_start', 'scan_end', 'scan_delta',
+                        'simulation_seed', 'version', 'pulse_count', 'sweep_count', 'pulse_size', 'codec',
+                        'pulse_header_offset', 'pulse_index_offset', 'sweep_offset', 'iq_offset', 'mantissa_bits'],
+    'formats': ['<f4'] * len(_params) + ['<u4', ('<u4', 8), 'S16', '<f4', '<f4', '<f4',
+                                         '<u4', '<u4', '<u4', '<u4', '<u4', '<u4',
+                                         '<u8', '<u8', '<u8', '<u8', '<u4'],
+    'offsets': [4 * k for k in range(len(_params))] + [96, 100, 132, 148, 152, 156,
+                                                       160, 164, 168, 172, 176, 180,
+                                                       184, 192, 200, 208, 216],
+    'itemsize': 1024})
+
+pulse_dtype = np.dtype({
+    'names': ['time', 'el_deg', 'az_deg', 'sweep'],
+    'formats': ['<f4', '<f4', '<f4', '<u4'],
+    'offsets': [0, 4, 8, 12],
+    'itemsize': 32})
+
+sweep_dtype = np.dtype({
+    'names': ['first', 'count', 'el_start', 'el_end', 'az_start', 'az_end'],
+    'formats': ['<u4', '<u4', '<f4', '<f4', '<f4', '<f4'],
+    'offsets': [0, 4, 8, 12, 16, 20],
+    'itemsize': 32})
+
+_lib = None
+
+
+def _load():
+    global _lib
+    if _lib is not None:
+        return _lib
+    path = os.environ.get('SIMRADAR_LIB',
+                          os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'lib'))
+    if os.path.isdir(path):
+        path = os.path.join(path, 'libiq.so')
+    lib = ctypes.CDLL(path)
+    size_p = ctypes.POINTER(ctypes.c_size_t)
+    for name, restype, argtypes in [
+        ('IQ_reader_init', ctypes.c_void_p, [ctypes.c_char_p]),
+        ('IQ_reader_free', None, [ctypes.c_void_p]),
+        ('IQ_reader_get_header', ctypes.c_void_p, [ctypes.c_void_p]),
+        ('IQ_reader_get_pulse_count', ctypes.c_uint32, [ctypes.c_void_p]),
+        ('IQ_reader_get_range_count', ctypes.c_uint32, [ctypes.c_void_p]),
+        ('IQ_reader_get_pulse_headers', ctypes.c_void_p, [ctypes.c_void_p, size_p]),
+        ('IQ_reader_get_samples', ctypes.c_void_p, [ctypes.c_void_p, size_p]),
+        ('IQ_reader_get_sweeps', ctypes.c_void_p, [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint32)]),
+        ('IQ_reader_read_samples', ctypes.c_long, [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint32])]:
+        f = getattr(lib, name)
+        f.restype = restype
+        f.argtypes = argtypes
+    _lib = lib
+    return lib
+
+
+def _array(address, shape, dtype, strides):
+    # A read-only array on the mapped pages, no copy
+    if address is None or shape[0] == 0:
+        return np.zeros(shape, dtype=dtype)
+    dtype = np.dtype(dtype)
+    size = sum((n - 1) * s for n, s in zip(shape, strides)) + dtype.itemsize
+    buffer = (ctypes.c_char * size).from_address(address)
+    a = np.ndarray(shape, dtype=dtype, buffer=buffer, strides=strides)
+    a.flags.writeable = False
+    return a
+
+
+class IQFile(object):
+    """An IQ file of version 1 or 2, mapped. Arrays from it are only valid until close()."""
+
+    def __init__(self, filename):
+        self._lib = _load()
+        self._handle = self._lib.IQ_reader_init(os.fsencode(filename))
+        if not self._handle:
+            raise IOError('Unable to read {}'.format(filename))
+        self.filename = filename
+        self.pulse_count = self._lib.IQ_reader_get_pulse_count(self._handle)
+        self.range_count = self._lib.IQ_reader_get_range_count(self._handle)
+        self.header = _array(self._lib.IQ_reader_get_header(self._handle), (1,), header_dtype, (1024,))[0]
+        stride = ctypes.c_size_t()
+        address = self._lib.IQ_reader_get_pulse_headers(self._handle, ctypes.byref(stride))
+        self.pulses = _array(address, (self.pulse_count,), pulse_dtype, (stride.value,))
+        count = ctypes.c_uint32()
+        address = self._lib.IQ_reader_get_sweeps(self._handle, ctypes.byref(count))
+        self.sweeps = _array(address, (count.value,), sweep_dtype, (32,))
+        self._iq = None
+
+    def read(self, first=0, count=None):
+        """Samples of count pulses from first, decoded if needed, into a new array"""
+        if count is None:
+            count = self.pulse_count - first
+        out = np.empty((count, self.range_count, 4), dtype=np.float32)
+        if self._lib.IQ_reader_read_samples(self._handle, out.ctypes.data, first, count) < 0:
+            raise IOError('Unable to read pulses {} to {} of {}'.format(first, first + count, self.filename))
+        return out
+
+    @property
+    def iq(self):
+        """pulse_count x range_count x (hi, hq, vi, vq), on the file unless there is a codec"""
+        if self._iq is None:
+            stride = ctypes.c_size_t()
+            address = self._lib.IQ_reader_get_samples(self._handle, ctypes.byref(stride))
+            if address:
+                self._iq = _array(address, (self.pulse_count, self.range_count, 4), np.float32, (stride.value, 16, 4))
+            else:
+                self._iq = self.read()
+        return self._iq
+
+    @property
+    def h(self):
+        return self.iq.view(np.complex64)[..., 0]
+
+    @property
+    def v(self):
+        return self.iq.view(np.complex64)[..., 1]
+
+    def close(self):
+        if self._handle:
+            self.header = self.pulses = self.sweeps = self._iq = None
+            self._lib.IQ_reader_free(self._handle)
+            self._handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def __del__(self):
+        self.close()
@@ -7,12 +7,15 @@
 //
 
 #include "rcs.h"
+#include <sys/mman.h>
 
 // Private structure
 typedef struct _rcs_mem {
     char data_path[1024];
     RCSTable table[256];
     int count;
+    char *maps[256];          // Coefficients mapped from the table files, NULL if read through stdio
+    size_t map_sizes[256];
 } RCSMem;
 
 // Private functions
@@ -167,6 +170,10 @@ void RCS_free(RCSHandle i) {
         RCSTable *table = &h->table[i];
         free(table->data.a);
         free(table->data.b);
+        if (h->maps[i] != NULL) {
+            munmap(h->maps[i], h->map_sizes[i]);
+            continue;
+        }
         free(table->data.hh_real);
         free(table->data.vv_real);
         free(table->data.hv_real);
@@ -215,12 +222,34 @@ RCSTable *RCS_get_table(const RCSHandle in, const RCSConfig config) {
     // Allocate the space needed
     table->data.a = (float *)malloc(table->na * sizeof(float));
     table->data.b = (float *)malloc(table->nb * sizeof(float));
-    table->data.hh_real = (float *)malloc(table->nn * sizeof(float));
-    table->data.vv_real = (float *)malloc(table->nn * sizeof(float));
-    table->data.hv_real = (float *)malloc(table->nn * sizeof(float));
-    table->data.hh_imag = (float *)malloc(table->nn * sizeof(float));
-    table->data.vv_imag = (float *)malloc(table->nn * sizeof(float));
-    table->data.hv_imag = (float *)malloc(table->nn * sizeof(float));
+    // Coefficients are used straight from the page cache, which all processes on a node share
+    const size_t map_size = 2 * sizeof(uint16_t) + 6 * (size_t)table->nn * sizeof(float);
+    struct stat file_stat;
+    char *map = NULL;
+    if (fstat(fileno(fid), &file_stat) == 0 && (size_t)file_stat.st_size >= map_size) {
+        map = (char *)mmap(NULL, map_size, PROT_READ, MAP_SHARED, fileno(fid), 0);
+        if (map == MAP_FAILED) {
+            map = NULL;
+        }
+    }
+    h->maps[h->count] = map;
+    h->map_sizes[h->count] = map_size;
+    if (map != NULL) {
+        float *coef = (float *)(map + 2 * sizeof(uint16_t));
+        table->data.hh_real = coef;
+        table->data.vv_real = coef + table->nn;
+        table->data.hv_real = coef + 2 * table->nn;
+        table->data.hh_imag = coef + 3 * table->nn;
+        table->data.vv_imag = coef + 4 * table->nn;
+        table->data.hv_imag = coef + 5 * table->nn;
+    } else {
+        table->data.hh_real = (float *)malloc(table->nn * sizeof(float));
+        table->data.vv_real = (float *)malloc(table->nn * sizeof(float));
+        table->data.hv_real = (float *)malloc(table->nn * sizeof(float));
+        table->data.hh_imag = (float *)malloc(table->nn * sizeof(float));
+        table->data.vv_imag = (float *)malloc(table->nn * sizeof(float));
+        table->data.hv_imag = (float *)malloc(table->nn * sizeof(float));
+    }
     
     // Fill in the table
     snprintf(table->name, 1024, "%s", config);
@@ -231,12 +260,14 @@ RCSTable *RCS_get_table(const RCSHandle in, const RCSConfig config) {
     for (i=0; i<table->nb; i++) {
         table->data.b[i] = (float)i / (float)(table->nb - 1) * 180.0f;
     }
-    fread(table->data.hh_real, sizeof(float), table->nn, fid);
-    fread(table->data.vv_real, sizeof(float), table->nn, fid);
-    fread(table->data.hv_real, sizeof(float), table->nn, fid);
-    fread(table->data.hh_imag, sizeof(float), table->nn, fid);
-    fread(table->data.vv_imag, sizeof(float), table->nn, fid);
-    fread(table->data.hv_imag, sizeof(float), table->nn, fid);
+    if (map == NULL) {
+        fread(table->data.hh_real, sizeof(float), table->nn, fid);
+        fread(table->data.vv_real, sizeof(float), table->nn, fid);
+        fread(table->data.hv_real, sizeof(float), table->nn, fid);
+        fread(table->data.hh_imag, sizeof(float), table->nn, fid);
+        fread(table->data.vv_imag, sizeof(float), table->nn, fid);
+        fread(table->data.hv_imag, sizeof(float), table->nn, fid);
+    }
     
     h->count++;
 
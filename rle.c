@@ -0,0 +1,107 @@
+//
+//  rle.c
+//  Radar Simulation Framework
+//
+//  Byte plane zero-run codec of float words, shared by the LES cache and the IQ files
+//
+
+#include "rle.h"
+
+// Byte plane b of the residuals, returns the size
+static size_t RLE_pack_bytes(uint8_t *dst, const uint32_t *w, const size_t count, const int b) {
+    uint8_t *out = dst;
+    size_t i = 0, n;
+    #define RLE_residual_byte(i)  (uint8_t)(((i) < 4 ? w[i] : w[i] ^ w[(i) - 4]) >> (8 * b))
+    while (i < count) {
+        n = 0;
+        while (i + n < count && n < 128 && RLE_residual_byte(i + n) == 0) {
+            n++;
+        }
+        if (n > 0) {
+            *out++ = (uint8_t)(127 + n);
+            i += n;
+            continue;
+        }
+        // Literals until a pair of zeros
+        n = 1;
+        while (i + n < count && n < 128 &&
+               !(RLE_residual_byte(i + n) == 0 && (i + n + 1 == count || RLE_residual_byte(i + n + 1) == 0))) {
+            n++;
+        }
+        *out++ = (uint8_t)(n - 1);
+        for (size_t j = 0; j < n; j++) {
+            *out++ = RLE_residual_byte(i + j);
+        }
+        i += n;
+    }
+    #undef RLE_residual_byte
+    return out - dst;
+}
+
+
+// All four byte planes, returns the size
+size_t RLE_pack(uint8_t *dst, const uint32_t *w, const size_t count) {
+    size_t size = 0;
+    for (int b = 0; b < 4; b++) {
+        size += RLE_pack_bytes(dst + size, w, count, b);
+    }
+    return size;
+}
+
+
+// False if src is not exactly count words
+bool RLE_unpack(uint32_t *w, const size_t count, const uint8_t *src, const size_t size) {
+    const uint8_t *end = src + size;
+    size_t i, j, n;
+    uint8_t c;
+    for (int b = 0; b < 4; b++) {
+        i = 0;
+        while (i < count) {
+            if (src == end) {
+                return false;
+            }
+            c = *src++;
+            n = c < 128 ? c + 1 : c - 127;
+            if (i + n > count || (c < 128 && src + n > end)) {
+                return false;
+            }
+            if (b == 0) {
+                if (c < 128) {
+                    for (j = 0; j < n; j++) {
+                        w[i + j] = src[j];
+                    }
+                    src += n;
+                } else {
+                    memset(w + i, 0, n * sizeof(uint32_t));
+                }
+            } else if (c < 128) {
+                for (j = 0; j < n; j++) {
+                    w[i + j] |= (uint32_t)src[j] << (8 * b);
+                }
+                src += n;
+            }
+            i += n;
+        }
+    }
+    // Undo the prediction from the previous cell or gate
+    for (i = 4; i < count; i++) {
+        w[i] ^= w[i - 4];
+    }
+    return src == end;
+}
+
+
+// Keeps the leading bits of the mantissa, rounded to nearest, relative error <= 2 ^ -(bits + 1)
+void RLE_round_mantissa(uint32_t *w, const size_t count, const uint32_t bits) {
+    if (bits >= 23) {
+        return;
+    }
+    const uint32_t drop = 23 - bits;
+    const uint32_t half = 1U << (drop - 1);
+    const uint32_t mask = ~((1U << drop) - 1);
+    for (size_t i = 0; i < count; i++) {
+        if ((w[i] & 0x7f800000) != 0x7f800000) {
+            w[i] = (w[i] + half) & mask;
+        }
+    }
+}
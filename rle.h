@@ -0,0 +1,21 @@
+//
+//  rle.h
+//  Radar Simulation Framework
+//
+//  Byte plane zero-run codec of float words, shared by the LES cache and the IQ files
+//
+
+#ifndef rle_h
+#define rle_h
+
+#include "rs_types.h"
+
+// Each word is XOR'ed with the word four before it, i.e., the same component of the previous cell or gate, then the
+// four byte planes are coded one after another as runs: (c - 127) zero bytes for c >= 128, otherwise (c + 1) bytes
+// as they are.
+
+size_t RLE_pack(uint8_t *dst, const uint32_t *w, const size_t count);
+bool RLE_unpack(uint32_t *w, const size_t count, const uint8_t *src, const size_t size);
+void RLE_round_mantissa(uint32_t *w, const size_t count, const uint32_t bits);
+
+#endif /* rle_h */
@@ -380,6 +380,33 @@ float zdr(cl_float4 x) {
 #pragma mark -
 #pragma mark Private Functions
 
+#if !defined (_USE_GCL_)
+
+static void RS_worker_create_kernels(RSWorker *C) {
+    
+    cl_int ret;
+    
+    C->kern_io = clCreateKernel(C->prog, "io", &ret);                                             CHECK_CL_CREATE_KERNEL
+    C->kern_scat_pop = clCreateKernel(C->prog, "scat_pop", &ret);                                 CHECK_CL_CREATE_KERNEL
+    C->kern_dummy = clCreateKernel(C->prog, "dummy", &ret);                                       CHECK_CL_CREATE_KERNEL
+    C->kern_db_rcs = clCreateKernel(C->prog, "db_rcs", &ret);                                     CHECK_CL_CREATE_KERNEL
+    C->kern_bg_atts = clCreateKernel(C->prog, "bg_atts", &ret);                                   CHECK_CL_CREATE_KERNEL
+    C->kern_fp_atts = clCreateKernel(C->prog, "fp_atts", &ret);                                   CHECK_CL_CREATE_KERNEL
+    C->kern_el_atts = clCreateKernel(C->prog, "el_atts", &ret);                                   CHECK_CL_CREATE_KERNEL
+    C->kern_db_atts = clCreateKernel(C->prog, "db_atts", &ret);                                   CHECK_CL_CREATE_KERNEL
+    C->kern_scat_clr = clCreateKernel(C->prog, "scat_clr", &ret);                                 CHECK_CL_CREATE_KERNEL
+    C->kern_scat_move = clCreateKernel(C->prog, "scat_move", &ret);                               CHECK_CL_CREATE_KERNEL
+    C->kern_scat_sig_aux = clCreateKernel(C->prog, "scat_sig_aux", &ret);                         CHECK_CL_CREATE_KERNEL
+    C->kern_make_pulse_pass_1 = clCreateKernel(C->prog, "make_pulse_pass_1", &ret);               CHECK_CL_CREATE_KERNEL
+    C->kern_make_pulse_pass_2_group = clCreateKernel(C->prog, "make_pulse_pass_2_group", &ret);   CHECK_CL_CREATE_KERNEL
+    C->kern_make_pulse_pass_2_local = clCreateKernel(C->prog, "make_pulse_pass_2_local", &ret);   CHECK_CL_CREATE_KERNEL
+    C->kern_make_pulse_pass_2_range = clCreateKernel(C->prog, "make_pulse_pass_2_range", &ret);   CHECK_CL_CREATE_KERNEL
+    C->kern_make_pulse_pass_2 = C->kern_make_pulse_pass_2_group;
+}
+
+#endif
+
+
 void RS_worker_init(RSWorker *C, cl_device_id dev, cl_uint src_size, const char **src_ptr, cl_context_properties sharegroup, const char verb) {
     
     C->dev = dev;
@@ -492,20 +519,10 @@ void RS_worker_init(RSWorker *C, cl_device_id dev, cl_uint src_size, const char
     }
     
     // Tie all kernels to the program
-    C->kern_io = clCreateKernel(C->prog, "io", &ret);                                             CHECK_CL_CREATE_KERNEL
-    C->kern_dummy = clCreateKernel(C->prog, "dummy", &ret);                                       CHECK_CL_CREATE_KERNEL
-    C->kern_db_rcs = clCreateKernel(C->prog, "db_rcs", &ret);                                     CHECK_CL_CREATE_KERNEL
-    C->kern_bg_atts = clCreateKernel(C->prog, "bg_atts", &ret);                                   CHECK_CL_CREATE_KERNEL
-    C->kern_fp_atts = clCreateKernel(C->prog, "fp_atts", &ret);                                   CHECK_CL_CREATE_KERNEL
-    C->kern_el_atts = clCreateKernel(C->prog, "el_atts", &ret);                                   CHECK_CL_CREATE_KERNEL
-    C->kern_db_atts = clCreateKernel(C->prog, "db_atts", &ret);                                   CHECK_CL_CREATE_KERNEL
-    C->kern_scat_clr = clCreateKernel(C->prog, "scat_clr", &ret);                                 CHECK_CL_CREATE_KERNEL
-    C->kern_scat_sig_aux = clCreateKernel(C->prog, "scat_sig_aux", &ret);                         CHECK_CL_CREATE_KERNEL
-    C->kern_make_pulse_pass_1 = clCreateKernel(C->prog, "make_pulse_pass_1", &ret);               CHECK_CL_CREATE_KERNEL
-    C->kern_make_pulse_pass_2_group = clCreateKernel(C->prog, "make_pulse_pass_2_group", &ret);   CHECK_CL_CREATE_KERNEL
-    C->kern_make_pulse_pass_2_local = clCreateKernel(C->prog, "make_pulse_pass_2_range", &ret);   CHECK_CL_CREATE_KERNEL
-    C->kern_make_pulse_pass_2_range = clCreateKernel(C->prog, "make_pulse_pass_2_local", &ret);   CHECK_CL_CREATE_KERNEL
-    C->kern_make_pulse_pass_2 = C->kern_make_pulse_pass_2_group;
+    RS_worker_create_kernels(C);
+    if (C->kern_make_pulse_pass_2 == NULL) {
+        return;
+    }
     
     if (verb > 1) {
         rsprint("Kernels for program[%d] created.\n", (int)C->name);
@@ -532,7 +549,7 @@ void RS_worker_init(RSWorker *C, cl_device_id dev, cl_uint src_size, const char
     }
     
     // A queue for the CL work of each device
-    C->que = clCreateCommandQueue(C->context, C->dev, 0, &ret);
+    C->que = clCreateCommandQueue(C->context, C->dev, CL_QUEUE_PROFILING_ENABLE, &ret);
     if (ret != CL_SUCCESS) {
         rsprint("Creating command queue[%d] failed  (ret = %d).\n", (int)C->name, ret);
     } else if (verb > 1) {
@@ -544,6 +561,121 @@ void RS_worker_init(RSWorker *C, cl_device_id dev, cl_uint src_size, const char
 }
 
 
+// Another segment of scatterers on the device of P, sharing the context, the program and the tables of P
+void RS_worker_init_segment(RSWorker *C, const RSWorker *P, const char name) {
+    
+#if defined (_USE_GCL_)
+    
+    rsprint("ERROR: Scatterer segments are not available with GCL.");
+    exit(EXIT_FAILURE);
+    
+#else
+    
+    int k;
+    cl_int ret;
+    
+    memcpy(C, P, sizeof(RSWorker));
+    C->name = name;
+    C->segment = name - P->name;
+    C->mem_usage = 0;
+    C->busy_time = 0.0;
+    C->busy_scats = 0.0;
+    
+    // Scatterer buffers are allocated later by RS_worker_malloc()
+    C->scat_pos = NULL;
+    C->scat_vel = NULL;
+    C->scat_ori = NULL;
+    C->scat_tum = NULL;
+    C->scat_aux = NULL;
+    C->scat_rcs = NULL;
+    C->scat_sig = NULL;
+    C->scat_rnd = NULL;
+    C->scat_clr = NULL;
+    C->work = NULL;
+    C->pulse = NULL;
+    
+    // Every worker releases its own references in RS_worker_free(), wind tables replaced later are shared again by RS_set_vel_data()
+    clRetainContext(C->context);
+    clRetainProgram(C->prog);
+    if (C->range_weight)       clRetainMemObject(C->range_weight);
+    if (C->angular_weight)     clRetainMemObject(C->angular_weight);
+    if (C->angular_weight_2d)  clRetainMemObject(C->angular_weight_2d);
+    if (C->rcs_ellipsoid)      clRetainMemObject(C->rcs_ellipsoid);
+    for (k = 0; k < C->adm_count; k++) {
+        clRetainMemObject(C->adm_cd[k]);
+        clRetainMemObject(C->adm_cm[k]);
+    }
+    for (k = 0; k < C->rcs_count; k++) {
+        clRetainMemObject(C->rcs_real[k]);
+        clRetainMemObject(C->rcs_imag[k]);
+    }
+    for (k = 0; k < 2; k++) {
+        if (C->les_uvwt[k])    clRetainMemObject(C->les_uvwt[k]);
+        if (C->les_cpxx[k])    clRetainMemObject(C->les_cpxx[k]);
+        if (C->dff_icdf[k])    clRetainMemObject(C->dff_icdf[k]);
+        if (C->les_nest_uvwt[k]) clRetainMemObject(C->les_nest_uvwt[k]);
+    }
+    if (C->les_nest_desc)      clRetainMemObject(C->les_nest_desc);
+    C->event_nest_upload = NULL;
+    
+    // Own kernels since the arguments differ, own queue so that segments are scheduled like other workers
+    C->kern_make_pulse_pass_2 = NULL;
+    RS_worker_create_kernels(C);
+    if (C->kern_make_pulse_pass_2 == NULL) {
+        exit(EXIT_FAILURE);
+    }
+    C->que = clCreateCommandQueue(C->context, C->dev, CL_QUEUE_PROFILING_ENABLE, &ret);
+    if (ret != CL_SUCCESS) {
+        rsprint("Creating command queue[%d] failed  (ret = %d).\n", (int)C->name, ret);
+        exit(EXIT_FAILURE);
+    }
+    
+#endif
+    
+}
+
+
+// Points mem to the same object as shared, replacing its own reference
+static void RS_worker_share_mem(cl_mem *mem, const cl_mem shared) {
+    
+#if !defined (_USE_GCL_)
+    
+    if (*mem == shared) {
+        return;
+    }
+    if (*mem != NULL) {
+        clReleaseMemObject(*mem);
+    }
+    *mem = shared;
+    if (shared != NULL) {
+        clRetainMemObject(shared);
+    }
+    
+#endif
+    
+}
+
+
+// Wind tables of the other segments of a device are those of the first segment, only that one creates and uploads them
+static void RS_worker_share_vel_data(RSWorker *C, const RSWorker *P) {
+    for (int k = 0; k < 2; k++) {
+        RS_worker_share_mem(&C->les_uvwt[k], P->les_uvwt[k]);
+        RS_worker_share_mem(&C->les_cpxx[k], P->les_cpxx[k]);
+    }
+    C->les_half = P->les_half;
+    memcpy(C->les_region, P->les_region, sizeof(C->les_region));
+}
+
+
+static void RS_worker_share_vel_nests(RSWorker *C, const RSWorker *P) {
+    RS_worker_share_mem(&C->les_nest_uvwt[0], P->les_nest_uvwt[0]);
+    RS_worker_share_mem(&C->les_nest_uvwt[1], P->les_nest_uvwt[1]);
+    RS_worker_share_mem(&C->les_nest_desc, P->les_nest_desc);
+    C->les_nest_half = P->les_nest_half;
+    memcpy(C->les_nest_region, P->les_nest_region, sizeof(C->les_nest_region));
+}
+
+
 void RS_worker_free(RSWorker *C) {
     
 #if defined (_USE_GCL_)
@@ -569,14 +701,24 @@ void RS_worker_free(RSWorker *C) {
     gcl_release_image(C->les_uvwt[0]);
     gcl_release_image(C->les_uvwt[1]);
     
+    if (C->les_nest_uvwt[0] != NULL) {
+        gcl_release_image(C->les_nest_uvwt[0]);
+        gcl_release_image(C->les_nest_uvwt[1]);
+        gcl_free(C->les_nest_desc);
+    }
+    
     gcl_release_image(C->dff_icdf[0]);
     gcl_release_image(C->dff_icdf[1]);
 
 #else
     
     clReleaseCommandQueue(C->que);
+    if (C->que_copy) {
+        clReleaseCommandQueue(C->que_copy);
+    }
     
     clReleaseKernel(C->kern_io);
+    clReleaseKernel(C->kern_scat_pop);
     clReleaseKernel(C->kern_dummy);
     clReleaseKernel(C->kern_db_rcs);
     clReleaseKernel(C->kern_bg_atts);
@@ -584,6 +726,7 @@ void RS_worker_free(RSWorker *C) {
     clReleaseKernel(C->kern_el_atts);
     clReleaseKernel(C->kern_db_atts);
     clReleaseKernel(C->kern_scat_clr);
+    clReleaseKernel(C->kern_scat_move);
     clReleaseKernel(C->kern_scat_sig_aux);
     clReleaseKernel(C->kern_make_pulse_pass_1);
     clReleaseKernel(C->kern_make_pulse_pass_2_group);
@@ -611,6 +754,18 @@ void RS_worker_free(RSWorker *C) {
     
     clReleaseMemObject(C->les_uvwt[0]);
     clReleaseMemObject(C->les_uvwt[1]);
+    clReleaseMemObject(C->les_cpxx[0]);
+    clReleaseMemObject(C->les_cpxx[1]);
+    
+    if (C->event_nest_upload != NULL) {
+        clWaitForEvents(1, &C->event_nest_upload);
+        clReleaseEvent(C->event_nest_upload);
+    }
+    if (C->les_nest_uvwt[0] != NULL) {
+        clReleaseMemObject(C->les_nest_uvwt[0]);
+        clReleaseMemObject(C->les_nest_uvwt[1]);
+        clReleaseMemObject(C->les_nest_desc);
+    }
     
     clReleaseMemObject(C->dff_icdf[0]);
     clReleaseMemObject(C->dff_icdf[1]);
@@ -635,11 +790,23 @@ void RS_worker_malloc(RSHandle *H, const int worker_id) {
     }
     
     // Derive the necessary parameters from host to compute workers
-    if (C->num_scats != H->num_scats / MAX(1, H->num_workers)) {
+    if (H->offset[worker_id] + C->num_scats > H->num_scats) {
         rsprint("ERROR: Inconsistent number of scatterers.\n");
         return;
     }
     
+    C->in_beam = 1;
+    C->sig_stale = 0;
+    
+    // Only a chunk of the population is on the device when streaming
+    C->stream_chunk = H->stream_chunk ? MIN(H->stream_chunk, C->num_scats) : 0;
+    const size_t resident_scats = C->stream_chunk ? C->stream_chunk : C->num_scats;
+    
+    // Native threads work on the host arrays directly
+    if (H->method == RS_METHOD_NATIVE) {
+        return;
+    }
+    
     size_t group_size_multiple = RS_CL_GROUP_ITEMS;
     
 #if !defined (_USE_GCL_)
@@ -665,7 +832,7 @@ void RS_worker_malloc(RSHandle *H, const int worker_id) {
         rsprint("CL_DEVICE_LOCAL_MEM_SIZE = %zu", (size_t)local_mem_size);
     }
     
-    C->make_pulse_params = RS_make_pulse_params((cl_uint)C->num_scats,
+    C->make_pulse_params = RS_make_pulse_params((cl_uint)resident_scats,
                                                 (cl_uint)group_size_multiple,
                                                 (cl_uint)max_work_group_size,
                                                 (cl_uint)local_mem_size,
@@ -712,7 +879,7 @@ void RS_worker_malloc(RSHandle *H, const int worker_id) {
     
     //printf("shared_vbo: %d %d %d\n", C->vbo_scat_pos, C->vbo_scat_clr, C->vbo_scat_ori);
     
-    size_t numel = ((C->num_scats + group_size_multiple - 1) / group_size_multiple) * group_size_multiple;
+    size_t numel = ((resident_scats + group_size_multiple - 1) / group_size_multiple) * group_size_multiple;
     
     //printf("numel = %zu  num_scats = %zu\n", numel, C->num_scats);
     
@@ -745,10 +912,51 @@ void RS_worker_malloc(RSHandle *H, const int worker_id) {
     clEnqueueWriteBuffer(C->que, C->scat_aux, CL_TRUE, 0, numel * sizeof(cl_float4), zeros, 0, NULL, NULL);
     clEnqueueWriteBuffer(C->que, C->scat_rcs, CL_TRUE, 0, numel * sizeof(cl_float4), zeros, 0, NULL, NULL);
     clEnqueueWriteBuffer(C->que, C->scat_sig, CL_TRUE, 0, numel * sizeof(cl_float4), zeros, 0, NULL, NULL);
-    free(zeros);
     
     C->mem_usage += (8 * numel + work_numel + H->params.range_count) * sizeof(cl_float4) + numel * sizeof(cl_uint4);
     
+    // Second set of buffers so that the transfers of one chunk overlap the kernels of the other
+    if (C->stream_chunk) {
+        C->stream_pos[0] = C->scat_pos;
+        C->stream_vel[0] = C->scat_vel;
+        C->stream_aux[0] = C->scat_aux;
+        C->stream_rcs[0] = C->scat_rcs;
+        C->stream_sig[0] = C->scat_sig;
+        C->stream_rnd[0] = C->scat_rnd;
+        C->stream_pulse[0] = C->pulse;
+        C->stream_pos[1]   = clCreateBuffer(C->context, CL_MEM_READ_WRITE, numel * sizeof(cl_float4), NULL, &ret);                CHECK_CL_CREATE_BUFFER
+        C->stream_vel[1]   = clCreateBuffer(C->context, CL_MEM_READ_WRITE, numel * sizeof(cl_float4), NULL, &ret);                CHECK_CL_CREATE_BUFFER
+        C->stream_aux[1]   = clCreateBuffer(C->context, CL_MEM_READ_WRITE, numel * sizeof(cl_float4), NULL, &ret);                CHECK_CL_CREATE_BUFFER
+        C->stream_rcs[1]   = clCreateBuffer(C->context, CL_MEM_READ_WRITE, numel * sizeof(cl_float4), NULL, &ret);                CHECK_CL_CREATE_BUFFER
+        C->stream_sig[1]   = clCreateBuffer(C->context, CL_MEM_READ_WRITE, numel * sizeof(cl_float4), NULL, &ret);                CHECK_CL_CREATE_BUFFER
+        C->stream_rnd[1]   = clCreateBuffer(C->context, CL_MEM_READ_WRITE, numel * sizeof(cl_uint4), NULL, &ret);                 CHECK_CL_CREATE_BUFFER
+        C->stream_pulse[1] = clCreateBuffer(C->context, CL_MEM_READ_WRITE, H->params.range_count * sizeof(cl_float4), NULL, &ret);    CHECK_CL_CREATE_BUFFER
+        clEnqueueWriteBuffer(C->que, C->stream_aux[1], CL_TRUE, 0, numel * sizeof(cl_float4), zeros, 0, NULL, NULL);
+        clEnqueueWriteBuffer(C->que, C->stream_rcs[1], CL_TRUE, 0, numel * sizeof(cl_float4), zeros, 0, NULL, NULL);
+        clEnqueueWriteBuffer(C->que, C->stream_sig[1], CL_TRUE, 0, numel * sizeof(cl_float4), zeros, 0, NULL, NULL);
+        
+        C->mem_usage += (5 * numel + H->params.range_count) * sizeof(cl_float4) + numel * sizeof(cl_uint4);
+        
+        if (C->que_copy == NULL) {
+            C->que_copy = clCreateCommandQueue(C->context, C->dev, 0, &ret);
+            if (ret != CL_SUCCESS) {
+                fprintf(stderr, "%s : RS : Error creating the transfer queue for streaming.  ret = %d\n", now(), ret);
+                exit(EXIT_FAILURE);
+            }
+        }
+        
+        const size_t num_chunks = (C->num_scats + C->stream_chunk - 1) / C->stream_chunk;
+        if (posix_memalign((void **)&C->stream_pulse_parts, RS_ALIGN_SIZE, num_chunks * H->params.range_count * sizeof(cl_float4))) {
+            rsprint("ERROR: Unable to allocate memory space for the pulses of %s chunks.", commaint(num_chunks));
+            exit(EXIT_FAILURE);
+        }
+        
+        if (C->verb) {
+            rsprint("workers[%d] streams %s scatterers in %s chunks of %s", C->name, commaint(C->num_scats), commaint(num_chunks), commaint(C->stream_chunk));
+        }
+    }
+    free(zeros);
+    
     //
     // Set up kernel's input / output arguments
     //
@@ -788,8 +996,11 @@ void RS_worker_malloc(RSHandle *H, const int worker_id) {
     ret |= clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundVelocity,            sizeof(cl_mem),     &C->les_uvwt[0]);
     ret |= clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundCn2Pressure,         sizeof(cl_mem),     &C->les_cpxx[0]);
     ret |= clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundDescription,         sizeof(cl_float16), &C->les_desc);
+    ret |= clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundNestVelocity,        sizeof(cl_mem),     &C->les_nest_uvwt[0]);
+    ret |= clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundNestDescription,     sizeof(cl_mem),     &C->les_nest_desc);
     ret |= clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentEllipsoidRCS,                  sizeof(cl_mem),     &C->rcs_ellipsoid);
     ret |= clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentEllipsoidRCSDescription,       sizeof(cl_float4),  &C->rcs_ellipsoid_desc);
+    ret |= clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentSlabDescription,               sizeof(cl_float4),  &C->slab_desc);
     ret |= clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentSimulationDescription,         sizeof(cl_float16), &H->sim_desc);
     if (ret != CL_SUCCESS) {
         fprintf(stderr, "%s : RS : Error: Failed to set arguments for kernel kern_bg_atts().\n", now());
@@ -804,8 +1015,11 @@ void RS_worker_malloc(RSHandle *H, const int worker_id) {
     ret |= clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundVelocity,            sizeof(cl_mem),     &C->les_uvwt[0]);
     ret |= clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundCn2Pressure,         sizeof(cl_mem),     &C->les_cpxx[0]);
     ret |= clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundDescription,         sizeof(cl_float16), &C->les_desc);
+    ret |= clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundNestVelocity,        sizeof(cl_mem),     &C->les_nest_uvwt[0]);
+    ret |= clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundNestDescription,     sizeof(cl_mem),     &C->les_nest_desc);
     ret |= clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentEllipsoidRCS,                  sizeof(cl_mem),     &C->rcs_ellipsoid);
     ret |= clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentEllipsoidRCSDescription,       sizeof(cl_float4),  &C->rcs_ellipsoid_desc);
+    ret |= clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentSlabDescription,               sizeof(cl_float4),  &C->slab_desc);
     ret |= clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentSimulationDescription,         sizeof(cl_float16), &H->sim_desc);
     if (ret != CL_SUCCESS) {
         fprintf(stderr, "%s : RS : Error: Failed to set arguments for kernel kern_fp_atts().\n", now());
@@ -820,8 +1034,11 @@ void RS_worker_malloc(RSHandle *H, const int worker_id) {
     ret |= clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundVelocity,            sizeof(cl_mem),     &C->les_uvwt[0]);
     ret |= clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundCn2Pressure,         sizeof(cl_mem),     &C->les_cpxx[0]);
     ret |= clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundDescription,         sizeof(cl_float16), &C->les_desc);
+    ret |= clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundNestVelocity,        sizeof(cl_mem),     &C->les_nest_uvwt[0]);
+    ret |= clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundNestDescription,     sizeof(cl_mem),     &C->les_nest_desc);
     ret |= clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentEllipsoidRCS,                  sizeof(cl_mem),     &C->rcs_ellipsoid);
     ret |= clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentEllipsoidRCSDescription,       sizeof(cl_float4),  &C->rcs_ellipsoid_desc);
+    ret |= clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentSlabDescription,               sizeof(cl_float4),  &C->slab_desc);
     ret |= clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentSimulationDescription,         sizeof(cl_float16), &H->sim_desc);
     if (ret != CL_SUCCESS) {
         fprintf(stderr, "%s : RS : Error: Failed to set arguments for kernel kern_el_atts().\n", now());
@@ -838,6 +1055,8 @@ void RS_worker_malloc(RSHandle *H, const int worker_id) {
     ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundVelocity,            sizeof(cl_mem),     &C->les_uvwt[0]);
     ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundCn2Pressure,         sizeof(cl_mem),     &C->les_cpxx[0]);
     ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundVelocityDescription, sizeof(cl_float16), &C->les_desc);
+    ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundNestVelocity,        sizeof(cl_mem),     &C->les_nest_uvwt[0]);
+    ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundNestDescription,     sizeof(cl_mem),     &C->les_nest_desc);
     ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentAirDragModelDrag,              sizeof(cl_mem),     &C->adm_cd[0]);
     ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentAirDragModelMomentum,          sizeof(cl_mem),     &C->adm_cm[0]);
     ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentAirDragModelDescription,       sizeof(cl_float16), &C->adm_desc[0]);
@@ -846,6 +1065,7 @@ void RS_worker_malloc(RSHandle *H, const int worker_id) {
     ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentRadarCrossSectionDescription,  sizeof(cl_float16), &C->rcs_desc[0]);
     ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentDebrisFluxField,               sizeof(cl_mem),     &C->dff_icdf[0]);
     ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentDebrisFluxFieldDescription,    sizeof(cl_float16), &C->dff_desc);
+    ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentSlabDescription,               sizeof(cl_float4),  &C->slab_desc);
     ret |= clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentSimulationDescription,         sizeof(cl_float16), &H->sim_desc);
     if (ret != CL_SUCCESS) {
         fprintf(stderr, "%s : RS : Error: Failed to set arguments for kernel kern_db_atts().\n", now());
@@ -995,6 +1215,39 @@ int RS_indent_copy(char *dst, char *src, const int width) {
 #pragma mark RS Initialization and Deallocation
 
 
+static RSHandle *RS_init_defaults(RSHandle *H, const char verb) {
+    
+    // Temporary supress the verbose output for setting default values; or very verbosy for heavy debug version
+
+#if defined(DEBUG_HEAVY)
+    
+    H->verb = 3;
+
+#else
+
+    H->verb = verb > 1 ? verb : 0;
+
+#endif
+    
+    // Set up some basic parameters to default values, H->verb is still 0 so no API message output
+    RS_set_prt(H, RS_PARAMS_PRT);
+    
+    RS_set_lambda(H, RS_PARAMS_LAMBDA);
+    
+    RS_set_antenna_params(H, RS_PARAMS_BEAMWIDTH, 50.0f);
+    
+    RS_set_tx_params(H, RS_PARAMS_TAU, 50.0e3f);
+    
+    RS_set_beam_pos(H, 5.0f, 1.0f);
+    
+    RS_set_sampling_spacing(H, RS_PARAMS_GATEWIDTH, RS_PARAMS_BEAMWIDTH, RS_PARAMS_BEAMWIDTH);
+
+    H->verb = verb;
+    
+    return H;
+}
+
+
 RSHandle *RS_init_with_path(const char *bundle_path, RSMethod method, const uint8_t gpu_mask, cl_context_properties sharegroup, const char verb) {
     
     int i, k;
@@ -1019,8 +1272,9 @@ RSHandle *RS_init_with_path(const char *bundle_path, RSMethod method, const uint
     H->num_types = 1;
     H->method = method;
     H->random_seed = 19760520;
+    H->host_mirrors = RSHostMirrorAll;
     
-    for (i = 0; i < RS_MAX_GPU_DEVICE; i++) {
+    for (i = 0; i < RS_MAX_WORKERS; i++) {
         H->workers[i].name = i;
     }
     
@@ -1028,7 +1282,32 @@ RSHandle *RS_init_with_path(const char *bundle_path, RSMethod method, const uint
         H->counts[i] = 0;
     }
     
-    if (H->method == RS_METHOD_GPU) {
+    if (H->method == RS_METHOD_NATIVE) {
+        
+#if defined (_USE_GCL_) || defined (GUI)
+        
+        rsprint("ERROR: The native engine cannot share buffers with OpenGL.");
+        return NULL;
+        
+#else
+        
+        // One host thread per worker, no OpenCL device is touched. A mask picks the thread count, one per bit
+        long num_cpus = gpu_mask ? __builtin_popcount(gpu_mask) : sysconf(_SC_NPROCESSORS_ONLN);
+        H->num_workers = (cl_uint)MIN(MAX(1, num_cpus), RS_MAX_WORKERS);
+        H->num_devs = 1;
+        H->num_cus[0] = 1;
+        H->preferred_multiple = H->num_workers * RS_CL_GROUP_ITEMS;
+        if (verb) {
+            rsprint("Native engine with %d threads", H->num_workers);
+        }
+        if (RS_native_init(H)) {
+            return NULL;
+        }
+        return RS_init_defaults(H, verb);
+        
+#endif
+        
+    } else if (H->method == RS_METHOD_GPU) {
         if (verb) {
             rsprint("Getting CL devices ...");
         }
@@ -1122,50 +1401,33 @@ RSHandle *RS_init_with_path(const char *bundle_path, RSMethod method, const uint
         if (verb > 1) {
             rsprint("Initializing worker %d using device %d @ %p\n", i, k, H->devs[k]);
         }
-        RS_worker_init(&H->workers[i], H->devs[i], count, (const char **)src_ptr, sharegroup, verb);
+        RS_worker_init(&H->workers[i], H->devs[k], count, (const char **)src_ptr, sharegroup, verb);
         i++;
     }
     
 #endif
     
-    // Temporary supress the verbose output for setting default values; or very verbosy for heavy debug version
-
-#if defined(DEBUG_HEAVY)
-    
-    H->verb = 3;
+    return RS_init_defaults(H, verb);
+}
 
-#else
 
-    H->verb = verb > 1 ? verb : 0;
+RSHandle *RS_init_for_selected_gpu(const uint8_t gpu_mask, const char verb) {
+    return RS_init_with_path(".", RS_METHOD_GPU, gpu_mask, 0, verb);
+}
 
-#endif
-    
-    // Set up some basic parameters to default values, H->verb is still 0 so no API message output
-    RS_set_prt(H, RS_PARAMS_PRT);
-    
-    RS_set_lambda(H, RS_PARAMS_LAMBDA);
-    
-    RS_set_antenna_params(H, RS_PARAMS_BEAMWIDTH, 50.0f);
-    
-    RS_set_tx_params(H, RS_PARAMS_TAU, 50.0e3f);
-    
-    RS_set_beam_pos(H, 5.0f, 1.0f);
-    
-    RS_set_sampling_spacing(H, RS_PARAMS_GATEWIDTH, RS_PARAMS_BEAMWIDTH, RS_PARAMS_BEAMWIDTH);
 
-    H->verb = verb;
-    
-    return H;
+RSHandle *RS_init_for_cpu_verbose(const char verb) {
+    return RS_init_with_path(".", RS_METHOD_CPU, 0x01, 0, verb);
 }
 
 
-RSHandle *RS_init_for_selected_gpu(const uint8_t gpu_mask, const char verb) {
-    return RS_init_with_path(".", RS_METHOD_GPU, gpu_mask, 0, verb);
+RSHandle *RS_init_native_verbose(const char verb) {
+    return RS_init_with_path(".", RS_METHOD_NATIVE, 0, 0, verb);
 }
 
 
-RSHandle *RS_init_for_cpu_verbose(const char verb) {
-    return RS_init_with_path(".", RS_METHOD_CPU, 0, 0, verb);
+RSHandle *RS_init_native_for_selected_threads(const uint8_t thread_mask, const char verb) {
+    return RS_init_with_path(".", RS_METHOD_NATIVE, thread_mask, 0, verb);
 }
 
 
@@ -1179,6 +1441,59 @@ RSHandle *RS_init() {
 }
 
 
+// Address of the host array behind bit k of RSHostMirror
+static void **RS_host_mirror_address(RSHandle *H, const int k) {
+    void **address[] = {
+        (void **)&H->scat_pos,
+        (void **)&H->scat_vel,
+        (void **)&H->scat_ori,
+        (void **)&H->scat_tum,
+        (void **)&H->scat_aux,
+        (void **)&H->scat_rcs,
+        (void **)&H->scat_sig,
+        (void **)&H->scat_rnd
+    };
+    return address[k];
+}
+
+
+// Allocates the requested host mirrors that do not exist yet, returns the ones that are new
+static RSHostMirror RS_alloc_host_mirrors(RSHandle *H, const RSHostMirror mirrors) {
+    int k;
+    void **a;
+    RSHostMirror fresh = RSHostMirrorNone;
+    for (k = 0; k < 8; k++) {
+        a = RS_host_mirror_address(H, k);
+        if (!(mirrors & (1 << k)) || *a != NULL) {
+            continue;
+        }
+        // The cl_uint4 seeds take as much space as the cl_float4 attributes
+        if (posix_memalign(a, RS_ALIGN_SIZE, H->num_scats * sizeof(cl_float4))) {
+            rsprint("ERROR: Unable to allocate memory space for scatterers.");
+            exit(EXIT_FAILURE);
+        }
+        H->mem_size += H->num_scats * sizeof(cl_float4);
+        fresh |= 1 << k;
+    }
+    return fresh;
+}
+
+
+static void RS_free_host_mirrors(RSHandle *H, const RSHostMirror mirrors) {
+    int k;
+    void **a;
+    for (k = 0; k < 8; k++) {
+        a = RS_host_mirror_address(H, k);
+        if (!(mirrors & (1 << k)) || *a == NULL) {
+            continue;
+        }
+        free(*a);
+        *a = NULL;
+        H->mem_size -= H->num_scats * sizeof(cl_float4);
+    }
+}
+
+
 void RS_free_scat_memory(RSHandle *H) {
     int i;
     
@@ -1208,7 +1523,7 @@ void RS_free_scat_memory(RSHandle *H) {
     
 #else
     
-    for (i = 0; i < H->num_workers; i++) {
+    for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
         clReleaseMemObject(H->workers[i].scat_pos);
         clReleaseMemObject(H->workers[i].scat_clr);
         clReleaseMemObject(H->workers[i].scat_vel);
@@ -1220,6 +1535,18 @@ void RS_free_scat_memory(RSHandle *H) {
         clReleaseMemObject(H->workers[i].work);
         clReleaseMemObject(H->workers[i].pulse);
         clReleaseMemObject(H->workers[i].scat_rnd);
+        // Set 0 of the streaming buffers aliases the ones above
+        if (H->workers[i].stream_chunk) {
+            clReleaseMemObject(H->workers[i].stream_pos[1]);
+            clReleaseMemObject(H->workers[i].stream_vel[1]);
+            clReleaseMemObject(H->workers[i].stream_aux[1]);
+            clReleaseMemObject(H->workers[i].stream_rcs[1]);
+            clReleaseMemObject(H->workers[i].stream_sig[1]);
+            clReleaseMemObject(H->workers[i].stream_rnd[1]);
+            clReleaseMemObject(H->workers[i].stream_pulse[1]);
+            free(H->workers[i].stream_pulse_parts);
+            H->workers[i].stream_pulse_parts = NULL;
+        }
     }
     
 #endif
@@ -1228,20 +1555,21 @@ void RS_free_scat_memory(RSHandle *H) {
         rsprint("Freeing CPU memories ...");
     }
     
-    free(H->scat_pos);
-    free(H->scat_vel);
-    free(H->scat_ori);
-    free(H->scat_tum);
-    free(H->scat_aux);
-    free(H->scat_rcs);
-    free(H->scat_sig);
-    free(H->scat_rnd);
+    RS_free_host_mirrors(H, RSHostMirrorAll);
+    
+    free(H->scat_uid);
+    H->scat_uid = NULL;
     
     free(H->pulse);
     
     for (i = 0; i < H->num_workers; i++) {
         free(H->pulse_tmp[i]);
     }
+    
+    if (H->stream_zeros) {
+        free(H->stream_zeros);
+        H->stream_zeros = NULL;
+    }
 }
 
 
@@ -1251,20 +1579,34 @@ void RS_free(RSHandle *H) {
     
     char v = H->verb;
     
-    LES_free(H->L);
+    if (H->L) {
+        LES_free(H->L);
+    }
     
     if (H->O) {
         OBJ_free(H->O);
     }
     
-    for (i = 0; i < H->num_workers; i++) {
+    for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
         RS_worker_free(&H->workers[i]);
     }
     
+    if (H->native) {
+        RS_native_free(H);
+    }
+    
     RS_free_scat_memory(H);
     
+    for (i = 0; i < H->vel_nest_count; i++) {
+        RS_table3d_free(H->vel_nests[i]);
+        if (H->vel_nest_les[i] != NULL) {
+            LES_free(H->vel_nest_les[i]);
+        }
+    }
+    
     free(H->anchor_pos);
     free(H->anchor_lines);
+    free(H->dff_icdf);
     
     if (H->dsd_r != NULL) {
         free(H->dsd_r);
@@ -2136,8 +2478,10 @@ void RS_revise_population(RSHandle *H) {
     
     // Get GPU preferred multiplication factor
     // NOTE: make_pulse_pass_1 uses 2 x max_work_group_size stride
-    size_t max_work_group_size;
-    clGetDeviceInfo(H->workers[0].dev, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(max_work_group_size), &max_work_group_size, NULL);
+    size_t max_work_group_size = RS_CL_GROUP_ITEMS;
+    if (H->method != RS_METHOD_NATIVE) {
+        clGetDeviceInfo(H->workers[0].dev, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(max_work_group_size), &max_work_group_size, NULL);
+    }
     const size_t mul = H->num_cus[0] * H->num_workers * max_work_group_size * 2;
     
     if (H->sim_concept & RSSimulationConceptVerticallyPointingRadar) {
@@ -2258,7 +2602,7 @@ RSVolume RS_get_domain(RSHandle *H) {
 
 void RS_update_origins_offsets(RSHandle *H) {
     
-    int i, k;
+    int i, j, k;
     
     size_t count = H->num_scats;
     
@@ -2267,11 +2611,15 @@ void RS_update_origins_offsets(RSHandle *H) {
         exit(EXIT_FAILURE);
     }
     
-    // Divide the scatter bodies into (num_workers) chunks
-    const size_t sub_num_scats = H->num_scats / MAX(1, H->num_workers);
+    // Divide the scatter bodies into (num_workers) chunks, in proportion to the weights if the workers have been balanced
+    const char weighted = H->num_workers > 1 && H->worker_weights[0] > 0.0f;
+    size_t sub_num_scats = H->num_scats / MAX(1, H->num_workers);
     
     size_t offset = 0;
     for (i = 0; i < H->num_workers; i++) {
+        if (weighted) {
+            sub_num_scats = i == H->num_workers - 1 ? H->num_scats - offset : (size_t)(H->worker_weights[i] * (float)H->num_scats);
+        }
         H->offset[i] = offset;
         H->workers[i].num_scats = sub_num_scats;
         if (H->verb > 2) {
@@ -2320,6 +2668,29 @@ void RS_update_origins_offsets(RSHandle *H) {
             }
             continue;
         }
+        if (weighted) {
+            if (k == 0) {
+                // Background takes whatever is left after the debris of each worker
+                for (i = 0; i < H->num_workers; i++) {
+                    size_t debris_count = 0;
+                    for (j = 1; j < RS_MAX_DEBRIS_TYPES; j++) {
+                        debris_count += H->workers[i].counts[j];
+                    }
+                    if (debris_count > H->workers[i].num_scats) {
+                        rsprint("ERROR: workers[%d] cannot hold %s debris.", i, commaint(debris_count));
+                        exit(EXIT_FAILURE);
+                    }
+                    H->workers[i].counts[0] = H->workers[i].num_scats - debris_count;
+                }
+                continue;
+            }
+            for (i = 0; i < H->num_workers - 1; i++) {
+                H->workers[i].counts[k] = (size_t)(H->worker_weights[i] * (float)H->counts[k]);
+                debris_count_left -= H->workers[i].counts[k];
+            }
+            H->workers[i].counts[k] = debris_count_left;
+            continue;
+        }
         // Groups of debris types
         size_t round_up_down_toggle = H->num_workers > 1 ? k % H->num_workers : k;
         size_t sub_counts = (H->counts[k] + round_up_down_toggle) / H->num_workers;
@@ -2506,7 +2877,7 @@ void RS_set_rcs_ellipsoid_table(RSHandle *H, const cl_float4 *weights, const flo
 #else
     
     cl_int ret;
-    for (i = 0; i < H->num_workers; i++) {
+    for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
         if (H->workers[i].rcs_ellipsoid != NULL) {
             if (H->verb > 1) {
                 rsprint("workers[%d] setting RCS of ellipsoid.\n", i);
@@ -2528,6 +2899,10 @@ void RS_set_rcs_ellipsoid_table(RSHandle *H, const cl_float4 *weights, const flo
     
 #endif
     
+    if (H->native) {
+        RS_native_set_rcs_ellipsoid(H, (cl_float4 *)table.data, table_size);
+    }
+    
     for (i = 0; i < H->num_workers; i++) {
         // Copy over to CL workers. A bit wasteful but the codes are easier to ready this way.
         H->workers[i].rcs_ellipsoid_desc.s[RSTable1DDescriptionScale] = table.dx;
@@ -2582,7 +2957,7 @@ void RS_set_range_weight(RSHandle *H, const float *weights, const float table_in
 #else
     
     cl_int ret;
-    for (i = 0; i < H->num_workers; i++) {
+    for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
         if (H->workers[i].range_weight != NULL) {
             if (H->verb > 1) {
                 rsprint("workers[%d] setting range weight.", i);
@@ -2604,6 +2979,10 @@ void RS_set_range_weight(RSHandle *H, const float *weights, const float table_in
     
 #endif
     
+    if (H->native) {
+        RS_native_set_range_weight(H, table.data, table_size);
+    }
+    
     for (i = 0; i < H->num_workers; i++) {
         // Copy over to CL workers. A bit wasteful but the codes are easier to ready this way.
         H->workers[i].range_weight_desc.s[RSTable1DDescriptionScale] = table.dx;
@@ -2664,7 +3043,7 @@ void RS_set_angular_weight(RSHandle *H, const float *weights, const float table_
 #else
     
     cl_int ret;
-    for (i = 0; i < H->num_workers; i++) {
+    for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
         if (H->workers[i].angular_weight != NULL) {
             if (H->verb > 1) {
                 rsprint("workers[%d] setting angular weight.\n", i);
@@ -2686,6 +3065,10 @@ void RS_set_angular_weight(RSHandle *H, const float *weights, const float table_
     
 #endif
     
+    if (H->native) {
+        RS_native_set_angular_weight(H, table.data, table_size);
+    }
+    
     // Copy over to CL workers. A bit wasteful but the codes are easier to ready this way.
     for (i = 0; i < H->num_workers; i++) {
         H->workers[i].angular_weight_desc.s[RSTable1DDescriptionScale] = table.dx;
@@ -2738,7 +3121,8 @@ void RS_set_angular_weight_2d(RSHandle *H,
 
 #endif
 
-    for (i = 0; i < H->num_workers; i++) {
+    // The native engine has no use for the 2D weight, only the descriptions are kept
+    for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
         if (H->workers[i].angular_weight_2d != NULL) {
 
 #if defined (_USE_GCL_)
@@ -2856,27 +3240,68 @@ void RS_set_vel_data(RSHandle *H, const RSTable3D table) {
     int i;
     cl_int ret = -1;
     cl_mem_flags flags = CL_MEM_READ_ONLY;
-    cl_image_format format = {CL_RGBA, CL_FLOAT};
+    const char half = table.uvwt_half != NULL;
+    cl_image_format format = {CL_RGBA, half ? CL_HALF_FLOAT : CL_FLOAT};
+    const size_t texel_size = half ? sizeof(cl_half4) : sizeof(cl_float4);
+    const void *uvwt = half ? (void *)table.uvwt_half : (void *)table.uvwt;
+    const void *cpxx = half ? (void *)table.cpxx_half : (void *)table.cpxx;
 
-   for (i = 0; i < H->num_workers; i++) {
-        if (H->workers[i].les_uvwt[0] == NULL) {
+    // Any table upload replaces an analytic wind model
+    H->vel_model = RSWindModelTable;
+
+    if (H->native) {
+        RS_native_set_vel_data(H, &table);
+    }
+
+    for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
+        if (H->workers[i].segment) {
+            RS_worker_share_vel_data(&H->workers[i], &H->workers[i - H->workers[i].segment]);
+            continue;
+        }
+        // Images of the other precision or another (crop) size cannot be reused
+        if (H->workers[i].les_uvwt[0] != NULL &&
+            (H->workers[i].les_half != half ||
+             H->workers[i].les_region[0] != table.x_ || H->workers[i].les_region[1] != table.y_ || H->workers[i].les_region[2] != table.z_)) {
 
 #if defined (_USE_GCL_)
-            
-            H->workers[i].les_uvwt[0] = gcl_create_image(&format, table.x_, table.y_, table.z_, H->workers[i].surf_uwvt[0]);
-            H->workers[i].les_uvwt[1] = gcl_create_image(&format, table.x_, table.y_, table.z_, H->workers[i].surf_uvwt[1]);
-            H->workers[i].les_cpxx[0] = gcl_create_image(&format, table.x_, table.y_, table.z_, H->workers[i].surf_cpxx[0]);
-            H->workers[i].les_cpxx[1] = gcl_create_image(&format, table.x_, table.y_, table.z_, H->workers[i].surf_cpxx[1]);
 
-#elif defined (CL_VERSION_1_2)
-        
-            cl_image_desc desc;
-            desc.image_type = CL_MEM_OBJECT_IMAGE3D;
-            desc.image_width  = table.x_;
-            desc.image_height = table.y_;
-            desc.image_depth  = table.z_;
-            desc.image_array_size = 0;
-            desc.image_row_pitch = 0;
+            gcl_release_image(H->workers[i].les_uvwt[0]);
+            gcl_release_image(H->workers[i].les_uvwt[1]);
+            gcl_release_image(H->workers[i].les_cpxx[0]);
+            gcl_release_image(H->workers[i].les_cpxx[1]);
+
+#else
+
+            clReleaseMemObject(H->workers[i].les_uvwt[0]);
+            clReleaseMemObject(H->workers[i].les_uvwt[1]);
+            clReleaseMemObject(H->workers[i].les_cpxx[0]);
+            clReleaseMemObject(H->workers[i].les_cpxx[1]);
+
+#endif
+
+            H->workers[i].les_uvwt[0] = NULL;
+            H->workers[i].les_uvwt[1] = NULL;
+            H->workers[i].les_cpxx[0] = NULL;
+            H->workers[i].les_cpxx[1] = NULL;
+        }
+        if (H->workers[i].les_uvwt[0] == NULL) {
+
+#if defined (_USE_GCL_)
+            
+            H->workers[i].les_uvwt[0] = gcl_create_image(&format, table.x_, table.y_, table.z_, H->workers[i].surf_uwvt[0]);
+            H->workers[i].les_uvwt[1] = gcl_create_image(&format, table.x_, table.y_, table.z_, H->workers[i].surf_uvwt[1]);
+            H->workers[i].les_cpxx[0] = gcl_create_image(&format, table.x_, table.y_, table.z_, H->workers[i].surf_cpxx[0]);
+            H->workers[i].les_cpxx[1] = gcl_create_image(&format, table.x_, table.y_, table.z_, H->workers[i].surf_cpxx[1]);
+
+#elif defined (CL_VERSION_1_2)
+        
+            cl_image_desc desc;
+            desc.image_type = CL_MEM_OBJECT_IMAGE3D;
+            desc.image_width  = table.x_;
+            desc.image_height = table.y_;
+            desc.image_depth  = table.z_;
+            desc.image_array_size = 0;
+            desc.image_row_pitch = 0;
             desc.image_slice_pitch = 0;
             desc.num_mip_levels = 0;
             desc.num_samples = 0;
@@ -2900,10 +3325,14 @@ void RS_set_vel_data(RSHandle *H, const RSTable3D table) {
                 rsprint("ERROR: workers[%d] unable to create wind table on CL device.  ret = %d   table of %d x %d x %d @ %p (%d)\n", i, ret, table.x_, table.y_, table.z_, table.uvwt, flags);
                 exit(EXIT_FAILURE);
             } else if (H->verb > 2) {
-                rsprint("workers[%d] created wind table @ %p %p %p %p\n", i,
+                rsprint("workers[%d] created %s wind table @ %p %p %p %p\n", i, half ? "half-precision" : "single-precision",
                         &H->workers[i].les_uvwt[0], &H->workers[i].les_uvwt[1],
                         &H->workers[i].les_cpxx[0], &H->workers[i].les_cpxx[1]);
             }
+            H->workers[i].les_half = half;
+            H->workers[i].les_region[0] = table.x_;
+            H->workers[i].les_region[1] = table.y_;
+            H->workers[i].les_region[2] = table.z_;
         } // if (H->workers[i].vel[0] == NULL) ...
 
 #if defined (_USE_GCL_)
@@ -2911,8 +3340,10 @@ void RS_set_vel_data(RSHandle *H, const RSTable3D table) {
         dispatch_async(H->workers[i].que, ^{
             size_t origin[3] = {0, 0, 0};
             size_t region[3] = {table.x_, table.y_, table.z_};
-            gcl_copy_ptr_to_image(H->workers[i].les_uvwt[H->workers[i].les_id], table.data, origin, region);
-            gcl_copy_ptr_to_image(H->workers[i].les_cpxx[H->workers[i].les_id], table.data, origin, region);
+            gcl_copy_ptr_to_image(H->workers[i].les_uvwt[H->workers[i].les_id], (void *)uvwt, origin, region);
+            if (H->sim_concept & RSSimulationConceptFixedScattererPosition) {
+                gcl_copy_ptr_to_image(H->workers[i].les_cpxx[H->workers[i].les_id], (void *)cpxx, origin, region);
+            }
             dispatch_semaphore_signal(H->workers[i].sem_upload);
         });
 
@@ -2921,9 +3352,12 @@ void RS_set_vel_data(RSHandle *H, const RSTable3D table) {
         size_t origin[3] = {0, 0, 0};
         size_t region[3] = {table.x_, table.y_, table.z_};
         clEnqueueWriteImage(H->workers[i].que, H->workers[i].les_uvwt[H->workers[i].les_id], CL_FALSE, origin, region,
-                            table.x_ * sizeof(cl_float4), table.y_ * table.x_ * sizeof(cl_float4), table.uvwt, 0, NULL, &H->workers[i].event_upload);
-        clEnqueueWriteImage(H->workers[i].que, H->workers[i].les_cpxx[H->workers[i].les_id], CL_FALSE, origin, region,
-                            table.x_ * sizeof(cl_float4), table.y_ * table.x_ * sizeof(cl_float4), table.cpxx, 0, NULL, &H->workers[i].event_upload);
+                            table.x_ * texel_size, table.y_ * table.x_ * texel_size, uvwt, 0, NULL, &H->workers[i].event_upload);
+        // The (cn2, p) table is only sampled by fp_atts, no need to move it across otherwise
+        if (H->sim_concept & RSSimulationConceptFixedScattererPosition) {
+            clEnqueueWriteImage(H->workers[i].que, H->workers[i].les_cpxx[H->workers[i].les_id], CL_FALSE, origin, region,
+                                table.x_ * texel_size, table.y_ * table.x_ * texel_size, cpxx, 0, NULL, &H->workers[i].event_upload);
+        }
 
 #endif
         
@@ -2937,7 +3371,9 @@ void RS_set_vel_data(RSHandle *H, const RSTable3D table) {
 
 #else
 
-        clWaitForEvents(1, &H->workers[i].event_upload);
+        if (H->method != RS_METHOD_NATIVE && H->workers[i].segment == 0) {
+            clWaitForEvents(1, &H->workers[i].event_upload);
+        }
 
 #endif
 
@@ -2977,6 +3413,27 @@ void RS_set_vel_data(RSHandle *H, const RSTable3D table) {
 }
 
 
+void RS_set_vel_data_half_precision(RSHandle *H, const char half) {
+    if (half && H->method == RS_METHOD_NATIVE) {
+        rsprint("WARNING: Half-precision wind tables are not supported by the native engine.");
+        return;
+    }
+    H->vel_half = half;
+    if (H->L != NULL) {
+        LES_set_half_precision(H->L, half);
+    }
+    for (int k = 0; k < H->vel_nest_count; k++) {
+        if (H->vel_nest_les[k] != NULL) {
+            LES_set_half_precision(H->vel_nest_les[k], half);
+        }
+    }
+    // Refined grids already on the devices are restacked in the new precision
+    if (RS_CL_WORKER_COUNT(H) && H->workers[0].les_nest_uvwt[0] != NULL) {
+        RS_update_vel_data_nests(H);
+    }
+}
+
+
 void RS_set_vel_data_to_config(RSHandle *H, LESConfig c) {
     int i;
     if (H->L != NULL) {
@@ -2986,6 +3443,7 @@ void RS_set_vel_data_to_config(RSHandle *H, LESConfig c) {
         rsprint("Using LES configuration '" UNDERLINE("%s") "' ...", (char *)c);
     }
     H->L = LES_init_with_config_path(c, NULL);
+    H->vel_model = RSWindModelTable;
 
 #if defined(GUI)
 
@@ -2993,6 +3451,13 @@ void RS_set_vel_data_to_config(RSHandle *H, LESConfig c) {
     
 #endif
 
+    LES_set_half_precision(H->L, H->vel_half);
+
+    // Concept is final once populated, see RS_populate()
+    if (H->status & RSStatusDomainPopulated) {
+        LES_set_velocity_only(H->L, !(H->sim_concept & RSSimulationConceptFixedScattererPosition));
+    }
+
     // Release the pre-existing memory. Alaways assume the new LESConfig is not the same size.
     for (i = 0; i < H->num_workers; i++) {
         if (H->workers[i].les_uvwt[i] != NULL) {
@@ -3055,12 +3520,14 @@ void RS_set_vel_data_to_LES_table(RSHandle *H, const LESTable *leslie) {
         //
         //     k = 47.6681 * log1p ( 0.0160000000 * z [ k ] )
         //
+        //  A cropped table is offset by (ox, oy, oz) cells from the full grid, which is where the center is referenced
+        //
         table.spacing = RSTableSpacingStretchedX | RSTableSpacingStretchedY | RSTableSpacingStretchedZ;
-        table.x_ = leslie->nx;    table.xm = 0.5f * (float)(leslie->nx - 1);    table.xs = 1.0f / log(leslie->rx);    table.xo = (leslie->rx - 1.0f) / leslie->ax;
-        table.y_ = leslie->ny;    table.ym = 0.5f * (float)(leslie->ny - 1);    table.ys = 1.0f / log(leslie->ry);    table.yo = (leslie->ry - 1.0f) / leslie->ay;
-        table.z_ = leslie->nz;    table.zm = 0.0f;                              table.zs = 1.0f / log(leslie->rz);    table.zo = (leslie->rz - 1.0f) / leslie->az;
-        hmax = leslie->ax * (1.0f - powf(leslie->rx, table.xm)) / (1.0f - leslie->rx);
-        zmax = leslie->az * (1.0f - powf(leslie->rz, (float)(leslie->nz - 1))) / (1.0f - leslie->rz);
+        table.x_ = leslie->nx;    table.xm = 0.5f * (float)(leslie->gx - 1) - (float)leslie->ox;    table.xs = 1.0f / log(leslie->rx);    table.xo = (leslie->rx - 1.0f) / leslie->ax;
+        table.y_ = leslie->ny;    table.ym = 0.5f * (float)(leslie->gy - 1) - (float)leslie->oy;    table.ys = 1.0f / log(leslie->ry);    table.yo = (leslie->ry - 1.0f) / leslie->ay;
+        table.z_ = leslie->nz;    table.zm = -(float)leslie->oz;                                    table.zs = 1.0f / log(leslie->rz);    table.zo = (leslie->rz - 1.0f) / leslie->az;
+        hmax = leslie->ax * (1.0f - powf(leslie->rx, 0.5f * (float)(leslie->gx - 1))) / (1.0f - leslie->rx);
+        zmax = leslie->az * (1.0f - powf(leslie->rz, (float)(leslie->gz - 1))) / (1.0f - leslie->rz);
         if (H->verb > 0 && H->vel_idx == 0) {
             rsprint("LES stretched x-grid using %.6f * log1p( %.6f * x )    Mid = %.2f m\n",
                     table.xs, table.xo, hmax);
@@ -3069,20 +3536,20 @@ void RS_set_vel_data_to_LES_table(RSHandle *H, const LESTable *leslie) {
             rsprint("GPU LES[%2d/%2d] (%d, %s MB)\n",
                     H->vel_idx, H->vel_count,
                     H->workers[0].les_id,
-                    commaint(leslie->nn * sizeof(cl_float4) / 1024 / 1024));
+                    commaint(leslie->nn * (H->vel_half ? sizeof(cl_half4) : sizeof(cl_float4)) / 1024 / 1024));
         }
     } else {
-        table.x_ = leslie->nx;    table.xm = (float)leslie->nx - 1.0f;    table.xs = 1.0f / leslie->rx;    table.xo = (float)(leslie->nx - 1) * 0.5f;
-        table.y_ = leslie->ny;    table.ym = (float)leslie->ny - 1.0f;    table.ys = 1.0f / leslie->ry;    table.yo = (float)(leslie->ny - 1) * 0.5f;
-        table.z_ = leslie->nz;    table.zm = (float)leslie->nz - 1.0f;    table.zs = 1.0f / leslie->rz;    table.zo = 0.0f;
-        hmax = 0.5f * ((float)leslie->nx - 1.0) * leslie->rx;
-        zmax = ((float)leslie->nz - 1.0) * leslie->rz;
+        table.x_ = leslie->nx;    table.xm = (float)leslie->nx - 1.0f;    table.xs = 1.0f / leslie->rx;    table.xo = (float)(leslie->gx - 1) * 0.5f - (float)leslie->ox;
+        table.y_ = leslie->ny;    table.ym = (float)leslie->ny - 1.0f;    table.ys = 1.0f / leslie->ry;    table.yo = (float)(leslie->gy - 1) * 0.5f - (float)leslie->oy;
+        table.z_ = leslie->nz;    table.zm = (float)leslie->nz - 1.0f;    table.zs = 1.0f / leslie->rz;    table.zo = -(float)leslie->oz;
+        hmax = 0.5f * ((float)leslie->gx - 1.0) * leslie->rx;
+        zmax = ((float)leslie->gz - 1.0) * leslie->rz;
         if (H->verb > 0 && H->vel_idx == 0) {
             rsprint("LES uniform grid spacing using %.2f, %.2f, %.2f m\n", leslie->rx, leslie->ry, leslie->rz);
             rsprint("GPU LES[%2d/%2d] (%d, %s MB)\n",
                     H->vel_idx, H->vel_count,
                     H->workers[0].les_id,
-                    commaint(leslie->nn * sizeof(cl_float4) / 1024 / 1024));
+                    commaint(leslie->nn * (H->vel_half ? sizeof(cl_half4) : sizeof(cl_float4)) / 1024 / 1024));
         }
     }
     if (H->verb > 0 && H->vel_idx == 0) {
@@ -3102,6 +3569,10 @@ void RS_set_vel_data_to_LES_table(RSHandle *H, const LESTable *leslie) {
     void *cpxx_orig = table.cpxx;
     table.uvwt = (cl_float4 *)leslie->uvwt;
     table.cpxx = (cl_float4 *)leslie->cpxx;
+    if (H->vel_half && leslie->has_half) {
+        table.uvwt_half = (cl_half4 *)leslie->uvwt_half;
+        table.cpxx_half = (cl_half4 *)leslie->cpxx_half;
+    }
 
     if (H->sim_concept & RSSimulationConceptDebrisFluxFromVelocity) {
         //RS_set_debris_flux_field_to_center_cell_of_3x3(H);
@@ -3234,635 +3705,1136 @@ void RS_set_vel_data_to_cube125(RSHandle *H) {
 }
 
 
-void RS_clear_vel_data(RSHandle *H) {
-    // Technically the video RAM hasn't been freed but we will assume there is enough room and this memory gets freed when a new table comes in
-    for (int i = 0; i < H->num_workers; i++) {
-        cl_uint nx = (cl_uint)H->workers[i].les_desc.s[RSTable3DDescriptionMaximumX] + 1;
-        cl_uint ny = (cl_uint)H->workers[i].les_desc.s[RSTable3DDescriptionMaximumY] + 1;
-        cl_uint nz = (cl_uint)H->workers[i].les_desc.s[RSTable3DDescriptionMaximumZ] + 1;
-        H->workers[i].mem_usage -= nx * ny * nz * sizeof(cl_float4);
-    }
-}
-
-void RS_set_debris_flux_field_by_pdf(RSHandle *H, RSTable2D *map, const float *pdf) {
-    int k;
-    
-    // Some constants
-    const int n = 2048;
-    const int pdf_count = map->x_;
-    const int cdf_count = pdf_count + 1;
+void RS_set_vel_data_to_analytic_model(RSHandle *H, const RSWindModel model, const cl_float16 desc) {
     
-    double *cdf = (double *)malloc(cdf_count * sizeof(double));
+    int i;
 
-    int b, e;
-    float vl, vh, a, x;
-    
-    // The corresponding CDF
-    float cumsum = 0.0f;
-    for (k = 0; k < pdf_count; k++) {
-        cdf[k] = cumsum;
-        cumsum += pdf[k];
-        if (cumsum > 1.0f) {
-            if (k < pdf_count - 2) {
-                rsprint("Error. Bad PDF was supplied, cumsum = %.8f > 1.0 @ k = %d / %d\n", cumsum, k, pdf_count);
-                free(cdf);
-                return;
-            } else if (k < pdf_count - 1) {
-                rsprint("Warning. PDF value[%d/%d] = %.8f clamped to 1.0\n", k, pdf_count, cumsum);
-                cumsum = 1.0f;
-            }
-        }
+    // Analytic models do not need the LES reader, nor the large table images
+    if (H->L != NULL) {
+        LES_free(H->L);
+        H->L = NULL;
     }
-    cdf[k] = 1.0f;
-    
-    float *tab = (float *)malloc(n * sizeof(float));
+    for (i = 0; i < H->num_workers; i++) {
+        if (H->workers[i].les_uvwt[0] != NULL) {
 
-    // Derive the CDF inverse lookup table
-    for (k = 0; k < n; k++) {
-        x = (float)k / (n - 1);
-        b = 0;
-        while (cdf[b] <= x && b < cdf_count) {
-            b++;
-        }
-        b = MAX(b - 1, 0);
-        e = MIN(b + 1, pdf_count);
-        if (cdf[b] == cdf[e]) {
-            #if defined(DEBUG_CDF)
-            printf("roll back   (b, e) = (%d, %d)   x = %.2f   cdf[b] = %.2f -> %s\n", b, e, x, cdf[b], cdf[b] >= x ? "Y" : "N");
-            #endif
-            while (cdf[b] >= x && b > 0) {
-                b--;
-            }
-            e = MIN(b + 1, pdf_count);
-            #if defined(DEBUG_CDF)
-            printf("      -->   (b, e) = (%d, %d)\n", b, e);
-            #endif
-        }
-        // Gather the two points for linear interpolation
-        vl = (float)b;
-        vh = (float)e;
-        if (b == e) {
-            tab[k] = vl;
-        } else {
-            a = (x - cdf[b]) / (cdf[e] - cdf[b]);
-            if (cdf[b] <= x && x <= cdf[e]) {
-                tab[k] =  vl + a * (vh - vl);
-            } else {
-                rsprint("ERROR. Unable to continue. I need upgrades. Tell my father.  (b, e) = (%d, %d)  x = %.2f\n", b, e, x);
-                return;
-            }
+#if defined (_USE_GCL_)
+
+            gcl_release_image(H->workers[i].les_uvwt[0]);
+            gcl_release_image(H->workers[i].les_uvwt[1]);
+            gcl_release_image(H->workers[i].les_cpxx[0]);
+            gcl_release_image(H->workers[i].les_cpxx[1]);
+
+#else
+
+            clReleaseMemObject(H->workers[i].les_uvwt[0]);
+            clReleaseMemObject(H->workers[i].les_uvwt[1]);
+            clReleaseMemObject(H->workers[i].les_cpxx[0]);
+            clReleaseMemObject(H->workers[i].les_cpxx[1]);
+
+#endif
+
+            H->workers[i].les_uvwt[0] = NULL;
+            H->workers[i].les_uvwt[1] = NULL;
+            H->workers[i].les_cpxx[0] = NULL;
+            H->workers[i].les_cpxx[1] = NULL;
         }
-        //printf("k = %3d   (b, e) = (%d, %d)   x = [%.2f, (%.2f), %.2f]   v = [%.2f, (%.2f), %.2f]\n", k, b, e, cdf[b], x, cdf[e], vl, tab[k], vh);
     }
+
+    // The kernels still need valid image arguments, a single zero texel is enough (only fp_atts reads cn2 off it)
+    RSTable3D table = RS_table3d_init(1);
+    table.x_ = 1;
+    table.y_ = 1;
+    table.z_ = 1;
+    table.tr = desc.s[RSWindModelDescriptionRefreshTime];
+    memset(table.uvwt, 0, sizeof(cl_float4));
+    memset(table.cpxx, 0, sizeof(cl_float4));
+    RS_set_vel_data(H, table);
+    RS_table3d_free(table);
+
+    H->vel_model = model;
+    H->vel_model_desc = desc;
     
-    // Replace the count of table elements to CDF element count
-    map->x_ = n;
+    const RSTableSpacing spacing = RSTableSpacingAnalytic;
+    float tmpf; memcpy(&tmpf, &spacing, sizeof(float));
+    H->vel_model_desc.s[RSWindModelDescriptionFormat] = tmpf;
+    H->vel_model_desc.s[RSWindModelDescriptionModel] = (float)model;
+    H->vel_model_desc.s[RSWindModelDescriptionNestCount] = (float)H->vel_nest_count;
+    for (i = 0; i < H->num_workers; i++) {
+        H->workers[i].les_desc = H->vel_model_desc;
+    }
+
+    // A uniform grid shadow copy so that the scan domain can be suggested the same way as an LES domain, no frame period
+    memset(&H->vel_desc, 0, sizeof(LESTable));
+    H->vel_desc.rx = RS_ANALYTIC_WIND_SPACING;
+    H->vel_desc.ry = RS_ANALYTIC_WIND_SPACING;
+    H->vel_desc.rz = RS_ANALYTIC_WIND_SPACING;
+    H->vel_desc.nx = (uint32_t)(RS_ANALYTIC_WIND_WIDTH / RS_ANALYTIC_WIND_SPACING);
+    H->vel_desc.ny = (uint32_t)(RS_ANALYTIC_WIND_WIDTH / RS_ANALYTIC_WIND_SPACING);
+    H->vel_desc.nz = (uint32_t)(RS_ANALYTIC_WIND_HEIGHT / RS_ANALYTIC_WIND_SPACING);
+    H->vel_desc.gx = H->vel_desc.nx;
+    H->vel_desc.gy = H->vel_desc.ny;
+    H->vel_desc.gz = H->vel_desc.nz;
+    H->vel_desc.nn = H->vel_desc.nx * H->vel_desc.ny * H->vel_desc.nz;
+    H->vel_desc.tr = table.tr;
+    H->vel_idx = 0;
+    H->vel_count = 1;
+}
 
-    RS_set_debris_flux_field_by_icdf(H, map, tab);
 
-    free(cdf);
-    free(tab);
+void RS_set_vel_data_to_analytic_uniform(RSHandle *H, cl_float4 velocity) {
+
+    cl_float16 desc;
+    memset(&desc, 0, sizeof(cl_float16));
+    desc.s[RSWindModelDescriptionVelocityX] = velocity.x;
+    desc.s[RSWindModelDescriptionVelocityY] = velocity.y;
+    desc.s[RSWindModelDescriptionVelocityZ] = velocity.z;
+    desc.s[RSWindModelDescriptionRefreshTime] = 1000.0f;
+
+    if (H->verb) {
+        rsprint("Analytic uniform wind ( %.2f, %.2f, %.2f ) m/s", velocity.x, velocity.y, velocity.z);
+    }
+    
+    RS_set_vel_data_to_analytic_model(H, RSWindModelUniform, desc);
 }
 
 
-void RS_set_debris_flux_field_by_icdf(RSHandle *H, RSTable2D *map, const float *icdf) {
+void RS_set_vel_data_to_analytic_shear(RSHandle *H, cl_float4 velocity, cl_float4 shear) {
     
-    int i;
-    cl_int ret;
+    cl_float16 desc;
+    memset(&desc, 0, sizeof(cl_float16));
+    desc.s[RSWindModelDescriptionVelocityX] = velocity.x;
+    desc.s[RSWindModelDescriptionVelocityY] = velocity.y;
+    desc.s[RSWindModelDescriptionVelocityZ] = velocity.z;
+    desc.s[RSWindModelDescriptionRefreshTime] = 1000.0f;
+    desc.s[RSWindModelDescriptionShearX] = shear.x;
+    desc.s[RSWindModelDescriptionShearY] = shear.y;
+    desc.s[RSWindModelDescriptionShearZ] = shear.z;
 
-    const int count = (int)(map->x_);
+    if (H->verb) {
+        rsprint("Analytic shear wind ( %.2f, %.2f, %.2f ) m/s + z * ( %.4f, %.4f, %.4f ) 1/s",
+                velocity.x, velocity.y, velocity.z, shear.x, shear.y, shear.z);
+    }
 
-    RSTable table = RS_table_init(count);
-    if (table.data == NULL) {
-        rsprint("RS_set_debris_flux_field(): Unable to allocate memory.\n");
+    RS_set_vel_data_to_analytic_model(H, RSWindModelUniform | RSWindModelLinearShear, desc);
+}
+
+
+void RS_set_vel_data_to_rankine_vortex(RSHandle *H, cl_float4 center, float max_speed, float core_radius, cl_float4 translation) {
+    
+    if (core_radius <= 0.0f) {
+        rsprint("ERROR: Rankine vortex core radius must be positive.");
         return;
     }
-    memcpy(table.data, icdf, count * sizeof(float));
     
-    for (i = 0; i < H->num_workers; i++) {
-        if (H->workers[i].dff_icdf[0] == NULL) {
+    cl_float16 desc;
+    memset(&desc, 0, sizeof(cl_float16));
+    desc.s[RSWindModelDescriptionVelocityX] = translation.x;
+    desc.s[RSWindModelDescriptionVelocityY] = translation.y;
+    desc.s[RSWindModelDescriptionVelocityZ] = translation.z;
+    desc.s[RSWindModelDescriptionRefreshTime] = 1000.0f;
+    desc.s[RSWindModelDescriptionCenterX] = center.x;
+    desc.s[RSWindModelDescriptionCenterY] = center.y;
+    desc.s[RSWindModelDescriptionMaximumSpeed] = max_speed;
+    desc.s[RSWindModelDescriptionCoreRadius] = core_radius;
 
-#if defined (_USE_GCL_)
+    if (H->verb) {
+        rsprint("Analytic Rankine vortex @ domain center + ( %.2f, %.2f ) m   Vmax = %.2f m/s   Rmax = %.2f m",
+                center.x, center.y, max_speed, core_radius);
+    }
 
-            rsprint("Error. This portion still needs to be implemented (A). i = %d\n", i);
+    RS_set_vel_data_to_analytic_model(H, RSWindModelUniform | RSWindModelRankineVortex, desc);
+}
 
-#else
 
-            H->workers[i].dff_icdf[0] = clCreateBuffer(H->workers[i].context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, count * sizeof(float), table.data, &ret);
-            H->workers[i].dff_icdf[1] = clCreateBuffer(H->workers[i].context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, count * sizeof(float), table.data, NULL);
-            H->workers[i].mem_usage += count * sizeof(cl_float);
+void RS_clear_vel_data(RSHandle *H) {
+    // Technically the video RAM hasn't been freed but we will assume there is enough room and this memory gets freed when a new table comes in
+    if (H->vel_model != RSWindModelTable) {
+        return;
+    }
+    for (int i = 0; i < H->num_workers; i++) {
+        cl_uint nx = (cl_uint)H->workers[i].les_desc.s[RSTable3DDescriptionMaximumX] + 1;
+        cl_uint ny = (cl_uint)H->workers[i].les_desc.s[RSTable3DDescriptionMaximumY] + 1;
+        cl_uint nz = (cl_uint)H->workers[i].les_desc.s[RSTable3DDescriptionMaximumZ] + 1;
+        H->workers[i].mem_usage -= nx * ny * nz * sizeof(cl_float4);
+    }
+}
 
-#endif
-            
-            if (H->workers[i].dff_icdf[0] == NULL || H->workers[i].dff_icdf[1] == NULL || ret != CL_SUCCESS) {
-                rsprint("ERROR: workers[%d] unable to create debris flux field table on CL device.  ret = %d   table of %d @ %p\n", i, ret, count, table.data);
-                exit(EXIT_FAILURE);
-            } else if (H->verb > 2) {
-                rsprint("workers[%d] created debris flux field @ %p %p.", i, H->workers[i].dff_icdf[0], H->workers[i].dff_icdf[1]);
-            }
-            
-        } else {
-            
-#if defined (_USE_GCL_)
-            
-            rsprint("Error. This portion still needs to be implemented (B). i = %d\n", i);
-            
-#else
-            
-            clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].dff_icdf[H->workers[i].les_id], CL_FALSE, 0, count * sizeof(cl_float), table.data, 0, NULL, &H->workers[i].event_upload);
-            clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].dff_icdf[H->workers[i].les_id], CL_FALSE, 0, count * sizeof(cl_float), table.data, 0, NULL, &H->workers[i].event_upload);
 
+// Frame uploads of the refined grids are left in flight until the next one, the LES may recycle the frames after that
+static void RS_wait_vel_data_nest_uploads(RSHandle *H) {
+    
+#if !defined (_USE_GCL_)
+    
+    for (int i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
+        if (H->workers[i].event_nest_upload != NULL) {
+            clWaitForEvents(1, &H->workers[i].event_nest_upload);
+            clReleaseEvent(H->workers[i].event_nest_upload);
+            H->workers[i].event_nest_upload = NULL;
+        }
+    }
+    
 #endif
-            
-        } // if (H->workers[i].iff[0] == NULL) ...
+    
+}
+
+
+// Data of a refined grid, the current frame if it is fed by an LES
+static const cl_float4 *RS_vel_data_nest_uvwt(RSHandle *H, const int k) {
+    LESHandle L = H->vel_nest_les[k];
+    if (L == NULL) {
+        return H->vel_nests[k].uvwt;
     }
+    const LESTable *leslie = LES_get_frame(L, (int)(H->vel_nest_idx % MAX(1, LES_get_table_count(L))));
+    if (leslie == NULL || leslie->nn != H->vel_nests[k].x_ * H->vel_nests[k].y_ * H->vel_nests[k].z_) {
+        return NULL;
+    }
+    return (const cl_float4 *)leslie->uvwt;
+}
 
-    for (i = 0; i < H->num_workers; i++) {
 
+void RS_update_vel_data_nests(RSHandle *H) {
+    
+    int i, k;
+    uint32_t y, z;
+    
+    RS_wait_vel_data_nest_uploads(H);
+    
+    // Stack all refined grids along z in one image, a 1 x 1 x 1 placeholder if there is none
+    size_t w = 1, h = 1, d = 0;
+    for (k = 0; k < H->vel_nest_count; k++) {
+        w = MAX(w, H->vel_nests[k].x_);
+        h = MAX(h, H->vel_nests[k].y_);
+        d += H->vel_nests[k].z_;
+    }
+    d = MAX(d, 1);
+    
+    cl_float4 *stack;
+    if (posix_memalign((void **)&stack, RS_ALIGN_SIZE, w * h * d * sizeof(cl_float4))) {
+        rsprint("ERROR: Unable to allocate memory for refined wind grids.\n");
+        return;
+    }
+    memset(stack, 0, w * h * d * sizeof(cl_float4));
+    
+    cl_float16 desc[RS_MAX_VEL_NESTS];
+    memset(desc, 0, sizeof(desc));
+    
+    size_t o = 0;
+    for (k = 0; k < H->vel_nest_count; k++) {
+        RSTable3D *table = &H->vel_nests[k];
+        const cl_float4 *uvwt = RS_vel_data_nest_uvwt(H, k);
+        for (z = 0; uvwt != NULL && z < table->z_; z++) {
+            for (y = 0; y < table->y_; y++) {
+                memcpy(&stack[((o + z) * h + y) * w], &uvwt[(z * table->y_ + y) * table->x_], table->x_ * sizeof(cl_float4));
+            }
+        }
+        // Same convention as the uniform table but shifted to texel centers, limits are within the slab
+        desc[k].s[RSTable3DNestDescriptionScaleX] = table->xs;
+        desc[k].s[RSTable3DNestDescriptionScaleY] = table->ys;
+        desc[k].s[RSTable3DNestDescriptionScaleZ] = table->zs;
+        desc[k].s[RSTable3DNestDescriptionOriginX] = table->xo + 0.5f;
+        desc[k].s[RSTable3DNestDescriptionOriginY] = table->yo + 0.5f;
+        desc[k].s[RSTable3DNestDescriptionOriginZ] = table->zo + 0.5f;
+        desc[k].s[RSTable3DNestDescriptionSlabOffsetZ] = (float)o;
+        desc[k].s[RSTable3DNestDescriptionLimitX] = (float)table->x_ - 0.5f;
+        desc[k].s[RSTable3DNestDescriptionLimitY] = (float)table->y_ - 0.5f;
+        desc[k].s[RSTable3DNestDescriptionLimitZ] = (float)table->z_ - 0.5f;
+        o += table->z_;
+    }
+    
+    if (H->native) {
+        RS_native_set_vel_nests(H, stack, w, h, d, desc);
+    }
+    
+    // Same precision as the outer table, see RS_set_vel_data_half_precision()
+    const char half = H->vel_half;
+    cl_image_format format = {CL_RGBA, half ? CL_HALF_FLOAT : CL_FLOAT};
+    const size_t texel_size = half ? sizeof(cl_half4) : sizeof(cl_float4);
+    void *texels = stack;
+    if (half && RS_CL_WORKER_COUNT(H)) {
+        if (posix_memalign(&texels, RS_ALIGN_SIZE, w * h * d * sizeof(cl_half4))) {
+            rsprint("ERROR: Unable to allocate memory for half-precision refined wind grids.\n");
+            free(stack);
+            return;
+        }
+        LES_float4_to_half4((LESHalf4 *)texels, (const LESFloat4 *)stack, w * h * d);
+    }
+    
+    for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
+        
+        if (H->workers[i].segment) {
+            RS_worker_share_vel_nests(&H->workers[i], &H->workers[i - H->workers[i].segment]);
+            continue;
+        }
+        
+        // Images of the same size & precision are rewritten, e.g., grids fed with a new frame
+        const char reuse = H->workers[i].les_nest_uvwt[0] != NULL && H->workers[i].les_nest_half == half &&
+            H->workers[i].les_nest_region[0] == w && H->workers[i].les_nest_region[1] == h && H->workers[i].les_nest_region[2] == d;
+        
 #if defined (_USE_GCL_)
         
-        rsprint("Error. This portion still needs to be implemented (C).\n")
+        if (!reuse) {
+            if (H->workers[i].les_nest_uvwt[0] != NULL) {
+                gcl_release_image(H->workers[i].les_nest_uvwt[0]);
+                gcl_release_image(H->workers[i].les_nest_uvwt[1]);
+                gcl_free(H->workers[i].les_nest_desc);
+            }
+            H->workers[i].les_nest_uvwt[0] = gcl_create_image(&format, w, h, d, NULL);
+            H->workers[i].les_nest_uvwt[1] = gcl_create_image(&format, w, h, d, NULL);
+            H->workers[i].les_nest_desc = gcl_malloc(sizeof(desc), NULL, CL_MEM_READ_ONLY);
+        }
+        dispatch_async(H->workers[i].que, ^{
+            size_t origin[3] = {0, 0, 0};
+            size_t region[3] = {w, h, d};
+            gcl_copy_ptr_to_image(H->workers[i].les_nest_uvwt[0], texels, origin, region);
+            gcl_copy_ptr_to_image(H->workers[i].les_nest_uvwt[1], texels, origin, region);
+            gcl_memcpy(H->workers[i].les_nest_desc, desc, sizeof(desc));
+            dispatch_semaphore_signal(H->workers[i].sem_upload);
+        });
+        dispatch_semaphore_wait(H->workers[i].sem_upload, DISPATCH_TIME_FOREVER);
         
 #else
-
-        clWaitForEvents(1, &H->workers[i].event_upload);
         
-#endif
+        cl_int ret;
         
-        H->workers[i].dff_desc.s[RSTableDescriptionScaleX] = map->xs;                                   // s0
-        H->workers[i].dff_desc.s[RSTableDescriptionScaleY] = map->ys;                                   // s1
-        H->workers[i].dff_desc.s[RSTableDescriptionScaleZ] = -1.0f;                                     // s2
-        H->workers[i].dff_desc.s[RSTableDescriptionOriginX] = map->xo;                                  // s4
-        H->workers[i].dff_desc.s[RSTableDescriptionOriginY] = map->yo;                                  // s5
-        H->workers[i].dff_desc.s[RSTableDescriptionOriginZ] = -1.0f;                                    // s6
-        H->workers[i].dff_desc.s[RSTableDescriptionMaximumX] = map->xm;                                 // s8
-        H->workers[i].dff_desc.s[RSTableDescriptionMaximumY] = map->ym;                                 // s9
-        H->workers[i].dff_desc.s[RSTableDescriptionMaximumZ] = -1.0f;                                   // sa
-        H->workers[i].dff_desc.s[RSTableDescriptionReserved4] = 0.0f;                                   // sc
-        H->workers[i].dff_desc.s[RSTableDescriptionReserved5] = map->xm + 1.0f;                         // sd
-        H->workers[i].dff_desc.s[RSTableDescriptionReserved6] = (float)map->y_;                         // se
-        H->workers[i].dff_desc.s[RSTableDescriptionReserved7] = (float)map->x_ - 1.0f;                  // sf
+        if (reuse) {
+            size_t origin[3] = {0, 0, 0};
+            size_t region[3] = {w, h, d};
+            ret = clEnqueueWriteImage(H->workers[i].que, H->workers[i].les_nest_uvwt[0], CL_FALSE, origin, region,
+                                      w * texel_size, h * w * texel_size, texels, 0, NULL, NULL);
+            ret |= clEnqueueWriteImage(H->workers[i].que, H->workers[i].les_nest_uvwt[1], CL_TRUE, origin, region,
+                                       w * texel_size, h * w * texel_size, texels, 0, NULL, NULL);
+            ret |= clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].les_nest_desc, CL_TRUE, 0, sizeof(desc), desc, 0, NULL, NULL);
+            if (ret != CL_SUCCESS) {
+                rsprint("ERROR: workers[%d] unable to update refined wind grids on CL device.  ret = %d\n", i, ret);
+                exit(EXIT_FAILURE);
+            }
+            continue;
+        }
+        
+        cl_mem_flags flags = CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR;
+        
+        if (H->workers[i].les_nest_uvwt[0] != NULL) {
+            clReleaseMemObject(H->workers[i].les_nest_uvwt[0]);
+            clReleaseMemObject(H->workers[i].les_nest_uvwt[1]);
+            clReleaseMemObject(H->workers[i].les_nest_desc);
+        }
+        
+#if defined (CL_VERSION_1_2)
+        
+        cl_image_desc image_desc;
+        image_desc.image_type = CL_MEM_OBJECT_IMAGE3D;
+        image_desc.image_width  = w;
+        image_desc.image_height = h;
+        image_desc.image_depth  = d;
+        image_desc.image_array_size = 0;
+        image_desc.image_row_pitch = 0;
+        image_desc.image_slice_pitch = 0;
+        image_desc.num_mip_levels = 0;
+        image_desc.num_samples = 0;
+        image_desc.buffer = NULL;
+        
+        H->workers[i].les_nest_uvwt[0] = clCreateImage(H->workers[i].context, flags, &format, &image_desc, texels, &ret);
+        if (ret == CL_SUCCESS) {
+            H->workers[i].les_nest_uvwt[1] = clCreateImage(H->workers[i].context, flags, &format, &image_desc, texels, &ret);
+        }
+        
+#else
+        
+        H->workers[i].les_nest_uvwt[0] = clCreateImage3D(H->workers[i].context, flags, &format, w, h, d, 0, 0, texels, &ret);
+        if (ret == CL_SUCCESS) {
+            H->workers[i].les_nest_uvwt[1] = clCreateImage3D(H->workers[i].context, flags, &format, w, h, d, 0, 0, texels, &ret);
+        }
+        
+#endif
+        
+        if (ret != CL_SUCCESS) {
+            rsprint("ERROR: workers[%d] unable to create refined wind grids on CL device.  ret = %d   stack of %zu x %zu x %zu\n", i, ret, w, h, d);
+            exit(EXIT_FAILURE);
+        }
+        H->workers[i].les_nest_desc = clCreateBuffer(H->workers[i].context, flags, sizeof(desc), desc, &ret);
+        if (ret != CL_SUCCESS) {
+            rsprint("ERROR: workers[%d] unable to create refined wind grid descriptions on CL device.  ret = %d\n", i, ret);
+            exit(EXIT_FAILURE);
+        }
+        
+#endif
+        
+        H->workers[i].les_nest_half = half;
+        H->workers[i].les_nest_region[0] = w;
+        H->workers[i].les_nest_region[1] = h;
+        H->workers[i].les_nest_region[2] = d;
     }
-    RS_table_free(table);
-}
-
-
-void RS_set_debris_flux_field_to_center_cell_of_3x3(RSHandle *H) {
-    // CDF: 3 x 3 flux field with a middle cell at 1.0 (cell 4)
-    //
-    //  1.0  |         o o o o
-    //       |         | | | |
-    //  0.0  o-o-o-o-o-+-+-+-+---> cell index
-    //       0 1 2 3 4 5 6 7 8
-    //
-    // iCDF should be:
-    //
-    //        1.0  |                   (This point does not exist in the table
-    //             |                    but it is assumed in this convention)
-    //    5/count  |      ...  o
-    //    4/count  o  ...      |
-    //             |           |
-    //             +-----------+--> v
-    //             0    ...   1.0
-    //
-    //     iCDF = [4 4.1 4.2 ... 5]
-    //
-    float icdf[2] = {4.0f, 5.0f};
-    RSTable2D map = {
-        .x_ = sizeof(icdf) / sizeof(float),
-        .xs = 1.0 / 3.0f,
-        .xo = -1.0f,
-        .xm = 2.0f,
-        .ys = 1.0 / 3.0f,
-        .yo = -1.0f,
-        .ym = 2.0f
-    };
-    RS_set_debris_flux_field_by_icdf(H, &map, icdf);
+    
+    for (i = 0; i < H->num_workers; i++) {
+        H->workers[i].les_desc.s[RSTable3DDescriptionNestCount] = (float)H->vel_nest_count;
+    }
+    
+    if (H->verb > 1 && H->vel_nest_count) {
+        rsprint("Refined wind grids: %d stacked in %zu x %zu x %zu (%s MB, %s precision)\n", H->vel_nest_count, w, h, d,
+                commaint(w * h * d * texel_size / 1024 / 1024), half ? "half" : "single");
+    }
+    
+    if (texels != stack) {
+        free(texels);
+    }
+    free(stack);
 }
 
 
-void RS_set_debris_flux_field_to_checker_board(RSHandle *H, const int c) {
+// Keeps the finest (largest index per meter) first, the kernels take the first one that covers a position
+static void RS_insert_vel_data_nest(RSHandle *H, const RSTable3D table, LESHandle L) {
+    
     int k;
-
-    // Some constants for the derived CDF
-    const int pdf_count = c * c;
-    float *pdf = (float *)malloc(pdf_count * sizeof(float));
     
-    // Psuedo-PDF, not yet normalized
-    memset(pdf, 0, pdf_count * sizeof(float));
-    for (k = 0; k < pdf_count; k += 2) {
-        pdf[k] = 100.0;
+    // Keep a private copy of a static grid, the caller is free to release theirs, the LES keeps the frames of the others
+    RSTable3D copy = table;
+    copy.uvwt = NULL;
+    copy.cpxx = NULL;
+    copy.uvwt_half = NULL;
+    copy.cpxx_half = NULL;
+    if (L == NULL) {
+        size_t nn = table.x_ * table.y_ * table.z_;
+        copy = RS_table3d_init(nn);
+        if (copy.uvwt == NULL) {
+            return;
+        }
+        void *uvwt = copy.uvwt;
+        void *cpxx = copy.cpxx;
+        copy = table;
+        copy.uvwt = uvwt;
+        copy.cpxx = cpxx;
+        copy.uvwt_half = NULL;
+        copy.cpxx_half = NULL;
+        memcpy(copy.uvwt, table.uvwt, nn * sizeof(cl_float4));
     }
     
-    // Actual PDF after a proper normalization
-    float sum = 0.0;
-    for (k = 0; k < pdf_count; k++) {
-        sum += pdf[k];
+    const float cells = table.xs * table.ys * table.zs;
+    for (k = H->vel_nest_count; k > 0 && H->vel_nests[k - 1].xs * H->vel_nests[k - 1].ys * H->vel_nests[k - 1].zs < cells; k--) {
+        H->vel_nests[k] = H->vel_nests[k - 1];
+        H->vel_nest_les[k] = H->vel_nest_les[k - 1];
     }
-    for (k = 0; k < pdf_count; k++) {
-        pdf[k] /= sum;
+    H->vel_nests[k] = copy;
+    H->vel_nest_les[k] = L;
+    H->vel_nest_count++;
+    
+    if (H->verb) {
+        rsprint("Refined wind grid %d / %d   %d x %d x %d @ %.2f x %.2f x %.2f m%s\n", k, H->vel_nest_count,
+                table.x_, table.y_, table.z_, 1.0f / table.xs, 1.0f / table.ys, 1.0f / table.zs, L ? "   (LES frames)" : "");
     }
-
-    // rsprint("=== %.2f %.2f / %.2f %.2f\n", H->sim_desc.hi.s4, H->sim_desc.hi.s5, H->sim_desc.hi.s0, H->sim_desc.hi.s1);
     
-    // Mapping convention
-    RSTable2D map = {
-        .x_ = c * c,                  // Total number of cells
-        .y_ = 2,                      // Table convention: 0 - uniform grid, 1 - stretched_grid, >= 2 - test modes
-        .xs = 1.0f / (float)c,        // Scale of X
-        .ys = 1.0f / (float)c,        // Scale of Y
-        .xo = -1.0f,                  // Offset of X
-        .yo = -1.0f,                  // Offset of Y
-        .xm = (float)(c - 1),         // Maximum cell index of X (for CL kernel)
-        .ym = (float)(c - 1)          // Maximum cell index of Y (for CL kernel)
-    };
+    RS_update_vel_data_nests(H);
+}
 
-    RS_set_debris_flux_field_by_pdf(H, &map, pdf);
+
+// Refined grids fed by an LES take the frame of the same index as the outer table. Only their slabs of the stack are
+// written, into the buffer the kernels switch to with les_id, and the writes are left in flight
+static void RS_update_vel_data_nest_frames(RSHandle *H, const uint32_t index) {
     
-    free(pdf);
+    int i, k;
+    
+    H->vel_nest_idx = index;
+    
+    if (H->vel_nest_count == 0) {
+        return;
+    }
+    
+    RS_wait_vel_data_nest_uploads(H);
+    
+    // The LES converts its frames to half precision on its own thread, see LES_set_half_precision()
+    const char half = RS_CL_WORKER_COUNT(H) && H->workers[0].les_nest_half;
+    const size_t texel_size = half ? sizeof(cl_half4) : sizeof(cl_float4);
+    
+    size_t o = 0;
+    for (k = 0; k < H->vel_nest_count; k++) {
+        RSTable3D *table = &H->vel_nests[k];
+        LESHandle L = H->vel_nest_les[k];
+        if (L == NULL) {
+            o += table->z_;
+            continue;
+        }
+        const LESTable *leslie = LES_get_frame(L, (int)(index % MAX(1, LES_get_table_count(L))));
+        if (leslie == NULL || leslie->nn != table->x_ * table->y_ * table->z_ || (half && leslie->uvwt_half == NULL)) {
+            rsprint("ERROR: Refined wind grid %d has no frame %u of %d x %d x %d.", k, index, table->x_, table->y_, table->z_);
+            o += table->z_;
+            continue;
+        }
+        
+        if (H->native) {
+            RS_native_set_vel_nest_slab(H, (const cl_float4 *)leslie->uvwt, table->x_, table->y_, table->z_, o);
+        }
+        
+        const void *texels = half ? (const void *)leslie->uvwt_half : (const void *)leslie->uvwt;
+        
+        for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
+            if (H->workers[i].segment) {
+                continue;
+            }
+            
+#if defined (_USE_GCL_)
+            
+            dispatch_async(H->workers[i].que, ^{
+                size_t origin[3] = {0, 0, o};
+                size_t region[3] = {table->x_, table->y_, table->z_};
+                gcl_copy_ptr_to_image(H->workers[i].les_nest_uvwt[H->workers[i].les_id], (void *)texels, origin, region);
+                dispatch_semaphore_signal(H->workers[i].sem_upload);
+            });
+            dispatch_semaphore_wait(H->workers[i].sem_upload, DISPATCH_TIME_FOREVER);
+            
+#else
+            
+            size_t origin[3] = {0, 0, o};
+            size_t region[3] = {table->x_, table->y_, table->z_};
+            if (H->workers[i].event_nest_upload != NULL) {
+                clReleaseEvent(H->workers[i].event_nest_upload);
+            }
+            cl_int ret = clEnqueueWriteImage(H->workers[i].que, H->workers[i].les_nest_uvwt[H->workers[i].les_id], CL_FALSE, origin, region,
+                                             table->x_ * texel_size, table->y_ * table->x_ * texel_size, texels, 0, NULL, &H->workers[i].event_nest_upload);
+            if (ret != CL_SUCCESS) {
+                rsprint("ERROR: workers[%d] unable to update refined wind grid %d on CL device.  ret = %d\n", i, k, ret);
+                exit(EXIT_FAILURE);
+            }
+            
+#endif
+            
+        }
+        o += table->z_;
+    }
 }
 
 
-void RS_set_debris_flux_field_to_checker_board_stretched(RSHandle *H, const LESTable *leslie) {
-    int k;
-    int ix, iy;
-    float dx, dy;
-
-    const int c = 9;
+void RS_add_vel_data_nest(RSHandle *H, const RSTable3D table) {
     
-    // Scale the r constant so that the rate increases quicker since we use a small c
-    const float q = 1.46f;
+    if (H->vel_nest_count >= RS_MAX_VEL_NESTS) {
+        rsprint("ERROR: Only %d refined wind grids are supported.\n", RS_MAX_VEL_NESTS);
+        return;
+    }
+    if (table.spacing != RSTableSpacingUniform) {
+        rsprint("ERROR: Refined wind grids must have uniform spacing.\n");
+        return;
+    }
     
-    // Some constants for the derived CDF
-    const int pdf_count = c * c;
-    const float m = 0.5f * (float)(c - 1);
+    RS_insert_vel_data_nest(H, table, NULL);
+}
 
-    // A local storage for the pdf function
-    float *pdf = (float *)malloc(pdf_count * sizeof(float));
+
+// A refined LES of the core, centered at (x, y) of the outer domain, advancing with the frames of the outer table
+void RS_add_vel_data_nest_from_config(RSHandle *H, const LESConfig c, const float x, const float y) {
     
-    // Psuedo-PDF, not yet normalized
-    memset(pdf, 0, pdf_count * sizeof(float));
-    for (k = 0; k < pdf_count; k += 2) {
-        if (leslie->is_stretched) {
-            iy = k / c;
-            ix = k % c;
-            // d(k) = a * r ^ k
-            dx = leslie->ax * powf(q * leslie->rx, fabs((float)ix - m));
-            dy = leslie->ay * powf(q * leslie->ry, fabs((float)iy - m));
-            pdf[k] = dx * dy;
-        } else {
-            pdf[k] = 1.0;
-        }
+    if (H->vel_nest_count >= RS_MAX_VEL_NESTS) {
+        rsprint("ERROR: Only %d refined wind grids are supported.\n", RS_MAX_VEL_NESTS);
+        return;
+    }
+    LESHandle L = LES_init_with_config_path(c, NULL);
+    if (L == NULL) {
+        rsprint("ERROR: Unable to use LES configuration '%s' for a refined wind grid.\n", (char *)c);
+        return;
     }
+    // Only u, v, w are sampled in the grids, in the same precision as the outer table
+    LES_set_velocity_only(L, true);
+    LES_set_half_precision(L, H->vel_half);
     
-    // Actual PDF after normalization
-    float sum = 0.0;
-    for (k = 0; k < pdf_count; k++) {
-        sum += pdf[k];
+    const LESTable *leslie = LES_get_frame(L, (int)(H->vel_nest_idx % MAX(1, LES_get_table_count(L))));
+    if (leslie == NULL || leslie->is_stretched) {
+        rsprint("ERROR: Refined wind grids must have uniform spacing, '%s' does not.\n", (char *)c);
+        LES_free(L);
+        return;
     }
-    for (k = 0; k < pdf_count; k++) {
-        pdf[k] /= sum;
+    
+    RSTable3D table;
+    memset(&table, 0, sizeof(RSTable3D));
+    table.spacing = RSTableSpacingUniform;
+    table.x_ = leslie->nx;    table.xs = 1.0f / leslie->rx;    table.xo = (float)(leslie->gx - 1) * 0.5f - (float)leslie->ox - x / leslie->rx;
+    table.y_ = leslie->ny;    table.ys = 1.0f / leslie->ry;    table.yo = (float)(leslie->gy - 1) * 0.5f - (float)leslie->oy - y / leslie->ry;
+    table.z_ = leslie->nz;    table.zs = 1.0f / leslie->rz;    table.zo = -(float)leslie->oz;
+    table.xm = (float)leslie->nx - 1.0f;
+    table.ym = (float)leslie->ny - 1.0f;
+    table.zm = (float)leslie->nz - 1.0f;
+    table.tr = leslie->tr;
+    table.uvwt = (cl_float4 *)leslie->uvwt;
+    
+    RS_insert_vel_data_nest(H, table, L);
+}
+
+
+void RS_clear_vel_data_nests(RSHandle *H) {
+    RS_wait_vel_data_nest_uploads(H);
+    for (int k = 0; k < H->vel_nest_count; k++) {
+        RS_table3d_free(H->vel_nests[k]);
+        if (H->vel_nest_les[k] != NULL) {
+            LES_free(H->vel_nest_les[k]);
+            H->vel_nest_les[k] = NULL;
+        }
     }
+    H->vel_nest_count = 0;
+    RS_update_vel_data_nests(H);
+}
 
-    RSTable2D map = {
-        .x_ = pdf_count,
-        .y_ = 1
-    };
 
-    if (leslie->is_stretched) {
-        //
-        // z(k) = a * (1.0 - r ^ k) / (1.0 - r)
-        //      = (1.0 - pow(r, k)) * a / (1.0 - r)
-        //      = pow(r, k) * -a / (1.0 - r) + a / (1.0 - r)
-        //      = fma(pow(r, k), -a / (1.0 - r), a / (1.0 - r))
-        //
-        // Note that k is assumed to have value of 0.0 at the middle of the domain
-        //
-        // Need to pass (1) = a / (1.0 - r), (2) r, and (3) count of x
-        //
-        map.xs = leslie->ax / (1.0f - leslie->rx);                 // --> dff_desc.s0
-        map.ys = leslie->ay / (1.0f - leslie->ry);                 // --> dff_desc.s1
-        map.xo = q * leslie->rx;                                   // --> dff_desc.s4
-        map.yo = q * leslie->ry;                                   // --> dff_desc.s5
+void RS_update_vel_data_crop(RSHandle *H) {
+    
+    int k;
+    float lo[3], hi[3];
+    uint32_t o[3], n[3];
+    
+    if (H->L == NULL) {
+        return;
+    }
+
+    // The debris flux field is derived from the whole LES domain
+    if (H->sim_concept & RSSimulationConceptDebrisFluxFromVelocity) {
+        LES_clear_crop(H->L);
+        return;
+    }
+
+    const LESTable *desc = &H->vel_desc;
+    const uint32_t g[3] = {desc->gx, desc->gy, desc->gz};
+    const RSVolume domain = RS_get_domain(H);
+    
+    // Same mappings as wind_table_index() but on the full LES grid
+    if (desc->is_stretched) {
+        const float cx = 0.5f * (float)(g[0] - 1);
+        const float cy = 0.5f * (float)(g[1] - 1);
+        const float dx = log1pf((desc->rx - 1.0f) / desc->ax * 0.5f * domain.size.x) / logf(desc->rx);
+        const float dy = log1pf((desc->ry - 1.0f) / desc->ay * 0.5f * domain.size.y) / logf(desc->ry);
+        lo[0] = cx - dx;    hi[0] = cx + dx;
+        lo[1] = cy - dy;    hi[1] = cy + dy;
+        lo[2] = log1pf((desc->rz - 1.0f) / desc->az * MAX(0.0f, domain.origin.z)) / logf(desc->rz);
+        hi[2] = log1pf((desc->rz - 1.0f) / desc->az * (domain.origin.z + domain.size.z)) / logf(desc->rz);
     } else {
-        map.xs = leslie->rx;
-        map.ys = leslie->ry;
-        map.xo = (float)(leslie->nx - 1) * 0.5f * leslie->rx;
-        map.yo = (float)(leslie->ny - 1) * 0.5f * leslie->ry;
+        lo[0] = domain.origin.x / desc->rx + 0.5f * (float)(g[0] - 1);
+        hi[0] = (domain.origin.x + domain.size.x) / desc->rx + 0.5f * (float)(g[0] - 1);
+        lo[1] = domain.origin.y / desc->ry + 0.5f * (float)(g[1] - 1);
+        hi[1] = (domain.origin.y + domain.size.y) / desc->ry + 0.5f * (float)(g[1] - 1);
+        lo[2] = domain.origin.z / desc->rz;
+        hi[2] = (domain.origin.z + domain.size.z) / desc->rz;
     }
-    map.xm = (float)(c - 1);                                       // --> dff_desc.s8
-    map.ym = (float)(c - 1);                                       // --> dff_desc.s9
     
-    // Temporary use a local pdf instead of leslie-flux
-    RS_set_debris_flux_field_by_pdf(H, &map, pdf);
+    // Pad with a halo for the linear interpolation and particles that wander slightly outside
+    for (k = 0; k < 3; k++) {
+        int b = (int)floorf(lo[k]) - RS_VEL_CROP_HALO;
+        int e = (int)ceilf(hi[k]) + RS_VEL_CROP_HALO;
+        b = MAX(0, MIN(b, (int)g[k] - 1));
+        e = MAX(b, MIN(e, (int)g[k] - 1));
+        o[k] = (uint32_t)b;
+        n[k] = (uint32_t)(e - b + 1);
+    }
     
-    // Be a good citizen, clean up
-    free(pdf);
+    LES_set_crop(H->L, o[0], o[1], o[2], n[0], n[1], n[2]);
+
+    if (H->verb) {
+        rsprint("LES crop X:[ %u ~ %u ]   Y:[ %u ~ %u ]   Z:[ %u ~ %u ] of %u x %u x %u  (%.1f%%)",
+                o[0], o[0] + n[0] - 1, o[1], o[1] + n[1] - 1, o[2], o[2] + n[2] - 1,
+                g[0], g[1], g[2], 100.0f * (float)(n[0] * n[1] * n[2]) / (float)(g[0] * g[1] * g[2]));
+    }
 }
 
 
-void RS_set_debris_flux_field_from_LES(RSHandle *H, const LESTable *leslie) {
+// Inverse of the CDF of pdf, evaluated at count points from 0 to 1. Returns 0 on success.
+int RS_derive_icdf_from_pdf(float *icdf, const int count, const float *pdf, const int pdf_count) {
     int k;
-    int ix, iy;
-    float dx, dy;
     
-    // Some constants for the derived CDF
-    const int pdf_count = leslie->nx * leslie->ny;
-    const float mx = 0.5f * (float)(leslie->nx - 1);
-    const float my = 0.5f * (float)(leslie->ny - 1);
+    // Some constants
+    const int n = count;
+    const int cdf_count = pdf_count + 1;
+    
+    double *cdf = (double *)malloc(cdf_count * sizeof(double));
 
-    // Derive a PDF from velocity
-    float v;
-    float sum = 0.0;
-    int i = pdf_count;
+    int b, e, s;
+    float vl, vh, a, x;
+    
+    // The corresponding CDF
+    float cumsum = 0.0f;
     for (k = 0; k < pdf_count; k++) {
-        v = leslie->data.u[i] * leslie->data.u[i] + leslie->data.v[i] * leslie->data.v[i] + leslie->data.w[i] * leslie->data.w[i];
-        if (leslie->is_stretched) {
-            iy = k / leslie->nx;
-            ix = k % leslie->nx;
-            // d(k) = a * r ^ k
-            dx = leslie->ax * powf(leslie->rx, fabs((float)ix - mx));
-            dy = leslie->ay * powf(leslie->ry, fabs((float)iy - my));
-            v *= dx * dy;
+        cdf[k] = cumsum;
+        cumsum += pdf[k];
+        if (cumsum > 1.0f) {
+            if (k < pdf_count - 2) {
+                rsprint("Error. Bad PDF was supplied, cumsum = %.8f > 1.0 @ k = %d / %d\n", cumsum, k, pdf_count);
+                free(cdf);
+                return -1;
+            } else if (k < pdf_count - 1) {
+                rsprint("Warning. PDF value[%d/%d] = %.8f clamped to 1.0\n", k, pdf_count, cumsum);
+                cumsum = 1.0f;
+            }
         }
-        leslie->flux[k] = v;
-        sum += v;
-        i++;
-    }
-    for (k = 0; k < pdf_count; k++) {
-        leslie->flux[k] /= sum;
     }
+    cdf[k] = 1.0f;
     
-    RSTable2D map = {
-        .x_ = pdf_count,
-        .y_ = leslie->is_stretched
-    };
-    
-    if (leslie->is_stretched) {
-        //
-        // z(k) = a * (1.0 - r ^ k) / (1.0 - r)
-        //      = (1.0 - pow(r, k)) * a / (1.0 - r)
-        //      = pow(r, k) * -a / (1.0 - r) + a / (1.0 - r)
-        //      = fma(pow(r, k), -a / (1.0 - r), a / (1.0 - r))
-        //
-        // Note that k is assumed to have value of 0.0 at the middle of the domain
-        //
-        // Need to pass (1) = a / (1.0 - r), (2) r, and (3) count of x
-        //
-        map.xs = leslie->ax / (1.0f - leslie->rx);                 // --> dff_desc.s0
-        map.ys = leslie->ay / (1.0f - leslie->ry);                 // --> dff_desc.s1
-        map.xo = leslie->rx;                                       // --> dff_desc.s4
-        map.yo = leslie->ry;                                       // --> dff_desc.s5
-    } else {
-        map.xs = leslie->rx;
-        map.ys = leslie->ry;
-        map.xo = (float)(leslie->nx - 1) * 0.5f * leslie->rx;
-        map.yo = (float)(leslie->ny - 1) * 0.5f * leslie->ry;
+    // Derive the CDF inverse lookup table
+    s = 0;
+    for (k = 0; k < n; k++) {
+        x = (float)k / (n - 1);
+        // x only goes up so the search picks up where the previous one stopped
+        while (s < cdf_count && cdf[s] <= x) {
+            s++;
+        }
+        b = MAX(s - 1, 0);
+        e = MIN(b + 1, pdf_count);
+        if (cdf[b] == cdf[e]) {
+            #if defined(DEBUG_CDF)
+            printf("roll back   (b, e) = (%d, %d)   x = %.2f   cdf[b] = %.2f -> %s\n", b, e, x, cdf[b], cdf[b] >= x ? "Y" : "N");
+            #endif
+            while (cdf[b] >= x && b > 0) {
+                b--;
+            }
+            e = MIN(b + 1, pdf_count);
+            #if defined(DEBUG_CDF)
+            printf("      -->   (b, e) = (%d, %d)\n", b, e);
+            #endif
+        }
+        // Gather the two points for linear interpolation
+        vl = (float)b;
+        vh = (float)e;
+        if (b == e) {
+            icdf[k] = vl;
+        } else {
+            a = (x - cdf[b]) / (cdf[e] - cdf[b]);
+            if (cdf[b] <= x && x <= cdf[e]) {
+                icdf[k] =  vl + a * (vh - vl);
+            } else {
+                rsprint("ERROR. Unable to continue. I need upgrades. Tell my father.  (b, e) = (%d, %d)  x = %.2f\n", b, e, x);
+                free(cdf);
+                return -1;
+            }
+        }
+        //printf("k = %3d   (b, e) = (%d, %d)   x = [%.2f, (%.2f), %.2f]   v = [%.2f, (%.2f), %.2f]\n", k, b, e, cdf[b], x, cdf[e], vl, icdf[k], vh);
     }
-    map.xm = (float)(leslie->nx - 1);                              // --> dff_desc.s8
-    map.ym = (float)(leslie->ny - 1);                              // --> dff_desc.s9
     
-    RS_set_debris_flux_field_by_pdf(H, &map, leslie->flux);
+    free(cdf);
+    return 0;
 }
 
-void RS_set_scan_pattern(RSHandle *H, const POSPattern *scan_pattern) {
-    H->P = (POSHandle)scan_pattern;
-    if (H->verb > 2) {
-        POS_summary(H->P);
-    }
-}
 
+void RS_set_debris_flux_field_by_pdf(RSHandle *H, RSTable2D *map, const float *pdf) {
+    const int n = RS_DFF_ICDF_COUNT;
 
-void RS_set_scan_pattern_with_string(RSHandle *H, const char *scan_string) {
-    POSPattern *scan_pattern = POS_init_with_string(scan_string);
-    RS_set_scan_pattern(H, scan_pattern);
+    float *tab = (float *)malloc(n * sizeof(float));
+
+    if (RS_derive_icdf_from_pdf(tab, n, pdf, map->x_) == 0) {
+        // Replace the count of table elements to CDF element count
+        map->x_ = n;
+
+        RS_set_debris_flux_field_by_icdf(H, map, tab);
+    }
+
+    free(tab);
 }
 
 
-void RS_set_adm_data(RSHandle *H, const RSTable2D cd, const RSTable2D cm) {
+void RS_set_debris_flux_field_by_icdf(RSHandle *H, RSTable2D *map, const float *icdf) {
     
     int i;
-    
-    const int t = H->workers[0].adm_count;
-    
-    const size_t n = cd.x_ * cd.y_;
-    if (cm.x_ * cm.y_ != n) {
-        rsprint("WARNING. RS_set_adm_data() received inconsistent cd (%d x %d) & cm (%d x %d) dimensions", cd.x_, cd.y_, cm.x_, cm.y_);
+    cl_int ret;
+
+    const int count = (int)(map->x_);
+
+    RSTable table = RS_table_init(count);
+    if (table.data == NULL) {
+        rsprint("RS_set_debris_flux_field(): Unable to allocate memory.\n");
         return;
     }
+    memcpy(table.data, icdf, count * sizeof(float));
     
-    if (H->verb > 2) {
-        rsprint("ADM[%d] @ X:[ -M_PI - +M_PI ]  Y:[ 0 - M_PI ]", H->workers[0].adm_count);
+    // The native engine and the slab migration bring the debris back in on the host
+    float *host_icdf = (float *)realloc(H->dff_icdf, count * sizeof(float));
+    if (host_icdf == NULL) {
+        rsprint("RS_set_debris_flux_field(): Unable to allocate memory.\n");
+        RS_table_free(table);
+        return;
     }
+    H->dff_icdf = host_icdf;
+    memcpy(H->dff_icdf, icdf, count * sizeof(float));
     
-    // This is the part that we need to create two texture maps for each RSTable2D table
-    cl_image_format format = {CL_RGBA, CL_FLOAT};
-    
-#if defined (CL_VERSION_1_2)
-    
-    cl_image_desc desc;
-    desc.image_type = CL_MEM_OBJECT_IMAGE2D;
-    desc.image_width  = cd.x_;
-    desc.image_height = cd.y_;
-    desc.image_depth  = 1;
-    desc.image_array_size = 0;
-    desc.image_row_pitch = desc.image_width * sizeof(cl_float4);
-    desc.image_slice_pitch = desc.image_height * desc.image_row_pitch;
-    desc.num_mip_levels = 0;
-    desc.num_samples = 0;
-    desc.buffer = NULL;
-    
+    for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
+        if (H->workers[i].segment) {
+            RS_worker_share_mem(&H->workers[i].dff_icdf[0], H->workers[i - H->workers[i].segment].dff_icdf[0]);
+            RS_worker_share_mem(&H->workers[i].dff_icdf[1], H->workers[i - H->workers[i].segment].dff_icdf[1]);
+            continue;
+        }
+        if (H->workers[i].dff_icdf[0] == NULL) {
+
+#if defined (_USE_GCL_)
+
+            rsprint("Error. This portion still needs to be implemented (A). i = %d\n", i);
+
+#else
+
+            H->workers[i].dff_icdf[0] = clCreateBuffer(H->workers[i].context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, count * sizeof(float), table.data, &ret);
+            H->workers[i].dff_icdf[1] = clCreateBuffer(H->workers[i].context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, count * sizeof(float), table.data, NULL);
+            H->workers[i].mem_usage += count * sizeof(cl_float);
+
 #endif
-    
-    for (i = 0; i < H->num_workers; i++) {
-        if (H->workers[i].adm_cd[t] != NULL && H->workers[i].adm_cm[t] != NULL) {
+            
+            if (H->workers[i].dff_icdf[0] == NULL || H->workers[i].dff_icdf[1] == NULL || ret != CL_SUCCESS) {
+                rsprint("ERROR: workers[%d] unable to create debris flux field table on CL device.  ret = %d   table of %d @ %p\n", i, ret, count, table.data);
+                exit(EXIT_FAILURE);
+            } else if (H->verb > 2) {
+                rsprint("workers[%d] created debris flux field @ %p %p.", i, H->workers[i].dff_icdf[0], H->workers[i].dff_icdf[1]);
+            }
+            
+        } else {
             
 #if defined (_USE_GCL_)
             
-            gcl_release_image(H->workers[i].adm_cd[t]);
-            gcl_release_image(H->workers[i].adm_cm[t]);
+            rsprint("Error. This portion still needs to be implemented (B). i = %d\n", i);
             
 #else
             
-            clReleaseMemObject(H->workers[i].adm_cd[t]);
-            clReleaseMemObject(H->workers[i].adm_cm[t]);
-            
+            clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].dff_icdf[H->workers[i].les_id], CL_FALSE, 0, count * sizeof(cl_float), table.data, 0, NULL, &H->workers[i].event_upload);
+            clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].dff_icdf[H->workers[i].les_id], CL_FALSE, 0, count * sizeof(cl_float), table.data, 0, NULL, &H->workers[i].event_upload);
+
 #endif
             
-            H->workers[i].mem_usage -= ((cl_uint)(H->workers[i].adm_desc[t].s8 + 1.0f) * (H->workers[i].adm_desc[t].s9 + 1.0f)) * 2 * sizeof(cl_float4);
-        }
-        //  adm_cd & adm_cm always have the same desc
-        
-        
+        } // if (H->workers[i].iff[0] == NULL) ...
+    }
+
+    for (i = 0; i < H->num_workers; i++) {
+
 #if defined (_USE_GCL_)
         
-        H->workers[i].adm_cd[t] = gcl_create_image(&format, cd.x_, cd.y_, 1, H->workers[i].surf_adm_cd[t]);
-        H->workers[i].adm_cm[t] = gcl_create_image(&format, cm.x_, cm.y_, 1, H->workers[i].surf_adm_cm[t]);
-        
-#elif defined (CL_VERSION_1_2)
-        
-        cl_int retd, retm;
-        cl_mem_flags flags = CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR;
-        
-        H->workers[i].adm_cd[t] = clCreateImage(H->workers[i].context, flags, &format, &desc, cd.data, &retd);
-        H->workers[i].adm_cm[t] = clCreateImage(H->workers[i].context, flags, &format, &desc, cm.data, &retm);
+        rsprint("Error. This portion still needs to be implemented (C).\n")
         
 #else
-        
-        H->workers[i].adm_cd[t] = clCreateImage2D(H->workers[i].context, flags, &format, cd.x_, cd.y_, cd.x_ * sizeof(cl_float4), cd.data, &retd);
-        H->workers[i].adm_cm[t] = clCreateImage2D(H->workers[i].context, flags, &format, cm.x_, cm.y_, cm.x_ * sizeof(cl_float4), cm.data, &retm);
 
-#endif
-        if (H->workers[i].adm_cd[t] == NULL || H->workers[i].adm_cm[t] == NULL) {
-            rsprint("ERROR: workers[%d] unable to create ADM tables on CL device(s).", i);
-            return;
-        } else if (H->verb > 2) {
-            rsprint("workers[%d] created ADM tables adm_cd[%d] & adm_cd[%d] @ %p & %p", i, t, t, &H->workers[i].adm_cd[t], &H->workers[i].adm_cm[t]);
+        if (H->method != RS_METHOD_NATIVE && H->workers[i].segment == 0) {
+            clWaitForEvents(1, &H->workers[i].event_upload);
         }
         
-#if defined (_USE_GCL_)
-        
-        dispatch_async(H->workers[i].que, ^{
-            size_t origin[3] = {0, 0, 0};
-            size_t region[3] = {cd.x_, cd.y_, 1};
-            gcl_copy_ptr_to_image(H->workers[i].adm_cd[t], cd.data, origin, region);
-            gcl_copy_ptr_to_image(H->workers[i].adm_cm[t], cm.data, origin, region);
-            dispatch_semaphore_signal(H->workers[i].sem);
-        });
-        
-#endif
-        
-    }
-    
-    for (i = 0; i < H->num_workers; i++) {
-        
-#if defined (_USE_GCL_)
-        
-        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
-        
 #endif
         
-        // Copy over to the CL worker
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionScaleX] = cd.xs;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionScaleY] = cd.ys;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionScaleZ] = 0.0f;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionOriginX] = cd.xo;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionOriginY] = cd.yo;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionOriginZ] = 0.0f;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionMaximumX] = cd.xm;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionMaximumY] = cd.ym;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionMaximumZ] = 0.0f;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionRecipInLnX] = H->adm_desc[t].phys.inv_inln_x;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionRecipInLnY] = H->adm_desc[t].phys.inv_inln_y;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionRecipInLnZ] = H->adm_desc[t].phys.inv_inln_z;
-        H->workers[i].adm_desc[t].s[RSTable3DDescriptionTachikawa] = H->adm_desc[t].phys.Ta;
-        H->workers[i].adm_count++;
-        H->workers[i].mem_usage += ((cl_uint)(cd.xm + 1.0f) * (cd.ym + 1.0f)) * 2 * sizeof(cl_float4);
+        H->workers[i].dff_desc.s[RSTableDescriptionScaleX] = map->xs;                                   // s0
+        H->workers[i].dff_desc.s[RSTableDescriptionScaleY] = map->ys;                                   // s1
+        H->workers[i].dff_desc.s[RSTableDescriptionScaleZ] = -1.0f;                                     // s2
+        H->workers[i].dff_desc.s[RSTableDescriptionOriginX] = map->xo;                                  // s4
+        H->workers[i].dff_desc.s[RSTableDescriptionOriginY] = map->yo;                                  // s5
+        H->workers[i].dff_desc.s[RSTableDescriptionOriginZ] = -1.0f;                                    // s6
+        H->workers[i].dff_desc.s[RSTableDescriptionMaximumX] = map->xm;                                 // s8
+        H->workers[i].dff_desc.s[RSTableDescriptionMaximumY] = map->ym;                                 // s9
+        H->workers[i].dff_desc.s[RSTableDescriptionMaximumZ] = -1.0f;                                   // sa
+        H->workers[i].dff_desc.s[RSTableDescriptionReserved4] = 0.0f;                                   // sc
+        H->workers[i].dff_desc.s[RSTableDescriptionReserved5] = map->xm + 1.0f;                         // sd
+        H->workers[i].dff_desc.s[RSTableDescriptionReserved6] = (float)map->y_;                         // se
+        H->workers[i].dff_desc.s[RSTableDescriptionReserved7] = (float)map->x_ - 1.0f;                  // sf
     }
+    RS_table_free(table);
 }
 
 
-void RS_set_adm_data_to_ADM_table(RSHandle *H, const ADMTable *adam) {
-    
-    int i;
-    
-    RSTable2D cd = RS_table2d_init(adam->nn);
-    RSTable2D cm = RS_table2d_init(adam->nn);
+void RS_set_debris_flux_field_to_center_cell_of_3x3(RSHandle *H) {
+    // CDF: 3 x 3 flux field with a middle cell at 1.0 (cell 4)
+    //
+    //  1.0  |         o o o o
+    //       |         | | | |
+    //  0.0  o-o-o-o-o-+-+-+-+---> cell index
+    //       0 1 2 3 4 5 6 7 8
+    //
+    // iCDF should be:
+    //
+    //        1.0  |                   (This point does not exist in the table
+    //             |                    but it is assumed in this convention)
+    //    5/count  |      ...  o
+    //    4/count  o  ...      |
+    //             |           |
+    //             +-----------+--> v
+    //             0    ...   1.0
+    //
+    //     iCDF = [4 4.1 4.2 ... 5]
+    //
+    float icdf[2] = {4.0f, 5.0f};
+    RSTable2D map = {
+        .x_ = sizeof(icdf) / sizeof(float),
+        .xs = 1.0 / 3.0f,
+        .xo = -1.0f,
+        .xm = 2.0f,
+        .ys = 1.0 / 3.0f,
+        .yo = -1.0f,
+        .ym = 2.0f
+    };
+    RS_set_debris_flux_field_by_icdf(H, &map, icdf);
+}
+
+
+void RS_set_debris_flux_field_to_checker_board(RSHandle *H, const int c) {
+    int k;
+
+    // Some constants for the derived CDF
+    const int pdf_count = c * c;
+    float *pdf = (float *)malloc(pdf_count * sizeof(float));
     
-    if (cd.data == NULL || cm.data == NULL) {
-        rsprint("ADM input data cannot be NULL.");
-        return;
+    // Psuedo-PDF, not yet normalized
+    memset(pdf, 0, pdf_count * sizeof(float));
+    for (k = 0; k < pdf_count; k += 2) {
+        pdf[k] = 100.0;
     }
     
-    // Set up the mapping coefficients
-    // Assumptions: maps are always in beta in [-180deg, +180deg] and alpha in [0, +180deg]
-    cd.x_ = adam->nb;    cd.xm = (float)(cd.x_ - 1);    cd.xs = (float)(adam->nb - 1) / (2.0f * M_PI);    cd.xo = -(-M_PI) * cd.xs + 0.5f;
-    cd.y_ = adam->na;    cd.ym = (float)(cd.y_ - 1);    cd.ys = (float)(adam->na - 1) / M_PI;             cd.yo = 0.5f;
-    
-    cm.x_ = adam->nb;    cm.xm = (float)(cm.x_ - 1);    cm.xs = (float)(adam->nb - 1) / (2.0f * M_PI);    cm.xo = -(-M_PI) * cm.xs + 0.5f;
-    cm.y_ = adam->na;    cm.ym = (float)(cm.y_ - 1);    cm.ys = (float)(adam->na - 1) / M_PI;             cm.yo = 0.5f;
-    
-    // Arrange ADM values into float4, getting ready for GPU's global memory
-    for (i = 0; i < adam->nn; i++) {
-        cd.data[i].x = adam->data.cdx[i];
-        cd.data[i].y = adam->data.cdy[i];
-        cd.data[i].z = adam->data.cdz[i];
-        cd.data[i].w = 0.0f;
-        cm.data[i].x = adam->data.cmx[i];
-        cm.data[i].y = adam->data.cmy[i];
-        cm.data[i].z = adam->data.cmz[i];
-        cm.data[i].w = 0.0f;
+    // Actual PDF after a proper normalization
+    float sum = 0.0;
+    for (k = 0; k < pdf_count; k++) {
+        sum += pdf[k];
     }
-    
-    // Cache a copy of the parameters but not the data, the data could be deallocated immediately after this function call.
-    H->adm_desc[H->workers[0].adm_count] = *adam;
-    memset(&H->adm_desc[H->workers[0].adm_count].data, 0, sizeof(ADMData));
-    
-    if (H->verb > 1) {
-        const int t = H->workers[0].adm_count;
-        rsprint("GPU ADM[%d]   Ta = %.4f  inv_inln = [%.4f %.4f %.4f]   mass = %.4f kg",
-                t, H->adm_desc[t].phys.Ta, H->adm_desc[t].phys.inv_inln_x, H->adm_desc[t].phys.inv_inln_y, H->adm_desc[t].phys.inv_inln_z, H->adm_desc[t].phys.mass);
+    for (k = 0; k < pdf_count; k++) {
+        pdf[k] /= sum;
     }
+
+    // rsprint("=== %.2f %.2f / %.2f %.2f\n", H->sim_desc.hi.s4, H->sim_desc.hi.s5, H->sim_desc.hi.s0, H->sim_desc.hi.s1);
     
-    RS_set_adm_data(H, cd, cm);
+    // Mapping convention
+    RSTable2D map = {
+        .x_ = c * c,                  // Total number of cells
+        .y_ = 2,                      // Table convention: 0 - uniform grid, 1 - stretched_grid, >= 2 - test modes
+        .xs = 1.0f / (float)c,        // Scale of X
+        .ys = 1.0f / (float)c,        // Scale of Y
+        .xo = -1.0f,                  // Offset of X
+        .yo = -1.0f,                  // Offset of Y
+        .xm = (float)(c - 1),         // Maximum cell index of X (for CL kernel)
+        .ym = (float)(c - 1)          // Maximum cell index of Y (for CL kernel)
+    };
+
+    RS_set_debris_flux_field_by_pdf(H, &map, pdf);
     
-    RS_table2d_free(cd);
-    RS_table2d_free(cm);
+    free(pdf);
 }
 
 
-void RS_set_adm_data_to_unity(RSHandle *H) {
+void RS_set_debris_flux_field_to_checker_board_stretched(RSHandle *H, const LESTable *leslie) {
+    int k;
+    int ix, iy;
+    float dx, dy;
+
+    const int c = 9;
     
-    int i;
+    // Scale the r constant so that the rate increases quicker since we use a small c
+    const float q = 1.46f;
     
-    RSTable2D table = RS_table2d_init(9);
+    // Some constants for the derived CDF
+    const int pdf_count = c * c;
+    const float m = 0.5f * (float)(c - 1);
+
+    // A local storage for the pdf function
+    float *pdf = (float *)malloc(pdf_count * sizeof(float));
     
-    if (H->verb > 1) {
-        rsprint("ADM to unity @ X:[ -M_PI - M_PI ]  Y:[ 0 - M_PI ]");
+    // Psuedo-PDF, not yet normalized
+    memset(pdf, 0, pdf_count * sizeof(float));
+    for (k = 0; k < pdf_count; k += 2) {
+        if (leslie->is_stretched) {
+            iy = k / c;
+            ix = k % c;
+            // d(k) = a * r ^ k
+            dx = leslie->ax * powf(q * leslie->rx, fabs((float)ix - m));
+            dy = leslie->ay * powf(q * leslie->ry, fabs((float)iy - m));
+            pdf[k] = dx * dy;
+        } else {
+            pdf[k] = 1.0;
+        }
     }
     
-    table.x_ = 3;    table.xm = 2.0f;    table.xs = 3.0f / (2.0f * M_PI);    table.xo = -(-M_PI) * table.xs;
-    table.y_ = 3;    table.ym = 2.0f;    table.ys = 3.0f / M_PI;             table.yo = 0.0f;
-    
-    for (i = 0; i < 9; i++) {
-        table.data[i].x = 1.0f;
-        table.data[i].y = 1.0f;
-        table.data[i].z = 1.0f;
-        table.data[i].w = 0.0f;
+    // Actual PDF after normalization
+    float sum = 0.0;
+    for (k = 0; k < pdf_count; k++) {
+        sum += pdf[k];
+    }
+    for (k = 0; k < pdf_count; k++) {
+        pdf[k] /= sum;
+    }
+
+    RSTable2D map = {
+        .x_ = pdf_count,
+        .y_ = 1
+    };
+
+    if (leslie->is_stretched) {
+        //
+        // z(k) = a * (1.0 - r ^ k) / (1.0 - r)
+        //      = (1.0 - pow(r, k)) * a / (1.0 - r)
+        //      = pow(r, k) * -a / (1.0 - r) + a / (1.0 - r)
+        //      = fma(pow(r, k), -a / (1.0 - r), a / (1.0 - r))
+        //
+        // Note that k is assumed to have value of 0.0 at the middle of the domain
+        //
+        // Need to pass (1) = a / (1.0 - r), (2) r, and (3) count of x
+        //
+        map.xs = leslie->ax / (1.0f - leslie->rx);                 // --> dff_desc.s0
+        map.ys = leslie->ay / (1.0f - leslie->ry);                 // --> dff_desc.s1
+        map.xo = q * leslie->rx;                                   // --> dff_desc.s4
+        map.yo = q * leslie->ry;                                   // --> dff_desc.s5
+    } else {
+        map.xs = leslie->rx;
+        map.ys = leslie->ry;
+        map.xo = (float)(leslie->nx - 1) * 0.5f * leslie->rx;
+        map.yo = (float)(leslie->ny - 1) * 0.5f * leslie->ry;
     }
+    map.xm = (float)(c - 1);                                       // --> dff_desc.s8
+    map.ym = (float)(c - 1);                                       // --> dff_desc.s9
     
-    RS_set_adm_data(H, table, table);
+    // Temporary use a local pdf instead of leslie-flux
+    RS_set_debris_flux_field_by_pdf(H, &map, pdf);
     
-    RS_table2d_free(table);
+    // Be a good citizen, clean up
+    free(pdf);
 }
 
 
-void RS_clear_adm_data(RSHandle *H) {
-    for (int i = 0; i < H->num_workers; i++) {
-        for (int t = 0; t < H->workers[i].adm_count; t++) {
-            cl_uint nx = (cl_uint)H->workers[i].adm_desc[t].s[RSTable3DDescriptionMaximumX] + 1;
-            cl_uint ny = (cl_uint)H->workers[i].adm_desc[t].s[RSTable3DDescriptionMaximumY] + 1;
-            H->workers[i].mem_usage -= nx * ny * 2 * sizeof(cl_float4);
+// Flux PDF of the second plane of the table, weighted by the cell area on a stretched grid
+void RS_derive_flux_pdf_from_LES(float *pdf, const LESTable *leslie) {
+    int k;
+    int ix, iy;
+    float dx, dy;
+    
+    // Some constants for the derived CDF
+    const int pdf_count = leslie->nx * leslie->ny;
+    const float mx = 0.5f * (float)(leslie->nx - 1);
+    const float my = 0.5f * (float)(leslie->ny - 1);
+
+    // Derive a PDF from velocity
+    float v;
+    float sum = 0.0;
+    int i = pdf_count;
+    for (k = 0; k < pdf_count; k++) {
+        v = leslie->uvwt[i][0] * leslie->uvwt[i][0] + leslie->uvwt[i][1] * leslie->uvwt[i][1] + leslie->uvwt[i][2] * leslie->uvwt[i][2];
+        if (leslie->is_stretched) {
+            iy = k / leslie->nx;
+            ix = k % leslie->nx;
+            // d(k) = a * r ^ k
+            dx = leslie->ax * powf(leslie->rx, fabs((float)ix - mx));
+            dy = leslie->ay * powf(leslie->ry, fabs((float)iy - my));
+            v *= dx * dy;
         }
-        H->workers[0].adm_count = 0;
+        pdf[k] = v;
+        sum += v;
+        i++;
+    }
+    for (k = 0; k < pdf_count; k++) {
+        pdf[k] /= sum;
     }
 }
 
 
-void RS_set_rcs_data(RSHandle *H, const RSTable2D real, const RSTable2D imag) {
+// Flux ICDF of a table, e.g., for LES_write_cache()
+void RS_derive_flux_icdf_from_LES(float *icdf, const uint32_t count, const LESTable *leslie) {
+    RS_derive_flux_pdf_from_LES(leslie->flux, leslie);
+    RS_derive_icdf_from_pdf(icdf, count, leslie->flux, leslie->nx * leslie->ny);
+}
+
+
+void RS_set_debris_flux_field_from_LES(RSHandle *H, const LESTable *leslie) {
+    const int pdf_count = leslie->nx * leslie->ny;
+
+    RSTable2D map = {
+        .x_ = pdf_count,
+        .y_ = leslie->is_stretched
+    };
     
-    int i;
+    if (leslie->is_stretched) {
+        //
+        // z(k) = a * (1.0 - r ^ k) / (1.0 - r)
+        //      = (1.0 - pow(r, k)) * a / (1.0 - r)
+        //      = pow(r, k) * -a / (1.0 - r) + a / (1.0 - r)
+        //      = fma(pow(r, k), -a / (1.0 - r), a / (1.0 - r))
+        //
+        // Note that k is assumed to have value of 0.0 at the middle of the domain
+        //
+        // Need to pass (1) = a / (1.0 - r), (2) r, and (3) count of x
+        //
+        map.xs = leslie->ax / (1.0f - leslie->rx);                 // --> dff_desc.s0
+        map.ys = leslie->ay / (1.0f - leslie->ry);                 // --> dff_desc.s1
+        map.xo = leslie->rx;                                       // --> dff_desc.s4
+        map.yo = leslie->ry;                                       // --> dff_desc.s5
+    } else {
+        map.xs = leslie->rx;
+        map.ys = leslie->ry;
+        map.xo = (float)(leslie->nx - 1) * 0.5f * leslie->rx;
+        map.yo = (float)(leslie->ny - 1) * 0.5f * leslie->ry;
+    }
+    map.xm = (float)(leslie->nx - 1);                              // --> dff_desc.s8
+    map.ym = (float)(leslie->ny - 1);                              // --> dff_desc.s9
     
-    const int t = H->workers[0].rcs_count;
+    // Frames from the LES cache come with the ICDF
+    if (leslie->flux_icdf != NULL) {
+        map.x_ = leslie->flux_icdf_count;
+        RS_set_debris_flux_field_by_icdf(H, &map, leslie->flux_icdf);
+        return;
+    }
+
+    RS_derive_flux_pdf_from_LES(leslie->flux, leslie);
+    RS_set_debris_flux_field_by_pdf(H, &map, leslie->flux);
+}
+
+// Flux PDF of an analytic wind model over the domain, speed squared at the second plane of the shadow grid as with the LES
+void RS_set_debris_flux_field_from_analytic_model(RSHandle *H) {
+    int i, j;
+
+    const RSVolume domain = RS_get_domain(H);
+    const float center[2] = {domain.origin.x + 0.5f * domain.size.x, domain.origin.y + 0.5f * domain.size.y};
+    const int nx = MIN(MAX(1, (int)ceilf(domain.size.x / RS_ANALYTIC_WIND_SPACING)), (int)(RS_ANALYTIC_WIND_WIDTH / RS_ANALYTIC_WIND_SPACING));
+    const int ny = MIN(MAX(1, (int)ceilf(domain.size.y / RS_ANALYTIC_WIND_SPACING)), (int)(RS_ANALYTIC_WIND_WIDTH / RS_ANALYTIC_WIND_SPACING));
+    const int pdf_count = nx * ny;
+
+    float *pdf = (float *)malloc(pdf_count * sizeof(float));
+    if (pdf == NULL) {
+        rsprint("ERROR: Unable to allocate memory for the debris flux field.");
+        exit(EXIT_FAILURE);
+    }
+
+    float sum = 0.0f;
+    cl_float4 pos = {{0.0f, 0.0f, domain.origin.z + RS_ANALYTIC_WIND_SPACING, 0.0f}};
+    for (j = 0; j < ny; j++) {
+        pos.y = domain.origin.y + ((float)j + 0.5f) * domain.size.y / (float)ny;
+        for (i = 0; i < nx; i++) {
+            pos.x = domain.origin.x + ((float)i + 0.5f) * domain.size.x / (float)nx;
+            const cl_float4 v = RS_native_analytic_vel(&H->vel_model_desc, center, pos);
+            pdf[j * nx + i] = v.x * v.x + v.y * v.y + v.z * v.z;
+            sum += pdf[j * nx + i];
+        }
+    }
+    // Still air gives no preference
+    for (i = 0; i < pdf_count; i++) {
+        pdf[i] = sum > 0.0f ? pdf[i] / sum : 1.0f / (float)pdf_count;
+    }
+
+    // Cells stretched to the simulation domain like the checker board
+    RSTable2D map = {
+        .x_ = pdf_count,
+        .y_ = 2,
+        .xs = 1.0f / (float)nx,
+        .ys = 1.0f / (float)ny,
+        .xo = -1.0f,
+        .yo = -1.0f,
+        .xm = (float)(nx - 1),
+        .ym = (float)(ny - 1)
+    };
+    RS_set_debris_flux_field_by_pdf(H, &map, pdf);
+
+    free(pdf);
+}
+
+void RS_set_scan_pattern(RSHandle *H, const POSPattern *scan_pattern) {
+    H->P = (POSHandle)scan_pattern;
+    if (H->verb > 2) {
+        POS_summary(H->P);
+    }
+}
+
+
+void RS_set_scan_pattern_with_string(RSHandle *H, const char *scan_string) {
+    POSPattern *scan_pattern = POS_init_with_string(scan_string);
+    RS_set_scan_pattern(H, scan_pattern);
+}
+
+
+void RS_set_adm_data(RSHandle *H, const RSTable2D cd, const RSTable2D cm) {
     
-    const size_t n = real.x_ * real.y_;
-    if (imag.x_ * imag.y_ != n) {
-        rsprint("WARNING. RS_set_rcs_data() received inconsistent real (%d x %d) & imag (%d x %d) dimensions", now(), real.x_, real.y_, imag.x_, imag.y_);
+    int i;
+    
+    const int t = H->workers[0].adm_count;
+    
+    const size_t n = cd.x_ * cd.y_;
+    if (cm.x_ * cm.y_ != n) {
+        rsprint("WARNING. RS_set_adm_data() received inconsistent cd (%d x %d) & cm (%d x %d) dimensions", cd.x_, cd.y_, cm.x_, cm.y_);
         return;
     }
     
-    if (H->verb > 1) {
-        rsprint("GPU RCS[%d] @ X:[ -M_PI - +M_PI ]  Y:[ 0 - M_PI ]", H->workers[0].rcs_count);
+    if (H->verb > 2) {
+        rsprint("ADM[%d] @ X:[ -M_PI - +M_PI ]  Y:[ 0 - M_PI ]", H->workers[0].adm_count);
     }
     
     // This is the part that we need to create two texture maps for each RSTable2D table
@@ -3872,8 +4844,8 @@ void RS_set_rcs_data(RSHandle *H, const RSTable2D real, const RSTable2D imag) {
     
     cl_image_desc desc;
     desc.image_type = CL_MEM_OBJECT_IMAGE2D;
-    desc.image_width  = real.x_;
-    desc.image_height = real.y_;
+    desc.image_width  = cd.x_;
+    desc.image_height = cd.y_;
     desc.image_depth  = 1;
     desc.image_array_size = 0;
     desc.image_row_pitch = desc.image_width * sizeof(cl_float4);
@@ -3884,63 +4856,63 @@ void RS_set_rcs_data(RSHandle *H, const RSTable2D real, const RSTable2D imag) {
     
 #endif
     
-    for (i = 0; i < H->num_workers; i++) {
-        if (H->workers[i].rcs_real[t] != NULL && H->workers[i].rcs_imag[t] != NULL) {
+    if (H->native) {
+        RS_native_set_adm_data(H, t, &cd, &cm);
+    }
+    
+    for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
+        if (H->workers[i].adm_cd[t] != NULL && H->workers[i].adm_cm[t] != NULL) {
             
 #if defined (_USE_GCL_)
             
-            gcl_release_image(H->workers[i].rcs_real[t]);
-            gcl_release_image(H->workers[i].rcs_imag[t]);
+            gcl_release_image(H->workers[i].adm_cd[t]);
+            gcl_release_image(H->workers[i].adm_cm[t]);
             
 #else
             
-            clReleaseMemObject(H->workers[i].rcs_real[t]);
-            clReleaseMemObject(H->workers[i].rcs_imag[t]);
+            clReleaseMemObject(H->workers[i].adm_cd[t]);
+            clReleaseMemObject(H->workers[i].adm_cm[t]);
             
 #endif
             
-            H->workers[i].mem_usage -= ((cl_uint)(H->workers[i].rcs_desc[t].s8 + 1.0f) * (H->workers[i].rcs_desc[t].s9 + 1.0f)) * 2 * sizeof(cl_float4);
+            H->workers[i].mem_usage -= ((cl_uint)(H->workers[i].adm_desc[t].s8 + 1.0f) * (H->workers[i].adm_desc[t].s9 + 1.0f)) * 2 * sizeof(cl_float4);
         }
-        //  rcs_real & rcs_imag always have the same desc
+        //  adm_cd & adm_cm always have the same desc
         
         
 #if defined (_USE_GCL_)
         
-        H->workers[i].rcs_real[t] = gcl_create_image(&format, real.x_, real.y_, 1, H->workers[i].surf_rcs_real[t]);
-        H->workers[i].rcs_imag[t] = gcl_create_image(&format, imag.x_, imag.y_, 1, H->workers[i].surf_rcs_imag[t]);
+        H->workers[i].adm_cd[t] = gcl_create_image(&format, cd.x_, cd.y_, 1, H->workers[i].surf_adm_cd[t]);
+        H->workers[i].adm_cm[t] = gcl_create_image(&format, cm.x_, cm.y_, 1, H->workers[i].surf_adm_cm[t]);
         
-#else
+#elif defined (CL_VERSION_1_2)
         
         cl_int retd, retm;
         cl_mem_flags flags = CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR;
         
-#if defined (CL_VERSION_1_2)
-        
-        H->workers[i].rcs_real[t] = clCreateImage(H->workers[i].context, flags, &format, &desc, real.data, &retd);
-        H->workers[i].rcs_imag[t] = clCreateImage(H->workers[i].context, flags, &format, &desc, imag.data, &retm);
+        H->workers[i].adm_cd[t] = clCreateImage(H->workers[i].context, flags, &format, &desc, cd.data, &retd);
+        H->workers[i].adm_cm[t] = clCreateImage(H->workers[i].context, flags, &format, &desc, cm.data, &retm);
         
 #else
         
-        H->workers[i].rcs_real[t] = clCreateImage2D(H->workers[i].context, flags, &format, real.x_, real.y_, real.x_ * sizeof(cl_float4), real.data, &retd);
-        H->workers[i].rcs_imag[t] = clCreateImage2D(H->workers[i].context, flags, &format, imag.x_, imag.y_, imag.x_ * sizeof(cl_float4), imag.data, &retm);
-        
-#endif
-        
+        H->workers[i].adm_cd[t] = clCreateImage2D(H->workers[i].context, flags, &format, cd.x_, cd.y_, cd.x_ * sizeof(cl_float4), cd.data, &retd);
+        H->workers[i].adm_cm[t] = clCreateImage2D(H->workers[i].context, flags, &format, cm.x_, cm.y_, cm.x_ * sizeof(cl_float4), cm.data, &retm);
+
 #endif
-        if (H->workers[i].rcs_real[t] == NULL || H->workers[i].rcs_imag[t] == NULL) {
-            rsprint("ERROR: workers[%d] unable to create RCS tables on CL device(s).", i);
+        if (H->workers[i].adm_cd[t] == NULL || H->workers[i].adm_cm[t] == NULL) {
+            rsprint("ERROR: workers[%d] unable to create ADM tables on CL device(s).", i);
             return;
         } else if (H->verb > 2) {
-            rsprint("workers[%d] created RCS tables rcs_real[%d] & rcs_imag[%d] @ %p & %p", i, t, t, &H->workers[i].rcs_real[t], &H->workers[i].rcs_imag[t]);
+            rsprint("workers[%d] created ADM tables adm_cd[%d] & adm_cd[%d] @ %p & %p", i, t, t, &H->workers[i].adm_cd[t], &H->workers[i].adm_cm[t]);
         }
         
 #if defined (_USE_GCL_)
         
         dispatch_async(H->workers[i].que, ^{
             size_t origin[3] = {0, 0, 0};
-            size_t region[3] = {real.x_, imag.y_, 1};
-            gcl_copy_ptr_to_image(H->workers[i].rcs_real[t], real.data, origin, region);
-            gcl_copy_ptr_to_image(H->workers[i].rcs_imag[t], imag.data, origin, region);
+            size_t region[3] = {cd.x_, cd.y_, 1};
+            gcl_copy_ptr_to_image(H->workers[i].adm_cd[t], cd.data, origin, region);
+            gcl_copy_ptr_to_image(H->workers[i].adm_cm[t], cm.data, origin, region);
             dispatch_semaphore_signal(H->workers[i].sem);
         });
         
@@ -3957,132 +4929,387 @@ void RS_set_rcs_data(RSHandle *H, const RSTable2D real, const RSTable2D imag) {
 #endif
         
         // Copy over to the CL worker
-        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionScaleX] = real.xs;
-        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionScaleY] = real.ys;
-        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionScaleZ] = 0.0f;
-        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionOriginX] = real.xo;
-        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionOriginY] = real.yo;
-        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionOriginZ] = 0.0f;
-        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionMaximumX] = real.xm;
-        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionMaximumY] = real.ym;
-        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionMaximumZ] = 0.0f;
-        H->workers[i].rcs_count++;
-        H->workers[i].mem_usage += ((cl_uint)(real.xm + 1.0f) * (real.ym + 1.0f)) * 2 * sizeof(cl_float4);
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionScaleX] = cd.xs;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionScaleY] = cd.ys;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionScaleZ] = 0.0f;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionOriginX] = cd.xo;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionOriginY] = cd.yo;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionOriginZ] = 0.0f;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionMaximumX] = cd.xm;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionMaximumY] = cd.ym;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionMaximumZ] = 0.0f;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionRecipInLnX] = H->adm_desc[t].phys.inv_inln_x;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionRecipInLnY] = H->adm_desc[t].phys.inv_inln_y;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionRecipInLnZ] = H->adm_desc[t].phys.inv_inln_z;
+        H->workers[i].adm_desc[t].s[RSTable3DDescriptionTachikawa] = H->adm_desc[t].phys.Ta;
+        H->workers[i].adm_count++;
+        H->workers[i].mem_usage += ((cl_uint)(cd.xm + 1.0f) * (cd.ym + 1.0f)) * 2 * sizeof(cl_float4);
     }
 }
 
 
-void RS_set_rcs_data_to_RCS_table(RSHandle *H, const RCSTable *rosie) {
+void RS_set_adm_data_to_ADM_table(RSHandle *H, const ADMTable *adam) {
     
     int i;
     
-    RSTable2D real = RS_table2d_init(rosie->nn);
-    RSTable2D imag = RS_table2d_init(rosie->nn);
+    RSTable2D cd = RS_table2d_init(adam->nn);
+    RSTable2D cm = RS_table2d_init(adam->nn);
     
-    if (real.data == NULL || imag.data == NULL) {
-        rsprint("ERROR: RCS input data cannot be NULL.");
+    if (cd.data == NULL || cm.data == NULL) {
+        rsprint("ADM input data cannot be NULL.");
         return;
     }
+    
     // Set up the mapping coefficients
-    // Assumptions: maps are always in alpha in [-180deg, +180deg] and beta in [0, +180deg]
-    real.x_ = rosie->na;    real.xm = (float)(real.x_ - 1);    real.xs = (float)(rosie->na - 1) / (2.0f * M_PI);    real.xo = -(-M_PI) * real.xs;
-    real.y_ = rosie->nb;    real.ym = (float)(real.y_ - 1);    real.ys = (float)(rosie->nb - 1) / M_PI;             real.yo = 0.0f;
+    // Assumptions: maps are always in beta in [-180deg, +180deg] and alpha in [0, +180deg]
+    cd.x_ = adam->nb;    cd.xm = (float)(cd.x_ - 1);    cd.xs = (float)(adam->nb - 1) / (2.0f * M_PI);    cd.xo = -(-M_PI) * cd.xs + 0.5f;
+    cd.y_ = adam->na;    cd.ym = (float)(cd.y_ - 1);    cd.ys = (float)(adam->na - 1) / M_PI;             cd.yo = 0.5f;
     
-    imag.x_ = rosie->na;    imag.xm = (float)(imag.x_ - 1);    imag.xs = (float)(rosie->na - 1) / (2.0f * M_PI);    imag.xo = -(-M_PI) * real.xs;
-    imag.y_ = rosie->nb;    imag.ym = (float)(imag.y_ - 1);    imag.ys = (float)(rosie->nb - 1) / M_PI;             imag.yo = 0.0f;
+    cm.x_ = adam->nb;    cm.xm = (float)(cm.x_ - 1);    cm.xs = (float)(adam->nb - 1) / (2.0f * M_PI);    cm.xo = -(-M_PI) * cm.xs + 0.5f;
+    cm.y_ = adam->na;    cm.ym = (float)(cm.y_ - 1);    cm.ys = (float)(adam->na - 1) / M_PI;             cm.yo = 0.5f;
     
-    // Arrange RCS values into float4, getting ready for GPU's global memory
-    for (i = 0; i < rosie->nn; i++) {
-        real.data[i].x = rosie->data.hh_real[i];
-        real.data[i].y = rosie->data.vv_real[i];
-        real.data[i].z = rosie->data.hv_real[i];
-        real.data[i].w = 0.0f;
-        imag.data[i].x = rosie->data.hh_imag[i];
-        imag.data[i].y = rosie->data.vv_imag[i];
-        imag.data[i].z = rosie->data.hv_imag[i];
-        imag.data[i].w = 0.0f;
+    // Arrange ADM values into float4, getting ready for GPU's global memory
+    for (i = 0; i < adam->nn; i++) {
+        cd.data[i].x = adam->data.cdx[i];
+        cd.data[i].y = adam->data.cdy[i];
+        cd.data[i].z = adam->data.cdz[i];
+        cd.data[i].w = 0.0f;
+        cm.data[i].x = adam->data.cmx[i];
+        cm.data[i].y = adam->data.cmy[i];
+        cm.data[i].z = adam->data.cmz[i];
+        cm.data[i].w = 0.0f;
     }
     
     // Cache a copy of the parameters but not the data, the data could be deallocated immediately after this function call.
-    H->rcs_desc[H->workers[0].rcs_count] = *rosie;
-    memset(&H->rcs_desc[H->workers[0].rcs_count].data, 0, sizeof(RCSData));
+    H->adm_desc[H->workers[0].adm_count] = *adam;
+    memset(&H->adm_desc[H->workers[0].adm_count].data, 0, sizeof(ADMData));
     
     if (H->verb > 1) {
-        const int t = H->workers[0].rcs_count;
-        rsprint("GPU RCS[%d]   lambda = %.2f m",
-                t, H->rcs_desc[t].lambda);
+        const int t = H->workers[0].adm_count;
+        rsprint("GPU ADM[%d]   Ta = %.4f  inv_inln = [%.4f %.4f %.4f]   mass = %.4f kg",
+                t, H->adm_desc[t].phys.Ta, H->adm_desc[t].phys.inv_inln_x, H->adm_desc[t].phys.inv_inln_y, H->adm_desc[t].phys.inv_inln_z, H->adm_desc[t].phys.mass);
     }
     
-    RS_set_rcs_data(H, real, imag);
+    RS_set_adm_data(H, cd, cm);
     
-    RS_table2d_free(real);
-    RS_table2d_free(imag);
+    RS_table2d_free(cd);
+    RS_table2d_free(cm);
 }
 
 
-void RS_set_rcs_data_to_unity(RSHandle *H) {
+void RS_set_adm_data_to_unity(RSHandle *H) {
     
     int i;
     
-    RSTable2D table_real = RS_table2d_init(9);
-    RSTable2D table_imag = RS_table2d_init(9);
+    RSTable2D table = RS_table2d_init(9);
     
     if (H->verb > 1) {
-        rsprint("RCS to unity @ X:[ -M_PI - M_PI ]  Y:[ 0 - M_PI ]");
+        rsprint("ADM to unity @ X:[ -M_PI - M_PI ]  Y:[ 0 - M_PI ]");
     }
     
-    table_real.x_ = 3;    table_real.xm = 2.0f;    table_real.xs = 3.0f / (2.0f * M_PI);    table_real.xo = -(-M_PI) * table_real.xs;
-    table_real.y_ = 3;    table_real.ym = 2.0f;    table_real.ys = 3.0f / M_PI;             table_real.yo = 0.0f;
-    
-    table_imag.x_ = 3;    table_imag.xm = 2.0f;    table_imag.xs = 3.0f / (2.0f * M_PI);    table_imag.xo = -(-M_PI) * table_imag.xs;
-    table_imag.y_ = 3;    table_imag.ym = 2.0f;    table_imag.ys = 3.0f / M_PI;             table_imag.yo = 0.0f;
+    table.x_ = 3;    table.xm = 2.0f;    table.xs = 3.0f / (2.0f * M_PI);    table.xo = -(-M_PI) * table.xs;
+    table.y_ = 3;    table.ym = 2.0f;    table.ys = 3.0f / M_PI;             table.yo = 0.0f;
     
-    for (i =  0; i < 9; i++) {
-        table_real.data[i].x = 1.0f;
-        table_real.data[i].y = 1.0f;
-        table_real.data[i].z = 1.0f;
-        table_real.data[i].w = 0.0f;
-        
-        table_imag.data[i].x = 0.0f;
-        table_imag.data[i].y = 0.0f;
-        table_imag.data[i].z = 0.0f;
-        table_imag.data[i].w = 0.0f;
+    for (i = 0; i < 9; i++) {
+        table.data[i].x = 1.0f;
+        table.data[i].y = 1.0f;
+        table.data[i].z = 1.0f;
+        table.data[i].w = 0.0f;
     }
     
-    RS_set_rcs_data(H, table_real, table_imag);
+    RS_set_adm_data(H, table, table);
     
-    RS_table2d_free(table_real);
-    RS_table2d_free(table_imag);
+    RS_table2d_free(table);
 }
 
 
-void RS_clear_rcs_data(RSHandle *H) {
+void RS_clear_adm_data(RSHandle *H) {
     for (int i = 0; i < H->num_workers; i++) {
-        for (int t = 0; t < H->workers[i].rcs_count; t++) {
-            cl_uint nx = (cl_uint)H->workers[i].rcs_desc[t].s[RSTable3DDescriptionMaximumX] + 1;
-            cl_uint ny = (cl_uint)H->workers[i].rcs_desc[t].s[RSTable3DDescriptionMaximumY] + 1;
+        for (int t = 0; t < H->workers[i].adm_count; t++) {
+            cl_uint nx = (cl_uint)H->workers[i].adm_desc[t].s[RSTable3DDescriptionMaximumX] + 1;
+            cl_uint ny = (cl_uint)H->workers[i].adm_desc[t].s[RSTable3DDescriptionMaximumY] + 1;
             H->workers[i].mem_usage -= nx * ny * 2 * sizeof(cl_float4);
         }
-        H->workers[i].rcs_count = 0;
+        H->workers[0].adm_count = 0;
     }
 }
 
-// This method can be confusing. Don't use
-void RS_set_obj_data_to_config(RSHandle *H, OBJConfig type) {
-    OBJTable *obj_table = OBJ_get_table(H->O, type);
-    
-    RS_set_adm_data_to_ADM_table(H, obj_table->adm_table);
-    RS_set_rcs_data_to_RCS_table(H, obj_table->rcs_table);
-}
-
 
-void RS_set_random_seed(RSHandle *H, const unsigned int seed) {
-    if (H->verb) {
-        rsprint("Random number generator set to use seed %s", commaint(seed));
+void RS_set_rcs_data(RSHandle *H, const RSTable2D real, const RSTable2D imag) {
+    
+    int i;
+    
+    const int t = H->workers[0].rcs_count;
+    
+    const size_t n = real.x_ * real.y_;
+    if (imag.x_ * imag.y_ != n) {
+        rsprint("WARNING. RS_set_rcs_data() received inconsistent real (%d x %d) & imag (%d x %d) dimensions", now(), real.x_, real.y_, imag.x_, imag.y_);
+        return;
+    }
+    
+    if (H->verb > 1) {
+        rsprint("GPU RCS[%d] @ X:[ -M_PI - +M_PI ]  Y:[ 0 - M_PI ]", H->workers[0].rcs_count);
+    }
+    
+    // This is the part that we need to create two texture maps for each RSTable2D table
+    cl_image_format format = {CL_RGBA, CL_FLOAT};
+    
+#if defined (CL_VERSION_1_2)
+    
+    cl_image_desc desc;
+    desc.image_type = CL_MEM_OBJECT_IMAGE2D;
+    desc.image_width  = real.x_;
+    desc.image_height = real.y_;
+    desc.image_depth  = 1;
+    desc.image_array_size = 0;
+    desc.image_row_pitch = desc.image_width * sizeof(cl_float4);
+    desc.image_slice_pitch = desc.image_height * desc.image_row_pitch;
+    desc.num_mip_levels = 0;
+    desc.num_samples = 0;
+    desc.buffer = NULL;
+    
+#endif
+    
+    if (H->native) {
+        RS_native_set_rcs_data(H, t, &real, &imag);
+    }
+    
+    for (i = 0; i < RS_CL_WORKER_COUNT(H); i++) {
+        if (H->workers[i].rcs_real[t] != NULL && H->workers[i].rcs_imag[t] != NULL) {
+            
+#if defined (_USE_GCL_)
+            
+            gcl_release_image(H->workers[i].rcs_real[t]);
+            gcl_release_image(H->workers[i].rcs_imag[t]);
+            
+#else
+            
+            clReleaseMemObject(H->workers[i].rcs_real[t]);
+            clReleaseMemObject(H->workers[i].rcs_imag[t]);
+            
+#endif
+            
+            H->workers[i].mem_usage -= ((cl_uint)(H->workers[i].rcs_desc[t].s8 + 1.0f) * (H->workers[i].rcs_desc[t].s9 + 1.0f)) * 2 * sizeof(cl_float4);
+        }
+        //  rcs_real & rcs_imag always have the same desc
+        
+        
+#if defined (_USE_GCL_)
+        
+        H->workers[i].rcs_real[t] = gcl_create_image(&format, real.x_, real.y_, 1, H->workers[i].surf_rcs_real[t]);
+        H->workers[i].rcs_imag[t] = gcl_create_image(&format, imag.x_, imag.y_, 1, H->workers[i].surf_rcs_imag[t]);
+        
+#else
+        
+        cl_int retd, retm;
+        cl_mem_flags flags = CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR;
+        
+#if defined (CL_VERSION_1_2)
+        
+        H->workers[i].rcs_real[t] = clCreateImage(H->workers[i].context, flags, &format, &desc, real.data, &retd);
+        H->workers[i].rcs_imag[t] = clCreateImage(H->workers[i].context, flags, &format, &desc, imag.data, &retm);
+        
+#else
+        
+        H->workers[i].rcs_real[t] = clCreateImage2D(H->workers[i].context, flags, &format, real.x_, real.y_, real.x_ * sizeof(cl_float4), real.data, &retd);
+        H->workers[i].rcs_imag[t] = clCreateImage2D(H->workers[i].context, flags, &format, imag.x_, imag.y_, imag.x_ * sizeof(cl_float4), imag.data, &retm);
+        
+#endif
+        
+#endif
+        if (H->workers[i].rcs_real[t] == NULL || H->workers[i].rcs_imag[t] == NULL) {
+            rsprint("ERROR: workers[%d] unable to create RCS tables on CL device(s).", i);
+            return;
+        } else if (H->verb > 2) {
+            rsprint("workers[%d] created RCS tables rcs_real[%d] & rcs_imag[%d] @ %p & %p", i, t, t, &H->workers[i].rcs_real[t], &H->workers[i].rcs_imag[t]);
+        }
+        
+#if defined (_USE_GCL_)
+        
+        dispatch_async(H->workers[i].que, ^{
+            size_t origin[3] = {0, 0, 0};
+            size_t region[3] = {real.x_, imag.y_, 1};
+            gcl_copy_ptr_to_image(H->workers[i].rcs_real[t], real.data, origin, region);
+            gcl_copy_ptr_to_image(H->workers[i].rcs_imag[t], imag.data, origin, region);
+            dispatch_semaphore_signal(H->workers[i].sem);
+        });
+        
+#endif
+        
+    }
+    
+    for (i = 0; i < H->num_workers; i++) {
+        
+#if defined (_USE_GCL_)
+        
+        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+        
+#endif
+        
+        // Copy over to the CL worker
+        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionScaleX] = real.xs;
+        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionScaleY] = real.ys;
+        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionScaleZ] = 0.0f;
+        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionOriginX] = real.xo;
+        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionOriginY] = real.yo;
+        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionOriginZ] = 0.0f;
+        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionMaximumX] = real.xm;
+        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionMaximumY] = real.ym;
+        H->workers[i].rcs_desc[t].s[RSTable3DDescriptionMaximumZ] = 0.0f;
+        H->workers[i].rcs_count++;
+        H->workers[i].mem_usage += ((cl_uint)(real.xm + 1.0f) * (real.ym + 1.0f)) * 2 * sizeof(cl_float4);
+    }
+}
+
+
+void RS_set_rcs_data_to_RCS_table(RSHandle *H, const RCSTable *rosie) {
+    
+    int i;
+    
+    RSTable2D real = RS_table2d_init(rosie->nn);
+    RSTable2D imag = RS_table2d_init(rosie->nn);
+    
+    if (real.data == NULL || imag.data == NULL) {
+        rsprint("ERROR: RCS input data cannot be NULL.");
+        return;
+    }
+    // Set up the mapping coefficients
+    // Assumptions: maps are always in alpha in [-180deg, +180deg] and beta in [0, +180deg]
+    real.x_ = rosie->na;    real.xm = (float)(real.x_ - 1);    real.xs = (float)(rosie->na - 1) / (2.0f * M_PI);    real.xo = -(-M_PI) * real.xs;
+    real.y_ = rosie->nb;    real.ym = (float)(real.y_ - 1);    real.ys = (float)(rosie->nb - 1) / M_PI;             real.yo = 0.0f;
+    
+    imag.x_ = rosie->na;    imag.xm = (float)(imag.x_ - 1);    imag.xs = (float)(rosie->na - 1) / (2.0f * M_PI);    imag.xo = -(-M_PI) * real.xs;
+    imag.y_ = rosie->nb;    imag.ym = (float)(imag.y_ - 1);    imag.ys = (float)(rosie->nb - 1) / M_PI;             imag.yo = 0.0f;
+    
+    // Arrange RCS values into float4, getting ready for GPU's global memory
+    for (i = 0; i < rosie->nn; i++) {
+        real.data[i].x = rosie->data.hh_real[i];
+        real.data[i].y = rosie->data.vv_real[i];
+        real.data[i].z = rosie->data.hv_real[i];
+        real.data[i].w = 0.0f;
+        imag.data[i].x = rosie->data.hh_imag[i];
+        imag.data[i].y = rosie->data.vv_imag[i];
+        imag.data[i].z = rosie->data.hv_imag[i];
+        imag.data[i].w = 0.0f;
+    }
+    
+    // Cache a copy of the parameters but not the data, the data could be deallocated immediately after this function call.
+    H->rcs_desc[H->workers[0].rcs_count] = *rosie;
+    memset(&H->rcs_desc[H->workers[0].rcs_count].data, 0, sizeof(RCSData));
+    
+    if (H->verb > 1) {
+        const int t = H->workers[0].rcs_count;
+        rsprint("GPU RCS[%d]   lambda = %.2f m",
+                t, H->rcs_desc[t].lambda);
+    }
+    
+    RS_set_rcs_data(H, real, imag);
+    
+    RS_table2d_free(real);
+    RS_table2d_free(imag);
+}
+
+
+void RS_set_rcs_data_to_unity(RSHandle *H) {
+    
+    int i;
+    
+    RSTable2D table_real = RS_table2d_init(9);
+    RSTable2D table_imag = RS_table2d_init(9);
+    
+    if (H->verb > 1) {
+        rsprint("RCS to unity @ X:[ -M_PI - M_PI ]  Y:[ 0 - M_PI ]");
+    }
+    
+    table_real.x_ = 3;    table_real.xm = 2.0f;    table_real.xs = 3.0f / (2.0f * M_PI);    table_real.xo = -(-M_PI) * table_real.xs;
+    table_real.y_ = 3;    table_real.ym = 2.0f;    table_real.ys = 3.0f / M_PI;             table_real.yo = 0.0f;
+    
+    table_imag.x_ = 3;    table_imag.xm = 2.0f;    table_imag.xs = 3.0f / (2.0f * M_PI);    table_imag.xo = -(-M_PI) * table_imag.xs;
+    table_imag.y_ = 3;    table_imag.ym = 2.0f;    table_imag.ys = 3.0f / M_PI;             table_imag.yo = 0.0f;
+    
+    for (i =  0; i < 9; i++) {
+        table_real.data[i].x = 1.0f;
+        table_real.data[i].y = 1.0f;
+        table_real.data[i].z = 1.0f;
+        table_real.data[i].w = 0.0f;
+        
+        table_imag.data[i].x = 0.0f;
+        table_imag.data[i].y = 0.0f;
+        table_imag.data[i].z = 0.0f;
+        table_imag.data[i].w = 0.0f;
+    }
+    
+    RS_set_rcs_data(H, table_real, table_imag);
+    
+    RS_table2d_free(table_real);
+    RS_table2d_free(table_imag);
+}
+
+
+void RS_clear_rcs_data(RSHandle *H) {
+    for (int i = 0; i < H->num_workers; i++) {
+        for (int t = 0; t < H->workers[i].rcs_count; t++) {
+            cl_uint nx = (cl_uint)H->workers[i].rcs_desc[t].s[RSTable3DDescriptionMaximumX] + 1;
+            cl_uint ny = (cl_uint)H->workers[i].rcs_desc[t].s[RSTable3DDescriptionMaximumY] + 1;
+            H->workers[i].mem_usage -= nx * ny * 2 * sizeof(cl_float4);
+        }
+        H->workers[i].rcs_count = 0;
+    }
+}
+
+// This method can be confusing. Don't use
+void RS_set_obj_data_to_config(RSHandle *H, OBJConfig type) {
+    OBJTable *obj_table = OBJ_get_table(H->O, type);
+    
+    RS_set_adm_data_to_ADM_table(H, obj_table->adm_table);
+    RS_set_rcs_data_to_RCS_table(H, obj_table->rcs_table);
+}
+
+
+void RS_set_random_seed(RSHandle *H, const unsigned int seed) {
+    if (H->verb) {
+        rsprint("Random number generator set to use seed %s", commaint(seed));
     }
     H->random_seed = seed;
 }
 
+
+void RS_set_worker_partition(RSHandle *H, const RSWorkerPartition partition) {
+    if (H->status & RSStatusDomainPopulated) {
+        rsprint("Simulation domain has been populated. Worker partition cannot be changed.");
+        return;
+    }
+    H->worker_partition = partition;
+}
+
+// Keep the population in host memory and pipeline it through the devices in chunks, 0 to keep it resident
+void RS_set_streaming(RSHandle *H, const size_t chunk) {
+    if (H->status & RSStatusDomainPopulated) {
+        rsprint("Simulation domain has been populated. Streaming cannot be changed.");
+        return;
+    }
+    H->stream_chunk = chunk ? ((chunk + RS_CL_GROUP_ITEMS - 1) / RS_CL_GROUP_ITEMS) * RS_CL_GROUP_ITEMS : 0;
+}
+
+
+void RS_set_device_population(RSHandle *H, const bool device) {
+    if (H->status & RSStatusDomainPopulated) {
+        rsprint("Simulation domain has been populated. Population method cannot be changed.");
+        return;
+    }
+    H->device_population = device;
+}
+
+
+// Host mirrors that stay allocated after the population is uploaded, RSHostMirrorAll by default
+void RS_set_host_mirrors(RSHandle *H, const RSHostMirror mirrors) {
+    if (H->status & RSStatusDomainPopulated) {
+        rsprint("Simulation domain has been populated. Host mirrors cannot be changed.");
+        return;
+    }
+    H->host_mirrors = mirrors & RSHostMirrorAll;
+}
+
 // Add debris to the simulation machine
 void RS_add_debris(RSHandle *H, OBJConfig type, const size_t count) {
 
@@ -4136,6 +5363,12 @@ void RS_update_auxiliary_attributes(RSHandle *H) {
         return;
     }
     
+    if (H->native) {
+        RS_native_update_auxiliary_attributes(H);
+        H->status &= ~RSStatusScattererSignalNeedsUpdate;
+        return;
+    }
+    
 #if defined (_USE_GCL_)
     
     for (i = 0; i < H->num_workers; i++) {
@@ -4158,7 +5391,7 @@ void RS_update_auxiliary_attributes(RSHandle *H) {
     
 #else
     
-    cl_event events[RS_MAX_GPU_DEVICE];
+    cl_event events[RS_MAX_WORKERS];
     memset(events, 0, sizeof(events));
     
     for (i = 0; i < H->num_workers; i++) {
@@ -4259,7 +5492,7 @@ void RS_update_colors(RSHandle *H) {
     
 #else
     
-    cl_event events[RS_MAX_GPU_DEVICE][H->num_types];
+    cl_event events[RS_MAX_WORKERS][H->num_types];
     memset(events, 0, sizeof(events));
     
     if (H->status & RSStatusDebrisRCSNeedsUpdate) {
@@ -4387,9 +5620,155 @@ void RS_derive_ndranges(RSHandle *H) {
 #endif
 
 #pragma mark -
-#pragma mark Framework Functions
+#pragma mark Spatial Slabs
 
-void RS_io_test(RSHandle *H) {
+// Azimuth of (x, y) relative to the direction of the domain center, wrapped to [-pi, pi)
+static float RS_slab_azimuth(RSHandle *H, const float x, const float y) {
+    float a = atan2f(x, y) - H->slab_az_center;
+    if (a >= M_PI) {
+        a -= 2.0f * M_PI;
+    } else if (a < -M_PI) {
+        a += 2.0f * M_PI;
+    }
+    return a;
+}
+
+
+static int RS_compare_float(const void *a, const void *b) {
+    const float fa = *(const float *)a;
+    const float fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+
+void RS_update_slabs(RSHandle *H) {
+    
+    int i, j, k;
+    
+    // No slab, the attribute kernels respawn anywhere in the domain
+    for (k = 0; k < H->num_workers; k++) {
+        memset(&H->workers[k].slab_desc, 0, sizeof(cl_float4));
+    }
+    
+    if (H->worker_partition == RSWorkerPartitionRandom) {
+        return;
+    }
+    
+    if (H->sim_concept & RSSimulationConceptFixedScattererPosition) {
+        rsprint("WARNING. Spatial slabs are not used in RSSimulationConceptFixedScattererPosition mode.");
+        H->worker_partition = RSWorkerPartitionRandom;
+        return;
+    }
+    
+    const RSVolume domain = RS_get_domain(H);
+    
+    H->slab_az_center = atan2f(domain.origin.x + 0.5f * domain.size.x, domain.origin.y + 0.5f * domain.size.y);
+    
+    // Sector boundaries at the quantiles of a regular grid so that every slab covers the same area, i.e., an even split of scatterers
+    const int n = RS_SLAB_SAMPLES;
+    float *az = (float *)malloc(n * n * sizeof(float));
+    if (az == NULL) {
+        rsprint("ERROR: Unable to allocate memory for spatial slabs.");
+        exit(EXIT_FAILURE);
+    }
+    for (j = 0; j < n; j++) {
+        for (i = 0; i < n; i++) {
+            az[j * n + i] = RS_slab_azimuth(H,
+                                            domain.origin.x + ((float)i + 0.5f) / (float)n * domain.size.x,
+                                            domain.origin.y + ((float)j + 0.5f) / (float)n * domain.size.y);
+        }
+    }
+    qsort(az, n * n, sizeof(float), RS_compare_float);
+    H->slab_az_bounds[0] = az[0];
+    for (k = 1; k < H->num_workers; k++) {
+        H->slab_az_bounds[k] = az[k * n * n / H->num_workers];
+    }
+    H->slab_az_bounds[H->num_workers] = az[n * n - 1];
+    free(az);
+    
+    // The first and the last slabs take everything beyond, just like RS_slab_of_position()
+    for (k = 0; k < H->num_workers; k++) {
+        cl_float4 *desc = &H->workers[k].slab_desc;
+        desc->s[RSSlabDescriptionCenter] = H->slab_az_center;
+        desc->s[RSSlabDescriptionLower] = k == 0 ? -4.0f : H->slab_az_bounds[k];
+        desc->s[RSSlabDescriptionUpper] = k == H->num_workers - 1 ? 4.0f : H->slab_az_bounds[k + 1];
+        desc->s[RSSlabDescriptionDraws] = (float)(RS_SLAB_RESPAWN_DRAWS * H->num_workers);
+    }
+    
+    // Closest horizontal distance of the domain, where a drift turns into the widest azimuth change
+    const float dx = MAX(0.0f, MAX(domain.origin.x, -domain.origin.x - domain.size.x));
+    const float dy = MAX(0.0f, MAX(domain.origin.y, -domain.origin.y - domain.size.y));
+    H->slab_range = sqrtf(dx * dx + dy * dy);
+    
+    // Speeds are unknown until the first migration, which comes right after the first time step
+    H->slab_speed = -1.0f;
+    H->slab_migration_tic = 0;
+    
+    if (H->verb) {
+        rsprint("RS : Spatial slabs around azimuth %.2f deg:", H->slab_az_center / M_PI * 180.0f);
+        for (k = 0; k < H->num_workers; k++) {
+            printf(RS_INDENT "o workers[%d] [ %7.2f, %7.2f ] deg\n", k, H->slab_az_bounds[k] / M_PI * 180.0f, H->slab_az_bounds[k + 1] / M_PI * 180.0f);
+        }
+    }
+}
+
+
+int RS_slab_of_position(RSHandle *H, const cl_float4 pos) {
+    const float a = RS_slab_azimuth(H, pos.x, pos.y);
+    int k = 0;
+    while (k < H->num_workers - 1 && a >= H->slab_az_bounds[k + 1]) {
+        k++;
+    }
+    return k;
+}
+
+
+// Whether the slab of a worker is within the reach of the angular weight of the current beam
+static char RS_slab_in_beam(RSHandle *H, const int worker_id) {
+    
+    int k;
+    
+    if (H->worker_partition == RSWorkerPartitionRandom) {
+        return 1;
+    }
+    
+    // Off-axis angles beyond the 1D angular weight table carry no weight, no table means no culling
+    const cl_float4 desc = H->workers[worker_id].angular_weight_desc;
+    if (desc.s[RSTable1DDescriptionScale] <= 0.0f) {
+        return 1;
+    }
+    const float reach = (desc.s[RSTable1DDescriptionMaximum] - desc.s[RSTable1DDescriptionOrigin]) / desc.s[RSTable1DDescriptionScale];
+    
+    // Azimuth half-width of the beam widens with elevation, a near vertical beam touches every slab
+    const float ux = H->sim_desc.s[RSSimulationDescriptionBeamUnitX];
+    const float uy = H->sim_desc.s[RSSimulationDescriptionBeamUnitY];
+    const float horiz = sqrtf(ux * ux + uy * uy);
+    if (sinf(reach) >= horiz) {
+        return 1;
+    }
+    const float da = asinf(sinf(reach) / horiz);
+    const float a = RS_slab_azimuth(H, ux, uy);
+    
+    // Scatterers may have drifted out of the slab since the last migration, widen it by the farthest they could have gone
+    const float drift = MAX(0.0f, H->slab_speed) * (float)H->slab_migration_tic * H->params.prt;
+    if (drift >= H->slab_range) {
+        return 1;
+    }
+    const float dd = asinf(drift / H->slab_range);
+    
+    for (k = -1; k <= 1; k++) {
+        const float b = a + (float)k * 2.0f * M_PI;
+        if (b + da >= H->slab_az_bounds[worker_id] - dd && b - da <= H->slab_az_bounds[worker_id + 1] + dd) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Framework Functions
+
+void RS_io_test(RSHandle *H) {
     
     int i;
     
@@ -4427,6 +5806,116 @@ void RS_io_test(RSHandle *H) {
 }
 
 
+static void RS_split_workers_into_segments(RSHandle *H, const int segments) {
+    
+    int d, s;
+    
+    const int num_devs = H->num_workers;
+    
+    if (num_devs * segments > RS_MAX_WORKERS) {
+        rsprint("ERROR: %d devices x %d segments exceed the maximum of %d workers.", num_devs, segments, RS_MAX_WORKERS);
+        exit(EXIT_FAILURE);
+    }
+    if (H->has_vbo_from_gl) {
+        rsprint("ERROR: Scatterer segments cannot share the VBOs with OpenGL.");
+        exit(EXIT_FAILURE);
+    }
+    
+    // Segments of a device are consecutive workers, the first one is the original worker
+    for (d = num_devs - 1; d >= 0; d--) {
+        if (d > 0) {
+            memcpy(&H->workers[d * segments], &H->workers[d], sizeof(RSWorker));
+            H->workers[d * segments].name = d * segments;
+        }
+        for (s = 1; s < segments; s++) {
+            RS_worker_init_segment(&H->workers[d * segments + s], &H->workers[d * segments], d * segments + s);
+        }
+    }
+    H->num_workers = num_devs * segments;
+    
+    if (H->verb) {
+        rsprint("Scatterers are split into %d segments on each device, %d workers in total.", segments, H->num_workers);
+    }
+}
+
+
+#if !defined (_USE_GCL_)
+
+// Generate the population on the devices with scat_pop, only the DSD tables go across
+static void RS_populate_on_device(RSHandle *H) {
+    
+    int i, k;
+    cl_int ret;
+    
+    // Same uid numbering as the host population, types first then workers
+    cl_uint uid[RS_MAX_WORKERS][RS_MAX_DEBRIS_TYPES];
+    cl_uint u = 0;
+    for (k = 0; k < H->num_types; k++) {
+        for (i = 0; i < H->num_workers; i++) {
+            uid[i][k] = u;
+            u += (cl_uint)H->workers[i].counts[k];
+        }
+    }
+    
+    const cl_uint dsd_count = H->dsd_name != RSDropSizeDistributionUndefined ? (cl_uint)H->dsd_count : 0;
+    const cl_uint uniform = (H->sim_concept & RSSimulationConceptUniformDSDScaledRCS) != 0;
+    
+    float zero = 0.0f;
+    cl_mem dsd_cdf[RS_MAX_WORKERS];
+    cl_mem dsd_r[RS_MAX_WORKERS];
+    
+    for (i = 0; i < H->num_workers; i++) {
+        RSWorker *C = &H->workers[i];
+        dsd_cdf[i] = clCreateBuffer(C->context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, MAX(1, dsd_count) * sizeof(float), dsd_count ? H->dsd_cdf : &zero, &ret);    CHECK_CL_CREATE_BUFFER
+        dsd_r[i] = clCreateBuffer(C->context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, MAX(1, dsd_count) * sizeof(float), dsd_count ? H->dsd_r : &zero, &ret);    CHECK_CL_CREATE_BUFFER
+        
+        ret = CL_SUCCESS;
+        ret |= clSetKernelArg(C->kern_scat_pop, 0, sizeof(cl_mem), &C->scat_pos);
+        ret |= clSetKernelArg(C->kern_scat_pop, 1, sizeof(cl_mem), &C->scat_vel);
+        ret |= clSetKernelArg(C->kern_scat_pop, 2, sizeof(cl_mem), &C->scat_ori);
+        ret |= clSetKernelArg(C->kern_scat_pop, 3, sizeof(cl_mem), &C->scat_tum);
+        ret |= clSetKernelArg(C->kern_scat_pop, 4, sizeof(cl_mem), &C->scat_aux);
+        ret |= clSetKernelArg(C->kern_scat_pop, 5, sizeof(cl_mem), &C->scat_rcs);
+        ret |= clSetKernelArg(C->kern_scat_pop, 6, sizeof(cl_mem), &C->scat_sig);
+        ret |= clSetKernelArg(C->kern_scat_pop, 7, sizeof(cl_mem), &C->scat_rnd);
+        ret |= clSetKernelArg(C->kern_scat_pop, 8, sizeof(cl_mem), &dsd_cdf[i]);
+        ret |= clSetKernelArg(C->kern_scat_pop, 9, sizeof(cl_mem), &dsd_r[i]);
+        ret |= clSetKernelArg(C->kern_scat_pop, 11, sizeof(cl_float16), &H->sim_desc);
+        if (ret != CL_SUCCESS) {
+            rsprint("ERROR: Failed to set arguments for kernel scat_pop().");
+            exit(EXIT_FAILURE);
+        }
+        
+        // Arguments are captured at enqueue so pop_desc can change between the types
+        for (k = 0; k < H->num_types; k++) {
+            if (C->counts[k] == 0) {
+                continue;
+            }
+            cl_uint4 pop_desc = {{uid[i][k], k == 0 ? dsd_count : 0, H->random_seed, uniform}};
+            clSetKernelArg(C->kern_scat_pop, 10, sizeof(cl_uint4), &pop_desc);
+            ret = clEnqueueNDRangeKernel(C->que, C->kern_scat_pop, 1, &C->origins[k], &C->counts[k], NULL, 0, NULL, NULL);
+            if (ret != CL_SUCCESS) {
+                rsprint("ERROR: Unable to populate workers[%d] type %d.  ret = %d", i, k, ret);
+                exit(EXIT_FAILURE);
+            }
+        }
+        clFlush(C->que);
+    }
+    
+    for (i = 0; i < H->num_workers; i++) {
+        clFinish(H->workers[i].que);
+        clReleaseMemObject(dsd_cdf[i]);
+        clReleaseMemObject(dsd_r[i]);
+    }
+    
+    if (H->verb) {
+        rsprint("Population generated on %d worker%s.", H->num_workers, H->num_workers > 1 ? "s" : "");
+    }
+}
+
+#endif
+
+
 void RS_populate(RSHandle *H) {
     
     int i, k, n, w;
@@ -4435,22 +5924,56 @@ void RS_populate(RSHandle *H) {
         rsprint("RS_populate()   preferred_multiple = %s\n", commaint(H->preferred_multiple));
     }
     
+    // Larger populations are split into segments, only the device and host memory are the limit
     if (H->num_scats > RS_MAX_NUM_SCATS) {
-        rsprint("Number of scatterers exceed the maximum allowed. (%s > %s).\n", commaint(H->num_scats), commaint(RS_MAX_NUM_SCATS));
-        exit(EXIT_FAILURE);
+        rsprint("WARNING: Number of scatterers exceed the maximum tested. (%s > %s).\n", commaint(H->num_scats), commaint(RS_MAX_NUM_SCATS));
     }
     
-    size_t max_var_size;
-    CL_CHECK(clGetDeviceInfo(H->workers[0].dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(max_var_size), &max_var_size, NULL));
-    if (H->workers[0].num_scats * sizeof(cl_float4) > max_var_size) {
-        rsprint("ERROR: Every scatterer attribute occupies %s B > %s B.", commaint(H->workers[0].num_scats * sizeof(cl_float4)), commaint(max_var_size));
+    // Split the scatterers of a device into segments when an attribute does not fit in a single allocation
+    size_t max_var_size = SIZE_MAX;
+    if (H->method == RS_METHOD_NATIVE) {
+        // The whole population is in host memory already
+        if (H->stream_chunk) {
+            rsprint("ERROR: Streaming is not available with the native engine.");
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        // The smallest limit of all devices, they all get the same number of segments
+        for (i = 0; i < H->num_workers; i++) {
+            cl_ulong max_alloc = 0;
+            CL_CHECK(clGetDeviceInfo(H->workers[i].dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(max_alloc), &max_alloc, NULL));
+            max_var_size = MIN(max_var_size, (size_t)max_alloc);
+        }
+    }
+    const size_t var_size = (H->num_scats / H->num_workers + RS_CL_GROUP_ITEMS) * sizeof(cl_float4);
+    if (H->stream_chunk) {
+        // Streaming only keeps a chunk on the device, the rest of the population stays in host memory
+#if defined (_USE_GCL_)
+        rsprint("ERROR: Streaming is not available with shared VBOs.");
         exit(EXIT_FAILURE);
+#else
+        if (H->stream_chunk * sizeof(cl_float4) > max_var_size) {
+            rsprint("ERROR: Streaming chunk of %s scatterers exceeds the maximum allocation size.", commaint(H->stream_chunk));
+            exit(EXIT_FAILURE);
+        }
+        if (H->num_types > 1 || H->worker_partition != RSWorkerPartitionRandom || H->has_vbo_from_gl) {
+            rsprint("ERROR: Streaming is only available for background scatterers, without slabs or shared VBOs.");
+            exit(EXIT_FAILURE);
+        }
+#endif
+    } else if (var_size > max_var_size) {
+        RS_split_workers_into_segments(H, (int)((var_size + max_var_size - 1) / max_var_size));
     }
 
-    // Set an LES field if there isn't one set before
-    if (H->L == NULL) {
+    // Set an LES field if there isn't one set before, analytic wind models need none
+    if (H->L == NULL && H->vel_model == RSWindModelTable) {
         RS_set_vel_data_to_config(H, LESConfigSuctionVortices);
     }
+
+    // Only the fixed-position kernel samples the (cn2, p) table, the reader can skip p & t otherwise
+    if (H->L != NULL) {
+        LES_set_velocity_only(H->L, !(H->sim_concept & RSSimulationConceptFixedScattererPosition));
+    }
     
     // Set a scanning strategy if none has been provided
     if (H->P == NULL) {
@@ -4467,6 +5990,14 @@ void RS_populate(RSHandle *H) {
         //rsprint("Suggested box size = %.2f x %.2f x %.2f\n", box.size.r, box.size.a, box.size.e);
         RS_set_scan_box(H, box);
     }
+
+    // Only the part of the LES grid covered by the domain needs to be read and uploaded from now on
+    RS_update_vel_data_crop(H);
+
+    // Analytic wind models have no frames to derive the debris flux from, the model itself is sampled over the domain
+    if (H->vel_model != RSWindModelTable && H->sim_concept & RSSimulationConceptDebrisFluxFromVelocity) {
+        RS_set_debris_flux_field_from_analytic_model(H);
+    }
     
     // These should be identical
     if (H->workers[0].adm_count != H->workers[0].rcs_count) {
@@ -4486,42 +6017,57 @@ void RS_populate(RSHandle *H) {
         exit(EXIT_FAILURE);
     }
     
+    // The devices generate the population themselves unless it has to live on the host or follow the slabs
+    char on_device = 0;
+    
+#if !defined (_USE_GCL_)
+    
+    if (H->device_population) {
+        if (H->method == RS_METHOD_NATIVE || H->stream_chunk ||
+            H->worker_partition != RSWorkerPartitionRandom ||
+            H->sim_concept & RSSimulationConceptFixedScattererPosition) {
+            rsprint("WARNING. Device population is not available in this configuration. Populating on the host.");
+        } else {
+            on_device = 1;
+        }
+    }
+    
+#endif
+    
+    // The native engine and streaming work off the host arrays, they must all stay
+    if (H->host_mirrors != RSHostMirrorAll && (H->method == RS_METHOD_NATIVE || H->stream_chunk)) {
+        if (H->verb) {
+            rsprint("Host mirrors are the population itself in this configuration. Keeping all of them.");
+        }
+        H->host_mirrors = RSHostMirrorAll;
+    }
+    
     //
     // CPU memory allocation
     //
-    if (H->scat_pos != NULL) {
+    if (H->scat_uid != NULL) {
         RS_free_scat_memory(H);
     }
     
     posix_memalign((void **)&H->scat_uid, RS_ALIGN_SIZE, H->num_scats * sizeof(cl_uint4));
-    posix_memalign((void **)&H->scat_pos, RS_ALIGN_SIZE, H->num_scats * sizeof(cl_float4));
-    posix_memalign((void **)&H->scat_vel, RS_ALIGN_SIZE, H->num_scats * sizeof(cl_float4));
-    posix_memalign((void **)&H->scat_ori, RS_ALIGN_SIZE, H->num_scats * sizeof(cl_float4));
-    posix_memalign((void **)&H->scat_tum, RS_ALIGN_SIZE, H->num_scats * sizeof(cl_float4));
-    posix_memalign((void **)&H->scat_aux, RS_ALIGN_SIZE, H->num_scats * sizeof(cl_float4));
-    posix_memalign((void **)&H->scat_rcs, RS_ALIGN_SIZE, H->num_scats * sizeof(cl_float4));
-    posix_memalign((void **)&H->scat_sig, RS_ALIGN_SIZE, H->num_scats * sizeof(cl_float4));
-    posix_memalign((void **)&H->scat_rnd, RS_ALIGN_SIZE, H->num_scats * sizeof(cl_uint4));
     posix_memalign((void **)&H->pulse, RS_ALIGN_SIZE, H->params.range_count * sizeof(cl_float4));
     
     if (H->scat_uid == NULL ||
-        H->scat_pos == NULL ||
-        H->scat_vel == NULL ||
-        H->scat_ori == NULL ||
-        H->scat_tum == NULL ||
-        H->scat_aux == NULL ||
-        H->scat_rcs == NULL ||
-        H->scat_sig == NULL ||
-        H->scat_rnd == NULL ||
         H->pulse == NULL) {
         rsprint("ERROR: Unable to allocate memory space for scatterers.");
         return;
     }
     
-    memset(H->scat_aux, 0, H->num_scats * sizeof(cl_float4));
-    memset(H->scat_sig, 0, H->num_scats * sizeof(cl_float4));
+    H->mem_size = H->num_scats * sizeof(cl_uint4) + H->params.range_count * sizeof(cl_float4);
     
-    H->mem_size = H->num_scats * (8 * sizeof(cl_float4) + 2 * sizeof(cl_uint4)) + H->params.range_count * sizeof(cl_float4);
+    // A population made here needs every array until it is uploaded
+    RS_alloc_host_mirrors(H, on_device ? H->host_mirrors : RSHostMirrorAll);
+    
+    // Pages of the host arrays are only touched when the population is made here
+    if (!on_device) {
+        memset(H->scat_aux, 0, H->num_scats * sizeof(cl_float4));
+        memset(H->scat_sig, 0, H->num_scats * sizeof(cl_float4));
+    }
     
     char has_null = 0;
     for (i = 0; i < H->num_workers; i++) {
@@ -4534,6 +6080,16 @@ void RS_populate(RSHandle *H) {
         return;
     }
     
+    // Zeros for the tail of a short chunk when streaming
+    if (H->stream_chunk) {
+        H->stream_zeros = (cl_float4 *)malloc(H->stream_chunk * sizeof(cl_float4));
+        if (H->stream_zeros == NULL) {
+            rsprint("ERROR: Unable to allocate memory space for streaming.");
+            return;
+        }
+        memset(H->stream_zeros, 0, H->stream_chunk * sizeof(cl_float4));
+    }
+    
     // Get the available memory of the host
     
 #if defined(_SC_PHYS_PAGES)
@@ -4564,6 +6120,9 @@ void RS_populate(RSHandle *H) {
     // Update scatterer origin and offset of each worker
     RS_update_origins_offsets(H);
     
+    // Sector of the domain owned by each worker if the scatterers are partitioned spatially
+    RS_update_slabs(H);
+    
     // Initialize the scatter body positions on CPU, will upload to the GPU later
     srand(H->random_seed);
     
@@ -4664,6 +6223,12 @@ void RS_populate(RSHandle *H) {
                     H->scat_uid[i].s2 = k;
                     H->scat_uid[i].s3 = w;
                     
+                    // Only the ids are needed, scat_pop derives everything else from them
+                    if (on_device) {
+                        i++;
+                        continue;
+                    }
+                    
                     H->scat_pos[i].x = (float)rand() / RAND_MAX * domain.size.x + domain.origin.x;
                     H->scat_pos[i].y = (float)rand() / RAND_MAX * domain.size.y + domain.origin.y;
                     //H->scat_pos[i].z = (float)rand() / RAND_MAX * domain.size.z + domain.origin.z;
@@ -4671,6 +6236,12 @@ void RS_populate(RSHandle *H) {
                     //H->scat_pos[i].z = 20.0f;
                     H->scat_pos[i].w = 0.0f;                       // Use this to store drop radius in m
                     
+                    // Keep drawing until the position lands in the slab of this worker
+                    while (H->worker_partition != RSWorkerPartitionRandom && RS_slab_of_position(H, H->scat_pos[i]) != w) {
+                        H->scat_pos[i].x = (float)rand() / RAND_MAX * domain.size.x + domain.origin.x;
+                        H->scat_pos[i].y = (float)rand() / RAND_MAX * domain.size.y + domain.origin.y;
+                    }
+                    
                     H->scat_aux[i].s0 = 0.0f;                      // range
                     H->scat_aux[i].s1 = (float)rand() / RAND_MAX;  // age
                     H->scat_aux[i].s2 = 0.0f;                      // dsd bin index
@@ -4763,7 +6334,16 @@ void RS_populate(RSHandle *H) {
             // Store a copy of concentration scale in simulation description
             H->sim_desc.s[RSSimulationDescriptionDropConcentrationScale] = sqrt(drops_per_scat);
             
-            if (H->sim_concept & RSSimulationConceptUniformDSDScaledRCS) {
+            if (on_device) {
+                // Drawn by scat_pop, report the expected share of each bin
+                for (k = 0; k < H->dsd_count; k++) {
+                    if (H->sim_concept & RSSimulationConceptUniformDSDScaledRCS) {
+                        H->dsd_pop[k] = H->counts[0] / H->dsd_count;
+                    } else {
+                        H->dsd_pop[k] = (size_t)roundf(H->dsd_pdf[k] * (float)H->counts[0]);
+                    }
+                }
+            } else if (H->sim_concept & RSSimulationConceptUniformDSDScaledRCS) {
                 for (w = 0; w < H->num_workers; w++) {
                     i = (int)(H->offset[w] + H->workers[w].origins[0]);
                     for (n = 0; n < H->workers[w].counts[0]; n++) {
@@ -4837,341 +6417,1175 @@ void RS_populate(RSHandle *H) {
                     printf(RS_INDENT "o %.2f mm - PDF %.5f / %.5f / %s particles\n", 2000.0f * H->dsd_r[i], H->dsd_pdf[i], (float)H->dsd_pop[i] / (float)H->counts[0], commaint(H->dsd_pop[i]));
                 }
             }
-        } else {
-            rsprint("INFO: No DSD specified. The meteorological scatterers do not return any power.");
-            float drops_per_scat = (vol * 1000.0f) / H->counts[0];
-            
-            sprintf(H->summary + strlen(H->summary), "Drops / scatterer = %s  (%s / %s)\n", commafloat(drops_per_scat), commafloat((vol * H->dsd_nd_sum)), commaint(H->counts[0]));
-            rsprint("Drops / scatterer = %s  (%s / %s)\n", commafloat(drops_per_scat), commafloat((vol * H->dsd_nd_sum)), commaint(H->counts[0]));
+        } else {
+            rsprint("INFO: No DSD specified. The meteorological scatterers do not return any power.");
+            float drops_per_scat = (vol * 1000.0f) / H->counts[0];
+            
+            sprintf(H->summary + strlen(H->summary), "Drops / scatterer = %s  (%s / %s)\n", commafloat(drops_per_scat), commafloat((vol * H->dsd_nd_sum)), commaint(H->counts[0]));
+            rsprint("Drops / scatterer = %s  (%s / %s)\n", commafloat(drops_per_scat), commafloat((vol * H->dsd_nd_sum)), commaint(H->counts[0]));
+        }
+        
+    } // if (H->sim_concept & RSSimulationConceptFixedScattererPosition) ...
+    
+    #if defined(DEBUG_RCS)
+
+    // Replace a few points for debugging purpose.
+    H->scat_pos[0].x = domain.origin.x + 0.5f * domain.size.x;
+    H->scat_pos[0].y = domain.origin.y + 0.5f * domain.size.y;
+    H->scat_pos[0].z = H->scat_pos[0].y * tanf(5.0f / 180.0f * M_PI);
+
+    #endif
+    
+    #if defined(DEBUG_DEBRIS)
+
+    // Replace the very first debris particle
+    if (H->counts[1] > 0) {
+        k = (int)H->counts[0];
+        //printf("k = %d\n", k);
+        H->scat_pos[k].x = 0.0f;
+        H->scat_pos[k].y = H->params.range_start + floorf(H->params.range_count * 0.5f) * H->params.range_delta;
+        H->scat_pos[k].z = 0.5f * domain.size.z;
+        
+        H->scat_aux[k].s0 = H->params.range_start + floorf(H->params.range_count * 0.5f) * H->params.range_delta;
+    }
+
+    #endif
+    
+    // Restore simulation time, default beam position at unit vector (0, 1, 0)
+    H->sim_tic = 0.0f;
+    H->sim_toc = H->vel_desc.tp;
+    H->sim_desc.s[RSSimulationDescriptionBeamUnitX] = 0.0f;
+    H->sim_desc.s[RSSimulationDescriptionBeamUnitY] = 1.0f;
+    H->sim_desc.s[RSSimulationDescriptionBeamUnitZ] = 0.0f;
+    H->sim_desc.s[RSSimulationDescriptionTotalParticles] = H->num_scats;
+    
+    // Make a copy in float so we are maintaining all 32-bits
+    float tmpf; memcpy(&tmpf, &H->sim_concept, sizeof(float));
+    H->sim_desc.s[RSSimulationDescriptionConcept] = tmpf;
+    
+    // Propagate / duplicate some constants to other places for efficient kernel execution
+    for (i = 0; i < H->num_workers; i++) {
+        H->workers[i].range_weight_desc.s[RSTable1DDescriptionUserConstant] = H->sim_desc.s[RSSimulationDescriptionWaveNumber];
+        H->workers[i].rcs_ellipsoid_desc.s[RSTable1DDescriptionUserConstant] = H->sim_desc.s[RSSimulationDescriptionDropConcentrationScale];
+    }
+    
+    // All tables must be ready at this point
+    // - range weight table
+    // - antenna weight table
+    // - RCS of ellipsoid table
+    // - RCS of debris table
+    // - ADM of debris table
+    // - 3D wind table
+    // - Flux table
+    RS_compute_rcs_ellipsoids(H);
+    
+    // Placeholder for the refined wind grids so that the kernel arguments are always valid
+    if (H->workers[0].les_nest_uvwt[0] == NULL) {
+        RS_update_vel_data_nests(H);
+    }
+
+    //
+    // GPU memory allocation (probably should rename this to RS_worker_kernel_setup()
+    //
+    for (i = 0; i < H->num_workers; i++) {
+        RS_worker_malloc(H, i);
+    }
+    
+    #if defined (_USE_GCL_)
+    
+    CGLContextObj cgl_context = CGLGetCurrentContext();
+    if (cgl_context == NULL) {
+        rsprint("ERROR: No GL context yet.");
+        return;
+    }
+
+    CGLShareGroupObj sharegroup = CGLGetShareGroup(cgl_context);
+    if (sharegroup == NULL) {
+        rsprint("ERROR: Sharegroup should have been set before.");
+        return;
+    }
+    rsprint("RS_populate() - context %p   sharegroup %p", cgl_context, sharegroup);
+    gcl_gl_set_sharegroup(sharegroup);
+    rsprint("RS_populate() - gcl_gl_set_sharegroup() ... done");
+
+    RS_derive_ndranges(H);
+    
+    #endif
+
+    // Upload the particle parameters to the GPU, or have each GPU generate its share
+#if !defined (_USE_GCL_)
+    
+    if (on_device) {
+        RS_populate_on_device(H);
+    } else {
+        RS_upload(H);
+    }
+    
+#else
+    
+    RS_upload(H);
+    
+#endif
+    
+    // The devices hold the population now, the mirrors that are not kept come back with the downloads
+    RS_free_host_mirrors(H, ~H->host_mirrors);
+    
+    if (H->verb) {
+        rsprint("ADM / RCS count = %d / %d", H->workers[0].adm_count, H->workers[0].rcs_count);
+        rsprint("CL domain synchronized.");
+    }
+    
+    H->status |= RSStatusDomainPopulated;
+
+    // Set initial scan position to be the very first position
+    RS_advance_beam(H);
+
+    // Advance time with 0 s so that all attributes kernels (bg_atts, fp_atts, el_atts, or db_atts) are called once but positions aren't updated.
+    H->sim_desc.s[RSSimulationDescriptionPRT] = 0.0f;
+    RS_advance_time(H);
+    RS_make_pulse(H);
+    if (H->verb > 2) {
+        RS_download(H);
+        RS_show_scat_att(H);
+    }
+    H->sim_desc.s[RSSimulationDescriptionPRT] = H->params.prt;
+    
+    // The attributes advanced along with that pulse did not move with zero PRT
+    H->stream_advanced = 0;
+
+    // Now we undo that sim_tic counter due to RS_advance_time()
+    H->sim_tic -= H->params.prt;
+    H->sim_desc.s[RSSimulationDescriptionSimTic] = H->sim_tic;
+    
+    return;
+}
+
+
+void RS_download(RSHandle *H) {
+    
+    int i;
+    
+    // Streaming and the native engine keep the host arrays current, only the pulse is left to merge
+    if (H->stream_chunk || H->method == RS_METHOD_NATIVE) {
+        RS_merge_pulse_tmp(H);
+        return;
+    }
+    
+    RS_alloc_host_mirrors(H, RSHostMirrorPosition | RSHostMirrorVelocity | RSHostMirrorOrientation |
+                             RSHostMirrorAuxiliary | RSHostMirrorRadarCrossSection | RSHostMirrorSignal);
+    
+#if defined (_USE_GCL_)
+    
+    //printf("%p <-----------------------\n", H->scat_ori);
+    
+    for (i = 0; i < H->num_workers; i++) {
+        dispatch_async(H->workers[i].que, ^{
+            gcl_memcpy(H->scat_pos + H->offset[i], H->workers[i].scat_pos, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_vel + H->offset[i], H->workers[i].scat_vel, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_ori + H->offset[i], H->workers[i].scat_ori, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_aux + H->offset[i], H->workers[i].scat_aux, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_rcs + H->offset[i], H->workers[i].scat_rcs, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_sig + H->offset[i], H->workers[i].scat_sig, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->pulse_tmp[i], H->workers[i].pulse, H->params.range_count * sizeof(cl_float4));
+            dispatch_semaphore_signal(H->workers[i].sem);
+        });
+        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+    }
+    
+#else
+    
+    int k;
+    
+    cl_event events[H->num_workers][7];
+    
+    // Non-blocking read, wait for events later when they are all queued up.
+    for (i = 0; i < H->num_workers; i++) {
+        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_pos, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_pos + H->offset[i], 0, NULL, &events[i][0]);
+        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_vel, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_vel + H->offset[i], 0, NULL, &events[i][1]);
+        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_ori, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_ori + H->offset[i], 0, NULL, &events[i][2]);
+        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_aux, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_aux + H->offset[i], 0, NULL, &events[i][3]);
+        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_rcs, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_rcs + H->offset[i], 0, NULL, &events[i][4]);
+        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_sig, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_sig + H->offset[i], 0, NULL, &events[i][5]);
+        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].pulse, CL_FALSE, 0, H->params.range_count * sizeof(cl_float4), H->pulse_tmp[i], 0, NULL, &events[i][6]);
+    }
+    
+    cl_int ret;
+    
+    for (i = 0; i < H->num_workers; i++) {
+        ret = clWaitForEvents(7, events[i]);
+        if (ret != CL_SUCCESS) {
+            rsprint("ERROR: Unable to properly read back the values.");
+        }
+        for (k = 0; k < 7; k++) {
+            clReleaseEvent(events[i][k]);
+        }
+    }
+    
+#endif
+    
+    RS_merge_pulse_tmp(H);
+}
+
+
+void RS_download_position_only(RSHandle *H) {
+    
+    int i;
+    
+    if (H->stream_chunk || H->method == RS_METHOD_NATIVE) {
+        return;
+    }
+    
+    RS_alloc_host_mirrors(H, RSHostMirrorPosition);
+    
+#if defined (_USE_GCL_)
+    
+    for (i = 0; i < H->num_workers; i++) {
+        dispatch_async(H->workers[i].que, ^{
+            gcl_memcpy(H->scat_pos + H->offset[i], H->workers[i].scat_pos, H->workers[i].num_scats * sizeof(cl_float4));
+            dispatch_semaphore_signal(H->workers[i].sem);
+        });
+        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+    }
+    
+#else
+    
+    for (i = 0; i < H->num_workers; i++) {
+        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_pos, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_pos + H->offset[i], 0, NULL, NULL);
+    }
+    
+#endif
+    
+}
+
+void RS_download_orientation_only(RSHandle *H) {
+    
+    int i;
+    
+    if (H->stream_chunk || H->method == RS_METHOD_NATIVE) {
+        return;
+    }
+    
+    RS_alloc_host_mirrors(H, RSHostMirrorOrientation);
+    
+#if defined (_USE_GCL_)
+    
+    for (i = 0; i < H->num_workers; i++) {
+        dispatch_async(H->workers[i].que, ^{
+            gcl_memcpy(H->scat_ori + H->offset[i], H->workers[i].scat_ori, H->workers[i].num_scats * sizeof(cl_float4));
+            dispatch_semaphore_signal(H->workers[i].sem);
+        });
+        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+    }
+    
+#else
+    
+    for (i = 0; i < H->num_workers; i++) {
+        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_ori, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_ori + H->offset[i], 0, NULL, NULL);
+    }
+    
+#endif
+    
+}
+
+void RS_merge_pulse_tmp(RSHandle *H) {
+    memset(H->pulse, 0, H->params.range_count * sizeof(cl_float4));
+    for (int i = 0; i < H->num_workers; i++) {
+        // Workers with their slab out of the beam did not make this pulse
+        if (!H->workers[i].in_beam) {
+            continue;
+        }
+        for (int k = 0; k < H->params.range_count; k++) {
+            H->pulse[k].s0 += H->pulse_tmp[i][k].s0;
+            H->pulse[k].s1 += H->pulse_tmp[i][k].s1;
+            H->pulse[k].s2 += H->pulse_tmp[i][k].s2;
+            H->pulse[k].s3 += H->pulse_tmp[i][k].s3;
+        }
+    }
+    //
+    // Scale the amplitude by antenna gain, tx power
+    // Amplitude scaling, Ga = 10 ^ (Gt / 20) * 10 ^ (Gr / 20) * sqrt(Pt)
+    // For dish antennas: Gt = Gr
+    //
+    //                  => g = 10 ^ (G / 20) * 10 ^ (G / 20) * sqrt(Pt)
+    //                       = 10 ^ (G / 10) * sqrt(Pt)
+    //
+    // Amplitude scale to 1-km referece: sqrt(R ^ 4) = R ^ 2 = 1.0e6
+    //
+    float g = powf(10.0f, 0.1f * H->params.antenna_gain_dbi) * sqrtf(H->params.tx_power_watt) / (4.0f * M_PI) * 1.0e6f;
+    //printf("** g = %.4e (linear unit)\n", g);
+    for (int k = 0; k < H->params.range_count; k++) {
+        H->pulse[k].s0 *= g;
+        H->pulse[k].s1 *= g;
+        H->pulse[k].s2 *= g;
+        H->pulse[k].s3 *= g;
+    }
+}
+
+void RS_download_pulse_only(RSHandle *H) {
+    
+    int i;
+    
+#if defined (_USE_GCL_)
+    
+    for (i = 0; i < H->num_workers; i++) {
+        dispatch_async(H->workers[i].que, ^{
+            gcl_memcpy(H->pulse_tmp[i], H->workers[i].pulse, H->params.range_count * sizeof(cl_float4));
+            dispatch_semaphore_signal(H->workers[i].sem);
+        });
+    }
+    for (i = 0; i < H->num_workers; i++)
+        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+    
+#else
+    
+    // Blocking read since there is only one read, the streaming passes have filled pulse_tmp already
+    for (i = 0; i < RS_CL_WORKER_COUNT(H) && H->stream_chunk == 0; i++) {
+        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].pulse, CL_TRUE, 0, H->params.range_count * sizeof(cl_float4), H->pulse_tmp[i], 0, NULL, NULL);
+    }
+    
+#endif
+    
+    RS_merge_pulse_tmp(H);
+}
+
+
+void RS_upload(RSHandle *H) {
+    
+    int i;
+    
+    if (H->verb > 3) {
+        for (i = 0; i < H->num_workers; i++) {
+            rsprint("workers[%d].scat_pos @ %p\n", i, H->workers[i].scat_pos);
+            rsprint("workers[%d].scat_vel @ %p\n", i, H->workers[i].scat_vel);
+        }
+        rsprint("scat_pos @ %p\n", H->scat_pos);
+        rsprint("scat_vel @ %p\n", H->scat_vel);
+    }
+    
+    if (H->num_scats == 0) {
+        rsprint("Abort @ num_scats = 0 during RS_upload()\n");
+        return;
+    }
+    
+    // Chunks are uploaded as they are streamed through, native threads read the host arrays
+    if (H->stream_chunk || H->method == RS_METHOD_NATIVE) {
+        return;
+    }
+    
+    if (H->scat_pos == NULL || H->scat_vel == NULL || H->scat_ori == NULL || H->scat_tum == NULL ||
+        H->scat_aux == NULL || H->scat_rcs == NULL || H->scat_sig == NULL || H->scat_rnd == NULL) {
+        rsprint("ERROR: Host mirrors are not all allocated. Use RS_download_all() before RS_upload().");
+        return;
+    }
+    
+#if defined (_USE_GCL_)
+    
+    for (i = 0; i < H->num_workers; i++) {
+        dispatch_async(H->workers[i].que, ^{
+            gcl_memcpy(H->workers[i].scat_pos, H->scat_pos + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->workers[i].scat_vel, H->scat_vel + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->workers[i].scat_ori, H->scat_ori + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->workers[i].scat_tum, H->scat_tum + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->workers[i].scat_aux, H->scat_aux + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->workers[i].scat_rcs, H->scat_rcs + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->workers[i].scat_sig, H->scat_sig + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->workers[i].scat_rnd, H->scat_rnd + H->offset[i], H->workers[i].num_scats * sizeof(cl_uint4));
+            dispatch_semaphore_signal(H->workers[i].sem);
+        });
+        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+    }
+    
+#else
+    
+    // Blocking write since there is no need to optimize this too much
+    for (i = 0; i < H->num_workers; i++) {
+        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_pos, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_pos + H->offset[i], 0, NULL, NULL);
+        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_vel, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_vel + H->offset[i], 0, NULL, NULL);
+        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_ori, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_ori + H->offset[i], 0, NULL, NULL);
+        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_tum, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_tum + H->offset[i], 0, NULL, NULL);
+        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_aux, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_aux + H->offset[i], 0, NULL, NULL);
+        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_rcs, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_rcs + H->offset[i], 0, NULL, NULL);
+        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_sig, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_sig + H->offset[i], 0, NULL, NULL);
+        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_rnd, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_uint4),  H->scat_rnd + H->offset[i], 0, NULL, NULL);
+    }
+    
+#endif
+    
+}
+
+
+// Everything about the scatterers, including the tumble and random seeds that RS_download() leaves behind
+void RS_download_all(RSHandle *H) {
+    
+    int i;
+    
+    if (H->stream_chunk || H->method == RS_METHOD_NATIVE) {
+        return;
+    }
+    
+    RS_alloc_host_mirrors(H, RSHostMirrorAll);
+    
+#if defined (_USE_GCL_)
+    
+    for (i = 0; i < H->num_workers; i++) {
+        dispatch_async(H->workers[i].que, ^{
+            gcl_memcpy(H->scat_pos + H->offset[i], H->workers[i].scat_pos, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_vel + H->offset[i], H->workers[i].scat_vel, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_ori + H->offset[i], H->workers[i].scat_ori, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_tum + H->offset[i], H->workers[i].scat_tum, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_aux + H->offset[i], H->workers[i].scat_aux, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_rcs + H->offset[i], H->workers[i].scat_rcs, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_sig + H->offset[i], H->workers[i].scat_sig, H->workers[i].num_scats * sizeof(cl_float4));
+            gcl_memcpy(H->scat_rnd + H->offset[i], H->workers[i].scat_rnd, H->workers[i].num_scats * sizeof(cl_uint4));
+            dispatch_semaphore_signal(H->workers[i].sem);
+        });
+        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+    }
+    
+#else
+    
+    for (i = 0; i < H->num_workers; i++) {
+        RSWorker *C = &H->workers[i];
+        clEnqueueReadBuffer(C->que, C->scat_pos, CL_TRUE, 0, C->num_scats * sizeof(cl_float4), H->scat_pos + H->offset[i], 0, NULL, NULL);
+        clEnqueueReadBuffer(C->que, C->scat_vel, CL_TRUE, 0, C->num_scats * sizeof(cl_float4), H->scat_vel + H->offset[i], 0, NULL, NULL);
+        clEnqueueReadBuffer(C->que, C->scat_ori, CL_TRUE, 0, C->num_scats * sizeof(cl_float4), H->scat_ori + H->offset[i], 0, NULL, NULL);
+        clEnqueueReadBuffer(C->que, C->scat_tum, CL_TRUE, 0, C->num_scats * sizeof(cl_float4), H->scat_tum + H->offset[i], 0, NULL, NULL);
+        clEnqueueReadBuffer(C->que, C->scat_aux, CL_TRUE, 0, C->num_scats * sizeof(cl_float4), H->scat_aux + H->offset[i], 0, NULL, NULL);
+        clEnqueueReadBuffer(C->que, C->scat_rcs, CL_TRUE, 0, C->num_scats * sizeof(cl_float4), H->scat_rcs + H->offset[i], 0, NULL, NULL);
+        clEnqueueReadBuffer(C->que, C->scat_sig, CL_TRUE, 0, C->num_scats * sizeof(cl_float4), H->scat_sig + H->offset[i], 0, NULL, NULL);
+        clEnqueueReadBuffer(C->que, C->scat_rnd, CL_TRUE, 0, C->num_scats * sizeof(cl_uint4),  H->scat_rnd + H->offset[i], 0, NULL, NULL);
+    }
+    
+#endif
+    
+}
+
+#if !defined (_USE_GCL_)
+
+// Move the scatterers of each debris type from the old partition to the current one, 16-byte elements throughout
+static void RS_repartition_array(RSHandle *H, void *array, void *buffer,
+                                 const size_t *old_offset, size_t old_origins[][RS_MAX_DEBRIS_TYPES], size_t old_counts[][RS_MAX_DEBRIS_TYPES]) {
+    
+    int i, j, k;
+    size_t m, n, c;
+    
+    char *src = (char *)array;
+    char *dst = (char *)buffer;
+    const size_t size = sizeof(cl_float4);
+    
+    for (k = 0; k < RS_MAX_DEBRIS_TYPES; k++) {
+        // i, m = old worker and position within its segment of type k
+        i = 0;
+        m = 0;
+        for (j = 0; j < H->num_workers; j++) {
+            n = 0;
+            while (n < H->workers[j].counts[k] && i < H->num_workers) {
+                if (m == old_counts[i][k]) {
+                    i++;
+                    m = 0;
+                    continue;
+                }
+                c = MIN(old_counts[i][k] - m, H->workers[j].counts[k] - n);
+                memcpy(dst + (H->offset[j] + H->workers[j].origins[k] + n) * size,
+                       src + (old_offset[i] + old_origins[i][k] + m) * size,
+                       c * size);
+                n += c;
+                m += c;
+            }
         }
-        
-    } // if (H->sim_concept & RSSimulationConceptFixedScattererPosition) ...
-    
-    #if defined(DEBUG_RCS)
+    }
+    memcpy(array, buffer, H->num_scats * size);
+}
 
-    // Replace a few points for debugging purpose.
-    H->scat_pos[0].x = domain.origin.x + 0.5f * domain.size.x;
-    H->scat_pos[0].y = domain.origin.y + 0.5f * domain.size.y;
-    H->scat_pos[0].z = H->scat_pos[0].y * tanf(5.0f / 180.0f * M_PI);
 
-    #endif
+static void RS_worker_free_scat(RSHandle *H, const int worker_id) {
     
-    #if defined(DEBUG_DEBRIS)
+    RSWorker *C = &H->workers[worker_id];
+    
+    // Same sizes as in RS_worker_malloc() so that mem_usage can be rolled back
+    size_t group_size_multiple = RS_CL_GROUP_ITEMS;
+    clGetKernelWorkGroupInfo(C->kern_dummy, C->dev, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(group_size_multiple), &group_size_multiple, NULL);
+    size_t numel = ((C->num_scats + group_size_multiple - 1) / group_size_multiple) * group_size_multiple;
+    const unsigned long work_numel = C->make_pulse_params.global[0] * C->make_pulse_params.local[0] * H->params.range_count;
+    
+    clReleaseMemObject(C->scat_pos);
+    clReleaseMemObject(C->scat_clr);
+    clReleaseMemObject(C->scat_vel);
+    clReleaseMemObject(C->scat_ori);
+    clReleaseMemObject(C->scat_tum);
+    clReleaseMemObject(C->scat_aux);
+    clReleaseMemObject(C->scat_rcs);
+    clReleaseMemObject(C->scat_sig);
+    clReleaseMemObject(C->scat_rnd);
+    clReleaseMemObject(C->work);
+    clReleaseMemObject(C->pulse);
+    
+    // RS_worker_malloc() leaves the last one NULL if any allocation fails
+    C->pulse = NULL;
+    
+    C->mem_usage -= (8 * numel + work_numel + H->params.range_count) * sizeof(cl_float4) + numel * sizeof(cl_uint4);
+}
 
-    // Replace the very first debris particle
-    if (H->counts[1] > 0) {
-        k = (int)H->counts[0];
-        //printf("k = %d\n", k);
-        H->scat_pos[k].x = 0.0f;
-        H->scat_pos[k].y = H->params.range_start + floorf(H->params.range_count * 0.5f) * H->params.range_delta;
-        H->scat_pos[k].z = 0.5f * domain.size.z;
-        
-        H->scat_aux[k].s0 = H->params.range_start + floorf(H->params.range_count * 0.5f) * H->params.range_delta;
-    }
+#endif
 
-    #endif
+
+void RS_balance_workers(RSHandle *H) {
     
-    // Restore simulation time, default beam position at unit vector (0, 1, 0)
-    H->sim_tic = 0.0f;
-    H->sim_toc = H->vel_desc.tp;
-    H->sim_desc.s[RSSimulationDescriptionBeamUnitX] = 0.0f;
-    H->sim_desc.s[RSSimulationDescriptionBeamUnitY] = 1.0f;
-    H->sim_desc.s[RSSimulationDescriptionBeamUnitZ] = 0.0f;
-    H->sim_desc.s[RSSimulationDescriptionTotalParticles] = H->num_scats;
+    int i;
     
-    // Make a copy in float so we are maintaining all 32-bits
-    float tmpf; memcpy(&tmpf, &H->sim_concept, sizeof(float));
-    H->sim_desc.s[RSSimulationDescriptionConcept] = tmpf;
+    if (H->num_workers < 2 || !(H->status & RSStatusDomainPopulated)) {
+        return;
+    }
     
-    // Propagate / duplicate some constants to other places for efficient kernel execution
-    for (i = 0; i < H->num_workers; i++) {
-        H->workers[i].range_weight_desc.s[RSTable1DDescriptionUserConstant] = H->sim_desc.s[RSSimulationDescriptionWaveNumber];
-        H->workers[i].rcs_ellipsoid_desc.s[RSTable1DDescriptionUserConstant] = H->sim_desc.s[RSSimulationDescriptionDropConcentrationScale];
+#if defined (_USE_GCL_)
+    
+    rsprint("Worker balancing is not available with shared VBOs.");
+    
+#else
+    
+    if (H->has_vbo_from_gl) {
+        rsprint("Worker balancing is not available with shared VBOs.");
+        return;
     }
     
-    // All tables must be ready at this point
-    // - range weight table
-    // - antenna weight table
-    // - RCS of ellipsoid table
-    // - RCS of debris table
-    // - ADM of debris table
-    // - 3D wind table
-    // - Flux table
-    RS_compute_rcs_ellipsoids(H);
+    // Slabs are sized by area, the density would be off if their counts followed the throughput.
+    // Streaming and the native engine have no kernel timing to go by.
+    if (H->worker_partition != RSWorkerPartitionRandom || H->stream_chunk || H->method == RS_METHOD_NATIVE) {
+        return;
+    }
     
-    //
-    // GPU memory allocation (probably should rename this to RS_worker_kernel_setup()
-    //
+    // Throughput of each worker in scatterers per second
+    double rate[RS_MAX_WORKERS];
+    double rate_sum = 0.0;
     for (i = 0; i < H->num_workers; i++) {
-        RS_worker_malloc(H, i);
+        if (H->workers[i].busy_time <= 0.0) {
+            rsprint("No kernel timing for workers[%d] yet. Balancing skipped.", i);
+            return;
+        }
+        rate[i] = H->workers[i].busy_scats / H->workers[i].busy_time;
+        rate_sum += rate[i];
     }
     
-    #if defined (_USE_GCL_)
-    
-    CGLContextObj cgl_context = CGLGetCurrentContext();
-    if (cgl_context == NULL) {
-        rsprint("ERROR: No GL context yet.");
-        return;
+    // Largest share each worker can hold, an attribute of its scatterers has to fit in a single allocation on its device.
+    // Some room is left for the work group padding and the rounding of the weights.
+    double cap[RS_MAX_WORKERS];
+    double cap_sum = 0.0;
+    for (i = 0; i < H->num_workers; i++) {
+        cl_ulong max_alloc = 0;
+        if (clGetDeviceInfo(H->workers[i].dev, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(max_alloc), &max_alloc, NULL) != CL_SUCCESS) {
+            rsprint("ERROR: Unable to get the maximum allocation size of workers[%d]. Balancing skipped.", i);
+            return;
+        }
+        cap[i] = 0.99 * ((double)(max_alloc / sizeof(cl_float4)) - (double)RS_CL_GROUP_ITEMS) / (double)H->num_scats;
+        cap_sum += cap[i];
     }
-
-    CGLShareGroupObj sharegroup = CGLGetShareGroup(cgl_context);
-    if (sharegroup == NULL) {
-        rsprint("ERROR: Sharegroup should have been set before.");
+    if (cap_sum < 1.0) {
+        rsprint("WARNING: Workers cannot hold the population in any other partition. Balancing skipped.");
         return;
     }
-    rsprint("RS_populate() - context %p   sharegroup %p", cgl_context, sharegroup);
-    gcl_gl_set_sharegroup(sharegroup);
-    rsprint("RS_populate() - gcl_gl_set_sharegroup() ... done");
-
-    RS_derive_ndranges(H);
     
-    #endif
-
-    // Upload the particle parameters to the GPU
-    RS_upload(H);
+    // Shares in proportion to the throughput, the workers at their limit leave the rest to the others
+    char capped[RS_MAX_WORKERS];
+    memset(capped, 0, sizeof(capped));
+    char changed;
+    do {
+        changed = 0;
+        double share = 1.0;
+        double free_rate = 0.0;
+        for (i = 0; i < H->num_workers; i++) {
+            if (capped[i]) {
+                share -= cap[i];
+            } else {
+                free_rate += rate[i];
+            }
+        }
+        for (i = 0; i < H->num_workers; i++) {
+            if (!capped[i] && (free_rate <= 0.0 || rate[i] / free_rate * share > cap[i])) {
+                capped[i] = 1;
+                changed = 1;
+            }
+        }
+        rate_sum = free_rate / MAX(share, 1.0e-9);
+    } while (changed);
+    
+    // All at their limit, which adds up to at least the population, each takes a share of it in proportion to its limit
+    char all_capped = 1;
+    for (i = 0; i < H->num_workers; i++) {
+        all_capped &= capped[i];
+    }
     
+    float weights[RS_MAX_WORKERS];
+    float imbalance = 0.0f;
+    for (i = 0; i < H->num_workers; i++) {
+        weights[i] = (float)(all_capped ? cap[i] / cap_sum : (capped[i] ? cap[i] : rate[i] / rate_sum));
+        imbalance = MAX(imbalance, fabsf(weights[i] - (float)H->workers[i].num_scats / (float)H->num_scats));
+        H->workers[i].busy_time = 0.0;
+        H->workers[i].busy_scats = 0.0;
+    }
     if (H->verb) {
-        rsprint("ADM / RCS count = %d / %d", H->workers[0].adm_count, H->workers[0].rcs_count);
-        rsprint("CL domain synchronized.");
+        rsprint("Worker throughput:");
+        for (i = 0; i < H->num_workers; i++) {
+            printf(RS_INDENT "o workers[%d] %s scatterers / s   share %.2f%% -> %.2f%%\n", i, commafloat((float)rate[i]),
+                   100.0f * (float)H->workers[i].num_scats / (float)H->num_scats, 100.0f * weights[i]);
+        }
+    }
+    if (imbalance < RS_BALANCE_TOLERANCE) {
+        return;
     }
     
-    H->status |= RSStatusDomainPopulated;
+    // Mirrors that are made just for this go away once the new partition is uploaded
+    const RSHostMirror fresh = RS_alloc_host_mirrors(H, RSHostMirrorAll) & ~H->host_mirrors;
+    
+    RS_download_all(H);
+    
+    // Keep the old partition, then derive the new one
+    size_t old_offset[RS_MAX_WORKERS];
+    size_t old_origins[RS_MAX_WORKERS][RS_MAX_DEBRIS_TYPES];
+    size_t old_counts[RS_MAX_WORKERS][RS_MAX_DEBRIS_TYPES];
+    for (i = 0; i < H->num_workers; i++) {
+        old_offset[i] = H->offset[i];
+        memcpy(old_origins[i], H->workers[i].origins, RS_MAX_DEBRIS_TYPES * sizeof(size_t));
+        memcpy(old_counts[i], H->workers[i].counts, RS_MAX_DEBRIS_TYPES * sizeof(size_t));
+        RS_worker_free_scat(H, i);
+        H->worker_weights[i] = weights[i];
+    }
+    RS_update_origins_offsets(H);
+    
+    void *buffer = NULL;
+    if (posix_memalign(&buffer, RS_ALIGN_SIZE, H->num_scats * sizeof(cl_float4))) {
+        rsprint("ERROR: Unable to allocate a buffer for worker balancing.");
+        exit(EXIT_FAILURE);
+    }
+    RS_repartition_array(H, H->scat_uid, buffer, old_offset, old_origins, old_counts);
+    RS_repartition_array(H, H->scat_pos, buffer, old_offset, old_origins, old_counts);
+    RS_repartition_array(H, H->scat_vel, buffer, old_offset, old_origins, old_counts);
+    RS_repartition_array(H, H->scat_ori, buffer, old_offset, old_origins, old_counts);
+    RS_repartition_array(H, H->scat_tum, buffer, old_offset, old_origins, old_counts);
+    RS_repartition_array(H, H->scat_aux, buffer, old_offset, old_origins, old_counts);
+    RS_repartition_array(H, H->scat_rcs, buffer, old_offset, old_origins, old_counts);
+    RS_repartition_array(H, H->scat_sig, buffer, old_offset, old_origins, old_counts);
+    RS_repartition_array(H, H->scat_rnd, buffer, old_offset, old_origins, old_counts);
+    free(buffer);
+    
+    // New buffer sizes, new work sizes and new kernel arguments
+    for (i = 0; i < H->num_workers; i++) {
+        RS_worker_malloc(H, i);
+        if (H->workers[i].pulse == NULL) {
+            rsprint("ERROR: Unable to allocate the scatterers of workers[%d] after balancing.", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    RS_upload(H);
+    RS_free_host_mirrors(H, fresh);
+    
+    H->status |= RSStatusDebrisRCSNeedsUpdate | RSStatusScattererSignalNeedsUpdate;
+    
+#endif
+    
+}
 
-    // Set initial scan position to be the very first position
-    RS_advance_beam(H);
 
-    // Advance time with 0 s so that all attributes kernels (bg_atts, fp_atts, el_atts, or db_atts) are called once but positions aren't updated.
-    H->sim_desc.s[RSSimulationDescriptionPRT] = 0.0f;
-    RS_advance_time(H);
-    RS_make_pulse(H);
-    if (H->verb > 2) {
-        RS_download(H);
-        RS_show_scat_att(H);
+
+static int RS_worker_of_scatterer(RSHandle *H, const size_t a) {
+    int i = H->num_workers - 1;
+    while (i > 0 && a < H->offset[i]) {
+        i--;
     }
-    H->sim_desc.s[RSSimulationDescriptionPRT] = H->params.prt;
+    return i;
+}
 
-    // Now we undo that sim_tic counter due to RS_advance_time()
-    H->sim_tic -= H->params.prt;
-    H->sim_desc.s[RSSimulationDescriptionSimTic] = H->sim_tic;
-    
-    return;
+
+#if !defined (_USE_GCL_)
+
+// Non-blocking gather (to_host) or scatter of the attributes of count scatterers of a worker, at the indices in idx,
+// through the records in staging, 8 per scatterer in the order of RS_host_mirror_address()
+static void RS_move_scatterers(RSWorker *C, const cl_mem idx, const cl_mem staging, const size_t count, cl_float4 *records, const char to_host) {
+    cl_int ret = CL_SUCCESS;
+    const cl_uint gather = to_host;
+    ret |= clSetKernelArg(C->kern_scat_move, RSScattererMoveKernelArgumentPosition,          sizeof(cl_mem),  &C->scat_pos);
+    ret |= clSetKernelArg(C->kern_scat_move, RSScattererMoveKernelArgumentVelocity,          sizeof(cl_mem),  &C->scat_vel);
+    ret |= clSetKernelArg(C->kern_scat_move, RSScattererMoveKernelArgumentOrientation,       sizeof(cl_mem),  &C->scat_ori);
+    ret |= clSetKernelArg(C->kern_scat_move, RSScattererMoveKernelArgumentTumble,            sizeof(cl_mem),  &C->scat_tum);
+    ret |= clSetKernelArg(C->kern_scat_move, RSScattererMoveKernelArgumentAuxiliary,         sizeof(cl_mem),  &C->scat_aux);
+    ret |= clSetKernelArg(C->kern_scat_move, RSScattererMoveKernelArgumentRadarCrossSection, sizeof(cl_mem),  &C->scat_rcs);
+    ret |= clSetKernelArg(C->kern_scat_move, RSScattererMoveKernelArgumentSignal,            sizeof(cl_mem),  &C->scat_sig);
+    ret |= clSetKernelArg(C->kern_scat_move, RSScattererMoveKernelArgumentRandomSeed,        sizeof(cl_mem),  &C->scat_rnd);
+    ret |= clSetKernelArg(C->kern_scat_move, RSScattererMoveKernelArgumentRecords,           sizeof(cl_mem),  &staging);
+    ret |= clSetKernelArg(C->kern_scat_move, RSScattererMoveKernelArgumentIndices,           sizeof(cl_mem),  &idx);
+    ret |= clSetKernelArg(C->kern_scat_move, RSScattererMoveKernelArgumentGather,            sizeof(cl_uint), &gather);
+    if (ret != CL_SUCCESS) {
+        fprintf(stderr, "%s : RS : Error: Failed to set arguments for kernel scat_move().\n", now());
+        exit(EXIT_FAILURE);
+    }
+    if (to_host) {
+        clEnqueueNDRangeKernel(C->que, C->kern_scat_move, 1, NULL, &count, NULL, 0, NULL, NULL);
+        clEnqueueReadBuffer(C->que, staging, CL_FALSE, 0, count * 8 * sizeof(cl_float4), records, 0, NULL, NULL);
+    } else {
+        clEnqueueWriteBuffer(C->que, staging, CL_FALSE, 0, count * 8 * sizeof(cl_float4), records, 0, NULL, NULL);
+        clEnqueueNDRangeKernel(C->que, C->kern_scat_move, 1, NULL, &count, NULL, 0, NULL, NULL);
+    }
 }
 
+#endif
+
 
-void RS_download(RSHandle *H) {
+void RS_migrate_slab_scatterers(RSHandle *H) {
     
-    int i;
+    int i, j, k;
+    size_t a, a_end, b, b_end, n;
+    size_t swapped = 0, redrawn = 0;
+    
+    if (H->worker_partition == RSWorkerPartitionRandom || H->num_workers < 2) {
+        return;
+    }
     
 #if defined (_USE_GCL_)
     
-    //printf("%p <-----------------------\n", H->scat_ori);
+    // Everything goes through the host with GCL
+    const RSHostMirror fresh = RS_alloc_host_mirrors(H, RSHostMirrorAll) & ~H->host_mirrors;
+    
+    RS_download_all(H);
+    
+#else
+    
+    // Positions tell which scatterers crossed an edge and velocities bound the drift until the next migration,
+    // only the scatterers that crossed are moved in full
+    const RSHostMirror fresh = RS_alloc_host_mirrors(H, RSHostMirrorPosition | RSHostMirrorVelocity) & ~H->host_mirrors;
+    
+    if (H->method != RS_METHOD_NATIVE) {
+        for (i = 0; i < H->num_workers; i++) {
+            RSWorker *C = &H->workers[i];
+            clEnqueueReadBuffer(C->que, C->scat_pos, CL_FALSE, 0, C->num_scats * sizeof(cl_float4), H->scat_pos + H->offset[i], 0, NULL, NULL);
+            clEnqueueReadBuffer(C->que, C->scat_vel, CL_FALSE, 0, C->num_scats * sizeof(cl_float4), H->scat_vel + H->offset[i], 0, NULL, NULL);
+        }
+        for (i = 0; i < H->num_workers; i++) {
+            clFinish(H->workers[i].que);
+        }
+    }
+    
+#endif
     
+    // Slab of every scatterer as it is now and the fastest horizontal speed
+    uint8_t *slab = (uint8_t *)malloc(H->num_scats * sizeof(uint8_t));
+    if (slab == NULL) {
+        rsprint("ERROR: Unable to allocate memory for slab migration.");
+        RS_free_host_mirrors(H, fresh);
+        return;
+    }
+    float speed = 0.0f;
+    size_t crossed = 0;
     for (i = 0; i < H->num_workers; i++) {
-        dispatch_async(H->workers[i].que, ^{
-            gcl_memcpy(H->scat_pos + H->offset[i], H->workers[i].scat_pos, H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->scat_vel + H->offset[i], H->workers[i].scat_vel, H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->scat_ori + H->offset[i], H->workers[i].scat_ori, H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->scat_aux + H->offset[i], H->workers[i].scat_aux, H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->scat_rcs + H->offset[i], H->workers[i].scat_rcs, H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->scat_sig + H->offset[i], H->workers[i].scat_sig, H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->pulse_tmp[i], H->workers[i].pulse, H->params.range_count * sizeof(cl_float4));
-            dispatch_semaphore_signal(H->workers[i].sem);
-        });
-        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+        for (a = H->offset[i]; a < H->offset[i] + H->workers[i].num_scats; a++) {
+            slab[a] = (uint8_t)RS_slab_of_position(H, H->scat_pos[a]);
+            crossed += slab[a] != i;
+            speed = MAX(speed, H->scat_vel[a].x * H->scat_vel[a].x + H->scat_vel[a].y * H->scat_vel[a].y);
+        }
     }
+    H->slab_speed = RS_SLAB_SPEED_MARGIN * sqrtf(speed);
     
-#else
+    // Scatterers that trade places, in pairs, followed by the ones to draw again
+    size_t *moves = (size_t *)malloc(MAX(1, crossed) * sizeof(size_t));
+    if (moves == NULL) {
+        rsprint("ERROR: Unable to allocate memory for slab migration.");
+        free(slab);
+        RS_free_host_mirrors(H, fresh);
+        return;
+    }
     
-    int k;
+    for (k = 0; k < RS_MAX_DEBRIS_TYPES; k++) {
+        // Pairs of scatterers that crossed into each other's slab trade places, which keeps the counts of every worker
+        for (i = 0; i < H->num_workers; i++) {
+            for (j = i + 1; j < H->num_workers; j++) {
+                a = H->offset[i] + H->workers[i].origins[k];
+                b = H->offset[j] + H->workers[j].origins[k];
+                a_end = a + H->workers[i].counts[k];
+                b_end = b + H->workers[j].counts[k];
+                while (1) {
+                    while (a < a_end && slab[a] != j) {
+                        a++;
+                    }
+                    while (b < b_end && slab[b] != i) {
+                        b++;
+                    }
+                    if (a == a_end || b == b_end) {
+                        break;
+                    }
+                    slab[a] = i;
+                    slab[b] = j;
+                    moves[swapped++] = a;
+                    moves[swapped++] = b;
+                }
+            }
+        }
+    }
+    for (i = 0; i < H->num_workers; i++) {
+        for (a = H->offset[i]; a < H->offset[i] + H->workers[i].num_scats; a++) {
+            if (slab[a] != i) {
+                moves[swapped + redrawn++] = a;
+            }
+        }
+    }
     
-    cl_event events[H->num_workers][7];
     
-    // Non-blocking read, wait for events later when they are all queued up.
+    // Everything that moves, grouped by worker, each as a record of its 8 attributes
+    const size_t count = swapped + redrawn;
+    size_t first[RS_MAX_WORKERS + 1], fill[RS_MAX_WORKERS];
+    memset(first, 0, sizeof(first));
+    size_t *where = (size_t *)malloc(MAX(1, count) * sizeof(size_t));
+    cl_uint *local = (cl_uint *)malloc(MAX(1, count) * sizeof(cl_uint));
+    cl_float4 *records = NULL, *moved = NULL;
+    if (where == NULL || local == NULL ||
+        posix_memalign((void **)&records, RS_ALIGN_SIZE, MAX(1, count) * 8 * sizeof(cl_float4)) ||
+        posix_memalign((void **)&moved, RS_ALIGN_SIZE, MAX(1, count) * 8 * sizeof(cl_float4))) {
+        rsprint("ERROR: Unable to allocate memory for slab migration.");
+        exit(EXIT_FAILURE);
+    }
+    for (n = 0; n < count; n++) {
+        first[RS_worker_of_scatterer(H, moves[n]) + 1]++;
+    }
     for (i = 0; i < H->num_workers; i++) {
-        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_pos, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_pos + H->offset[i], 0, NULL, &events[i][0]);
-        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_vel, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_vel + H->offset[i], 0, NULL, &events[i][1]);
-        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_ori, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_ori + H->offset[i], 0, NULL, &events[i][2]);
-        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_aux, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_aux + H->offset[i], 0, NULL, &events[i][3]);
-        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_rcs, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_rcs + H->offset[i], 0, NULL, &events[i][4]);
-        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_sig, CL_FALSE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_sig + H->offset[i], 0, NULL, &events[i][5]);
-        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].pulse, CL_FALSE, 0, H->params.range_count * sizeof(cl_float4), H->pulse_tmp[i], 0, NULL, &events[i][6]);
+        first[i + 1] += first[i];
     }
+    memcpy(fill, first, H->num_workers * sizeof(size_t));
+    for (n = 0; n < count; n++) {
+        i = RS_worker_of_scatterer(H, moves[n]);
+        where[n] = fill[i]++;
+        local[where[n]] = (cl_uint)(moves[n] - H->offset[i]);
+    }
+    
+#if !defined (_USE_GCL_)
     
+    // One gather per worker on the devices, the host mirrors are the population with the native engine
     cl_int ret;
-    
-    for (i = 0; i < H->num_workers; i++) {
-        ret = clWaitForEvents(7, events[i]);
-        if (ret != CL_SUCCESS) {
-            rsprint("ERROR: Unable to properly read back the values.");
+    cl_mem idx[RS_MAX_WORKERS], staging[RS_MAX_WORKERS];
+    memset(idx, 0, sizeof(idx));
+    memset(staging, 0, sizeof(staging));
+    if (H->method != RS_METHOD_NATIVE) {
+        for (i = 0; i < H->num_workers; i++) {
+            const size_t m = first[i + 1] - first[i];
+            if (m == 0) {
+                continue;
+            }
+            RSWorker *C = &H->workers[i];
+            idx[i] = clCreateBuffer(C->context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, m * sizeof(cl_uint), &local[first[i]], &ret);
+            if (ret == CL_SUCCESS) {
+                staging[i] = clCreateBuffer(C->context, CL_MEM_READ_WRITE, m * 8 * sizeof(cl_float4), NULL, &ret);
+            }
+            if (ret != CL_SUCCESS) {
+                rsprint("ERROR: workers[%d] unable to create the buffers for slab migration.  ret = %d", i, ret);
+                exit(EXIT_FAILURE);
+            }
+            RS_move_scatterers(C, idx[i], staging[i], m, records + 8 * first[i], 1);
         }
-        for (k = 0; k < 7; k++) {
-            clReleaseEvent(events[i][k]);
+        for (i = 0; i < H->num_workers; i++) {
+            clFinish(H->workers[i].que);
+        }
+    } else
+        
+#endif
+        
+    {
+        for (n = 0; n < count; n++) {
+            for (k = 0; k < 8; k++) {
+                records[8 * where[n] + k] = (*(cl_float4 **)RS_host_mirror_address(H, k))[moves[n]];
+            }
         }
     }
     
-#endif
+    // Pairs trade places
+    for (n = 0; n < swapped; n++) {
+        memcpy(&moved[8 * where[n]], &records[8 * where[n ^ 1]], 8 * sizeof(cl_float4));
+    }
+    for (n = 0; n < swapped; n += 2) {
+        const cl_uint4 u = H->scat_uid[moves[n]];
+        H->scat_uid[moves[n]] = H->scat_uid[moves[n + 1]];
+        H->scat_uid[moves[n + 1]] = u;
+    }
     
-    RS_merge_pulse_tmp(H);
-}
-
-
-void RS_download_position_only(RSHandle *H) {
+    // The rest are drawn again inside their own slab, debris the way db_atts brings them back in
+    const RSVolume domain = RS_get_domain(H);
+    for (n = swapped; n < count; n++) {
+        a = moves[n];
+        i = RS_worker_of_scatterer(H, a);
+        cl_float4 *r = &moved[8 * where[n]];
+        memcpy(r, &records[8 * where[n]], 8 * sizeof(cl_float4));
+        if (a - H->offset[i] >= H->workers[i].origins[0] + H->workers[i].counts[0]) {
+            RS_native_respawn_debris(H, &H->workers[i], &r[0], &r[2], &r[1], &r[3], &r[5], (cl_uint4 *)&r[7]);
+        } else {
+            do {
+                r[0].x = (float)rand() / RAND_MAX * domain.size.x + domain.origin.x;
+                r[0].y = (float)rand() / RAND_MAX * domain.size.y + domain.origin.y;
+            } while (RS_slab_of_position(H, r[0]) != i);
+            r[1].x = 0.0f;
+            r[1].y = 0.0f;
+            r[1].z = 0.0f;
+        }
+    }
     
-    int i;
+    // Back into the host mirrors that exist and one scatter per worker on the devices
+    for (k = 0; k < 8; k++) {
+        cl_float4 *x = *(cl_float4 **)RS_host_mirror_address(H, k);
+        if (x == NULL) {
+            continue;
+        }
+        for (n = 0; n < count; n++) {
+            x[moves[n]] = moved[8 * where[n] + k];
+        }
+    }
     
 #if defined (_USE_GCL_)
     
-    for (i = 0; i < H->num_workers; i++) {
-        dispatch_async(H->workers[i].que, ^{
-            gcl_memcpy(H->scat_pos + H->offset[i], H->workers[i].scat_pos, H->workers[i].num_scats * sizeof(cl_float4));
-            dispatch_semaphore_signal(H->workers[i].sem);
-        });
-        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
-    }
+    RS_upload(H);
     
 #else
     
-    for (i = 0; i < H->num_workers; i++) {
-        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_pos, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_pos + H->offset[i], 0, NULL, NULL);
+    if (H->method != RS_METHOD_NATIVE) {
+        for (i = 0; i < H->num_workers; i++) {
+            if (first[i + 1] > first[i]) {
+                RS_move_scatterers(&H->workers[i], idx[i], staging[i], first[i + 1] - first[i], moved + 8 * first[i], 0);
+            }
+        }
+        for (i = 0; i < H->num_workers; i++) {
+            clFinish(H->workers[i].que);
+            if (idx[i] != NULL) {
+                clReleaseMemObject(idx[i]);
+                clReleaseMemObject(staging[i]);
+            }
+        }
     }
     
 #endif
     
-}
-
-void RS_download_orientation_only(RSHandle *H) {
+    free(moves);
+    free(where);
+    free(local);
+    free(records);
+    free(moved);
     
-    int i;
+    RS_free_host_mirrors(H, fresh);
     
-#if defined (_USE_GCL_)
+    H->status |= RSStatusScattererSignalNeedsUpdate;
     
-    for (i = 0; i < H->num_workers; i++) {
-        dispatch_async(H->workers[i].que, ^{
-            gcl_memcpy(H->scat_ori + H->offset[i], H->workers[i].scat_ori, H->workers[i].num_scats * sizeof(cl_float4));
-            dispatch_semaphore_signal(H->workers[i].sem);
-        });
-        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+    if (H->verb > 1) {
+        rsprint("Slab migration: %s swapped, %s redrawn, speed bound %.1f m/s", commaint(swapped), commaint(redrawn), H->slab_speed);
     }
+}
+
+
+// Advance to next wind table when the time comes, analytic wind models have no frames
+static void RS_update_vel_frame(RSHandle *H) {
     
-#else
+    int i;
     
+    if (H->L == NULL || H->sim_tic < H->sim_toc) {
+        return;
+    }
+    H->sim_toc += H->vel_desc.tp;
+    if (H->vel_idx == 0) {
+        rsprint("Wind table restarted.");
+    }
     for (i = 0; i < H->num_workers; i++) {
-        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].scat_ori, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_ori + H->offset[i], 0, NULL, NULL);
+        H->workers[i].les_id = H->workers[i].les_id == 1 ? 0 : 1;
     }
+    RS_set_vel_data_to_LES_table(H, LES_get_frame(H->L, H->vel_idx));
+    RS_update_vel_data_nest_frames(H, H->vel_idx);
+    H->vel_idx = H->vel_idx == H->vel_count - 1 ? 0 : H->vel_idx + 1;
     
-#endif
-    
+    if (H->verb > 2) {
+        rsprint("Wind table advanced. vel_idx = %d   ( tp = %.2f / prt = %.4f )  vel_id = %d", H->vel_idx, H->vel_desc.tp, H->params.prt, H->workers[0].les_id);
+    }
 }
 
-void RS_merge_pulse_tmp(RSHandle *H) {
-    memcpy(H->pulse, H->pulse_tmp[0], H->params.range_count * sizeof(cl_float4));
-    for (int i = 1; i < H->num_workers; i++) {
-        for (int k = 0; k < H->params.range_count; k++) {
-            H->pulse[k].s0 += H->pulse_tmp[i][k].s0;
-            H->pulse[k].s1 += H->pulse_tmp[i][k].s1;
-            H->pulse[k].s2 += H->pulse_tmp[i][k].s2;
-            H->pulse[k].s3 += H->pulse_tmp[i][k].s3;
-        }
-    }
-    //
-    // Scale the amplitude by antenna gain, tx power
-    // Amplitude scaling, Ga = 10 ^ (Gt / 20) * 10 ^ (Gr / 20) * sqrt(Pt)
-    // For dish antennas: Gt = Gr
-    //
-    //                  => g = 10 ^ (G / 20) * 10 ^ (G / 20) * sqrt(Pt)
-    //                       = 10 ^ (G / 10) * sqrt(Pt)
-    //
-    // Amplitude scale to 1-km referece: sqrt(R ^ 4) = R ^ 2 = 1.0e6
-    //
-    float g = powf(10.0f, 0.1f * H->params.antenna_gain_dbi) * sqrtf(H->params.tx_power_watt) / (4.0f * M_PI) * 1.0e6f;
-    //printf("** g = %.4e (linear unit)\n", g);
-    for (int k = 0; k < H->params.range_count; k++) {
-        H->pulse[k].s0 *= g;
-        H->pulse[k].s1 *= g;
-        H->pulse[k].s2 *= g;
-        H->pulse[k].s3 *= g;
-    }
+
+#if !defined (_USE_GCL_)
+
+// Attribute kernel of the background scatterers, with the wind table of the current frame
+static cl_kernel RS_stream_atts_kernel(RSHandle *H, RSWorker *C) {
+    cl_kernel kern = C->kern_bg_atts;
+    if (H->sim_concept & RSSimulationConceptDraggedBackground) {
+        kern = C->kern_el_atts;
+    } else if (H->sim_concept & RSSimulationConceptFixedScattererPosition) {
+        kern = C->kern_fp_atts;
+    }
+    clSetKernelArg(kern, RSBackgroundAttributeKernelArgumentBackgroundVelocity,          sizeof(cl_mem),     &C->les_uvwt[C->les_id]);
+    clSetKernelArg(kern, RSBackgroundAttributeKernelArgumentBackgroundCn2Pressure,       sizeof(cl_mem),     &C->les_cpxx[C->les_id]);
+    clSetKernelArg(kern, RSBackgroundAttributeKernelArgumentBackgroundDescription,       sizeof(cl_float16), &C->les_desc);
+    clSetKernelArg(kern, RSBackgroundAttributeKernelArgumentBackgroundNestVelocity,      sizeof(cl_mem),     &C->les_nest_uvwt[C->les_id]);
+    clSetKernelArg(kern, RSBackgroundAttributeKernelArgumentBackgroundNestDescription,   sizeof(cl_mem),     &C->les_nest_desc);
+    clSetKernelArg(kern, RSBackgroundAttributeKernelArgumentSimulationDescription,       sizeof(cl_float16), &H->sim_desc);
+    return kern;
 }
 
-void RS_download_pulse_only(RSHandle *H) {
+
+// Host to buffer set (chunk % 2) on the transfer queue, event marks the last write
+static void RS_stream_upload(RSHandle *H, const int worker_id, const size_t chunk, const char with_pulse, const char with_atts, cl_event *event) {
     
-    int i;
+    RSWorker *C = &H->workers[worker_id];
     
-#if defined (_USE_GCL_)
+    const int b = chunk & 1;
+    const size_t o = H->offset[worker_id] + chunk * C->stream_chunk;
+    const size_t n = MIN(C->stream_chunk, C->num_scats - chunk * C->stream_chunk);
     
-    for (i = 0; i < H->num_workers; i++) {
-        dispatch_async(H->workers[i].que, ^{
-            gcl_memcpy(H->pulse_tmp[i], H->workers[i].pulse, H->params.range_count * sizeof(cl_float4));
-            dispatch_semaphore_signal(H->workers[i].sem);
-        });
+    // The tail of a short chunk must not add anything to the pulse
+    if (with_pulse && n < C->stream_chunk) {
+        clEnqueueWriteBuffer(C->que_copy, C->stream_sig[b], CL_FALSE, n * sizeof(cl_float4), (C->stream_chunk - n) * sizeof(cl_float4), H->stream_zeros, 0, NULL, NULL);
+        clEnqueueWriteBuffer(C->que_copy, C->stream_aux[b], CL_FALSE, n * sizeof(cl_float4), (C->stream_chunk - n) * sizeof(cl_float4), H->stream_zeros, 0, NULL, NULL);
     }
-    for (i = 0; i < H->num_workers; i++)
-        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+    if (with_pulse) {
+        clEnqueueWriteBuffer(C->que_copy, C->stream_aux[b], CL_FALSE, 0, n * sizeof(cl_float4), H->scat_aux + o, 0, NULL, NULL);
+    }
+    if (with_atts) {
+        clEnqueueWriteBuffer(C->que_copy, C->stream_vel[b], CL_FALSE, 0, n * sizeof(cl_float4), H->scat_vel + o, 0, NULL, NULL);
+        clEnqueueWriteBuffer(C->que_copy, C->stream_rnd[b], CL_FALSE, 0, n * sizeof(cl_uint4),  H->scat_rnd + o, 0, NULL, NULL);
+    }
+    clEnqueueWriteBuffer(C->que_copy, C->stream_rcs[b], CL_FALSE, 0, n * sizeof(cl_float4), H->scat_rcs + o, 0, NULL, NULL);
+    clEnqueueWriteBuffer(C->que_copy, C->stream_pos[b], CL_FALSE, 0, n * sizeof(cl_float4), H->scat_pos + o, 0, NULL, event);
+}
+
+
+// Kernels on buffer set (chunk % 2) once it is uploaded, event marks the last kernel
+static void RS_stream_compute(RSHandle *H, const int worker_id, const size_t chunk, const char with_pulse, const cl_kernel kern_atts, cl_event ready, cl_event *event) {
     
-#else
+    RSWorker *C = &H->workers[worker_id];
     
-    // Blocking read since there is only one read
-    for (i = 0; i < H->num_workers; i++) {
-        clEnqueueReadBuffer(H->workers[i].que, H->workers[i].pulse, CL_TRUE, 0, H->params.range_count * sizeof(cl_float4), H->pulse_tmp[i], 0, NULL, NULL);
+    const int b = chunk & 1;
+    const size_t n = MIN(C->stream_chunk, C->num_scats - chunk * C->stream_chunk);
+    
+    if (with_pulse) {
+        clSetKernelArg(C->kern_scat_sig_aux, RSScattererAngularWeightKernalArgumentSignal,            sizeof(cl_mem), &C->stream_sig[b]);
+        clSetKernelArg(C->kern_scat_sig_aux, RSScattererAngularWeightKernalArgumentAuxiliary,         sizeof(cl_mem), &C->stream_aux[b]);
+        clSetKernelArg(C->kern_scat_sig_aux, RSScattererAngularWeightKernalArgumentPosition,          sizeof(cl_mem), &C->stream_pos[b]);
+        clSetKernelArg(C->kern_scat_sig_aux, RSScattererAngularWeightKernalArgumentRadarCrossSection, sizeof(cl_mem), &C->stream_rcs[b]);
+        clSetKernelArg(C->kern_make_pulse_pass_1, 1, sizeof(cl_mem), &C->stream_sig[b]);
+        clSetKernelArg(C->kern_make_pulse_pass_1, 2, sizeof(cl_mem), &C->stream_aux[b]);
+        clSetKernelArg(C->kern_make_pulse_pass_2, 0, sizeof(cl_mem), &C->stream_pulse[b]);
+        clEnqueueNDRangeKernel(C->que, C->kern_scat_sig_aux, 1, NULL, &n, NULL, 1, &ready, NULL);
+        clEnqueueNDRangeKernel(C->que, C->kern_make_pulse_pass_1, 1, NULL, &C->make_pulse_params.global[0], &C->make_pulse_params.local[0], 0, NULL, NULL);
+        clEnqueueNDRangeKernel(C->que, C->kern_make_pulse_pass_2, 1, NULL, &C->make_pulse_params.global[1], &C->make_pulse_params.local[1], 0, NULL, kern_atts ? NULL : event);
+    }
+    if (kern_atts) {
+        clSetKernelArg(kern_atts, RSBackgroundAttributeKernelArgumentPosition,          sizeof(cl_mem), &C->stream_pos[b]);
+        clSetKernelArg(kern_atts, RSBackgroundAttributeKernelArgumentVelocity,          sizeof(cl_mem), &C->stream_vel[b]);
+        clSetKernelArg(kern_atts, RSBackgroundAttributeKernelArgumentRadarCrossSection, sizeof(cl_mem), &C->stream_rcs[b]);
+        clSetKernelArg(kern_atts, RSBackgroundAttributeKernelArgumentRandomSeed,        sizeof(cl_mem), &C->stream_rnd[b]);
+        clEnqueueNDRangeKernel(C->que, kern_atts, 1, NULL, &n, NULL, with_pulse ? 0 : 1, with_pulse ? NULL : &ready, event);
     }
+}
+
+
+// Buffer set (chunk % 2) back to the host on the transfer queue once the kernels are done
+static void RS_stream_download(RSHandle *H, const int worker_id, const size_t chunk, const char with_pulse, const char with_atts, cl_event done) {
     
-#endif
+    RSWorker *C = &H->workers[worker_id];
     
-    RS_merge_pulse_tmp(H);
+    const int b = chunk & 1;
+    const size_t o = H->offset[worker_id] + chunk * C->stream_chunk;
+    const size_t n = MIN(C->stream_chunk, C->num_scats - chunk * C->stream_chunk);
+    
+    // Only the first read waits, the transfer queue is in order
+    if (with_pulse) {
+        clEnqueueReadBuffer(C->que_copy, C->stream_pulse[b], CL_FALSE, 0, H->params.range_count * sizeof(cl_float4), C->stream_pulse_parts + chunk * H->params.range_count, 1, &done, NULL);
+        clEnqueueReadBuffer(C->que_copy, C->stream_aux[b], CL_FALSE, 0, n * sizeof(cl_float4), H->scat_aux + o, 0, NULL, NULL);
+    }
+    if (with_atts) {
+        clEnqueueReadBuffer(C->que_copy, C->stream_pos[b], CL_FALSE, 0, n * sizeof(cl_float4), H->scat_pos + o, with_pulse ? 0 : 1, with_pulse ? NULL : &done, NULL);
+        clEnqueueReadBuffer(C->que_copy, C->stream_vel[b], CL_FALSE, 0, n * sizeof(cl_float4), H->scat_vel + o, 0, NULL, NULL);
+        clEnqueueReadBuffer(C->que_copy, C->stream_rcs[b], CL_FALSE, 0, n * sizeof(cl_float4), H->scat_rcs + o, 0, NULL, NULL);
+        clEnqueueReadBuffer(C->que_copy, C->stream_rnd[b], CL_FALSE, 0, n * sizeof(cl_uint4),  H->scat_rnd + o, 0, NULL, NULL);
+    }
 }
 
 
-void RS_upload(RSHandle *H) {
+//
+// Pipeline the whole population through the devices, one chunk computes while the next one is uploaded
+// and the previous one is downloaded. Signal and pulse first, then the attributes for the next time step.
+//
+static void RS_stream_pass(RSHandle *H, const char with_pulse, const char with_atts) {
     
-    int i;
+    int i, k;
+    size_t c, m;
     
-    if (H->verb > 3) {
-        for (i = 0; i < H->num_workers; i++) {
-            rsprint("workers[%d].scat_pos @ %p\n", i, H->workers[i].scat_pos);
-            rsprint("workers[%d].scat_vel @ %p\n", i, H->workers[i].scat_vel);
+    size_t num_chunks[RS_MAX_WORKERS];
+    size_t max_chunks = 0;
+    cl_kernel kern_atts[RS_MAX_WORKERS];
+    cl_event ready[RS_MAX_WORKERS][2];
+    cl_event done;
+    
+    for (i = 0; i < H->num_workers; i++) {
+        RSWorker *C = &H->workers[i];
+        num_chunks[i] = C->stream_chunk ? (C->num_scats + C->stream_chunk - 1) / C->stream_chunk : 0;
+        max_chunks = MAX(max_chunks, num_chunks[i]);
+        kern_atts[i] = with_atts ? RS_stream_atts_kernel(H, C) : NULL;
+        if (with_pulse) {
+            clSetKernelArg(C->kern_scat_sig_aux, RSScattererAngularWeightKernalArgumentSimulationDescription, sizeof(cl_float16), &H->sim_desc);
+        }
+        if (num_chunks[i]) {
+            RS_stream_upload(H, i, 0, with_pulse, with_atts, &ready[i][0]);
         }
-        rsprint("scat_pos @ %p\n", H->scat_pos);
-        rsprint("scat_vel @ %p\n", H->scat_vel);
     }
     
-    if (H->num_scats == 0) {
-        rsprint("Abort @ num_scats = 0 during RS_upload()\n");
-        return;
+    for (c = 0; c < max_chunks; c++) {
+        for (i = 0; i < H->num_workers; i++) {
+            if (c >= num_chunks[i]) {
+                continue;
+            }
+            // Uploading the next chunk only follows the download of the one that used the same buffer set
+            if (c + 1 < num_chunks[i]) {
+                RS_stream_upload(H, i, c + 1, with_pulse, with_atts, &ready[i][(c + 1) & 1]);
+            }
+            RS_stream_compute(H, i, c, with_pulse, kern_atts[i], ready[i][c & 1], &done);
+            clReleaseEvent(ready[i][c & 1]);
+            RS_stream_download(H, i, c, with_pulse, with_atts, done);
+            clReleaseEvent(done);
+        }
+        for (i = 0; i < H->num_workers; i++) {
+            if (c < num_chunks[i]) {
+                clFlush(H->workers[i].que_copy);
+                clFlush(H->workers[i].que);
+            }
+        }
     }
     
-#if defined (_USE_GCL_)
-    
     for (i = 0; i < H->num_workers; i++) {
-        dispatch_async(H->workers[i].que, ^{
-            gcl_memcpy(H->workers[i].scat_pos, H->scat_pos + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->workers[i].scat_vel, H->scat_vel + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->workers[i].scat_ori, H->scat_ori + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->workers[i].scat_tum, H->scat_tum + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->workers[i].scat_aux, H->scat_aux + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->workers[i].scat_rcs, H->scat_rcs + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->workers[i].scat_sig, H->scat_sig + H->offset[i], H->workers[i].num_scats * sizeof(cl_float4));
-            gcl_memcpy(H->workers[i].scat_rnd, H->scat_rnd + H->offset[i], H->workers[i].num_scats * sizeof(cl_uint4));
-            dispatch_semaphore_signal(H->workers[i].sem);
-        });
-        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+        if (num_chunks[i]) {
+            clFinish(H->workers[i].que_copy);
+        }
     }
     
-#else
+    if (!with_pulse) {
+        return;
+    }
     
-    // Blocking write since there is no need to optimize this too much
+    // Pulse of each worker is the sum over its chunks
     for (i = 0; i < H->num_workers; i++) {
-        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_pos, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_pos + H->offset[i], 0, NULL, NULL);
-        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_vel, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_vel + H->offset[i], 0, NULL, NULL);
-        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_ori, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_ori + H->offset[i], 0, NULL, NULL);
-        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_tum, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_tum + H->offset[i], 0, NULL, NULL);
-        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_aux, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_aux + H->offset[i], 0, NULL, NULL);
-        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_rcs, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_rcs + H->offset[i], 0, NULL, NULL);
-        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_sig, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_float4), H->scat_sig + H->offset[i], 0, NULL, NULL);
-        clEnqueueWriteBuffer(H->workers[i].que, H->workers[i].scat_rnd, CL_TRUE, 0, H->workers[i].num_scats * sizeof(cl_uint4),  H->scat_rnd + H->offset[i], 0, NULL, NULL);
+        RSWorker *C = &H->workers[i];
+        memset(H->pulse_tmp[i], 0, H->params.range_count * sizeof(cl_float4));
+        for (m = 0; m < num_chunks[i]; m++) {
+            const cl_float4 *part = C->stream_pulse_parts + m * H->params.range_count;
+            for (k = 0; k < H->params.range_count; k++) {
+                H->pulse_tmp[i][k].s0 += part[k].s0;
+                H->pulse_tmp[i][k].s1 += part[k].s1;
+                H->pulse_tmp[i][k].s2 += part[k].s2;
+                H->pulse_tmp[i][k].s3 += part[k].s3;
+            }
+        }
     }
-    
+}
+
 #endif
+
+
+static void RS_advance_clock(RSHandle *H) {
+    
+    H->sim_tic += H->params.prt;
+    H->sim_desc.s[RSSimulationDescriptionSimTic] = H->sim_tic;
+    H->status |= RSStatusScattererSignalNeedsUpdate;
     
+    // Hand over the scatterers that drifted into the slab of another worker, right away if the speeds are not known yet
+    if (H->worker_partition != RSWorkerPartitionRandom && (++H->slab_migration_tic >= RS_SLAB_MIGRATION_INTERVAL || H->slab_speed < 0.0f)) {
+        RS_migrate_slab_scatterers(H);
+        H->slab_migration_tic = 0;
+    }
 }
 
 
@@ -5185,21 +7599,29 @@ void RS_advance_time(RSHandle *H) {
         return;
     }
     
-    // Advance to next wind table when the time comes
-    if (H->sim_tic >= H->sim_toc) {
-        H->sim_toc += H->vel_desc.tp;
-        if (H->vel_idx == 0) {
-            rsprint("Wind table restarted.");
-        }
-        for (i = 0; i < H->num_workers; i++) {
-            H->workers[i].les_id = H->workers[i].les_id == 1 ? 0 : 1;
-        }
-        RS_set_vel_data_to_LES_table(H, LES_get_frame(H->L, H->vel_idx));
-        H->vel_idx = H->vel_idx == H->vel_count - 1 ? 0 : H->vel_idx + 1;
-        
-        if (H->verb > 2) {
-            rsprint("Wind table advanced. vel_idx = %d   ( tp = %.2f / prt = %.4f )  vel_id = %d", H->vel_idx, H->vel_desc.tp, H->params.prt, H->workers[0].les_id);
+    RS_update_vel_frame(H);
+    
+#if !defined (_USE_GCL_)
+    
+    // Attributes of a streamed population are usually advanced along with the pulse
+    if (H->stream_chunk) {
+        if (!H->stream_advanced) {
+            RS_stream_pass(H, 0, 1);
         }
+        H->stream_advanced = 0;
+        H->sim_tic += H->params.prt;
+        H->sim_desc.s[RSSimulationDescriptionSimTic] = H->sim_tic;
+        H->status |= RSStatusScattererSignalNeedsUpdate;
+        return;
+    }
+    
+#endif
+    
+    // Native threads update the host arrays in place
+    if (H->native) {
+        RS_native_advance_time(H);
+        RS_advance_clock(H);
+        return;
     }
     
 #if defined (_USE_GCL_)
@@ -5263,8 +7685,11 @@ void RS_advance_time(RSHandle *H) {
                                (cl_image)H->workers[i].les_uvwt[H->workers[i].les_id],
                                (cl_image)H->workers[i].les_cpxx[H->workers[i].les_id],
                                H->workers[i].les_desc,
+                               (cl_image)H->workers[i].les_nest_uvwt[H->workers[i].les_id],
+                               (cl_float16 *)H->workers[i].les_nest_desc,
                                (cl_float4 *)H->workers[i].rcs_ellipsoid,
                                H->workers[i].rcs_ellipsoid_desc,
+                               H->workers[i].slab_desc,
                                H->sim_desc);
             } else {
                 bg_atts_kernel(&H->workers[i].ndrange_scat[0],
@@ -5275,8 +7700,11 @@ void RS_advance_time(RSHandle *H) {
                                (cl_image)H->workers[i].les_uvwt[H->workers[i].les_id],
                                (cl_image)H->workers[i].les_cpxx[H->workers[i].les_id],
                                H->workers[i].les_desc,
+                               (cl_image)H->workers[i].les_nest_uvwt[H->workers[i].les_id],
+                               (cl_float16 *)H->workers[i].les_nest_desc,
                                (cl_float4 *)H->workers[i].rcs_ellipsoid,
                                H->workers[i].rcs_ellipsoid_desc,
+                               H->workers[i].slab_desc,
                                H->sim_desc);
             }
             dispatch_semaphore_signal(H->workers[i].sem);
@@ -5296,12 +7724,15 @@ void RS_advance_time(RSHandle *H) {
                                    (cl_uint4 *)H->workers[i].scat_rnd,
                                    (cl_image)H->workers[i].les_uvwt[H->workers[i].les_id],
                                    H->workers[i].les_desc,
+                                   (cl_image)H->workers[i].les_nest_uvwt[H->workers[i].les_id],
+                                   (cl_float16 *)H->workers[i].les_nest_desc,
                                    (cl_image)H->workers[i].adm_cd[a],
                                    (cl_image)H->workers[i].adm_cm[a],
                                    H->workers[i].adm_desc[a],
                                    (cl_image)H->workers[i].rcs_real[r],
                                    (cl_image)H->workers[i].rcs_imag[r],
                                    H->workers[i].rcs_desc[r],
+                                   H->workers[i].slab_desc,
                                    H->sim_desc);
                     dispatch_semaphore_signal(H->workers[i].sem);
                 });
@@ -5324,7 +7755,7 @@ void RS_advance_time(RSHandle *H) {
     
 #else
     
-    cl_event events[RS_MAX_GPU_DEVICE][H->num_types];
+    cl_event events[RS_MAX_WORKERS][H->num_types];
     memset(events, 0, sizeof(events));
     
     for (i = 0; i < H->num_workers; i++) {
@@ -5336,32 +7767,44 @@ void RS_advance_time(RSHandle *H) {
         
         // Need to refresh some parameters of the background at each time update
         if (H->sim_concept & RSSimulationConceptDraggedBackground) {
-            clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundVelocity,    sizeof(cl_mem),     &C->les_uvwt[C->les_id]);
-            clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundCn2Pressure, sizeof(cl_mem),     &C->les_cpxx[C->les_id]);
-            clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentSimulationDescription, sizeof(cl_float16), &H->sim_desc);
+            clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundVelocity,          sizeof(cl_mem),     &C->les_uvwt[C->les_id]);
+            clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundCn2Pressure,       sizeof(cl_mem),     &C->les_cpxx[C->les_id]);
+            clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundDescription,       sizeof(cl_float16), &C->les_desc);
+            clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundNestVelocity,      sizeof(cl_mem),     &C->les_nest_uvwt[C->les_id]);
+            clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentBackgroundNestDescription,   sizeof(cl_mem),     &C->les_nest_desc);
+            clSetKernelArg(C->kern_el_atts, RSBackgroundAttributeKernelArgumentSimulationDescription,       sizeof(cl_float16), &H->sim_desc);
             clEnqueueNDRangeKernel(C->que, C->kern_el_atts, 1, &C->origins[0], &C->counts[0], NULL, 0, NULL, &events[i][0]);
         } else if (H->sim_concept & RSSimulationConceptFixedScattererPosition) {
-            clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundVelocity,    sizeof(cl_mem),     &C->les_uvwt[C->les_id]);
-            clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundCn2Pressure, sizeof(cl_mem),     &C->les_cpxx[C->les_id]);
-            clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentSimulationDescription, sizeof(cl_float16), &H->sim_desc);
+            clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundVelocity,          sizeof(cl_mem),     &C->les_uvwt[C->les_id]);
+            clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundCn2Pressure,       sizeof(cl_mem),     &C->les_cpxx[C->les_id]);
+            clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundDescription,       sizeof(cl_float16), &C->les_desc);
+            clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundNestVelocity,      sizeof(cl_mem),     &C->les_nest_uvwt[C->les_id]);
+            clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentBackgroundNestDescription,   sizeof(cl_mem),     &C->les_nest_desc);
+            clSetKernelArg(C->kern_fp_atts, RSBackgroundAttributeKernelArgumentSimulationDescription,       sizeof(cl_float16), &H->sim_desc);
             clEnqueueNDRangeKernel(C->que, C->kern_fp_atts, 1, &C->origins[0], &C->counts[0], NULL, 0, NULL, &events[i][0]);
         } else {
-            clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundVelocity,    sizeof(cl_mem),     &C->les_uvwt[C->les_id]);
-            clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundCn2Pressure, sizeof(cl_mem),     &C->les_cpxx[C->les_id]);
-            clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentSimulationDescription, sizeof(cl_float16), &H->sim_desc);
+            clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundVelocity,          sizeof(cl_mem),     &C->les_uvwt[C->les_id]);
+            clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundCn2Pressure,       sizeof(cl_mem),     &C->les_cpxx[C->les_id]);
+            clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundDescription,       sizeof(cl_float16), &C->les_desc);
+            clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundNestVelocity,      sizeof(cl_mem),     &C->les_nest_uvwt[C->les_id]);
+            clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentBackgroundNestDescription,   sizeof(cl_mem),     &C->les_nest_desc);
+            clSetKernelArg(C->kern_bg_atts, RSBackgroundAttributeKernelArgumentSimulationDescription,       sizeof(cl_float16), &H->sim_desc);
             clEnqueueNDRangeKernel(C->que, C->kern_bg_atts, 1, &C->origins[0], &C->counts[0], NULL, 0, NULL, &events[i][0]);
         }
         
         // Debris particles
-        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundVelocity,         sizeof(cl_mem),     &C->les_uvwt[C->les_id]);
-        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundCn2Pressure,      sizeof(cl_mem),     &C->les_cpxx[C->les_id]);
-        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentDebrisFluxField,            sizeof(cl_mem),     &C->dff_icdf[C->les_id]);
-        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentDebrisFluxFieldDescription, sizeof(cl_float16), &C->dff_desc);
-        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentSimulationDescription,      sizeof(cl_float16), &H->sim_desc);
+        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundVelocity,             sizeof(cl_mem),     &C->les_uvwt[C->les_id]);
+        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundCn2Pressure,          sizeof(cl_mem),     &C->les_cpxx[C->les_id]);
+        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundVelocityDescription,  sizeof(cl_float16), &C->les_desc);
+        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundNestVelocity,         sizeof(cl_mem),     &C->les_nest_uvwt[C->les_id]);
+        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentBackgroundNestDescription,      sizeof(cl_mem),     &C->les_nest_desc);
+        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentDebrisFluxField,                sizeof(cl_mem),     &C->dff_icdf[C->les_id]);
+        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentDebrisFluxFieldDescription,     sizeof(cl_float16), &C->dff_desc);
+        clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentSimulationDescription,          sizeof(cl_float16), &H->sim_desc);
         for (k = 1; k < H->num_types; k++) {
             if (C->counts[k]) {
-                clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentAirDragModelDrag,              sizeof(cl_mem),     &C->adm_cd[a]);
-                clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentAirDragModelMomentum,          sizeof(cl_mem),     &C->adm_cm[a]);
+                clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentAirDragModelDrag,               sizeof(cl_mem),     &C->adm_cd[a]);
+                clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentAirDragModelMomentum,           sizeof(cl_mem),     &C->adm_cm[a]);
                 clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentAirDragModelDescription,       sizeof(cl_float16), &C->adm_desc[a]);
                 clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentRadarCrossSectionReal,         sizeof(cl_mem),     &C->rcs_real[r]);
                 clSetKernelArg(C->kern_db_atts, RSDebrisAttributeKernelArgumentRadarCrossSectionImag,         sizeof(cl_mem),     &C->rcs_imag[r]);
@@ -5378,19 +7821,29 @@ void RS_advance_time(RSHandle *H) {
     }
     
     for (i = 0; i < H->num_workers; i++) {
+        cl_ulong t, t0 = (cl_ulong)-1, t1 = 0;
         for (k = 0; k < H->num_types; k++) {
             if (H->workers[i].counts[k]) {
                 clWaitForEvents(1, &events[i][k]);
+                // Span from the first kernel start to the last kernel end is the busy time of this worker
+                if (clGetEventProfilingInfo(events[i][k], CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &t, NULL) == CL_SUCCESS) {
+                    t0 = MIN(t0, t);
+                }
+                if (clGetEventProfilingInfo(events[i][k], CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &t, NULL) == CL_SUCCESS) {
+                    t1 = MAX(t1, t);
+                }
                 clReleaseEvent(events[i][k]);
             }
         }
+        if (t1 > t0) {
+            H->workers[i].busy_time += 1.0e-9 * (double)(t1 - t0);
+            H->workers[i].busy_scats += (double)H->workers[i].num_scats;
+        }
     }
     
 #endif
 
-    H->sim_tic += H->params.prt;
-    H->sim_desc.s[RSSimulationDescriptionSimTic] = H->sim_tic;
-    H->status |= RSStatusScattererSignalNeedsUpdate;
+    RS_advance_clock(H);
 }
 
 
@@ -5411,6 +7864,42 @@ void RS_make_pulse(RSHandle *H) {
         return;
     }
     
+#if !defined (_USE_GCL_)
+    
+    // A streamed chunk is advanced to the next time step while it is on the device, RS_advance_time() then only moves the clock
+    if (H->stream_chunk) {
+        if (!H->stream_advanced) {
+            RS_update_vel_frame(H);
+        }
+        RS_stream_pass(H, 1, !H->stream_advanced);
+        H->stream_advanced = 1;
+        H->status &= ~RSStatusScattererSignalNeedsUpdate;
+        return;
+    }
+    
+#endif
+    
+    // Workers whose slab is out of the beam skip the signal and the pulse entirely, their signal is refreshed once back in the beam
+    char sig_update[RS_MAX_WORKERS];
+    for (i = 0; i < H->num_workers; i++) {
+        RSWorker *C = &H->workers[i];
+        C->in_beam = RS_slab_in_beam(H, i);
+        if (C->in_beam) {
+            sig_update[i] = (H->status & RSStatusScattererSignalNeedsUpdate) || C->sig_stale;
+            C->sig_stale = 0;
+        } else {
+            sig_update[i] = 0;
+            C->sig_stale |= (H->status & RSStatusScattererSignalNeedsUpdate) != 0;
+        }
+    }
+    
+    if (H->native) {
+        RS_native_make_pulse(H, sig_update);
+        H->status &= ~RSStatusDebrisRCSNeedsUpdate;
+        H->status &= ~RSStatusScattererSignalNeedsUpdate;
+        return;
+    }
+    
 #if defined (_USE_GCL_)
     
     if (H->status & RSStatusDebrisRCSNeedsUpdate) {
@@ -5464,8 +7953,12 @@ void RS_make_pulse(RSHandle *H) {
     }
     for (i = 0; i < H->num_workers; i++) {
         RSWorker *C = &H->workers[i];
+        if (!C->in_beam) {
+            continue;
+        }
+        const char update = sig_update[i];
         dispatch_async(C->que, ^{
-            if (H->status & RSStatusScattererSignalNeedsUpdate) {
+            if (update) {
                 //printf("RS_make_pulse: kern_scat_sig_aux\n");
                 scat_sig_aux_kernel(&C->ndrange_scat_all,
                                     (cl_float4 *)C->scat_sig,
@@ -5518,7 +8011,9 @@ void RS_make_pulse(RSHandle *H) {
         });
     }
     for (i = 0; i < H->num_workers; i++) {
-        dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+        if (H->workers[i].in_beam) {
+            dispatch_semaphore_wait(H->workers[i].sem, DISPATCH_TIME_FOREVER);
+        }
     }
     
 #else
@@ -5561,7 +8056,10 @@ void RS_make_pulse(RSHandle *H) {
     }
     for (i = 0; i < H->num_workers; i++) {
         RSWorker *C = &H->workers[i];
-        if (H->status & RSStatusScattererSignalNeedsUpdate) {
+        if (!C->in_beam) {
+            continue;
+        }
+        if (sig_update[i]) {
             //printf("RS_make_pulse() kern_scat_sig_aux : %zu   sim_tic = %.4f\n", C->num_scats, H->sim_tic);
             clSetKernelArg(C->kern_scat_sig_aux, RSScattererAngularWeightKernalArgumentSimulationDescription, sizeof(cl_float16), &H->sim_desc);
             clEnqueueNDRangeKernel(C->que, C->kern_scat_sig_aux, 1, NULL, &C->num_scats, NULL, 0, NULL, &events[i][0]);
@@ -5575,8 +8073,18 @@ void RS_make_pulse(RSHandle *H) {
         clFlush(H->workers[i].que);
     }
     for (i = 0; i < H->num_workers; i++) {
+        if (!H->workers[i].in_beam) {
+            continue;
+        }
         clWaitForEvents(1, &events[i][2]);
-        if (H->status & RSStatusScattererSignalNeedsUpdate)
+        // The pulse kernels are part of the busy time too, the scatterers are counted once in RS_advance_time()
+        cl_ulong t0 = 0, t1 = 0;
+        if (clGetEventProfilingInfo(events[i][sig_update[i] ? 0 : 1], CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &t0, NULL) == CL_SUCCESS &&
+            clGetEventProfilingInfo(events[i][2], CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &t1, NULL) == CL_SUCCESS &&
+            t1 > t0) {
+            H->workers[i].busy_time += 1.0e-9 * (double)(t1 - t0);
+        }
+        if (sig_update[i])
             clReleaseEvent(events[i][0]);
         clReleaseEvent(events[i][1]);
         clReleaseEvent(events[i][2]);
@@ -5644,6 +8152,10 @@ RSTable3D RS_table3d_init(size_t numel) {
     table.xs = 1.0f;      table.ys = 1.0f;      table.zs = 1.0f;
     table.xo = 0.0f;      table.yo = 0.0f;      table.zo = 0.0f;
     table.xm = 1.0f;      table.ym = 1.0f;      table.zm = 1.0f;
+
+    // Half-precision data are never owned by the table
+    table.uvwt_half = NULL;
+    table.cpxx_half = NULL;
     
     if (posix_memalign((void **)&table.uvwt, RS_ALIGN_SIZE, numel * sizeof(cl_float4))) {
         rsprint("ERROR: Unable to allocate an RSTable3D->uvwt.\n", now());
@@ -5803,7 +8315,7 @@ RSBox RS_suggest_scan_domain(RSHandle *H) {
         H->P = POS_init();
     }
 
-    if (H->L == NULL) {
+    if (H->L == NULL && H->vel_model == RSWindModelTable) {
         RS_set_vel_data_to_config(H, LESConfigSuctionVortices);
     }
     
@@ -5818,12 +8330,13 @@ RSBox RS_suggest_scan_domain(RSHandle *H) {
     POSPattern *scan = H->P;
     
     // Extremas of the domain
+    // Always the full LES grid, the frames may have been cropped to a previous domain
     if (H->vel_desc.is_stretched) {
-        w = H->vel_desc.ax * (1.0f - powf(H->vel_desc.rx, 0.5f * (float)(H->vel_desc.nx - 3))) / (1.0f - H->vel_desc.rx);
-        h = H->vel_desc.az * (1.0f - powf(H->vel_desc.rz,        (float)(H->vel_desc.nz - 1))) / (1.0f - H->vel_desc.rz);
+        w = H->vel_desc.ax * (1.0f - powf(H->vel_desc.rx, 0.5f * (float)(H->vel_desc.gx - 3))) / (1.0f - H->vel_desc.rx);
+        h = H->vel_desc.az * (1.0f - powf(H->vel_desc.rz,        (float)(H->vel_desc.gz - 1))) / (1.0f - H->vel_desc.rz);
     } else {
-        w = 0.5f * H->vel_desc.nx * H->vel_desc.rx;
-        h = H->vel_desc.nz * H->vel_desc.rz;
+        w = 0.5f * H->vel_desc.gx * H->vel_desc.rx;
+        h = H->vel_desc.gz * H->vel_desc.rz;
     }
     
     //if (POS_is_dbs(scan)) {
@@ -8,6 +8,7 @@
 const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_LINEAR;
 
 float4 rand(uint4 *seed);
+uint4 hash_uint4(uint4 a);
 
 float4 quat_mult(float4 left, float4 right);
 float4 quat_conj(float4 quat);
@@ -19,10 +20,12 @@ float4 quat_rotate(float4 vector, float4 quat);
 float4 cl_complex_multiply(const float4 a, const float4 b);
 float4 cl_complex_divide(const float4 a, const float4 b);
 float4 wind_table_index(const float4 pos, const float16 wind_desc, const float16 sim_desc);
-float4 compute_bg_vel(const float4 pos, __read_only image3d_t wind_uvwt, const float16 wind_desc, const float16 sim_desc);
+float4 compute_analytic_vel(const float4 pos, const float16 wind_desc, const float16 sim_desc);
+float4 compute_bg_vel(const float4 pos, __read_only image3d_t wind_uvwt, const float16 wind_desc, __read_only image3d_t wind_nest_uvwt, __constant float16 *wind_nest_desc, const float16 sim_desc);
 float4 compute_dudt_dwdt(float4 *dwdt, const float4 vel, const float4 vel_bg, const float4 ori, __read_only image2d_t adm_cd, __read_only image2d_t adm_cm, const float16 adm_desc);
 float4 compute_ellipsoid_rcs(const float4 pos, __constant float4 *table, const float4 table_desc);
 float4 compute_debris_rcs(const float4 pos, const float4 ori, __read_only image2d_t rcs_real, __read_only image2d_t rcs_imag, const float16 rcs_desc, const float16 sim_desc);
+int is_in_slab(const float4 pos, const float4 slab_desc);
 
 /////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -43,6 +46,17 @@ float4 rand(uint4 *seed)
     return convert_float4(*seed) * n;
 }
 
+// Integer hash to spread scatterer ids into independent seeds of rand()
+uint4 hash_uint4(uint4 a)
+{
+    a = (a ^ 61u) ^ (a >> 16);
+    a *= 9u;
+    a ^= a >> 4;
+    a *= 0x27d4eb2du;
+    a ^= a >> 15;
+    return a;
+}
+
 #pragma mark -
 #pragma mark Quaternion Fun
 
@@ -180,7 +194,63 @@ float4 wind_table_index(const float4 pos, const float16 wind_desc, const float16
 // Background velocity
 //
 
-float4 compute_bg_vel(const float4 pos, __read_only image3d_t wind_uvwt, const float16 wind_desc, const float16 sim_desc) {
+float4 compute_analytic_vel(const float4 pos, const float16 wind_desc, const float16 sim_desc)
+{
+    //
+    //  RSWindModelDescriptionVelocityX/Y/Z   =  0, 1, 2  (u, v, w) or translation of the vortex
+    //  RSWindModelDescriptionShearX/Y/Z      =  4, 5, 6  (du/dz, dv/dz, dw/dz)
+    //  RSWindModelDescriptionCenterX/Y       =  8, 9     relative to the center of the domain
+    //  RSWindModelDescriptionModel           = 10
+    //  RSWindModelDescriptionMaximumSpeed    = 12
+    //  RSWindModelDescriptionCoreRadius      = 13
+    //
+    const uint model = (uint)wind_desc.sa;
+
+    float4 vel = (float4)(wind_desc.s012, 0.0f);
+    
+    if (model & RSWindModelLinearShear) {
+        vel.xyz = fma((float3)(pos.z, pos.z, pos.z), wind_desc.s456, vel.xyz);
+    }
+    
+    if (model & RSWindModelRankineVortex) {
+        // Tangential speed over radius: solid body inside the core, 1 / r outside
+        const float2 d = pos.xy - (sim_desc.hi.s01 + 0.5f * sim_desc.hi.s45) - wind_desc.s89;
+        const float r2 = dot(d, d);
+        const float rc = wind_desc.sd;
+        const float vt_r = r2 < rc * rc ? wind_desc.sc / rc : wind_desc.sc * rc / r2;
+        vel.xy += (float2)(-d.y, d.x) * vt_r;
+    }
+    
+    return vel;
+}
+
+float4 compute_bg_vel(const float4 pos,
+                      __read_only image3d_t wind_uvwt,
+                      const float16 wind_desc,
+                      __read_only image3d_t wind_nest_uvwt,
+                      __constant float16 *wind_nest_desc,
+                      const float16 sim_desc)
+{
+    //
+    //  Refined grids are ordered from the finest, the first one that covers the position wins.
+    //  The number of refined grids is kept in RSTable3DDescriptionNestCount of the outer grid.
+    //
+    const uint nest_count = (uint)wind_desc.sb;
+
+    for (uint k = 0; k < nest_count; k++) {
+        const float16 nest_desc = wind_nest_desc[k];
+        float4 nest_coord = fma(pos, nest_desc.s0123, nest_desc.s4567);
+        if (all(isgreaterequal(nest_coord.xyz, (float3)(0.5f, 0.5f, 0.5f)) & islessequal(nest_coord.xyz, nest_desc.s89a))) {
+            nest_coord.z += nest_desc.s7;
+            return read_imagef(wind_nest_uvwt, sampler, nest_coord);
+        }
+    }
+
+    // Analytic wind models are evaluated in place, there is no table behind them
+    const float s7 = wind_desc.s7;
+    if (*(uint *)&s7 == RSTableSpacingAnalytic) {
+        return compute_analytic_vel(pos, wind_desc, sim_desc);
+    }
 
     float4 wind_coord = wind_table_index(pos, wind_desc, sim_desc);
     
@@ -260,6 +330,19 @@ float4 compute_dudt_dwdt(float4 *dwdt,
     return dudt;
 }
 
+//
+// Whether the position is in the azimuth sector of the worker, same as RS_slab_of_position() of the host
+//
+int is_in_slab(const float4 pos, const float4 slab_desc) {
+    float a = atan2(pos.x, pos.y) - slab_desc.s0;
+    if (a >= M_PI_F) {
+        a -= 2.0f * M_PI_F;
+    } else if (a < -M_PI_F) {
+        a += 2.0f * M_PI_F;
+    }
+    return a >= slab_desc.s1 && a < slab_desc.s2;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////
 //
 //  Particle RCS
@@ -378,6 +461,46 @@ __kernel void io(__global float4 *i,
     o[k] = i[k];
 }
 
+// Attributes of the scatterers at idx into (gather) or out of the records, 8 per scatterer in the order of the host
+// mirrors, so that the slab migration moves the few that crossed in one transfer
+//
+__kernel void scat_move(__global float4 *p,
+                        __global float4 *v,
+                        __global float4 *o,
+                        __global float4 *t,
+                        __global float4 *a,
+                        __global float4 *x,
+                        __global float4 *s,
+                        __global uint4 *y,
+                        __global float4 *r,
+                        __global const uint *idx,
+                        const uint gather)
+{
+    const unsigned int k = get_global_id(0);
+    const unsigned int i = idx[k];
+    __global float4 *m = r + 8 * k;
+    
+    if (gather) {
+        m[0] = p[i];
+        m[1] = v[i];
+        m[2] = o[i];
+        m[3] = t[i];
+        m[4] = a[i];
+        m[5] = x[i];
+        m[6] = s[i];
+        m[7] = as_float4(y[i]);
+    } else {
+        p[i] = m[0];
+        v[i] = m[1];
+        o[i] = m[2];
+        t[i] = m[3];
+        a[i] = m[4];
+        x[i] = m[5];
+        s[i] = m[6];
+        y[i] = as_uint4(m[7]);
+    }
+}
+
 __kernel void dummy(__read_only __global float4 *p,
                     __global float4 *o,
                     __global float4 *x,
@@ -527,6 +650,71 @@ __kernel void dummy(__read_only __global float4 *p,
     x[i] = ss;
 }
 
+//
+// scatterer population
+//
+// Each scatterer derives its seeds from its uid so any split of the domain among
+// the workers gives the same population. The drop size is drawn from the DSD CDF.
+//
+// pop_desc = (uid of the first scatterer, DSD bin count or 0 for none, random seed, uniform DSD)
+//
+__kernel void scat_pop(__global float4 *p,
+                       __global float4 *v,
+                       __global float4 *o,
+                       __global float4 *t,
+                       __global float4 *x,
+                       __global float4 *r,
+                       __global float4 *s,
+                       __global uint4 *y,
+                       __global const float *dsd_cdf,
+                       __global const float *dsd_r,
+                       const uint4 pop_desc,
+                       const float16 sim_desc)
+{
+    const unsigned int i = get_global_id(0);
+    const uint uid = pop_desc.s0 + (uint)(i - get_global_offset(0));
+    const int dsd_count = (int)pop_desc.s1;
+    
+    uint4 seed = hash_uint4((uint4)(4 * uid) + (uint4)(0, 1, 2, 3) ^ hash_uint4((uint4)(pop_desc.s2)));
+    seed = (seed & 0x7FFFFFFFu) | 1u;
+    
+    // Same layout as the host population: anywhere in x & y, within 10 m of the bottom
+    float4 u = rand(&seed);
+    float4 pos = (float4)(fma(u.xy, sim_desc.hi.s45, sim_desc.hi.s01), fma(u.z, 10.0f, sim_desc.hi.s2), 0.0f);
+    float4 aux = (float4)(0.0f, u.w, 0.0f, 1.0f);
+    
+    if (dsd_count > 0) {
+        const float a = rand(&seed).x;
+        int bin;
+        if (pop_desc.s3) {
+            bin = min((int)(a * (float)dsd_count), dsd_count - 1);
+        } else {
+            // Last bin with dsd_cdf[bin] <= a
+            int lo = 0, hi = dsd_count - 1;
+            while (lo < hi) {
+                int mid = (lo + hi + 1) / 2;
+                if (a >= dsd_cdf[mid]) {
+                    lo = mid;
+                } else {
+                    hi = mid - 1;
+                }
+            }
+            bin = lo;
+        }
+        pos.w = dsd_r[bin];
+        aux.s2 = ((float)bin + 0.5f) / (float)dsd_count;
+    }
+    
+    p[i] = pos;
+    v[i] = FLOAT4_ZERO;
+    o[i] = (float4)(0.5f, -0.5f, -0.5f, 0.5f);                    // Facing the beam
+    t[i] = QUAT_IDENTITY;
+    x[i] = aux;
+    r[i] = (float4)(1.0f, 0.0f, 1.0f, 0.0f);
+    s[i] = FLOAT4_ZERO;
+    y[i] = seed;
+}
+
 //
 // background attributes
 //
@@ -537,8 +725,11 @@ __kernel void bg_atts(__global float4 *p,
                       __read_only image3d_t wind_uvwt,
                       __read_only image3d_t wind_cpxx,
                       const float16 wind_desc,
+                      __read_only image3d_t wind_nest_uvwt,
+                      __constant float16 *wind_nest_desc,
                       __constant float4 *drop_rcs,
                       const float4 drop_rcs_desc,
+                      const float4 slab_desc,
                       const float16 sim_desc)
 {
 
@@ -556,6 +747,11 @@ __kernel void bg_atts(__global float4 *p,
         uint4 seed = y[i];
         float4 r = rand(&seed);
         pos.xyz = r.xyz * sim_desc.hi.s456 + sim_desc.hi.s012;
+        // Draw again until the position is in the slab of this worker, the migration takes the few that are not
+        for (int k = 1; k < (int)slab_desc.s3 && !is_in_slab(pos, slab_desc); k++) {
+            r = rand(&seed);
+            pos.xyz = r.xyz * sim_desc.hi.s456 + sim_desc.hi.s012;
+        }
         //pos.xyz = (float3)(fma(r.xy, sim_desc.hi.s45, sim_desc.hi.s01), MIN_HEIGHT);   // Feed from the bottom
         vel = FLOAT4_ZERO;
 
@@ -566,11 +762,8 @@ __kernel void bg_atts(__global float4 *p,
         return;
     }
 
-    // Derive the lookup index
-    float4 wind_coord = wind_table_index(pos, wind_desc, sim_desc);
-    
-    // Look up the background velocity from the table
-    vel = read_imagef(wind_uvwt, sampler, wind_coord);
+    // Look up the background velocity from the tables
+    vel = compute_bg_vel(pos, wind_uvwt, wind_desc, wind_nest_uvwt, wind_nest_desc, sim_desc);
     
     float4 rcs = compute_ellipsoid_rcs(pos, drop_rcs, drop_rcs_desc);
     
@@ -594,8 +787,11 @@ __kernel void fp_atts(__global float4 *p,
                       __read_only image3d_t les_uvwt,
                       __read_only image3d_t les_cpxx,
                       const float16 les_desc,
+                      __read_only image3d_t les_nest_uvwt,
+                      __constant float16 *les_nest_desc,
                       __constant float4 *drop_rcs,
                       const float4 drop_rcs_desc,
+                      const float4 slab_desc,
                       const float16 sim_desc)
 {
     const unsigned int i = get_global_id(0);
@@ -613,7 +809,7 @@ __kernel void fp_atts(__global float4 *p,
 
     // Derive the lookup index
     float4 coord = wind_table_index(pos, les_desc, sim_desc);
-    float4 uvwt = read_imagef(les_uvwt, sampler, coord);
+    float4 uvwt = compute_bg_vel(pos, les_uvwt, les_desc, les_nest_uvwt, les_nest_desc, sim_desc);
     float4 cpxx = read_imagef(les_cpxx, sampler, coord);
     
     // Accumulate the phase to the existing phase stored in rcs.s3
@@ -657,8 +853,11 @@ __kernel void el_atts(__global float4 *p,                  // position (x, y, z)
                       __read_only image3d_t wind_uvwt,
                       __read_only image3d_t wind_cpxx,
                       const float16 wind_desc,
+                      __read_only image3d_t wind_nest_uvwt,
+                      __constant float16 *wind_nest_desc,
                       __constant float4 *drop_rcs,
                       const float4 drop_rcs_desc,
+                      const float4 slab_desc,
                       const float16 sim_desc)
 {
     const unsigned int i = get_global_id(0);
@@ -688,15 +887,17 @@ __kernel void el_atts(__global float4 *p,                  // position (x, y, z)
 
         //pos.xyz = (float3)(fma(r.xy, sim_desc.hi.s45, sim_desc.hi.s01), MIN_HEIGHT);   // Feed from the bottom
         pos.xyz = fma(r.xyz, sim_desc.hi.s456, sim_desc.hi.s012);
+        // Draw again until the position is in the slab of this worker, the migration takes the few that are not
+        for (int k = 1; k < (int)slab_desc.s3 && !is_in_slab(pos, slab_desc); k++) {
+            r = rand(&seed);
+            pos.xyz = fma(r.xyz, sim_desc.hi.s456, sim_desc.hi.s012);
+        }
         vel = FLOAT4_ZERO;
 
     } else {
 
-        // Derive the lookup index
-        float4 wind_coord = wind_table_index(pos, wind_desc, sim_desc);
-
-        // Look up the background velocity from the table
-        float4 bg_vel = read_imagef(wind_uvwt, sampler, wind_coord);
+        // Look up the background velocity from the tables
+        float4 bg_vel = compute_bg_vel(pos, wind_uvwt, wind_desc, wind_nest_uvwt, wind_nest_desc, sim_desc);
 
         // Particle velocity due to drag
         float4 delta_v = bg_vel - vel;
@@ -750,6 +951,8 @@ __kernel void db_atts(__global float4 *p,
                       __read_only image3d_t wind_uvwt,
                       __read_only image3d_t wind_cpxx,
                       const float16 wind_desc,
+                      __read_only image3d_t wind_nest_uvwt,
+                      __constant float16 *wind_nest_desc,
                       __read_only image2d_t adm_cd,
                       __read_only image2d_t adm_cm,
                       const float16 adm_desc,
@@ -758,6 +961,7 @@ __kernel void db_atts(__global float4 *p,
                       const float16 rcs_desc,
                       __constant float *dff_icdf,
                       const float16 dff_desc,
+                      const float4 slab_desc,
                       const float16 sim_desc)
 {
     const unsigned int i = get_global_id(0);
@@ -789,60 +993,66 @@ __kernel void db_atts(__global float4 *p,
 
     if (is_outside) {
         uint4 seed = y[i];
-        float4 r = rand(&seed);
-
-        // Reposition the xy components if the concept of debris flux as a velocity is activated
-        if (concept & RSSimulationConceptDebrisFluxFromVelocity) {
-            // Local scale and offset, flux pdf always starts with offset 0 so we don't calculate it like other tables
-            float2 table_s = (float2)(dff_desc.sf, dff_desc.sf);
-            float2 table_o = (float2)(0.0f, 1.0f);
-            float2 i_cdf_2 = (float2)(r.x, r.x);
-            
-            // e.g., If fidx_raw = 4.023, fidx_int = 4.0 ==> iidx = 4; fidx_dec = 0.023
-            float2 fidx_int;
-            float2 fidx_raw = clamp(fma(i_cdf_2, table_s, table_o), 0.0f, dff_desc.sf); // fidx_raw in [0, count)
-            float2 fidx_dec = fract(fidx_raw, &fidx_int);
-            uint2 iidx = convert_uint2(fidx_int);
-            float cidx = mix(dff_icdf[iidx.s0], dff_icdf[iidx.s1], fidx_dec.s0);
+        float4 r;
+
+        // Draw again until the position is in the slab of this worker, the migration takes the few that are not
+        int draws = 0;
+        do {
+            r = rand(&seed);
+
+            // Reposition the xy components if the concept of debris flux as a velocity is activated
+            if (concept & RSSimulationConceptDebrisFluxFromVelocity) {
+                // Local scale and offset, flux pdf always starts with offset 0 so we don't calculate it like other tables
+                float2 table_s = (float2)(dff_desc.sf, dff_desc.sf);
+                float2 table_o = (float2)(0.0f, 1.0f);
+                float2 i_cdf_2 = (float2)(r.x, r.x);
             
-//            if (i < 1000000) {
-//                printf("i = %d   table_s = %.2v2f  o = %.2v2f  --> %.2v2f   dff_desc.sc = %.1f\n", i, table_s, table_o, fma(i_cdf_2, table_s, table_o), dff_desc.sc);
-//                printf("             r.xy = %.2v2f --> fidx_raw = %.2v2f  iidx = %v2d -> cidx = %.2f   pos.xy = %.2v2f\n", r.xy, fidx_raw, iidx, cidx, pos.xy);
-//            }
-
-            //pos.xy = fma(pos.xy, sim_desc.hi.s45 * dff_desc.s01, sim_desc.hi.s01);
+                // e.g., If fidx_raw = 4.023, fidx_int = 4.0 ==> iidx = 4; fidx_dec = 0.023
+                float2 fidx_int;
+                float2 fidx_raw = clamp(fma(i_cdf_2, table_s, table_o), 0.0f, dff_desc.sf); // fidx_raw in [0, count)
+                float2 fidx_dec = fract(fidx_raw, &fidx_int);
+                uint2 iidx = convert_uint2(fidx_int);
+                float cidx = mix(dff_icdf[iidx.s0], dff_icdf[iidx.s1], fidx_dec.s0);
             
-            // Map cell index to x-index and y-index
-            pos.y = floor(cidx / dff_desc.sd);
-            pos.x = fma(pos.y, -dff_desc.sd, cidx);  // Same as pos.x = cidx - pos.y * dff_desc.sd;
-            pos.y += r.y;
-
-            // We use H->workers[i].dff_desc.s[RSTableDescriptionReserved6] = (float)map->y_ to indicate stretched grid
-            if (dff_desc.se == 1.0f) {
-                float2 pos_rel = pos.xy - fma(0.5f, dff_desc.s89, 0.5f);
-                pos.xy = fma(pow(dff_desc.s45, fabs(pos_rel)), -dff_desc.s01, dff_desc.s01);
-                pos.xy = copysign(pos.xy, pos_rel) + fma(0.5f, sim_desc.hi.s45, sim_desc.hi.s01);
-            } else if (dff_desc.se == 2.0f) {
-                // Checkerboard thing, stretch the board to the simulation domain
-                pos.xy = fma(pos.xy, sim_desc.hi.s45 * dff_desc.s01, sim_desc.hi.s01);
-            } else {
 //                if (i < 1000000) {
-//                    printf("i = %d   dff_desc = %.2v8f\n", i, dff_desc.lo);
+//                    printf("i = %d   table_s = %.2v2f  o = %.2v2f  --> %.2v2f   dff_desc.sc = %.1f\n", i, table_s, table_o, fma(i_cdf_2, table_s, table_o), dff_desc.sc);
+//                    printf("             r.xy = %.2v2f --> fidx_raw = %.2v2f  iidx = %v2d -> cidx = %.2f   pos.xy = %.2v2f\n", r.xy, fidx_raw, iidx, cidx, pos.xy);
 //                }
-                pos.xy = fma(pos.xy, dff_desc.s01, sim_desc.hi.s01);
-            }
+
+                //pos.xy = fma(pos.xy, sim_desc.hi.s45 * dff_desc.s01, sim_desc.hi.s01);
             
-            pos.z = MIN_HEIGHT;
-        } else {
-            // Random within the box but z component is at the lowest + MIN_HEIGHT
-            pos.xyz = (float3)(fma(r.xy, sim_desc.hi.s45, sim_desc.hi.s01), sim_desc.hi.s2 + MIN_HEIGHT);
+                // Map cell index to x-index and y-index
+                pos.y = floor(cidx / dff_desc.sd);
+                pos.x = fma(pos.y, -dff_desc.sd, cidx);  // Same as pos.x = cidx - pos.y * dff_desc.sd;
+                pos.y += r.y;
+
+                // We use H->workers[i].dff_desc.s[RSTableDescriptionReserved6] = (float)map->y_ to indicate stretched grid
+                if (dff_desc.se == 1.0f) {
+                    float2 pos_rel = pos.xy - fma(0.5f, dff_desc.s89, 0.5f);
+                    pos.xy = fma(pow(dff_desc.s45, fabs(pos_rel)), -dff_desc.s01, dff_desc.s01);
+                    pos.xy = copysign(pos.xy, pos_rel) + fma(0.5f, sim_desc.hi.s45, sim_desc.hi.s01);
+                } else if (dff_desc.se == 2.0f) {
+                    // Checkerboard thing, stretch the board to the simulation domain
+                    pos.xy = fma(pos.xy, sim_desc.hi.s45 * dff_desc.s01, sim_desc.hi.s01);
+                } else {
+//                    if (i < 1000000) {
+//                        printf("i = %d   dff_desc = %.2v8f\n", i, dff_desc.lo);
+//                    }
+                    pos.xy = fma(pos.xy, dff_desc.s01, sim_desc.hi.s01);
+                }
+            
+                pos.z = MIN_HEIGHT;
+            } else {
+                // Random within the box but z component is at the lowest + MIN_HEIGHT
+                pos.xyz = (float3)(fma(r.xy, sim_desc.hi.s45, sim_desc.hi.s01), sim_desc.hi.s2 + MIN_HEIGHT);
 
-            // Random within the box but z component is at MIN_HEIGHT
-            //pos.xyz = (float3)(fma(r.xy, sim_desc.hi.s45, sim_desc.hi.s01), MIN_HEIGHT);
+                // Random within the box but z component is at MIN_HEIGHT
+                //pos.xyz = (float3)(fma(r.xy, sim_desc.hi.s45, sim_desc.hi.s01), MIN_HEIGHT);
             
-            // Random within the box
-            //pos.xyz = fma(r.xyz, sim_desc.hi.s456, sim_desc.hi.s012);
-        }
+                // Random within the box
+                //pos.xyz = fma(r.xyz, sim_desc.hi.s456, sim_desc.hi.s012);
+            }
+        } while (++draws < (int)slab_desc.s3 && !is_in_slab(pos, slab_desc));
 
         r = rand(&seed);
         float4 c = (float4)(sqrt(-2.0f * log(r.s012)), r.s3);
@@ -873,7 +1083,7 @@ __kernel void db_atts(__global float4 *p,
         return;
     }
 
-    float4 vel_bg = compute_bg_vel(pos, wind_uvwt, wind_desc, sim_desc);
+    float4 vel_bg = compute_bg_vel(pos, wind_uvwt, wind_desc, wind_nest_uvwt, wind_nest_desc, sim_desc);
 
     float4 dwdt, dudt = compute_dudt_dwdt(&dwdt, vel, vel_bg, ori, adm_cd, adm_cm, adm_desc);
     
@@ -1334,7 +1544,10 @@ __kernel void make_pulse_pass_2_local(__global float4 *out,
     barrier(CLK_LOCAL_MEM_FENCE);
     
     //	printf("out[%d] = %.2f\n", groupd_id, shared[local_id].x);
-    out[groupd_id] = shared[local_id];
+    // The pulse only has range_count cells, work items beyond hold partial sums
+    if (groupd_id < range_count) {
+        out[groupd_id] = shared[local_id];
+    }
 }
 
 
@@ -1355,7 +1568,9 @@ __kernel void make_pulse_pass_2_range(__global float4 *out,
         tmp += in[i];
     }
     barrier(CLK_LOCAL_MEM_FENCE);
-    out[range_id] = tmp;
+    if (range_id < range_count) {
+        out[range_id] = tmp;
+    }
 }
 
 
@@ -113,6 +113,8 @@ typedef struct _rs_table3d {
     uint32_t      spacing;            // spacing convention: uniform or stretched (geometric)
     cl_float4     *uvwt;              // Data in float4 grid, e.g., u, v, w, t
     cl_float4     *cpxx;              // Data in float4 grid, e.g., cn2, p, _, _
+    cl_half4      *uvwt_half;         // Half-precision uvwt, uploaded as CL_HALF_FLOAT when not NULL
+    cl_half4      *cpxx_half;         // Half-precision cpxx, uploaded as CL_HALF_FLOAT when uvwt_half is not NULL
 } RSTable3D;
 
 
@@ -140,6 +142,10 @@ typedef uint32_t RSSimulationDescription;
 typedef uint32_t RSDropSizeDistribution;
 typedef uint32_t RSTableSpacing;
 typedef uint32_t RSSimulationConcept;
+typedef uint32_t RSWindModel;
+typedef uint32_t RSWindModelDescription;
+typedef uint32_t RSWorkerPartition;
+typedef uint32_t RSHostMirror;
 
 #pragma pack(push, 1)
 
@@ -154,6 +160,7 @@ typedef struct _rs_worker {
     // OpenCL device
     cl_device_id           dev;
     cl_uint                num_cus;
+    char                   segment;                      // Scatterer segment on the device, the first one owns the large tables
     
     // Scatter bodies
     size_t                 num_scats;
@@ -163,6 +170,26 @@ typedef struct _rs_worker {
     
     RSMakePulseParams      make_pulse_params;
     
+    // Kernel throughput, accumulated from profiled events in RS_advance_time() and RS_make_pulse()
+    double                 busy_time;                    // Seconds spent in the attribute and pulse kernels
+    double                 busy_scats;                   // Scatterers updated during busy_time
+    
+    // Spatial slab
+    cl_float4              slab_desc;                    // RSSlabDescription, where the attribute kernels respawn the scatterers
+    char                   in_beam;                      // Slab intersects the current beam, the pulse work is skipped otherwise
+    char                   sig_stale;                    // Signal was not refreshed while out of the beam
+    
+    // Streaming, chunks of the population go through two sets of buffers, set 0 aliases the scat_* buffers
+    size_t                 stream_chunk;                 // Scatterers per chunk, 0 when the population is resident
+    cl_float4              *stream_pulse_parts;          // Pulse of every chunk, summed once all chunks are done
+    cl_mem                 stream_pos[2];
+    cl_mem                 stream_vel[2];
+    cl_mem                 stream_aux[2];
+    cl_mem                 stream_rcs[2];
+    cl_mem                 stream_sig[2];
+    cl_mem                 stream_rnd[2];
+    cl_mem                 stream_pulse[2];
+    
     // GPU side memory
     cl_mem                 scat_pos;                     // x, y, z coordinates
     cl_mem                 scat_vel;                     // u, v, w wind components
@@ -202,6 +229,12 @@ typedef struct _rs_worker {
     cl_mem                 les_cpxx[2];                  // Double buffering of cn2, p, _, _
     cl_float16             les_desc;                     // LES-desc of the table
     unsigned int           les_id;                       // Index of the active buffer
+    char                   les_half;                     // Images were created as CL_HALF_FLOAT
+    size_t                 les_region[3];                // Dimensions the images were created with
+    cl_mem                 les_nest_uvwt[2];             // Double buffering of the refined grids of u, v, w, t stacked along z
+    cl_mem                 les_nest_desc;                // Descriptions of the refined grids, RS_MAX_VEL_NESTS x float16
+    char                   les_nest_half;                // Refined grids were created as CL_HALF_FLOAT
+    size_t                 les_nest_region[3];           // Dimensions the refined grids were created with
     
     cl_mem                 dff_icdf[2];                  // Debris flux field
     cl_float16             dff_desc;                // Debris flux field description
@@ -243,12 +276,14 @@ typedef struct _rs_worker {
     cl_program             prog;
     
     cl_kernel              kern_io;
+    cl_kernel              kern_scat_pop;
     cl_kernel              kern_db_rcs;
     cl_kernel              kern_bg_atts;
     cl_kernel              kern_fp_atts;
     cl_kernel              kern_el_atts;
     cl_kernel              kern_db_atts;
     cl_kernel              kern_scat_clr;
+    cl_kernel              kern_scat_move;
     cl_kernel              kern_scat_sig_aux;
     cl_kernel              kern_make_pulse_pass_1;
     cl_kernel              kern_make_pulse_pass_2;
@@ -257,7 +292,9 @@ typedef struct _rs_worker {
     cl_kernel              kern_make_pulse_pass_2_range;
     
     cl_command_queue       que;
+    cl_command_queue       que_copy;                     // Transfers of the streaming chunks, overlapped with que
     cl_event               event_upload;
+    cl_event               event_nest_upload;            // Last slab of the refined grids fed by an LES, still in flight
     
 #endif
     
@@ -283,6 +320,9 @@ struct _rs_handle {
     RSfloat                sim_toc;
     cl_float16             sim_desc;
     RSSimulationConcept    sim_concept;
+    char                   vel_half;
+    RSWindModel            vel_model;
+    cl_float16             vel_model_desc;
     
     // Table related variables
     uint32_t               vel_idx;
@@ -290,6 +330,15 @@ struct _rs_handle {
     uint32_t               adm_idx;
     uint32_t               rcs_idx;
     
+    // Refined wind grids, kept on the host so they can be restacked
+    RSTable3D              vel_nests[RS_MAX_VEL_NESTS];
+    uint32_t               vel_nest_count;
+    LESHandle              vel_nest_les[RS_MAX_VEL_NESTS];   // Source of the frames of each grid, NULL if it is static
+    uint32_t               vel_nest_idx;                     // Frame the grids fed by an LES are showing
+
+    // Debris flux field, the workers have it on the devices
+    float                  *dff_icdf;
+
     // Table parameter shadow copy: only the constants, not the pointers
     LESTable               vel_desc;
     ADMTable               adm_desc[RS_MAX_DEBRIS_TYPES];
@@ -312,7 +361,7 @@ struct _rs_handle {
     cl_uint4               *scat_rnd;       // random seed
     cl_float4              *pulse;
     
-    cl_float4              *pulse_tmp[RS_MAX_GPU_DEVICE];
+    cl_float4              *pulse_tmp[RS_MAX_WORKERS];
     
     size_t                 mem_size;
     
@@ -324,12 +373,35 @@ struct _rs_handle {
     cl_uint                vendors[RS_MAX_GPU_DEVICE];
     cl_device_id           devs[RS_MAX_GPU_DEVICE];
     
+    // Host threads standing in for the workers, NULL unless RS_METHOD_NATIVE
+    struct _rs_native      *native;
+    
     // OpenGL sharing
     char                   has_vbo_from_gl;
     
     // GPU side memory
-    RSWorker               workers[RS_MAX_GPU_DEVICE];
-    size_t                 offset[RS_MAX_GPU_DEVICE];
+    RSWorker               workers[RS_MAX_WORKERS];
+    size_t                 offset[RS_MAX_WORKERS];
+    float                  worker_weights[RS_MAX_WORKERS];  // Share of scatterers, all zeros for an even split
+    
+    // Spatial slabs, azimuth sectors relative to the direction of the domain center
+    RSWorkerPartition      worker_partition;
+    float                  slab_az_center;
+    float                  slab_az_bounds[RS_MAX_WORKERS + 1];
+    float                  slab_range;                   // Closest horizontal distance of the domain
+    float                  slab_speed;                   // Horizontal speed bound of the scatterers, from the last migration
+    uint32_t               slab_migration_tic;
+    
+    // Streaming of a population that lives in host memory only
+    size_t                 stream_chunk;                 // Scatterers per chunk on each worker, 0 = resident population
+    char                   stream_advanced;              // Attributes were advanced along with the last pulse
+    cl_float4              *stream_zeros;                // Fills the tail of a short chunk
+    
+    // Population generated by the scat_pop kernel on each device, the host only derives the DSD tables
+    char                   device_population;
+    
+    // Host mirrors of the scatterer arrays that stay allocated, the others come and go with the downloads
+    RSHostMirror           host_mirrors;
     
     // Anchors
     ssize_t                num_anchors;
@@ -374,6 +446,8 @@ int RS_indent_copy(char *dst, char *src, const int width);
 RSHandle *RS_init_with_path(const char *bundle_path, RSMethod method, const uint8_t gpu_mask, cl_context_properties sharegroup, const char verb);
 RSHandle *RS_init_for_selected_gpu(const uint8_t gpu_mask, const char verb);
 RSHandle *RS_init_for_cpu_verbose(const char verb);
+RSHandle *RS_init_native_verbose(const char verb);
+RSHandle *RS_init_native_for_selected_threads(const uint8_t thread_mask, const char verb);
 RSHandle *RS_init_verbose(const char verb);
 RSHandle *RS_init(void);
 void RS_free(RSHandle *H);
@@ -417,19 +491,30 @@ void RS_set_angular_weight(RSHandle *H, const float *weights, const float table_
 void RS_set_angular_weight_to_standard(RSHandle *H, float beamwidth_deg);
 void RS_set_angular_weight_to_double_cone(RSHandle *H, float beamwidth_deg);
 
+void RS_set_vel_data_half_precision(RSHandle *H, const char half);
 void RS_set_vel_data_to_config(RSHandle *, LESConfig);
 void RS_set_vel_data_to_LES_table(RSHandle *H, const LESTable *table);
 void RS_set_vel_data_to_uniform(RSHandle *H, cl_float4 velocity);
 void RS_set_vel_data_to_cube27(RSHandle *H);
 void RS_set_vel_data_to_cube125(RSHandle *H);
+void RS_set_vel_data_to_analytic_uniform(RSHandle *H, cl_float4 velocity);
+void RS_set_vel_data_to_analytic_shear(RSHandle *H, cl_float4 velocity, cl_float4 shear);
+void RS_set_vel_data_to_rankine_vortex(RSHandle *H, cl_float4 center, float max_speed, float core_radius, cl_float4 translation);
 void RS_clear_vel_data(RSHandle *H);
+void RS_add_vel_data_nest(RSHandle *H, const RSTable3D table);
+void RS_add_vel_data_nest_from_config(RSHandle *H, const LESConfig c, const float x, const float y);
+void RS_clear_vel_data_nests(RSHandle *H);
 
+int RS_derive_icdf_from_pdf(float *icdf, const int count, const float *pdf, const int pdf_count);
+void RS_derive_flux_pdf_from_LES(float *pdf, const LESTable *leslie);
+void RS_derive_flux_icdf_from_LES(float *icdf, const uint32_t count, const LESTable *leslie);
 void RS_set_debris_flux_field_by_pdf(RSHandle *H, RSTable2D *map, const float *pdf);
 void RS_set_debris_flux_field_by_icdf(RSHandle *H, RSTable2D *map, const float *icdf);
 void RS_set_debris_flux_field_to_center_cell_of_3x3(RSHandle *H);
 void RS_set_debris_flux_field_to_checker_board(RSHandle *H, const int);
 void RS_set_debris_flux_field_to_checker_board_stretched(RSHandle *H, const LESTable *table);
 void RS_set_debris_flux_field_from_LES(RSHandle *H, const LESTable *leslie);
+void RS_set_debris_flux_field_from_analytic_model(RSHandle *H);
 
 void RS_set_scan_pattern(RSHandle *H, const POSPattern *scan_pattern);
 void RS_set_scan_pattern_with_string(RSHandle *H, const char *scan_string);
@@ -437,6 +522,10 @@ void RS_set_scan_pattern_with_string(RSHandle *H, const char *scan_string);
 // New methods
 //void RS_set_obj_data_to_config(RSHandle *H, OBJConfig type);
 void RS_set_random_seed(RSHandle *H, const unsigned int seed);
+void RS_set_worker_partition(RSHandle *H, const RSWorkerPartition partition);
+void RS_set_streaming(RSHandle *H, const size_t chunk);
+void RS_set_device_population(RSHandle *H, const bool device);
+void RS_set_host_mirrors(RSHandle *H, const RSHostMirror mirrors);
 void RS_add_debris(RSHandle *H, OBJConfig type, const size_t count);
 
 #pragma mark -
@@ -465,6 +554,8 @@ void RS_download(RSHandle *H);
 void RS_download_position_only(RSHandle *H);
 void RS_download_orientation_only(RSHandle *H);
 void RS_download_pulse_only(RSHandle *H);
+void RS_download_all(RSHandle *H);
+void RS_balance_workers(RSHandle *H);
 
 //void RS_rcs_from_dsd(RSHandle *H);
 void RS_compute_rcs_ellipsoids(RSHandle *H);
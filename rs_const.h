@@ -16,6 +16,7 @@
 #define RS_MAX_STR               4096
 #define RS_MAX_GPU_PLATFORM        40
 #define RS_MAX_GPU_DEVICE           8
+#define RS_MAX_WORKERS             32     // Workers of all devices, a device may hold several segments of scatterers
 #define RS_MAX_KERNEL_LINES      2048
 #define RS_MAX_KERNEL_SRC      131072
 #define RS_ALIGN_SIZE             128     // Align size. Be sure to have a least 16 for SSE, 32 for AVX, 64 for AVX-512
@@ -24,6 +25,14 @@
 #define RS_MAX_DEBRIS_TYPES         8
 #define RS_MAX_ADM_TABLES           RS_MAX_DEBRIS_TYPES
 #define RS_MAX_RCS_TABLES           RS_MAX_DEBRIS_TYPES
+#define RS_MAX_VEL_NESTS            4
+#define RS_VEL_CROP_HALO            2               // Cells around the domain kept when LES frames are cropped
+#define RS_DFF_ICDF_COUNT        2048               // Entries of the debris flux field ICDF
+#define RS_BALANCE_TOLERANCE        0.02f           // Share difference below which workers are not re-partitioned
+#define RS_SLAB_SAMPLES           256               // Grid samples per dimension to derive equal-area slabs
+#define RS_SLAB_MIGRATION_INTERVAL  100             // Time steps between scatterer exchanges of the slabs
+#define RS_SLAB_SPEED_MARGIN      3.0f              // Speed bound over the fastest scatterer seen, debris may reach 3x the wind
+#define RS_SLAB_RESPAWN_DRAWS     32                // Respawn draws per slab before a scatterer is left to the migration
 
 #define RS_MAX_NUM_SCATS    120000000               // Maximum tested = 110M, 2016-03-003 (25k body/cell)
 #define RS_BODY_PER_CELL          100.0f            // Default scatterer density
@@ -33,6 +42,9 @@
 #define RS_PARAMS_PULSEWIDTH        RS_PARAMS_TAU   // Default pulse width in s, same as RS_PARAMS_TAU
 #define RS_PARAMS_BEAMWIDTH         1.0f
 #define RS_PARAMS_GATEWIDTH         30.0f
+#define RS_ANALYTIC_WIND_WIDTH   2000.0f            // Horizontal extent in m assumed for analytic wind models
+#define RS_ANALYTIC_WIND_HEIGHT  1000.0f            // Vertical extent in m assumed for analytic wind models
+#define RS_ANALYTIC_WIND_SPACING   10.0f            // Nominal grid spacing in m, only used to suggest a scan domain
 
 enum RSStatus {
     RSStatusNull                         = 0,
@@ -53,7 +65,8 @@ enum RS_CL_PASS_2 {
 typedef char RSMethod;
 enum RSMethod {
     RS_METHOD_CPU,
-    RS_METHOD_GPU
+    RS_METHOD_GPU,
+    RS_METHOD_NATIVE                        // Host threads, no OpenCL runtime needed
 };
 
 #endif /* rs_const_h */
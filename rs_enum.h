@@ -26,7 +26,7 @@ enum RSTable3DDescription {
     RSTable3DDescriptionMaximumX                  =  8,
     RSTable3DDescriptionMaximumY                  =  9,
     RSTable3DDescriptionMaximumZ                  = 10,
-    RSTable3DDescription11                        = 11,
+    RSTable3DDescriptionNestCount                 = 11,
     RSTable3DDescriptionRecipInLnX                = 12,
     RSTable3DDescriptionRecipInLnY                = 13,
     RSTable3DDescriptionRecipInLnZ                = 14,
@@ -45,13 +45,73 @@ enum RSTable3DStaggeredDescription {
     RSTable3DStaggeredDescriptionOffsetX          =  8,
     RSTable3DStaggeredDescriptionOffsetY          =  9,
     RSTable3DStaggeredDescriptionOffsetZ          = 10,
-    RSTable3DStaggeredDescription11               = 11,
+    RSTable3DStaggeredDescriptionNestCount        = 11,
     RSTable3DStaggeredDescriptionRecipInLnX       = 12,
     RSTable3DStaggeredDescriptionRecipInLnY       = 13,
     RSTable3DStaggeredDescriptionRecipInLnZ       = 14,
     RSTable3DStaggeredDescriptionTachikawa        = 15
 };
 
+// Refined (nested) wind grids are uniform and stacked along z in one image, sampled at texel centers
+enum RSTable3DNestDescription {
+    RSTable3DNestDescriptionScaleX                =  0,
+    RSTable3DNestDescriptionScaleY                =  1,
+    RSTable3DNestDescriptionScaleZ                =  2,
+    RSTable3DNestDescriptionReserved1             =  3,
+    RSTable3DNestDescriptionOriginX               =  4,
+    RSTable3DNestDescriptionOriginY               =  5,
+    RSTable3DNestDescriptionOriginZ               =  6,
+    RSTable3DNestDescriptionSlabOffsetZ           =  7,
+    RSTable3DNestDescriptionLimitX                =  8,
+    RSTable3DNestDescriptionLimitY                =  9,
+    RSTable3DNestDescriptionLimitZ                = 10,
+    RSTable3DNestDescriptionReserved2             = 11,
+    RSTable3DNestDescriptionReserved3             = 12,
+    RSTable3DNestDescriptionReserved4             = 13,
+    RSTable3DNestDescriptionReserved5             = 14,
+    RSTable3DNestDescriptionReserved6             = 15
+};
+
+// Analytic wind models use the wind table description slot, Format and NestCount stay where they are
+enum RSWindModelDescription {
+    RSWindModelDescriptionVelocityX               =  0,
+    RSWindModelDescriptionVelocityY               =  1,
+    RSWindModelDescriptionVelocityZ               =  2,
+    RSWindModelDescriptionRefreshTime             =  3,
+    RSWindModelDescriptionShearX                  =  4,  // du / dz
+    RSWindModelDescriptionShearY                  =  5,  // dv / dz
+    RSWindModelDescriptionShearZ                  =  6,  // dw / dz
+    RSWindModelDescriptionFormat                  =  7,
+    RSWindModelDescriptionCenterX                 =  8,
+    RSWindModelDescriptionCenterY                 =  9,
+    RSWindModelDescriptionModel                   = 10,
+    RSWindModelDescriptionNestCount               = 11,
+    RSWindModelDescriptionMaximumSpeed            = 12,
+    RSWindModelDescriptionCoreRadius              = 13,
+    RSWindModelDescriptionReserved1               = 14,
+    RSWindModelDescriptionReserved2               = 15
+};
+
+// How the scatterers are distributed across the workers
+enum RSWorkerPartition {
+    RSWorkerPartitionRandom                       = 0,     // Even slices of scatterers spread over the whole domain
+    RSWorkerPartitionAzimuthSector                = 1      // Each worker owns an azimuth sector of the domain
+};
+
+// Host copies of the scatterer arrays, the ones left out are only allocated when a download asks for them
+enum RSHostMirror {
+    RSHostMirrorNone                              = 0,
+    RSHostMirrorPosition                          = 1,
+    RSHostMirrorVelocity                          = 1 << 1,
+    RSHostMirrorOrientation                       = 1 << 2,
+    RSHostMirrorTumble                            = 1 << 3,
+    RSHostMirrorAuxiliary                         = 1 << 4,
+    RSHostMirrorRadarCrossSection                 = 1 << 5,
+    RSHostMirrorSignal                            = 1 << 6,
+    RSHostMirrorRandomSeed                        = 1 << 7,
+    RSHostMirrorAll                               = 0xFF
+};
+
 enum RSTableDescription {
     RSTableDescriptionScaleX                      =  0,
     RSTableDescriptionScaleY                      =  1,
@@ -109,6 +169,13 @@ enum RSSimulationDescription {
     RSSimulationDescription15                     = 15   //
 };
 
+enum RSSlabDescription {
+    RSSlabDescriptionCenter                       =  0,  // Azimuth of the domain center
+    RSSlabDescriptionLower                        =  1,  // Azimuth bounds of the slab, relative to the center
+    RSSlabDescriptionUpper                        =  2,
+    RSSlabDescriptionDraws                        =  3   // Draws to respawn a scatterer inside the slab, 0 = no slab
+};
+
 enum RSDropSizeDistribution {
     RSDropSizeDistributionUndefined               = 0,
     RSDropSizeDistributionMarshallPalmer          = 1,
@@ -121,7 +188,16 @@ enum RSTableSpacing {
     RSTableSpacingStretchedX                      = 1,
     RSTableSpacingStretchedY                      = 1 << 1,
     RSTableSpacingStretchedZ                      = 1 << 2,
-    RSTableSpacingStretchedXYZ                    = RSTableSpacingStretchedX | RSTableSpacingStretchedY | RSTableSpacingStretchedZ
+    RSTableSpacingStretchedXYZ                    = RSTableSpacingStretchedX | RSTableSpacingStretchedY | RSTableSpacingStretchedZ,
+    RSTableSpacingAnalytic                        = 1 << 3     // No table, the description holds an analytic wind model
+};
+
+// Analytic wind models, the terms are summed so they can be combined
+enum RSWindModel {
+    RSWindModelTable                              = 0,
+    RSWindModelUniform                            = 1,
+    RSWindModelLinearShear                        = 1 << 1,
+    RSWindModelRankineVortex                      = 1 << 2
 };
 
 enum RSSimulationConcept {
@@ -0,0 +1,1049 @@
+//
+//  rs_native.c
+//  Radar Simulation Framework
+//
+//  Native engine: the attribute, signal and pulse kernels of rs.cl ported to host threads.
+//  Each thread owns the scatterers of one worker, i.e., H->offset[i] + [0, num_scats), and
+//  works directly on the host arrays so there is nothing to upload or download.
+//
+//  Created by Boon Leng Cheong.
+//  Copyright (c) 2015-2016 Boon Leng Cheong. All rights reserved.
+//
+
+#include "rs.h"
+#include "rs_priv.h"
+
+#include <immintrin.h>
+
+#define RS_NATIVE_MIN_HEIGHT   2.0f
+#define RS_NATIVE_GRAVITY      -9.8f
+
+enum RSNativeJob {
+    RSNativeJobNone,
+    RSNativeJobAdvanceTime,
+    RSNativeJobMakePulse,
+    RSNativeJobAuxiliaryAttributes,
+    RSNativeJobQuit
+};
+
+// Texels in the same order as a CL image, x runs the fastest
+typedef struct _rs_native_image {
+    cl_float4          *data;
+    uint32_t           w;
+    uint32_t           h;
+    uint32_t           d;
+} RSNativeImage;
+
+// Constants of sim_desc in the form the ported kernels use them, refreshed before every job
+typedef struct _rs_native_frame {
+    float              beam[3];
+    float              origin[3];
+    float              size[3];
+    float              center[2];
+    float              dt;
+    float              wav_num;
+    float              age_step;
+    uint32_t           concept;
+} RSNativeFrame;
+
+typedef struct _rs_native_thread {
+    struct _rs_native  *N;
+    int                id;
+} RSNativeThread;
+
+typedef struct _rs_native {
+    RSHandle           *H;
+    int                count;
+    pthread_t          tid[RS_MAX_WORKERS];
+    RSNativeThread     threads[RS_MAX_WORKERS];
+
+    // Job hand-off, the caller waits until busy drops back to zero
+    pthread_mutex_t    lock;
+    pthread_cond_t     job_ready;
+    pthread_cond_t     job_done;
+    uint32_t           job_tic;
+    int                job;
+    int                busy;
+    RSNativeFrame      frame;
+    char               db_rcs;
+    char               sig_update[RS_MAX_WORKERS];
+
+    // Host copies of the tables that the CL workers keep as buffers and images
+    float              *range_weight;
+    char               range_weight_zero_edges;      // Gates beyond the table can be skipped
+    float              *angular_weight;
+    cl_float4          *rcs_ellipsoid;
+    RSNativeImage      les_uvwt;
+    RSNativeImage      les_cpxx;
+    RSNativeImage      les_nest_uvwt;
+    cl_float16         les_nest_desc[RS_MAX_VEL_NESTS];
+    RSNativeImage      adm_cd[RS_MAX_ADM_TABLES];
+    RSNativeImage      adm_cm[RS_MAX_ADM_TABLES];
+    RSNativeImage      rcs_real[RS_MAX_RCS_TABLES];
+    RSNativeImage      rcs_imag[RS_MAX_RCS_TABLES];
+} RSNative;
+
+
+#pragma mark -
+#pragma mark Basic Functions
+
+static inline float RS_native_clamp(const float x, const float lo, const float hi) {
+    return fminf(fmaxf(x, lo), hi);
+}
+
+
+static inline float RS_native_length3(const cl_float4 v) {
+    return sqrtf(v.s[0] * v.s[0] + v.s[1] * v.s[1] + v.s[2] * v.s[2]);
+}
+
+
+static inline float RS_native_length4(const cl_float4 v) {
+    return sqrtf(v.s[0] * v.s[0] + v.s[1] * v.s[1] + v.s[2] * v.s[2] + v.s[3] * v.s[3]);
+}
+
+
+static inline cl_float4 RS_native_normalize4(const cl_float4 v) {
+    const float n = RS_native_length4(v);
+    if (n == 0.0f) {
+        return v;
+    }
+    return (cl_float4){{v.s[0] / n, v.s[1] / n, v.s[2] / n, v.s[3] / n}};
+}
+
+
+static inline float RS_native_sign(const float x) {
+    return x > 0.0f ? 1.0f : (x < 0.0f ? -1.0f : 0.0f);
+}
+
+
+// Same generator as rand() in rs.cl, a Park-Miller step on each 32-bit lane
+static inline cl_float4 RS_native_rand(cl_uint4 *seed) {
+    cl_float4 r;
+    for (int k = 0; k < 4; k++) {
+        seed->s[k] = (seed->s[k] * 16807u) & 0x7FFFFFFF;
+        r.s[k] = (float)seed->s[k] * (1.0f / 2147483647.0f);
+    }
+    return r;
+}
+
+
+static inline cl_float4 RS_native_quat_mult(const cl_float4 l, const cl_float4 r) {
+    return (cl_float4){{
+        l.w * r.x - l.z * r.y + l.y * r.z + l.x * r.w,
+        l.w * r.y + l.z * r.x + l.y * r.w - l.x * r.z,
+        l.w * r.z + l.z * r.w - l.y * r.x + l.x * r.y,
+        l.w * r.w - l.z * r.z - l.y * r.y - l.x * r.x
+    }};
+}
+
+
+static inline cl_float4 RS_native_quat_conj(const cl_float4 q) {
+    return (cl_float4){{-q.x, -q.y, -q.z, q.w}};
+}
+
+
+static inline cl_float4 RS_native_quat_rotate(const cl_float4 v, const cl_float4 q) {
+    return RS_native_quat_mult(RS_native_quat_mult(q, v), RS_native_quat_conj(q));
+}
+
+
+// Linear interpolation of a 1D table at index x, both neighbors clamped to [0, xm] as the kernels do with fract()
+static inline float RS_native_read_table(const float *table, const float x, const float xm) {
+    const float f0 = RS_native_clamp(x, 0.0f, xm);
+    const float f1 = RS_native_clamp(x + 1.0f, 0.0f, xm);
+    const float i0 = floorf(f0);
+    const float a = fminf(f0 - i0, 0x1.fffffep-1f);
+    const float w0 = table[(uint32_t)i0];
+    return w0 + (table[(uint32_t)f1] - w0) * a;
+}
+
+
+#pragma mark -
+#pragma mark Image Sampler
+
+// Unnormalized coordinate, linear filter, clamp to edge: the sampler of rs.cl
+static inline void RS_native_texel_axis(const float x, const uint32_t n, uint32_t *i0, uint32_t *i1, float *a) {
+    float u = x - 0.5f;
+    // Far out (or NaN) coordinates land on the edge texel
+    if (!(u > -1.0f)) {
+        u = -1.0f;
+    } else if (u > (float)n) {
+        u = (float)n;
+    }
+    const float f = floorf(u);
+    const int i = (int)f;
+    *a = u - f;
+    *i0 = i < 0 ? 0 : (i >= (int)n ? n - 1 : i);
+    *i1 = i + 1 < 0 ? 0 : (i + 1 >= (int)n ? n - 1 : i + 1);
+}
+
+
+static inline __m128 RS_native_lerp(const __m128 a, const __m128 b, const float t) {
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t)));
+}
+
+
+static inline cl_float4 RS_native_read_image_2d(const RSNativeImage *image, const float x, const float y) {
+    uint32_t x0, x1, y0, y1;
+    float a, b;
+    RS_native_texel_axis(x, image->w, &x0, &x1, &a);
+    RS_native_texel_axis(y, image->h, &y0, &y1, &b);
+    const cl_float4 *r0 = image->data + (size_t)y0 * image->w;
+    const cl_float4 *r1 = image->data + (size_t)y1 * image->w;
+    const __m128 v0 = RS_native_lerp(_mm_load_ps(r0[x0].s), _mm_load_ps(r0[x1].s), a);
+    const __m128 v1 = RS_native_lerp(_mm_load_ps(r1[x0].s), _mm_load_ps(r1[x1].s), a);
+    cl_float4 v;
+    _mm_store_ps(v.s, RS_native_lerp(v0, v1, b));
+    return v;
+}
+
+
+static inline cl_float4 RS_native_read_image_3d(const RSNativeImage *image, const float x, const float y, const float z) {
+    uint32_t x0, x1, y0, y1, z0, z1;
+    float a, b, c;
+    RS_native_texel_axis(x, image->w, &x0, &x1, &a);
+    RS_native_texel_axis(y, image->h, &y0, &y1, &b);
+    RS_native_texel_axis(z, image->d, &z0, &z1, &c);
+    const size_t w = image->w;
+    const cl_float4 *s0 = image->data + (size_t)z0 * w * image->h;
+    const cl_float4 *s1 = image->data + (size_t)z1 * w * image->h;
+    const __m128 v00 = RS_native_lerp(_mm_load_ps(s0[y0 * w + x0].s), _mm_load_ps(s0[y0 * w + x1].s), a);
+    const __m128 v01 = RS_native_lerp(_mm_load_ps(s0[y1 * w + x0].s), _mm_load_ps(s0[y1 * w + x1].s), a);
+    const __m128 v10 = RS_native_lerp(_mm_load_ps(s1[y0 * w + x0].s), _mm_load_ps(s1[y0 * w + x1].s), a);
+    const __m128 v11 = RS_native_lerp(_mm_load_ps(s1[y1 * w + x0].s), _mm_load_ps(s1[y1 * w + x1].s), a);
+    cl_float4 v;
+    _mm_store_ps(v.s, RS_native_lerp(RS_native_lerp(v00, v01, b), RS_native_lerp(v10, v11, b), c));
+    return v;
+}
+
+
+static void RS_native_image_copy(RSNativeImage *image, const cl_float4 *data, const uint32_t w, const uint32_t h, const uint32_t d) {
+    const size_t n = (size_t)w * h * d;
+    if (image->data == NULL || (size_t)image->w * image->h * image->d != n) {
+        free(image->data);
+        if (posix_memalign((void **)&image->data, RS_ALIGN_SIZE, n * sizeof(cl_float4))) {
+            rsprint("ERROR: Unable to allocate a native table of %u x %u x %u.", w, h, d);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (data == NULL) {
+        memset(image->data, 0, n * sizeof(cl_float4));
+    } else {
+        memcpy(image->data, data, n * sizeof(cl_float4));
+    }
+    image->w = w;
+    image->h = h;
+    image->d = d;
+}
+
+
+static void RS_native_image_free(RSNativeImage *image) {
+    free(image->data);
+    memset(image, 0, sizeof(RSNativeImage));
+}
+
+
+#pragma mark -
+#pragma mark Ported Kernel Functions
+
+static cl_float4 RS_native_wind_table_index(const RSNativeFrame *F, const cl_float16 *desc, const cl_float4 pos) {
+    const float s7 = desc->s[RSTable3DDescriptionFormat];
+    uint32_t spacing; memcpy(&spacing, &s7, sizeof(uint32_t));
+    cl_float4 coord = {{0.0f, 0.0f, 0.0f, 0.0f}};
+    if (spacing == RSTableSpacingStretchedXYZ) {
+        const float rel[3] = {pos.x - F->center[0], pos.y - F->center[1], pos.z};
+        for (int k = 0; k < 3; k++) {
+            coord.s[k] = copysignf(desc->s[k], rel[k]) * log1pf(desc->s[4 + k] * fabsf(rel[k])) + desc->s[8 + k];
+        }
+    } else if (spacing == RSTableSpacingUniform) {
+        for (int k = 0; k < 3; k++) {
+            coord.s[k] = pos.s[k] * desc->s[k] + desc->s[4 + k];
+        }
+    }
+    return coord;
+}
+
+
+// Analytic wind at pos, center is the center of the domain
+cl_float4 RS_native_analytic_vel(const cl_float16 *desc, const float *center, const cl_float4 pos) {
+    const uint32_t model = (uint32_t)desc->s[RSWindModelDescriptionModel];
+    cl_float4 vel = {{desc->s[RSWindModelDescriptionVelocityX], desc->s[RSWindModelDescriptionVelocityY], desc->s[RSWindModelDescriptionVelocityZ], 0.0f}};
+    if (model & RSWindModelLinearShear) {
+        vel.x += pos.z * desc->s[RSWindModelDescriptionShearX];
+        vel.y += pos.z * desc->s[RSWindModelDescriptionShearY];
+        vel.z += pos.z * desc->s[RSWindModelDescriptionShearZ];
+    }
+    if (model & RSWindModelRankineVortex) {
+        const float dx = pos.x - center[0] - desc->s[RSWindModelDescriptionCenterX];
+        const float dy = pos.y - center[1] - desc->s[RSWindModelDescriptionCenterY];
+        const float r2 = dx * dx + dy * dy;
+        const float rc = desc->s[RSWindModelDescriptionCoreRadius];
+        const float vt_r = r2 < rc * rc ? desc->s[RSWindModelDescriptionMaximumSpeed] / rc : desc->s[RSWindModelDescriptionMaximumSpeed] * rc / r2;
+        vel.x -= dy * vt_r;
+        vel.y += dx * vt_r;
+    }
+    return vel;
+}
+
+
+static cl_float4 RS_native_bg_vel(const RSNative *N, const cl_float16 *desc, const cl_float4 pos) {
+    // Refined grids first, the first one that covers the position wins
+    const uint32_t nest_count = (uint32_t)desc->s[RSTable3DDescriptionNestCount];
+    for (uint32_t k = 0; k < nest_count; k++) {
+        const float *d = N->les_nest_desc[k].s;
+        const float x = pos.x * d[RSTable3DNestDescriptionScaleX] + d[RSTable3DNestDescriptionOriginX];
+        const float y = pos.y * d[RSTable3DNestDescriptionScaleY] + d[RSTable3DNestDescriptionOriginY];
+        const float z = pos.z * d[RSTable3DNestDescriptionScaleZ] + d[RSTable3DNestDescriptionOriginZ];
+        if (x >= 0.5f && y >= 0.5f && z >= 0.5f &&
+            x <= d[RSTable3DNestDescriptionLimitX] && y <= d[RSTable3DNestDescriptionLimitY] && z <= d[RSTable3DNestDescriptionLimitZ]) {
+            return RS_native_read_image_3d(&N->les_nest_uvwt, x, y, z + d[RSTable3DNestDescriptionSlabOffsetZ]);
+        }
+    }
+    const float s7 = desc->s[RSTable3DDescriptionFormat];
+    uint32_t spacing; memcpy(&spacing, &s7, sizeof(uint32_t));
+    if (spacing == RSTableSpacingAnalytic) {
+        return RS_native_analytic_vel(desc, N->frame.center, pos);
+    }
+    const cl_float4 coord = RS_native_wind_table_index(&N->frame, desc, pos);
+    return RS_native_read_image_3d(&N->les_uvwt, coord.x, coord.y, coord.z);
+}
+
+
+static inline cl_float4 RS_native_ellipsoid_rcs(const RSNative *N, const cl_float4 desc, const cl_float4 pos) {
+    const float fidx = RS_native_clamp(pos.w * desc.s[RSTable1DDescriptionScale] + desc.s[RSTable1DDescriptionOrigin], 0.0f, desc.s[RSTable1DDescriptionMaximum]);
+    const cl_float4 xz = N->rcs_ellipsoid[(uint32_t)fidx];
+    // cos(beta) ^ 2 of the elevation beta without the trip through atan2()
+    const float r2 = pos.x * pos.x + pos.y * pos.y;
+    const float d2 = r2 + pos.z * pos.z;
+    const float cb2 = d2 > 0.0f ? r2 / d2 : 1.0f;
+    return (cl_float4){{xz.s[0], xz.s[1], xz.s[0] + (xz.s[2] - xz.s[0]) * cb2, xz.s[1] + (xz.s[3] - xz.s[1]) * cb2}};
+}
+
+
+static cl_float4 RS_native_debris_rcs(const RSNative *N, const int r, const cl_float16 *desc, const cl_float4 pos, const cl_float4 ori) {
+    const float el = atan2f(pos.z, sqrtf(pos.x * pos.x + pos.y * pos.y));
+    const float az = atan2f(pos.x, pos.y);
+    const float se = sinf(0.5f * (el + (float)M_PI_2)), ce = cosf(0.5f * (el + (float)M_PI_2));
+    const float sa = sinf(0.5f * az), ca = cosf(0.5f * az);
+    const float h = (float)M_SQRT1_2;
+    const cl_float4 o_conj = {{(-se * ca + ce * sa) * h, (ce * ca + se * sa) * h, (se * ca + ce * sa) * h, (ce * ca - se * sa) * h}};
+
+    // Relative rotation from the identity, then the axis shuffle from the ADM to the RCS frame
+    const cl_float4 R = RS_native_quat_mult(ori, o_conj);
+    const cl_float4 q = {{R.x, R.z, -R.y, R.w}};
+
+    float alpha, beta, gamma;
+    const float beta_arg = q.w * q.w + q.z * q.z - q.y * q.y - q.x * q.x;
+    if (beta_arg > 0.999847f || beta_arg < -0.999847f) {
+        alpha = 0.0f;
+        beta = 0.0f;
+        gamma = RS_native_sign(q.z) * acosf(q.w) * 2.0f;
+    } else {
+        alpha = atan2f(q.y * q.z - q.w * q.x, q.x * q.z + q.w * q.y);
+        beta  = acosf(beta_arg);
+        gamma = atan2f(q.y * q.z + q.w * q.x, q.w * q.y - q.x * q.z);
+    }
+
+    const float x = alpha * desc->s[RSTable3DDescriptionScaleX] + desc->s[RSTable3DDescriptionOriginX];
+    const float y = beta * desc->s[RSTable3DDescriptionScaleY] + desc->s[RSTable3DDescriptionOriginY];
+    const cl_float4 re = RS_native_read_image_2d(&N->rcs_real[r], x, y);
+    const cl_float4 im = RS_native_read_image_2d(&N->rcs_imag[r], x, y);
+
+    const float sg = sinf(gamma), cg = cosf(gamma);
+    cl_float4 ss = {{
+        cg * (cg * re.s[0] - re.s[2] * sg) - sg * (cg * re.s[2] - re.s[1] * sg),
+        cg * (cg * im.s[0] - im.s[2] * sg) - sg * (cg * im.s[2] - im.s[1] * sg),
+        cg * (cg * re.s[1] + re.s[2] * sg) + sg * (cg * re.s[2] + re.s[0] * sg),
+        cg * (cg * im.s[1] + im.s[2] * sg) + sg * (cg * im.s[2] + im.s[0] * sg)
+    }};
+    if (N->frame.concept & RSSimulationConceptNonZeroCrossPol) {
+        ss.s[0] += cg * (cg * re.s[2] - re.s[1] * sg) + sg * (cg * re.s[0] - re.s[2] * sg);
+        ss.s[1] += cg * (cg * im.s[2] - im.s[1] * sg) + sg * (cg * im.s[0] - im.s[2] * sg);
+        ss.s[2] += cg * (cg * re.s[2] + re.s[0] * sg) - sg * (cg * re.s[1] + re.s[2] * sg);
+        ss.s[3] += cg * (cg * im.s[2] + im.s[0] * sg) - sg * (cg * im.s[1] + im.s[2] * sg);
+    }
+    return ss;
+}
+
+
+static cl_float4 RS_native_dudt_dwdt(const RSNative *N, const int a, const cl_float16 *desc, cl_float4 *dwdt, const cl_float4 vel, const cl_float4 vel_bg, const cl_float4 ori) {
+    const cl_float4 ur = {{vel_bg.x - vel.x, vel_bg.y - vel.y, vel_bg.z - vel.z, vel_bg.w - vel.w}};
+    const cl_float4 u_hat = RS_native_quat_rotate(RS_native_normalize4(ur), RS_native_quat_conj(ori));
+
+    float beta = acosf(u_hat.x);
+    float alpha = atan2f(u_hat.z, u_hat.y);
+    if (alpha < 0.0f) {
+        alpha = (float)M_PI + alpha;
+        beta = -beta;
+    }
+
+    const float x = beta * desc->s[RSTable3DDescriptionScaleX] + desc->s[RSTable3DDescriptionOriginX];
+    const float y = alpha * desc->s[RSTable3DDescriptionScaleY] + desc->s[RSTable3DDescriptionOriginY];
+    const cl_float4 cd = RS_native_quat_rotate(RS_native_read_image_2d(&N->adm_cd[a], x, y), ori);
+    const cl_float4 cm = RS_native_read_image_2d(&N->adm_cm[a], x, y);
+
+    const float Ta = desc->s[RSTable3DDescriptionTachikawa];
+    const float ur_norm_sq = ur.x * ur.x + ur.y * ur.y + ur.z * ur.z;
+    const float g = Ta * ur_norm_sq;
+    const float deg = (float)M_PI / 180.0f;
+
+    dwdt->x = g * desc->s[RSTable3DDescriptionRecipInLnX] * cm.x * deg;
+    dwdt->y = g * desc->s[RSTable3DDescriptionRecipInLnY] * cm.y * deg;
+    dwdt->z = g * desc->s[RSTable3DDescriptionRecipInLnZ] * cm.z * deg;
+    dwdt->w = 0.0f;
+
+    return (cl_float4){{g * cd.x, g * cd.y, g * cd.z + RS_NATIVE_GRAVITY, g * cd.w}};
+}
+
+
+static inline char RS_native_is_outside(const RSNativeFrame *F, const cl_float4 pos) {
+    for (int k = 0; k < 3; k++) {
+        if (pos.s[k] <= F->origin[k] || pos.s[k] >= F->origin[k] + F->size[k]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+static inline char RS_native_is_in_slab(const cl_float4 *desc, const cl_float4 pos) {
+    float a = atan2f(pos.x, pos.y) - desc->s[RSSlabDescriptionCenter];
+    if (a >= (float)M_PI) {
+        a -= 2.0f * (float)M_PI;
+    } else if (a < -(float)M_PI) {
+        a += 2.0f * (float)M_PI;
+    }
+    return a >= desc->s[RSSlabDescriptionLower] && a < desc->s[RSSlabDescriptionUpper];
+}
+
+
+#pragma mark -
+#pragma mark Ported Kernels
+
+// bg_atts
+static void RS_native_bg_atts(const RSNative *N, const RSWorker *C, const size_t i) {
+    RSHandle *H = N->H;
+    const RSNativeFrame *F = &N->frame;
+    cl_float4 pos = H->scat_pos[i];
+    cl_float4 vel = H->scat_vel[i];
+
+    pos.x += vel.x * F->dt;
+    pos.y += vel.y * F->dt;
+    pos.z += vel.z * F->dt;
+
+    if (RS_native_is_outside(F, pos)) {
+        const int draws = (int)C->slab_desc.s[RSSlabDescriptionDraws];
+        int drawn = 0;
+        do {
+            const cl_float4 r = RS_native_rand(&H->scat_rnd[i]);
+            for (int k = 0; k < 3; k++) {
+                pos.s[k] = r.s[k] * F->size[k] + F->origin[k];
+            }
+        } while (++drawn < draws && !RS_native_is_in_slab(&C->slab_desc, pos));
+        H->scat_pos[i] = pos;
+        H->scat_vel[i] = (cl_float4){{0.0f, 0.0f, 0.0f, 0.0f}};
+        return;
+    }
+
+    H->scat_pos[i] = pos;
+    H->scat_vel[i] = RS_native_bg_vel(N, &C->les_desc, pos);
+    H->scat_rcs[i] = RS_native_ellipsoid_rcs(N, C->rcs_ellipsoid_desc, pos);
+}
+
+
+// fp_atts
+static void RS_native_fp_atts(const RSNative *N, const RSWorker *C, const size_t i) {
+    RSHandle *H = N->H;
+    const RSNativeFrame *F = &N->frame;
+    const cl_float4 pos = H->scat_pos[i];
+    cl_float4 rcs = H->scat_rcs[i];
+
+    const cl_float4 coord = RS_native_wind_table_index(F, &C->les_desc, pos);
+    const cl_float4 uvwt = RS_native_bg_vel(N, &C->les_desc, pos);
+    const cl_float4 cpxx = RS_native_read_image_3d(&N->les_cpxx, coord.x, coord.y, coord.z);
+
+    // Accumulate the phase to the existing phase stored in rcs.s3
+    const float r = RS_native_length3(pos);
+    const float u = r > 0.0f ? (pos.x * uvwt.x + pos.y * uvwt.y + pos.z * uvwt.z) / r : 0.0f;
+    const float phi = rcs.s[3] - F->wav_num * u * F->dt;
+
+    const float cn2 = cpxx.s[0];
+    const float a = powf(10.0f, cn2);
+    const float s = sinf(phi), c = cosf(phi);
+
+    rcs.s[0] = a * c;
+    rcs.s[1] = a * s;
+    rcs.s[2] = cn2;
+    rcs.s[3] = atan2f(s, c);
+
+    H->scat_vel[i].x = uvwt.x;
+    H->scat_vel[i].y = uvwt.y;
+    H->scat_vel[i].z = uvwt.z;
+    H->scat_rcs[i] = rcs;
+}
+
+
+// el_atts
+static void RS_native_el_atts(const RSNative *N, const RSWorker *C, const size_t i) {
+    RSHandle *H = N->H;
+    const RSNativeFrame *F = &N->frame;
+    cl_float4 pos = H->scat_pos[i];
+    cl_float4 vel = H->scat_vel[i];
+
+    const float rho_air = 1.225f;
+    const float rho_over_mu_air = 6.7308e4f;
+
+    pos.x += vel.x * F->dt;
+    pos.y += vel.y * F->dt;
+    pos.z += vel.z * F->dt;
+
+    const float area_over_mass_particle = 0.003006012f / pos.w;
+
+    if (RS_native_is_outside(F, pos)) {
+        const int draws = (int)C->slab_desc.s[RSSlabDescriptionDraws];
+        int drawn = 0;
+        do {
+            const cl_float4 r = RS_native_rand(&H->scat_rnd[i]);
+            for (int k = 0; k < 3; k++) {
+                pos.s[k] = r.s[k] * F->size[k] + F->origin[k];
+            }
+        } while (++drawn < draws && !RS_native_is_in_slab(&C->slab_desc, pos));
+        H->scat_pos[i] = pos;
+        H->scat_vel[i] = (cl_float4){{0.0f, 0.0f, 0.0f, 0.0f}};
+        return;
+    }
+
+    const cl_float4 bg_vel = RS_native_bg_vel(N, &C->les_desc, pos);
+    const cl_float4 delta_v = {{bg_vel.x - vel.x, bg_vel.y - vel.y, bg_vel.z - vel.z, bg_vel.w - vel.w}};
+    const float delta_v_abs = RS_native_length3(delta_v);
+
+    if (delta_v_abs > 1.0e-3f) {
+        const float re = rho_over_mu_air * (2.0f * pos.w) * delta_v_abs;
+        const float cd = 24.0f / re + 6.0f / (1.0f + sqrtf(re)) + 0.4f;
+        const float f = 0.5f * rho_air * cd * area_over_mass_particle * delta_v_abs;
+        vel.x += f * delta_v.x * F->dt;
+        vel.y += f * delta_v.y * F->dt;
+        vel.z += (f * delta_v.z + RS_NATIVE_GRAVITY) * F->dt;
+        if ((F->concept & RSSimulationConceptBoundedParticleVelocity) && RS_native_length4(vel) > fmaxf(1.0f, 3.0f * RS_native_length4(bg_vel))) {
+            vel = bg_vel;
+            vel.z += RS_NATIVE_GRAVITY * F->dt;
+        }
+    } else {
+        vel.z += RS_NATIVE_GRAVITY * F->dt;
+    }
+
+    H->scat_pos[i] = pos;
+    H->scat_vel[i] = vel;
+    H->scat_rcs[i] = RS_native_ellipsoid_rcs(N, C->rcs_ellipsoid_desc, pos);
+}
+
+
+// Brings a debris back in the way db_atts does, from the flux field or anywhere at the bottom of the domain, in the slab of
+// the worker within as many draws as the kernels take, at rest with a random orientation
+void RS_native_respawn_debris(const RSHandle *H, const RSWorker *C, cl_float4 *pos, cl_float4 *ori, cl_float4 *vel, cl_float4 *tum, cl_float4 *rcs, cl_uint4 *seed) {
+    const float *origin = &H->sim_desc.s[RSSimulationDescriptionBoundOriginX];
+    const float *size = &H->sim_desc.s[RSSimulationDescriptionBoundSizeX];
+    const float center[2] = {origin[0] + 0.5f * size[0], origin[1] + 0.5f * size[1]};
+    cl_float4 p = *pos;
+    cl_float4 u;
+
+    // Draw again until the position is in the slab of this worker
+    const int draws = (int)C->slab_desc.s[RSSlabDescriptionDraws];
+    int drawn = 0;
+    do {
+        u = RS_native_rand(seed);
+
+        if (H->sim_concept & RSSimulationConceptDebrisFluxFromVelocity) {
+            // Inverse CDF of the flux field gives the cell index
+            const float *d = C->dff_desc.s;
+            const float cidx = RS_native_read_table(H->dff_icdf, u.x * d[RSTableDescriptionReserved7], d[RSTableDescriptionReserved7]);
+            p.y = floorf(cidx / d[RSTableDescriptionReserved5]);
+            p.x = cidx - p.y * d[RSTableDescriptionReserved5];
+            p.y += u.y;
+            if (d[RSTableDescriptionReserved6] == 1.0f) {
+                for (int k = 0; k < 2; k++) {
+                    const float rel = p.s[k] - (0.5f * d[RSTableDescriptionMaximumX + k] + 0.5f);
+                    const float v = powf(d[RSTableDescriptionOriginX + k], fabsf(rel)) * -d[RSTableDescriptionScaleX + k] + d[RSTableDescriptionScaleX + k];
+                    p.s[k] = copysignf(v, rel) + center[k];
+                }
+            } else if (d[RSTableDescriptionReserved6] == 2.0f) {
+                for (int k = 0; k < 2; k++) {
+                    p.s[k] = p.s[k] * (size[k] * d[RSTableDescriptionScaleX + k]) + origin[k];
+                }
+            } else {
+                for (int k = 0; k < 2; k++) {
+                    p.s[k] = p.s[k] * d[RSTableDescriptionScaleX + k] + origin[k];
+                }
+            }
+            p.z = RS_NATIVE_MIN_HEIGHT;
+        } else {
+            p.x = u.x * size[0] + origin[0];
+            p.y = u.y * size[1] + origin[1];
+            p.z = origin[2] + RS_NATIVE_MIN_HEIGHT;
+        }
+    } while (++drawn < draws && !RS_native_is_in_slab(&C->slab_desc, p));
+
+    // Random orientation
+    u = RS_native_rand(seed);
+    float c[4] = {sqrtf(-2.0f * logf(u.s[0])), sqrtf(-2.0f * logf(u.s[1])), sqrtf(-2.0f * logf(u.s[2])), u.s[3]};
+    u = RS_native_rand(seed);
+    for (int k = 0; k < 3; k++) {
+        c[k] *= cosf(2.0f * (float)M_PI * u.s[k]);
+    }
+    const float sin_th_2 = sinf((float)M_PI * c[3]), cos_th_2 = cosf((float)M_PI * c[3]);
+    const float sqxy = sqrtf(c[0] * c[0] + c[2] * c[2]);
+    const float sqxyz = sqrtf(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+    const float h = 0.5f * acosf(c[1] / sqxyz);
+    const float sa = sinf(h), ca = cosf(h);
+
+    *pos = p;
+    ori->x = c[0] * ca * sin_th_2 / sqxyz - c[0] * c[1] * sin_th_2 / sqxyz * sa / sqxy + c[2] * cos_th_2 * sa / sqxy;
+    ori->y = sin_th_2 / sqxyz * (sqxy * sa + c[1] * ca);
+    ori->z = c[2] * ca * sin_th_2 / sqxyz - c[0] * cos_th_2 * sa / sqxy - c[1] * c[2] * sin_th_2 * sa / sqxy / sqxyz;
+    ori->w = cos_th_2 * ca;
+    *vel = (cl_float4){{0.0f, 0.0f, 0.0f, 0.0f}};
+    *tum = (cl_float4){{0.0f, 0.0f, 0.0f, 1.0f}};
+    *rcs = (cl_float4){{0.0f, 0.0f, 0.0f, 0.0f}};
+}
+
+
+// db_atts
+static void RS_native_db_atts(const RSNative *N, const RSWorker *C, const int a, const int r, const size_t i) {
+    RSHandle *H = N->H;
+    const RSNativeFrame *F = &N->frame;
+    cl_float4 pos = H->scat_pos[i];
+    cl_float4 ori = H->scat_ori[i];
+    cl_float4 vel = H->scat_vel[i];
+    cl_float4 tum = H->scat_tum[i];
+
+    ori = RS_native_normalize4(RS_native_quat_mult(ori, tum));
+    pos.x += vel.x * F->dt;
+    pos.y += vel.y * F->dt;
+    pos.z += vel.z * F->dt;
+
+    if (RS_native_is_outside(F, pos)) {
+        RS_native_respawn_debris(H, C, &H->scat_pos[i], &H->scat_ori[i], &H->scat_vel[i], &H->scat_tum[i], &H->scat_rcs[i], &H->scat_rnd[i]);
+        return;
+    }
+
+    const cl_float4 vel_bg = RS_native_bg_vel(N, &C->les_desc, pos);
+
+    cl_float4 dwdt;
+    const cl_float4 dudt = RS_native_dudt_dwdt(N, a, &C->adm_desc[a], &dwdt, vel, vel_bg, ori);
+
+    // Bound the velocity
+    const float vx = vel.x + dudt.x * F->dt;
+    const float vy = vel.y + dudt.y * F->dt;
+    if ((F->concept & RSSimulationConceptBoundedParticleVelocity) && sqrtf(vx * vx + vy * vy) > 3.0f * sqrtf(vel_bg.x * vel_bg.x + vel_bg.y * vel_bg.y)) {
+        vel.x = vel_bg.x;
+        vel.y = vel_bg.y;
+    } else {
+        vel.x = vx;
+        vel.y = vy;
+    }
+    vel.z += dudt.z * F->dt;
+
+    float s[3], c[3];
+    for (int k = 0; k < 3; k++) {
+        s[k] = sinf(dwdt.s[k] * F->dt);
+        c[k] = cosf(dwdt.s[k] * F->dt);
+    }
+    tum = RS_native_normalize4((cl_float4){{
+        c[0] * s[1] * s[2] + s[0] * c[1] * c[2],
+        c[0] * s[1] * c[2] - s[0] * c[1] * s[2],
+        c[0] * c[1] * s[2] + s[0] * s[1] * c[2],
+        c[0] * c[1] * c[2] - s[0] * s[1] * s[2]
+    }});
+
+    H->scat_pos[i] = pos;
+    H->scat_ori[i] = ori;
+    H->scat_vel[i] = vel;
+    H->scat_tum[i] = tum;
+    H->scat_rcs[i] = RS_native_debris_rcs(N, r, &C->rcs_desc[r], pos, ori);
+}
+
+
+// scat_sig_aux
+static inline void RS_native_sig_aux(const RSNative *N, const RSWorker *C, const size_t i) {
+    RSHandle *H = N->H;
+    const RSNativeFrame *F = &N->frame;
+    const cl_float4 pos = H->scat_pos[i];
+    cl_float4 aux = H->scat_aux[i];
+
+    const float r = RS_native_length3(pos);
+    const float c = r > 0.0f ? RS_native_clamp((F->beam[0] * pos.x + F->beam[1] * pos.y + F->beam[2] * pos.z) / r, -1.0f, 1.0f) : 0.0f;
+    const float angle = acosf(c);
+
+    aux.s[0] = r;
+    aux.s[1] += F->age_step;
+    aux.s[3] = RS_native_read_table(N->angular_weight,
+                                    angle * C->angular_weight_desc.s[RSTable1DDescriptionScale] + C->angular_weight_desc.s[RSTable1DDescriptionOrigin],
+                                    C->angular_weight_desc.s[RSTable1DDescriptionMaximum]);
+
+    // Two-way amplitude attenuation 1 / R ^ 2 and the phase of exp(-j k R)
+    const float atten = 1.0f / (r * r);
+    const float phase = r * F->wav_num;
+    const float cc = cosf(phase), ss = sinf(phase);
+    const cl_float4 sig = complex_multiply(H->scat_rcs[i], (cl_float4){{cc, -ss, cc, -ss}});
+
+    _mm_store_ps(H->scat_sig[i].s, _mm_mul_ps(_mm_load_ps(sig.s), _mm_set1_ps(atten)));
+    H->scat_aux[i] = aux;
+}
+
+
+// make_pulse_pass_1 & make_pulse_pass_2 of a single scatterer
+static inline void RS_native_accumulate(const RSNative *N, const RSWorker *C, __m128 *pulse, const size_t i) {
+    RSHandle *H = N->H;
+    const cl_float4 aux = H->scat_aux[i];
+    const float xs = C->range_weight_desc.s[RSTable1DDescriptionScale];
+    const float x0 = C->range_weight_desc.s[RSTable1DDescriptionOrigin];
+    const float xm = C->range_weight_desc.s[RSTable1DDescriptionMaximum];
+    const float r0 = H->params.range_start;
+    const float dr = H->params.range_delta;
+    const uint32_t count = H->params.range_count;
+    const __m128 s = _mm_mul_ps(_mm_load_ps(H->scat_sig[i].s), _mm_set1_ps(aux.s[3]));
+
+    // Index of gate k is u - k * dr * xs, only the gates where it falls within (-1, xm) can have a weight
+    uint32_t k0 = 0, k1 = count;
+    const float step = dr * xs;
+    if (N->range_weight_zero_edges && step > 0.0f) {
+        const float u = (aux.s[0] - r0) * xs + x0;
+        const float a = floorf((u - xm) / step);
+        const float b = ceilf((u + 1.0f) / step);
+        k0 = !(a > 0.0f) ? 0 : (a >= (float)count ? count : (uint32_t)a);
+        k1 = !(b > 0.0f) ? 0 : (b >= (float)count ? count : (uint32_t)b);
+    }
+    for (uint32_t k = k0; k < k1; k++) {
+        const float w = RS_native_read_table(N->range_weight, (aux.s[0] - (r0 + (float)k * dr)) * xs + x0, xm);
+        pulse[k] = _mm_add_ps(pulse[k], _mm_mul_ps(s, _mm_set1_ps(w)));
+    }
+}
+
+
+#pragma mark -
+#pragma mark Jobs
+
+static void RS_native_advance_time_worker(RSNative *N, const int id) {
+    RSHandle *H = N->H;
+    const RSWorker *C = &H->workers[id];
+    const size_t o = H->offset[id];
+    size_t i, k;
+    int r = 0, a = 0;
+
+    void (*bg_atts)(const RSNative *, const RSWorker *, const size_t) = RS_native_bg_atts;
+    if (N->frame.concept & RSSimulationConceptDraggedBackground) {
+        bg_atts = RS_native_el_atts;
+    } else if (N->frame.concept & RSSimulationConceptFixedScattererPosition) {
+        bg_atts = RS_native_fp_atts;
+    }
+    for (i = o + C->origins[0]; i < o + C->origins[0] + C->counts[0]; i++) {
+        bg_atts(N, C, i);
+    }
+
+    for (k = 1; k < H->num_types; k++) {
+        for (i = o + C->origins[k]; i < o + C->origins[k] + C->counts[k]; i++) {
+            RS_native_db_atts(N, C, a, r, i);
+        }
+        r = r == C->rcs_count - 1 ? 0 : r + 1;
+        a = a == C->adm_count - 1 ? 0 : a + 1;
+    }
+}
+
+
+static void RS_native_make_pulse_worker(RSNative *N, const int id) {
+    RSHandle *H = N->H;
+    const RSWorker *C = &H->workers[id];
+    const size_t o = H->offset[id];
+    size_t i, k;
+    int r = 0;
+
+    if (!C->in_beam) {
+        return;
+    }
+
+    if (N->db_rcs) {
+        for (k = 1; k < H->num_types; k++) {
+            for (i = o + C->origins[k]; i < o + C->origins[k] + C->counts[k]; i++) {
+                H->scat_rcs[i] = RS_native_debris_rcs(N, r, &C->rcs_desc[r], H->scat_pos[i], H->scat_ori[i]);
+            }
+            r = r == C->rcs_count - 1 ? 0 : r + 1;
+        }
+    }
+
+    __m128 *pulse = (__m128 *)H->pulse_tmp[id];
+    memset(pulse, 0, H->params.range_count * sizeof(cl_float4));
+
+    if (N->sig_update[id] || N->db_rcs) {
+        for (i = o; i < o + C->num_scats; i++) {
+            RS_native_sig_aux(N, C, i);
+            RS_native_accumulate(N, C, pulse, i);
+        }
+    } else {
+        for (i = o; i < o + C->num_scats; i++) {
+            RS_native_accumulate(N, C, pulse, i);
+        }
+    }
+}
+
+
+static void RS_native_auxiliary_attributes_worker(RSNative *N, const int id) {
+    RSHandle *H = N->H;
+    const RSWorker *C = &H->workers[id];
+    for (size_t i = H->offset[id]; i < H->offset[id] + C->num_scats; i++) {
+        RS_native_sig_aux(N, C, i);
+    }
+}
+
+
+static void *RS_native_thread(void *in) {
+    RSNativeThread *T = (RSNativeThread *)in;
+    RSNative *N = T->N;
+    uint32_t tic = 0;
+    int job;
+
+    while (1) {
+        pthread_mutex_lock(&N->lock);
+        while (N->job_tic == tic) {
+            pthread_cond_wait(&N->job_ready, &N->lock);
+        }
+        tic = N->job_tic;
+        job = N->job;
+        pthread_mutex_unlock(&N->lock);
+
+        if (job == RSNativeJobQuit) {
+            break;
+        }
+        switch (job) {
+            case RSNativeJobAdvanceTime:
+                RS_native_advance_time_worker(N, T->id);
+                break;
+            case RSNativeJobMakePulse:
+                RS_native_make_pulse_worker(N, T->id);
+                break;
+            case RSNativeJobAuxiliaryAttributes:
+                RS_native_auxiliary_attributes_worker(N, T->id);
+                break;
+            default:
+                break;
+        }
+
+        pthread_mutex_lock(&N->lock);
+        if (--N->busy == 0) {
+            pthread_cond_signal(&N->job_done);
+        }
+        pthread_mutex_unlock(&N->lock);
+    }
+    return NULL;
+}
+
+
+// Hand a job to every thread and wait for all of them to finish
+static void RS_native_run(RSNative *N, const int job) {
+    RSHandle *H = N->H;
+    RSNativeFrame *F = &N->frame;
+
+    F->beam[0] = H->sim_desc.s[RSSimulationDescriptionBeamUnitX];
+    F->beam[1] = H->sim_desc.s[RSSimulationDescriptionBeamUnitY];
+    F->beam[2] = H->sim_desc.s[RSSimulationDescriptionBeamUnitZ];
+    for (int k = 0; k < 3; k++) {
+        F->origin[k] = H->sim_desc.s[RSSimulationDescriptionBoundOriginX + k];
+        F->size[k] = H->sim_desc.s[RSSimulationDescriptionBoundSizeX + k];
+    }
+    F->center[0] = F->origin[0] + 0.5f * F->size[0];
+    F->center[1] = F->origin[1] + 0.5f * F->size[1];
+    F->dt = H->sim_desc.s[RSSimulationDescriptionPRT];
+    F->wav_num = H->sim_desc.s[RSSimulationDescriptionWaveNumber];
+    F->age_step = H->sim_desc.s[RSSimulationDescription15];
+    memcpy(&F->concept, &H->sim_desc.s[RSSimulationDescriptionConcept], sizeof(uint32_t));
+
+    pthread_mutex_lock(&N->lock);
+    N->job = job;
+    N->busy = N->count;
+    N->job_tic++;
+    pthread_cond_broadcast(&N->job_ready);
+    while (N->busy) {
+        pthread_cond_wait(&N->job_done, &N->lock);
+    }
+    pthread_mutex_unlock(&N->lock);
+}
+
+
+#pragma mark -
+#pragma mark Native Engine
+
+int RS_native_init(RSHandle *H) {
+
+    int i;
+
+    RSNative *N = (RSNative *)malloc(sizeof(RSNative));
+    if (N == NULL) {
+        rsprint("ERROR: Unable to allocate the native engine.");
+        return -1;
+    }
+    memset(N, 0, sizeof(RSNative));
+    N->H = H;
+    N->count = H->num_workers;
+
+    pthread_mutex_init(&N->lock, NULL);
+    pthread_cond_init(&N->job_ready, NULL);
+    pthread_cond_init(&N->job_done, NULL);
+
+    for (i = 0; i < N->count; i++) {
+        N->threads[i].N = N;
+        N->threads[i].id = i;
+        if (pthread_create(&N->tid[i], NULL, RS_native_thread, &N->threads[i])) {
+            rsprint("ERROR: Unable to create native thread %d.", i);
+            N->count = i;
+            H->native = N;
+            RS_native_free(H);
+            return -1;
+        }
+    }
+
+    // Placeholders until the real tables arrive, the cn2 table is only filled in with fixed scatterers
+    RS_native_image_copy(&N->les_cpxx, NULL, 1, 1, 1);
+    RS_native_image_copy(&N->les_nest_uvwt, NULL, 1, 1, 1);
+
+    H->native = N;
+    return 0;
+}
+
+
+void RS_native_free(RSHandle *H) {
+
+    int i;
+
+    RSNative *N = H->native;
+    if (N == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&N->lock);
+    N->job = RSNativeJobQuit;
+    N->job_tic++;
+    pthread_cond_broadcast(&N->job_ready);
+    pthread_mutex_unlock(&N->lock);
+    for (i = 0; i < N->count; i++) {
+        pthread_join(N->tid[i], NULL);
+    }
+    pthread_cond_destroy(&N->job_ready);
+    pthread_cond_destroy(&N->job_done);
+    pthread_mutex_destroy(&N->lock);
+
+    free(N->range_weight);
+    free(N->angular_weight);
+    free(N->rcs_ellipsoid);
+    RS_native_image_free(&N->les_uvwt);
+    RS_native_image_free(&N->les_cpxx);
+    RS_native_image_free(&N->les_nest_uvwt);
+    for (i = 0; i < RS_MAX_ADM_TABLES; i++) {
+        RS_native_image_free(&N->adm_cd[i]);
+        RS_native_image_free(&N->adm_cm[i]);
+    }
+    for (i = 0; i < RS_MAX_RCS_TABLES; i++) {
+        RS_native_image_free(&N->rcs_real[i]);
+        RS_native_image_free(&N->rcs_imag[i]);
+    }
+    free(N);
+    H->native = NULL;
+}
+
+
+static float *RS_native_float_copy(float *dst, const float *src, const unsigned int count) {
+    free(dst);
+    dst = (float *)malloc(count * sizeof(float));
+    if (dst == NULL) {
+        rsprint("ERROR: Unable to allocate a native table of %u.", count);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(dst, src, count * sizeof(float));
+    return dst;
+}
+
+
+void RS_native_set_range_weight(RSHandle *H, const float *weights, const unsigned int count) {
+    RSNative *N = H->native;
+    N->range_weight = RS_native_float_copy(N->range_weight, weights, count);
+    N->range_weight_zero_edges = weights[0] == 0.0f && weights[count - 1] == 0.0f;
+}
+
+
+void RS_native_set_angular_weight(RSHandle *H, const float *weights, const unsigned int count) {
+    RSNative *N = H->native;
+    N->angular_weight = RS_native_float_copy(N->angular_weight, weights, count);
+}
+
+
+void RS_native_set_rcs_ellipsoid(RSHandle *H, const cl_float4 *table, const unsigned int count) {
+    RSNative *N = H->native;
+    free(N->rcs_ellipsoid);
+    if (posix_memalign((void **)&N->rcs_ellipsoid, RS_ALIGN_SIZE, count * sizeof(cl_float4))) {
+        rsprint("ERROR: Unable to allocate a native table of %u.", count);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(N->rcs_ellipsoid, table, count * sizeof(cl_float4));
+}
+
+
+void RS_native_set_vel_data(RSHandle *H, const RSTable3D *table) {
+    RSNative *N = H->native;
+    if (table->uvwt_half != NULL) {
+        rsprint("ERROR: Half-precision wind tables are not supported by the native engine.");
+        exit(EXIT_FAILURE);
+    }
+    RS_native_image_copy(&N->les_uvwt, table->uvwt, table->x_, table->y_, table->z_);
+    // The (cn2, p) table is only sampled by fp_atts
+    if (H->sim_concept & RSSimulationConceptFixedScattererPosition) {
+        RS_native_image_copy(&N->les_cpxx, table->cpxx, table->x_, table->y_, table->z_);
+    }
+}
+
+
+void RS_native_set_vel_nests(RSHandle *H, const cl_float4 *stack, const size_t w, const size_t h, const size_t d, const cl_float16 *desc) {
+    RSNative *N = H->native;
+    RS_native_image_copy(&N->les_nest_uvwt, stack, (uint32_t)w, (uint32_t)h, (uint32_t)d);
+    memcpy(N->les_nest_desc, desc, RS_MAX_VEL_NESTS * sizeof(cl_float16));
+}
+
+
+// New frame of one refined grid, w x h x d at depth o of the stack
+void RS_native_set_vel_nest_slab(RSHandle *H, const cl_float4 *uvwt, const size_t w, const size_t h, const size_t d, const size_t o) {
+    RSNativeImage *image = &H->native->les_nest_uvwt;
+    for (size_t z = 0; z < d; z++) {
+        for (size_t y = 0; y < h; y++) {
+            memcpy(&image->data[((o + z) * image->h + y) * image->w], &uvwt[(z * h + y) * w], w * sizeof(cl_float4));
+        }
+    }
+}
+
+
+void RS_native_set_adm_data(RSHandle *H, const int t, const RSTable2D *cd, const RSTable2D *cm) {
+    RSNative *N = H->native;
+    RS_native_image_copy(&N->adm_cd[t], cd->data, cd->x_, cd->y_, 1);
+    RS_native_image_copy(&N->adm_cm[t], cm->data, cm->x_, cm->y_, 1);
+}
+
+
+void RS_native_set_rcs_data(RSHandle *H, const int t, const RSTable2D *real, const RSTable2D *imag) {
+    RSNative *N = H->native;
+    RS_native_image_copy(&N->rcs_real[t], real->data, real->x_, real->y_, 1);
+    RS_native_image_copy(&N->rcs_imag[t], imag->data, imag->x_, imag->y_, 1);
+}
+
+
+void RS_native_advance_time(RSHandle *H) {
+    RS_native_run(H->native, RSNativeJobAdvanceTime);
+}
+
+
+void RS_native_make_pulse(RSHandle *H, const char *sig_update) {
+    RSNative *N = H->native;
+    N->db_rcs = (H->status & RSStatusDebrisRCSNeedsUpdate) != 0;
+    memcpy(N->sig_update, sig_update, H->num_workers);
+    RS_native_run(N, RSNativeJobMakePulse);
+}
+
+
+void RS_native_update_auxiliary_attributes(RSHandle *H) {
+    RS_native_run(H->native, RSNativeJobAuxiliaryAttributes);
+}
@@ -28,8 +28,11 @@ enum RSBackgroundAttributeKernelArgument {
     RSBackgroundAttributeKernelArgumentBackgroundVelocity,
     RSBackgroundAttributeKernelArgumentBackgroundCn2Pressure,
     RSBackgroundAttributeKernelArgumentBackgroundDescription,
+    RSBackgroundAttributeKernelArgumentBackgroundNestVelocity,
+    RSBackgroundAttributeKernelArgumentBackgroundNestDescription,
     RSBackgroundAttributeKernelArgumentEllipsoidRCS,
     RSBackgroundAttributeKernelArgumentEllipsoidRCSDescription,
+    RSBackgroundAttributeKernelArgumentSlabDescription,
     RSBackgroundAttributeKernelArgumentSimulationDescription
 };
 
@@ -43,6 +46,8 @@ enum RSDebrisAttributeKernelArgument {
     RSDebrisAttributeKernelArgumentBackgroundVelocity,
     RSDebrisAttributeKernelArgumentBackgroundCn2Pressure,
     RSDebrisAttributeKernelArgumentBackgroundVelocityDescription,
+    RSDebrisAttributeKernelArgumentBackgroundNestVelocity,
+    RSDebrisAttributeKernelArgumentBackgroundNestDescription,
     RSDebrisAttributeKernelArgumentAirDragModelDrag,
     RSDebrisAttributeKernelArgumentAirDragModelMomentum,
     RSDebrisAttributeKernelArgumentAirDragModelDescription,
@@ -51,6 +56,7 @@ enum RSDebrisAttributeKernelArgument {
     RSDebrisAttributeKernelArgumentRadarCrossSectionDescription,
     RSDebrisAttributeKernelArgumentDebrisFluxField,
     RSDebrisAttributeKernelArgumentDebrisFluxFieldDescription,
+    RSDebrisAttributeKernelArgumentSlabDescription,
     RSDebrisAttributeKernelArgumentSimulationDescription
 };
 
@@ -69,6 +75,20 @@ enum RSScattererSignalDropSizeDistributionKernalArgument {
     RSScattererSignalDropSizeDistributionKernalArgumentSimulationDescription
 };
 
+enum RSScattererMoveKernelArgument {
+    RSScattererMoveKernelArgumentPosition,
+    RSScattererMoveKernelArgumentVelocity,
+    RSScattererMoveKernelArgumentOrientation,
+    RSScattererMoveKernelArgumentTumble,
+    RSScattererMoveKernelArgumentAuxiliary,
+    RSScattererMoveKernelArgumentRadarCrossSection,
+    RSScattererMoveKernelArgumentSignal,
+    RSScattererMoveKernelArgumentRandomSeed,
+    RSScattererMoveKernelArgumentRecords,
+    RSScattererMoveKernelArgumentIndices,
+    RSScattererMoveKernelArgumentGather
+};
+
 enum RSScattererAngularWeightKernalArgument {
     RSScattererAngularWeightKernalArgumentSignal,
     RSScattererAngularWeightKernalArgumentAuxiliary,
@@ -99,14 +119,21 @@ cl_double4 double_complex_divide(const cl_double4 a, const cl_double4 b);
 
 void RS_worker_init(RSWorker *C, cl_device_id dev, cl_uint src_size, const char **src_ptr, cl_context_properties sharegroup, const char verb);
 void RS_worker_free(RSWorker *C);
+void RS_worker_init_segment(RSWorker *C, const RSWorker *P, const char name);
 void RS_worker_malloc(RSHandle *H, const int worker_id);
 
 void RS_merge_pulse_tmp(RSHandle *H);
 void RS_update_origins_offsets(RSHandle *H);
+void RS_update_slabs(RSHandle *H);
+int RS_slab_of_position(RSHandle *H, const cl_float4 pos);
+void RS_migrate_slab_scatterers(RSHandle *H);
 void RS_update_auxiliary_attributes(RSHandle *H);
 
 // Functions to upload to to GPU memory
 void RS_set_vel_data(RSHandle *H, const RSTable3D table);
+void RS_update_vel_data_nests(RSHandle *H);
+void RS_update_vel_data_crop(RSHandle *H);
+void RS_set_vel_data_to_analytic_model(RSHandle *H, const RSWindModel model, const cl_float16 desc);
 void RS_set_adm_data(RSHandle *H, const RSTable2D table_cd, const RSTable2D table_cm);
 void RS_set_rcs_data(RSHandle *H, const RSTable2D table_real, const RSTable2D table_imag);
 
@@ -124,4 +151,26 @@ void RS_set_rcs_ellipsoid_table(RSHandle *H, const cl_float4 *weights, const flo
 
 void RS_revise_population(RSHandle *H);
 
+#pragma mark -
+#pragma mark Native Engine
+
+// Workers that own OpenCL objects, none when the native engine stands in for them
+#define RS_CL_WORKER_COUNT(H)  ((H)->method == RS_METHOD_NATIVE ? 0 : (H)->num_workers)
+
+int RS_native_init(RSHandle *H);
+void RS_native_free(RSHandle *H);
+void RS_native_set_range_weight(RSHandle *H, const float *weights, const unsigned int count);
+void RS_native_set_angular_weight(RSHandle *H, const float *weights, const unsigned int count);
+void RS_native_set_rcs_ellipsoid(RSHandle *H, const cl_float4 *table, const unsigned int count);
+void RS_native_set_vel_data(RSHandle *H, const RSTable3D *table);
+void RS_native_set_vel_nests(RSHandle *H, const cl_float4 *stack, const size_t w, const size_t h, const size_t d, const cl_float16 *desc);
+void RS_native_set_vel_nest_slab(RSHandle *H, const cl_float4 *uvwt, const size_t w, const size_t h, const size_t d, const size_t o);
+void RS_native_set_adm_data(RSHandle *H, const int t, const RSTable2D *cd, const RSTable2D *cm);
+void RS_native_set_rcs_data(RSHandle *H, const int t, const RSTable2D *real, const RSTable2D *imag);
+void RS_native_respawn_debris(const RSHandle *H, const RSWorker *C, cl_float4 *pos, cl_float4 *ori, cl_float4 *vel, cl_float4 *tum, cl_float4 *rcs, cl_uint4 *seed);
+cl_float4 RS_native_analytic_vel(const cl_float16 *desc, const float *center, const cl_float4 pos);
+void RS_native_advance_time(RSHandle *H);
+void RS_native_make_pulse(RSHandle *H, const char *sig_update);
+void RS_native_update_auxiliary_attributes(RSHandle *H);
+
 #endif
@@ -17,6 +17,8 @@
 
 #include "rs.h"
 #include "iq.h"
+#include "mom.h"
+#include "spc.h"
 #include <stdbool.h>
 #include <getopt.h>
 #include <dirent.h>
@@ -30,7 +32,8 @@
 
 enum ACCEL_TYPE {
     ACCEL_TYPE_GPU,
-    ACCEL_TYPE_CPU
+    ACCEL_TYPE_CPU,
+    ACCEL_TYPE_NATIVE
 };
 
 typedef struct user_params {
@@ -49,6 +52,13 @@ typedef struct user_params {
     int   num_pulses;
     int   warm_up_pulses;
     int   seed;
+    int   stream_chunk;
+    int   les_prefetch;
+    int   iq_codec;
+    int   iq_mantissa_bits;
+    int   moments_pulses;
+    int   spectra_fft_size;
+    int   spectra_average;
     int   dsd_count;
 
     int   debris_type[RS_MAX_DEBRIS_TYPES];
@@ -56,6 +66,10 @@ typedef struct user_params {
     int   debris_group_count;
     
     char  les_config[256];
+    char  les_nests[RS_MAX_VEL_NESTS][256];
+    float les_nest_center[RS_MAX_VEL_NESTS][2];
+    int   les_nest_count;
+    char  wind_model[256];
 
     bool  output_iq_file;
     bool  output_state_file;
@@ -63,8 +77,13 @@ typedef struct user_params {
     bool  quiet_mode;
     bool  skip_questions;
     bool  tight_box;
+    bool  half_wind;
+    bool  slabs;
+    bool  device_population;
+    bool  lazy_mirrors;
     bool  show_progress;
     bool  resume_seed;
+    bool  node_shared;
 
     char output_dir[1024];
 } UserParams;
@@ -81,7 +100,7 @@ typedef union simstate {
 
 void show_help() {
     int k;
-    int size = 10 * 1024;
+    int size = 16 * 1024;
     char *buff = (char *)malloc(size);
     k = sprintf(buff, "SimRadar\n\n"
            PROGNAME " [options]\n\n"
@@ -128,6 +147,11 @@ void show_help() {
            "  -D (--density) " UNDERLINE("D") "\n"
            "         Set the density of particles to " UNDERLINE("D") " scatterers per resolution volume\n"
            "\n"
+           "  --device-pop\n"
+           "         Generates the scatterers on the GPUs instead of the host. Startup is much\n"
+           "         faster for large populations but the realization differs from the host's.\n"
+           "         Not available with --native, --slabs or --stream.\n"
+           "\n"
            "  --dontask\n"
            "         Sets the program to skip all the confirmation questions.\n"
            "\n"
@@ -138,15 +162,59 @@ void show_help() {
            "  --gpu-mask" UNDERLINE("mask") "\n"
            "         Selects the GPU devices to use through " UNDERLINE("mask") ".\n"
            "\n"
+           "  --half-wind\n"
+           "         Sets the LES wind tables to be kept on the GPU in half precision. This\n"
+           "         halves the texture footprint and the upload size of every LES frame.\n"
+           "\n"
+           "  --iq-codec " UNDERLINE("codec") "\n"
+           "         Encodes the samples of the IQ file with " UNDERLINE("codec") ", one block per pulse:\n"
+           "           none  - samples as they are (default)\n"
+           "           rle   - lossless, XOR'ed with the previous gate, byte planes with zero\n"
+           "                   runs. Blocks that would not shrink are kept as they are.\n"
+           "           int16 - scaled to int16 by the peak of each pulse, half the size.\n"
+           "\n"
+           "  --iq-mantissa-bits " UNDERLINE("bits") "\n"
+           "         Uses the rle codec, keeping only " UNDERLINE("bits") " bits of the mantissa. The\n"
+           "         relative error is bounded by 2 ^ -(" UNDERLINE("bits") " + 1), e.g., 7 bits for 0.4%%.\n"
+           "\n"
            "  -l (--lambda) " UNDERLINE("wavelength") "\n"
            "         Sets the radar wavelength to " UNDERLINE("wavelength") " meters. Framework default value\n"
            "         is 0.10 m if this is not specified.\n"
            "\n"
+           "  --lazy-mirrors\n"
+           "         Keeps no host copies of the scatterer arrays once they are on the GPUs.\n"
+           "         They are allocated again only when a download or --save-state needs them.\n"
+           "\n"
            "  -L (--les) " UNDERLINE("LESTable") "\n"
            "         Sets the LES field to use. This is the same string that is used to name\n"
            "         the folder under ${SIMRADAR_TABLE_HOME}/tables/les/${LESTable}. If not\n"
            "         specified, the default LES field is 'suctvort'.\n"
            "\n"
+           "  --les-nest " UNDERLINE("LESTable") "[@" UNDERLINE("x") "," UNDERLINE("y") "]\n"
+           "         Adds a refined LES field of uniform spacing, centered at (" UNDERLINE("x") ", " UNDERLINE("y") ") m of\n"
+           "         the outer field (default is the center). Scatterers inside it sample the\n"
+           "         refined field, which advances with the frames of the outer field. Can be\n"
+           "         repeated for up to %d fields, the finest one is sampled first.\n"
+           "\n"
+           "  --les-prefetch " UNDERLINE("N") "\n"
+           "         Sets the LES reader to stay " UNDERLINE("N") " frames ahead of the simulation. Framework\n"
+           "         default is 3. The reader statistics are shown at the end with -v.\n"
+           "\n"
+           "  --moments " UNDERLINE("N") "\n"
+           "         Generates the moments (Z, V, W, ZDR, PhiDP and RhoHV) of every " UNDERLINE("N") " pulses\n"
+           "         as the pulses are made, a .mom file per sweep. This can be used with\n"
+           "         or without -o.\n"
+           "\n"
+           "  --native\n"
+           "         Runs the simulation on host threads, one per CPU core, without OpenCL.\n"
+           "         Streaming and half-precision wind tables are not available.\n"
+           "\n"
+           "  --node-shared\n"
+           "         Lets the processes of simradar-mpi on a node share a small window of\n"
+           "         decoded LES frames in /dev/shm. Each frame is read by the first process\n"
+           "         that needs it and mapped by the others, instead of every process keeping\n"
+           "         its own frames.\n"
+           "\n"
            "  -N (--no-run)\n"
            "         No simulation. Previews the scanning angles of the setup. No data will\n"
            "         be generated.\n"
@@ -176,6 +244,22 @@ void show_help() {
            "         simulation. An output file like sim-20160229-143941-E03.0.simstate will\n"
            "         be generated in the ~/Downloads folder.\n"
            "\n"
+           "  --slabs\n"
+           "         Sets each GPU to own an azimuth sector of the domain instead of a random\n"
+           "         slice of all scatterers. GPUs with a sector outside the beam skip the\n"
+           "         pulse work. Scatterers are exchanged between sectors periodically.\n"
+           "\n"
+           "  --spectra " UNDERLINE("N") "[," UNDERLINE("M") "]\n"
+           "         Generates the Doppler spectra of every gate with " UNDERLINE("N") " bins as the pulses are\n"
+           "         made. Blocks of " UNDERLINE("N") " pulses of a dwell, i.e., the pulses at one position,\n"
+           "         or one sweep of a scanning beam, are Hann windowed and up to " UNDERLINE("M") " of them\n"
+           "         are averaged into a spectrum of the .spc file. " UNDERLINE("M") " is 1 if not specified.\n"
+           "         This can be used with or without -o.\n"
+           "\n"
+           "  --stream " UNDERLINE("N") "\n"
+           "         Keeps the scatterers in host memory and streams them through the GPUs in\n"
+           "         chunks of " UNDERLINE("N") " scatterers. Only the background scatterers can be streamed.\n"
+           "\n"
            "  --sweep " UNDERLINE("M:...") "\n"
            "         Sets the beam to scan mode.\n"
            "         The argument " UNDERLINE("M:...") " are parameters for mode, followed\n"
@@ -211,6 +295,18 @@ void show_help() {
            "\n"
            "  -W (--warm-up) " UNDERLINE("count") "\n"
            "         Sets the warm up stage to use " UNDERLINE("count") " pulses.\n"
+           "\n"
+           "  --wind-model " UNDERLINE("model") "\n"
+           "         Replaces the LES field with an analytic wind " UNDERLINE("model") " that is evaluated\n"
+           "         directly on the GPU, no table is read or uploaded. Speeds are in m/s,\n"
+           "         distances in m and shears in 1/s.\n"
+           "            U:" UNDERLINE("u") "," UNDERLINE("v") "," UNDERLINE("w") " - Uniform wind.\n"
+           "            S:" UNDERLINE("u") "," UNDERLINE("v") "," UNDERLINE("du/dz") "," UNDERLINE("dv/dz") " - Linear shear from (" UNDERLINE("u") ", " UNDERLINE("v") ") at the ground.\n"
+           "            R:" UNDERLINE("vmax") "," UNDERLINE("rmax") "[," UNDERLINE("u") "," UNDERLINE("v") "] - Rankine vortex at the domain center,\n"
+           "                optionally translating with (" UNDERLINE("u") ", " UNDERLINE("v") ").\n"
+           "         Example:\n"
+           "            --wind-model R:50,100\n"
+           "                sets a Rankine vortex with 50 m/s peak speed at 100 m radius.\n"
            "\n\n"
            "EXAMPLES\n"
            "     The following simulates a vortex and creates a PPI scan data using default\n"
@@ -256,8 +352,8 @@ void show_help() {
            "           " PROGNAME " -o -b 0.5 -l 0.328 -c FV -L flat --sweep D:0,75,10/90,75,10/0,90,10 -t 0.01 -p 60\n"
            "\n"
            "     The following simulates a default run using GPU 1 only (binary 0010 = 2).\n"
-           "           " PROGNAME " --gpu-mask 2\n"
-           );
+           "           " PROGNAME " --gpu-mask 2\n",
+           RS_MAX_VEL_NESTS);
     printf("%s\n(%.1f)\n", buff, (float)k / size * 100.0f);
     free(buff);
 }
@@ -337,28 +433,6 @@ static void show_user_param(const char *name, const void* value, const char *uni
     }
 }
 
-static void write_iq_file(const UserParams user, const IQFileHeader *file_header, const IQPulseHeader *pulse_headers, const cl_float4 *pulse_cache, const int stride, const int offset) {
-    char charbuff[2048];
-
-    memset(charbuff, 0, sizeof(charbuff));
-    snprintf(charbuff, sizeof(charbuff), "%s.iq", filename_prefix(&user));
-    printf("%s : Output file : " UNDERLINE("%s") "\n", now(), charbuff);
-    FILE *fid = fopen(charbuff, "wb");
-    if (fid == NULL) {
-        fprintf(stderr, "%s : Error creating file for IQ data.\n", now());
-    }
-    fwrite(file_header, sizeof(IQFileHeader), 1, fid);
-
-    // Flush out the cache
-    for (int k = 0; k < user.num_pulses; k++) {
-        fwrite(&pulse_headers[k], sizeof(IQPulseHeader), 1, fid);
-        fwrite(&pulse_cache[k * stride], sizeof(cl_float4), stride, fid);
-    }
-    printf("%s : Data file with %s B (seed = %s).\n", now(), commaint(ftell(fid)), commaint(file_header->simulation_seed));
-    printf("%s : Samples = %.4e%+.4ei  %.4e%+.4ei ...\n", now(), pulse_cache[0].s0, pulse_cache[0].s1, pulse_cache[1].s0, pulse_cache[1].s1);
-    fclose(fid);
-}
-
 int cstring_cmp(const void *a, const void *b) {
     const char **ia = (const char **)a;
     const char **ib = (const char **)b;
@@ -463,6 +537,14 @@ int main(int argc, char *argv[]) {
     user.seed              = PARAMS_INT_NOT_SUPPLIED;
     user.num_pulses        = PARAMS_INT_NOT_SUPPLIED;
     user.warm_up_pulses    = PARAMS_INT_NOT_SUPPLIED;
+    user.stream_chunk      = 0;
+    user.les_prefetch      = 0;
+    user.les_nest_count    = 0;
+    user.iq_codec          = IQCodecNone;
+    user.iq_mantissa_bits  = 23;
+    user.moments_pulses    = 0;
+    user.spectra_fft_size  = 0;
+    user.spectra_average   = 1;
 
     user.output_iq_file    = false;
     user.output_state_file = false;
@@ -471,7 +553,12 @@ int main(int argc, char *argv[]) {
     user.skip_questions    = false;
     user.show_progress     = true;
     user.tight_box         = false;
+    user.half_wind         = false;
+    user.slabs             = false;
+    user.device_population = false;
+    user.lazy_mirrors      = false;
     user.resume_seed       = false;
+    user.node_shared       = false;
 
     user.output_dir[0]     = '\0';
 
@@ -492,22 +579,36 @@ int main(int argc, char *argv[]) {
         {"cpu"           , no_argument      , 0, 'C'},
         {"debris"        , required_argument, 0, 'd'},
         {"density"       , required_argument, 0, 'D'},
+        {"device-pop"    , no_argument      , 0, 'P'},
         {"save-state"    , no_argument      , 0, 'E'},
         {"frames"        , required_argument, 0, 'f'},
         {"no-progress"   , no_argument      , 0, 'F'},
         {"mp-dsd"        , required_argument, 0, 'g'},
         {"gpu"           , no_argument      , 0, 'G'},
         {"help"          , no_argument      , 0, 'h'},
+        {"iq-codec"      , required_argument, 0, 'I'},
+        {"iq-mantissa-bits", required_argument, 0, 'K'},
         {"resume-seed"   , no_argument      , 0, 'H'},
         {"lambda"        , required_argument, 0, 'l'},
+        {"lazy-mirrors"  , no_argument      , 0, 'z'},
         {"les"           , required_argument, 0, 'L'},
+        {"les-prefetch"  , required_argument, 0, 'R'},
+        {"les-nest"      , required_argument, 0, 'e'},
         {"gpu-mask"      , required_argument, 0, 'm'},
+        {"moments"       , required_argument, 0, 'Z'},
+        {"half-wind"     , no_argument      , 0, 'u'},
+        {"wind-model"    , required_argument, 0, 'M'},
+        {"native"        , no_argument      , 0, 'n'},
         {"no-run"        , no_argument      , 0, 'N'},
+        {"node-shared"   , no_argument      , 0, 'X'},
         {"output"        , no_argument      , 0, 'o'},
         {"out-dir"       , required_argument, 0, 'O'},
         {"pulses"        , required_argument, 0, 'p'},
         {"quiet"         , no_argument      , 0, 'q'},
         {"seed"          , required_argument, 0, 's'},
+        {"slabs"         , no_argument      , 0, 'B'},
+        {"spectra"       , required_argument, 0, 'J'},
+        {"stream"        , required_argument, 0, 'Q'},
         {"sweep"         , required_argument, 0, 'S'},
         {"prt"           , required_argument, 0, 't'},
         {"tight-box"     , no_argument      , 0, 'T'},
@@ -565,6 +666,9 @@ int main(int argc, char *argv[]) {
             case 'C':
                 accel_type = ACCEL_TYPE_CPU;
                 break;
+            case 'n':
+                accel_type = ACCEL_TYPE_NATIVE;
+                break;
             case 'd':
                 k = sscanf(optarg, "%d,%d", &u1, &u2);
                 if (k == 2) {
@@ -626,12 +730,62 @@ int main(int argc, char *argv[]) {
             case 'L':
                 strncpy(user.les_config, optarg, sizeof(user.les_config));
                 break;
+            case 'e':
+                if (user.les_nest_count >= RS_MAX_VEL_NESTS) {
+                    fprintf(stderr, "Only %d refined LES fields are supported.\n", RS_MAX_VEL_NESTS);
+                    exit(EXIT_FAILURE);
+                }
+                snprintf(user.les_nests[user.les_nest_count], sizeof(user.les_nests[0]), "%s", optarg);
+                user.les_nest_center[user.les_nest_count][0] = 0.0f;
+                user.les_nest_center[user.les_nest_count][1] = 0.0f;
+                char *at = strchr(user.les_nests[user.les_nest_count], '@');
+                if (at != NULL) {
+                    *at = '\0';
+                    if (sscanf(at + 1, "%f,%f", &user.les_nest_center[user.les_nest_count][0], &user.les_nest_center[user.les_nest_count][1]) != 2) {
+                        fprintf(stderr, "Each refined LES field should be specified as --les-nest LESTable@X,Y.\n");
+                        exit(EXIT_FAILURE);
+                    }
+                }
+                user.les_nest_count++;
+                break;
             case 'm':
                 user.gpu_mask = atoi(optarg);
                 break;
+            case 'M':
+                strncpy(user.wind_model, optarg, sizeof(user.wind_model));
+                break;
             case 'N':
                 user.preview_only = true;
                 break;
+            case 'X':
+                user.node_shared = true;
+                break;
+            case 'I':
+                if (!strcasecmp(optarg, "none")) {
+                    user.iq_codec = IQCodecNone;
+                } else if (!strcasecmp(optarg, "rle")) {
+                    user.iq_codec = IQCodecShuffleRLE;
+                } else if (!strcasecmp(optarg, "int16")) {
+                    user.iq_codec = IQCodecInt16;
+                } else {
+                    fprintf(stderr, "Unknown IQ codec '%s'.\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'K':
+                user.iq_codec = IQCodecShuffleRLE;
+                user.iq_mantissa_bits = MIN(MAX(atoi(optarg), 0), 23);
+                break;
+            case 'Z':
+                user.moments_pulses = MAX(atoi(optarg), 2);
+                break;
+            case 'J':
+                k = sscanf(optarg, "%d,%d", &u1, &u2);
+                user.spectra_fft_size = MIN(MAX(u1, 2), SPCMaxFFTSize);
+                if (k == 2) {
+                    user.spectra_average = MAX(u2, 1);
+                }
+                break;
             case 'o':
                 user.output_iq_file = true;
                 break;
@@ -656,6 +810,24 @@ int main(int argc, char *argv[]) {
             case 'T':
                 user.tight_box = true;
                 break;
+            case 'u':
+                user.half_wind = true;
+                break;
+            case 'B':
+                user.slabs = true;
+                break;
+            case 'P':
+                user.device_population = true;
+                break;
+            case 'z':
+                user.lazy_mirrors = true;
+                break;
+            case 'Q':
+                user.stream_chunk = atoi(optarg);
+                break;
+            case 'R':
+                user.les_prefetch = atoi(optarg);
+                break;
             case 'v':
                 verb++;
                 break;
@@ -687,6 +859,15 @@ int main(int argc, char *argv[]) {
     MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
     MPI_Get_processor_name(processor_name, &k);
 
+    // Processes that share the memory of a node
+    int node_rank, node_size;
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_size(node_comm, &node_size);
+    char node_window_path[1024] = "";
+    char node_window[1280] = "";
+
     //printf("Node " UNDERLINE("%s") " ( %d out of %d )\n",  processor_name, world_rank, world_size);
 
     if (user.resume_seed) {
@@ -730,6 +911,7 @@ int main(int argc, char *argv[]) {
             show_user_param("User DSD profile", user.dsd_sizes, "mm", ValueTypeFloatArray, user.dsd_count);
         }
         show_user_param("User LES configuration", user.les_config, "", ValueTypeChar, 0);
+        show_user_param("User wind model", user.wind_model, "", ValueTypeChar, 0);
         char name[64];
         char type[64];
         for (k = 0; k < user.debris_group_count; k++) {
@@ -812,6 +994,8 @@ int main(int argc, char *argv[]) {
     RSHandle *S;
     if (accel_type == ACCEL_TYPE_CPU) {
         S = RS_init_for_cpu_verbose(verb);
+    } else if (accel_type == ACCEL_TYPE_NATIVE) {
+        S = RS_init_native_verbose(verb);
     } else {
         if (user.gpu_mask == PARAMS_INT_NOT_SUPPLIED) {
             S = RS_init_verbose(verb);
@@ -840,7 +1024,7 @@ int main(int argc, char *argv[]) {
 
     // Pre-process some parameters to ensure proper logic
 
-    if (user.num_pulses > 1000 && user.output_iq_file == false && user.skip_questions == false) {
+    if (user.num_pulses > 1000 && user.output_iq_file == false && user.moments_pulses == 0 && user.spectra_fft_size == 0 && user.skip_questions == false) {
         printf("Simulating more than 1,000 pulses but no file will be generated.\n"
                "Do you want to generate an output file instead (Y/N/N) ? ");
         c1 = getchar();
@@ -889,10 +1073,94 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    if (user.half_wind) {
+        RS_set_vel_data_half_precision(S, true);
+    }
+
+    if (user.slabs) {
+        RS_set_worker_partition(S, RSWorkerPartitionAzimuthSector);
+    }
+
+    if (user.stream_chunk > 0) {
+        RS_set_streaming(S, (size_t)user.stream_chunk);
+    }
+
+    if (user.device_population) {
+        RS_set_device_population(S, true);
+    }
+
+    if (user.lazy_mirrors) {
+        RS_set_host_mirrors(S, RSHostMirrorNone);
+    }
+
+#if defined (_OPEN_MPI)
+
+    // One process per node sets up a window of decoded LES frames in tmpfs, the processes on the node fill and map its slots
+    if (user.node_shared && strlen(user.wind_model) == 0) {
+        if (node_rank == 0) {
+            snprintf(node_window_path, sizeof(node_window_path), "/dev/shm/simradar-%d-%d", (int)getuid(), (int)getpid());
+            if (mkdir(node_window_path, 0700) == 0) {
+                LESHandle L = LES_init_with_config_path(strlen(user.les_config) ? user.les_config : LESConfigSuctionVortices, NULL);
+                if (L != NULL) {
+                    if (!LES_window_filename(node_window, sizeof(node_window), L, node_window_path) ||
+                        !LES_create_window(L, node_window, (uint32_t)node_size)) {
+                        node_window[0] = '\0';
+                    }
+                    LES_free(L);
+                }
+                if (strlen(node_window) == 0) {
+                    rmdir(node_window_path);
+                }
+            }
+            if (strlen(node_window) == 0) {
+                fprintf(stderr, "Unable to set up the LES window on %s. Each process reads its own.\n", processor_name);
+                node_window_path[0] = '\0';
+            }
+        }
+        MPI_Bcast(node_window_path, sizeof(node_window_path), MPI_CHAR, 0, node_comm);
+        if (strlen(node_window_path)) {
+            setenv(LESWindowPathVariable, node_window_path, 1);
+        }
+    }
+
+#endif
+
     if (strlen(user.les_config)) {
       RS_set_vel_data_to_config(S, user.les_config);
     }
 
+    // An analytic wind model takes precedence over any LES field
+    if (strlen(user.wind_model)) {
+        float m[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        if (strlen(user.wind_model) < 3 || user.wind_model[1] != ':' ||
+            sscanf(user.wind_model + 2, "%f,%f,%f,%f", &m[0], &m[1], &m[2], &m[3]) < 2) {
+            fprintf(stderr, "Invalid wind model '%s'.\n", user.wind_model);
+            exit(EXIT_FAILURE);
+        }
+        switch (user.wind_model[0]) {
+            case 'u':
+            case 'U':
+                RS_set_vel_data_to_analytic_uniform(S, (cl_float4){{m[0], m[1], m[2], 0.0f}});
+                break;
+            case 's':
+            case 'S':
+                RS_set_vel_data_to_analytic_shear(S, (cl_float4){{m[0], m[1], 0.0f, 0.0f}}, (cl_float4){{m[2], m[3], 0.0f, 0.0f}});
+                break;
+            case 'r':
+            case 'R':
+                RS_set_vel_data_to_rankine_vortex(S, (cl_float4){{0.0f, 0.0f, 0.0f, 0.0f}}, m[0], m[1], (cl_float4){{m[2], m[3], 0.0f, 0.0f}});
+                break;
+            default:
+                fprintf(stderr, "Unknown wind model '%c'.\n", user.wind_model[0]);
+                exit(EXIT_FAILURE);
+                break;
+        }
+    }
+
+    for (k = 0; k < user.les_nest_count; k++) {
+        RS_add_vel_data_nest_from_config(S, user.les_nests[k], user.les_nest_center[k][0], user.les_nest_center[k][1]);
+    }
+
     // ---------------------------------------------------------------------------------------------------------------
 
 #if defined (_OPEN_MPI)
@@ -954,6 +1222,23 @@ int main(int argc, char *argv[]) {
     // upload all the parameters to the GPU.
     RS_populate(S);
 
+    if (user.les_prefetch > 0 && S->L != NULL) {
+        LES_set_prefetch_depth(S->L, (uint32_t)user.les_prefetch);
+    }
+
+#if defined (_OPEN_MPI)
+
+    // Every process on the node has the window mapped by now, tmpfs releases it after the last one exits
+    if (strlen(node_window_path)) {
+        MPI_Barrier(node_comm);
+        if (node_rank == 0) {
+            unlink(node_window);
+            rmdir(node_window_path);
+        }
+    }
+
+#endif
+
     // Show some basic info
 
 #if defined (_OPEN_MPI)
@@ -993,6 +1278,8 @@ int main(int argc, char *argv[]) {
         if (user.show_progress) {
             printf("%80s\r", " ");
         }
+        // Re-partition the scatterers based on the throughput of each worker during warm up
+        RS_balance_workers(S);
     }
 
     // Set PRT to the actual one
@@ -1000,12 +1287,84 @@ int main(int argc, char *argv[]) {
 
     // ---------------------------------------------------------------------------------------------------------------
 
-    // Allocate a pulse cache
-    IQPulseHeader *pulse_headers = (IQPulseHeader *)malloc(user.num_pulses * sizeof(IQPulseHeader));
-    cl_float4 *pulse_cache = (cl_float4 *)malloc(user.num_pulses * S->params.range_count * sizeof(cl_float4));
-    memset(pulse_headers, 0, user.num_pulses * sizeof(IQPulseHeader));
-    memset(pulse_cache, 0, user.num_pulses * S->params.range_count * sizeof(cl_float4));
+    // Initialize a file if the user wants output files
+    if (user.output_iq_file || user.output_state_file || user.moments_pulses || user.spectra_fft_size) {
+        file_header.params = S->params;
+        for (k = 0; k < S->num_types; k++) {
+            file_header.counts[k] = (uint32_t)S->counts[k];
+        }
+        snprintf(file_header.scan_mode, sizeof(file_header.scan_mode), "%c", user.scan_pattern.mode);
+        file_header.scan_start      = user.scan_pattern.sweeps[0].azStart;
+        file_header.scan_end        = user.scan_pattern.sweeps[0].azEnd;
+        file_header.scan_delta      = user.scan_pattern.sweeps[0].azDelta;
+        file_header.simulation_seed = S->random_seed;
+    }
+
+    if (strlen(user.output_dir) == 0) {
+        snprintf(user.output_dir, sizeof(user.output_dir), "%s/Downloads", getenv("HOME"));
+    } else {
+        size_t len = strlen(user.output_dir);
+        if (user.output_dir[len - 1] == '/') {
+            user.output_dir[len - 1] = '\0';
+        }
+        // Check if directory exists
+        struct stat dir_stat;
+        char os_cmd[1024];
+        snprintf(os_cmd, 1024, "mkdir -p \"%s\"", user.output_dir);
+        printf("%s : %s\n", now(), os_cmd);
+        if (stat(user.output_dir, &dir_stat) < 0) {
+            system(os_cmd);
+        }
+    }
     
+    // Pulses are streamed into the file as they are made, the IQ & moment files share the same prefix
+    IQWriterHandle iq_writer = NULL;
+    MOMHandle moments = NULL;
+    SPCHandle spectra = NULL;
+    IQPulseHeader pulse_header;
+    cl_float4 first_samples[2];
+    char output_prefix[800];
+    memset(&pulse_header, 0, sizeof(IQPulseHeader));
+
+#if defined (_OPEN_MPI)
+
+    // Every process writes its own files, the rank keeps the filenames apart
+    snprintf(output_prefix, sizeof(output_prefix), "%s-%03d", filename_prefix(&user), world_rank);
+
+#else
+
+    snprintf(output_prefix, sizeof(output_prefix), "%s", filename_prefix(&user));
+
+#endif
+
+    if (user.output_iq_file) {
+        snprintf(charbuff, sizeof(charbuff), "%s.iq", output_prefix);
+        printf("%s : Output file : " UNDERLINE("%s") "\n", now(), charbuff);
+        iq_writer = IQ_writer_init(charbuff, &file_header, S->params.range_count, user.num_pulses);
+        if (iq_writer == NULL) {
+            fprintf(stderr, "%s : Error creating file for IQ data.\n", now());
+            exit(EXIT_FAILURE);
+        }
+        IQ_writer_set_codec(iq_writer, user.iq_codec, user.iq_mantissa_bits);
+    }
+    if (user.moments_pulses) {
+        printf("%s : Moment files : " UNDERLINE("%s-S*.%s") "\n", now(), output_prefix, MOMFileExtension);
+        moments = MOM_init(output_prefix, &file_header, S->params.range_count, user.moments_pulses);
+        if (moments == NULL) {
+            fprintf(stderr, "%s : Error creating the moment generator.\n", now());
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (user.spectra_fft_size) {
+        snprintf(charbuff, sizeof(charbuff), "%s.%s", output_prefix, SPCFileExtension);
+        printf("%s : Spectra file : " UNDERLINE("%s") "\n", now(), charbuff);
+        spectra = SPC_init(charbuff, &file_header, S->params.range_count, user.spectra_fft_size, user.spectra_average);
+        if (spectra == NULL) {
+            fprintf(stderr, "%s : Error creating file for the spectra.\n", now());
+            exit(EXIT_FAILURE);
+        }
+    }
+
     // Now we bake
     int k0 = 0;
     for (k = 0; k < user.num_pulses; k++) {
@@ -1054,16 +1413,28 @@ int main(int argc, char *argv[]) {
                 }
             }
             printf("\n");
-        } else if (user.output_iq_file) {
+        } else if (user.output_iq_file || user.moments_pulses || user.spectra_fft_size) {
             RS_download_pulse_only(S);
         }
 
         // Gather information for the  pulse header
+        if (user.output_iq_file || user.moments_pulses || user.spectra_fft_size) {
+            pulse_header.time = S->sim_tic;
+            pulse_header.az_deg = user.scan_pattern.az;
+            pulse_header.el_deg = user.scan_pattern.el;
+            pulse_header.sweep = user.scan_pattern.sweepTic;
+        }
         if (user.output_iq_file) {
-            pulse_headers[k].time = S->sim_tic;
-            pulse_headers[k].az_deg = user.scan_pattern.az;
-            pulse_headers[k].el_deg = user.scan_pattern.el;
-            memcpy(&pulse_cache[k * S->params.range_count], S->pulse, S->params.range_count * sizeof(cl_float4));
+            IQ_writer_add_pulse(iq_writer, &pulse_header, (float *)S->pulse);
+            if (k == 0) {
+                memcpy(first_samples, S->pulse, MIN(2, S->params.range_count) * sizeof(cl_float4));
+            }
+        }
+        if (user.moments_pulses) {
+            MOM_add_pulse(moments, &pulse_header, (float *)S->pulse);
+        }
+        if (user.spectra_fft_size) {
+            SPC_add_pulse(spectra, &pulse_header, user.scan_pattern.dwellTic, (float *)S->pulse);
         }
 
         // Advance time
@@ -1098,8 +1469,16 @@ int main(int argc, char *argv[]) {
 
 #endif
     
-    // Download everything once we are all done.
-    RS_download(S);
+    // Download everything once we are all done, the state file also needs the tumble and random seeds
+    if (user.output_state_file) {
+        RS_download_all(S);
+    } else if (verb > 2) {
+        RS_download(S);
+    }
+
+    if (verb && S->L != NULL) {
+        LES_show_stats(S->L);
+    }
 
     if (verb > 2) {
         printf("%s : Final scatter body positions, velocities and orientations:\n", now());
@@ -1108,77 +1487,32 @@ int main(int argc, char *argv[]) {
 
     // ---------------------------------------------------------------------------------------------------------------
 
-    // Initialize a file if the user wants output files
-    if (user.output_iq_file || user.output_state_file) {
-        file_header.params = S->params;
-        for (k = 0; k < S->num_types; k++) {
-            file_header.counts[k] = (uint32_t)S->counts[k];
+    if (user.output_iq_file) {
+        long size = IQ_writer_free(iq_writer);
+        if (size < 0) {
+            fprintf(stderr, "%s : Error writing IQ data.\n", now());
+        } else {
+            printf("%s : Data file with %s B (seed = %s).\n", now(), commaint(size), commaint(file_header.simulation_seed));
+            printf("%s : Samples = %.4e%+.4ei  %.4e%+.4ei ...\n", now(), first_samples[0].s0, first_samples[0].s1, first_samples[1].s0, first_samples[1].s1);
         }
-        snprintf(file_header.scan_mode, sizeof(file_header.scan_mode), "%c", user.scan_pattern.mode);
-        file_header.scan_start      = user.scan_pattern.sweeps[0].azStart;
-        file_header.scan_end        = user.scan_pattern.sweeps[0].azEnd;
-        file_header.scan_delta      = user.scan_pattern.sweeps[0].azDelta;
-        file_header.simulation_seed = S->random_seed;
     }
 
-    if (strlen(user.output_dir) == 0) {
-        snprintf(user.output_dir, sizeof(user.output_dir), "%s/Downloads", getenv("HOME"));
-    } else {
-        size_t len = strlen(user.output_dir);
-        if (user.output_dir[len - 1] == '/') {
-            user.output_dir[len - 1] = '\0';
-        }
-        // Check if directory exists
-        struct stat dir_stat;
-        char os_cmd[1024];
-        snprintf(os_cmd, 1024, "mkdir -p \"%s\"", user.output_dir);
-        printf("%s : %s\n", now(), os_cmd);
-        if (stat(user.output_dir, &dir_stat) < 0) {
-            system(os_cmd);
+    if (user.moments_pulses) {
+        long size = MOM_free(moments);
+        if (size < 0) {
+            fprintf(stderr, "%s : Error writing the moments.\n", now());
+        } else {
+            printf("%s : Moment files with %s B.\n", now(), commaint(size));
         }
     }
-    
-    if (user.output_iq_file) {
-
-#if defined (_OPEN_MPI)
 
-        // Let master node do all the file writing to avoid identical filenames
-        if (world_rank == 0) {
-            int count;
-            write_iq_file(user, &file_header, pulse_headers, pulse_cache, S->params.range_count, 0);
-            // Collect data from worker nodes
-            for (k = 1; k < world_size; k++) {
-                MPI_Recv(&file_header, sizeof(IQFileHeader), MPI_BYTE, k, 0, MPI_COMM_WORLD, &status);
-                if (verb > 1) {
-                    printf("%s : Received file header from node %d  (seed = %s).\n", now(), status.MPI_SOURCE, commaint(file_header.simulation_seed));
-                }
-                MPI_Recv(pulse_headers, user.num_pulses * sizeof(IQPulseHeader), MPI_BYTE, k, 1, MPI_COMM_WORLD, &status);
-                if (verb > 1) {
-                    // printf("%s : Received pulse headers of %s B from node %d.\n", now(), commaint(status._count), status.MPI_SOURCE);
-                    MPI_Get_count(&status, MPI_INT, &count);
-                    printf("%s : Received pulse headers of %s B from node %d.\n", now(), commaint(count), status.MPI_SOURCE);
-                }
-                MPI_Recv(pulse_cache, user.num_pulses * S->params.range_count * sizeof(cl_float4), MPI_BYTE, k, 2, MPI_COMM_WORLD, &status);
-                if (verb > 1) {
-                    // printf("%s : Received pulse data of %s B from node %d.\n", now(), commaint(status._count), status.MPI_SOURCE);
-                    MPI_Get_count(&status, MPI_INT, &count);
-                    printf("%s : Received pulse data of %s B from node %d.\n", now(), commaint(count), status.MPI_SOURCE);
-                }
-                write_iq_file(user, &file_header, pulse_headers, pulse_cache, S->params.range_count, k);
-            }
+    if (user.spectra_fft_size) {
+        long size = SPC_free(spectra);
+        if (size < 0) {
+            fprintf(stderr, "%s : Error writing the spectra.\n", now());
         } else {
-            // Send data to master node
-            MPI_Send(&file_header, sizeof(IQFileHeader), MPI_BYTE, 0, 0, MPI_COMM_WORLD);
-            MPI_Send(pulse_headers, user.num_pulses * sizeof(IQPulseHeader), MPI_BYTE, 0, 1, MPI_COMM_WORLD);
-            MPI_Send(pulse_cache, user.num_pulses * S->params.range_count * sizeof(cl_float4), MPI_BYTE, 0, 2, MPI_COMM_WORLD);
+            printf("%s : Spectra file with %s B.\n", now(), commaint(size));
         }
-
-#else
-
-        write_iq_file(user, &file_header, pulse_headers, pulse_cache, S->params.range_count, 0);
-        
-#endif
-
     }
 
     if (user.output_state_file) {
@@ -1210,15 +1544,13 @@ int main(int argc, char *argv[]) {
         fclose(fid);
     }
 
-    free(pulse_headers);
-    free(pulse_cache);
-
     printf("%s : Session ended\n", now());
 
     RS_free(S);
 
 #if defined (_OPEN_MPI)
 
+    MPI_Comm_free(&node_comm);
     MPI_Finalize();
 
 #endif
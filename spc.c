@@ -0,0 +1,241 @@
+//
+//  spc.c
+//  Radar Simulation Framework
+//
+//  Accumulates the Doppler spectra of each gate over the dwells as the pulses are made and writes them, so spectral
+//  studies do not need the IQ
+//
+
+#include "spc.h"
+
+// Private structure
+
+typedef struct _spc_accumulator {
+    SPCFileHeader   header;
+    FILE            *fid;
+    uint32_t        range_count;
+    uint32_t        fft_size;
+    uint32_t        block_average;
+    uint32_t        count;           // Pulses in the current block
+    uint32_t        dwell;           // Dwell of the current record
+    SPCRecordHeader record;
+    float           *block;          // Samples of the current block, pulse by pulse
+    float           *spectra;        // Sums of the periodograms, H & V x range_count x fft_size
+    float           *cs;             // cos & sin of the twiddle factors
+    uint32_t        *bin;            // Bit reversed index of each input
+    float           *re;
+    float           *im;
+    float           *w;              // Window of the current block
+    long            size;
+    bool            ok;              // Cleared at the first write error
+} SPCAccumulator;
+
+// Private functions
+void SPC_fft(SPCAccumulator *m);
+void SPC_add_block(SPCAccumulator *m);
+void SPC_write_record(SPCAccumulator *m);
+
+#pragma mark -
+
+// In-place radix-2 transform of re & im, X(k) = sum x(n) exp(-j 2 pi k n / N)
+void SPC_fft(SPCAccumulator *m) {
+    const uint32_t n = m->fft_size;
+    for (uint32_t i = 0; i < n; i++) {
+        const uint32_t j = m->bin[i];
+        if (j > i) {
+            float t = m->re[i]; m->re[i] = m->re[j]; m->re[j] = t;
+            t = m->im[i]; m->im[i] = m->im[j]; m->im[j] = t;
+        }
+    }
+    for (uint32_t len = 2; len <= n; len <<= 1) {
+        const uint32_t half = len >> 1;
+        const uint32_t step = n / len;
+        for (uint32_t i = 0; i < n; i += len) {
+            for (uint32_t k = 0; k < half; k++) {
+                const float c = m->cs[2 * k * step], s = m->cs[2 * k * step + 1];
+                const uint32_t a = i + k, b = a + half;
+                const float xr = m->re[b] * c - m->im[b] * s;
+                const float xi = m->re[b] * s + m->im[b] * c;
+                m->re[b] = m->re[a] - xr;
+                m->im[b] = m->im[a] - xi;
+                m->re[a] += xr;
+                m->im[a] += xi;
+            }
+        }
+    }
+}
+
+
+// Periodograms of the pulses in the block, a block needs two pulses
+void SPC_add_block(SPCAccumulator *m) {
+    const uint32_t n = m->count;
+    const uint32_t N = m->fft_size;
+    m->count = 0;
+    if (n < 2) {
+        return;
+    }
+    // Hann window over the pulses of the block, the bins add up to the mean power
+    double ww = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+        const double s = sin(M_PI * (i + 0.5) / n);
+        m->w[i] = (float)(s * s);
+        ww += (double)m->w[i] * m->w[i];
+    }
+    const float scale = (float)(1.0 / (N * ww));
+    for (uint32_t p = 0; p < 2; p++) {
+        for (uint32_t g = 0; g < m->range_count; g++) {
+            const float *x = &m->block[4 * g + 2 * p];
+            for (uint32_t i = 0; i < n; i++) {
+                m->re[i] = m->w[i] * x[4 * i * m->range_count];
+                m->im[i] = m->w[i] * x[4 * i * m->range_count + 1];
+            }
+            memset(&m->re[n], 0, (N - n) * sizeof(float));
+            memset(&m->im[n], 0, (N - n) * sizeof(float));
+            SPC_fft(m);
+            // Bin i is frequency 1/2 - i / N, i.e., the velocity -va + 2 va i / N
+            float *y = &m->spectra[(p * m->range_count + g) * N];
+            for (uint32_t i = 0; i < N; i++) {
+                const uint32_t k = (N / 2 - i) & (N - 1);
+                y[i] += (m->re[k] * m->re[k] + m->im[k] * m->im[k]) * scale;
+            }
+        }
+    }
+    m->record.pulse_count += n;
+    m->record.block_count++;
+}
+
+
+void SPC_write_record(SPCAccumulator *m) {
+    const size_t count = 2 * m->range_count * m->fft_size;
+    if (m->record.block_count) {
+        const float b = 1.0f / m->record.block_count;
+        for (size_t i = 0; i < count; i++) {
+            m->spectra[i] *= b;
+        }
+        if (m->ok && (fwrite(&m->record, sizeof(SPCRecordHeader), 1, m->fid) != 1 ||
+                      fwrite(m->spectra, sizeof(float), count, m->fid) != count)) {
+            fprintf(stderr, "SPC : Unable to write the spectra of dwell %u.\n", m->record.dwell);
+            m->ok = false;
+        }
+        m->header.record_count++;
+    }
+    memset(m->spectra, 0, count * sizeof(float));
+    memset(&m->record, 0, sizeof(SPCRecordHeader));
+}
+
+
+SPCHandle SPC_init(const char *filename, const IQFileHeader *header, const uint32_t range_count, const uint32_t fft_size, const uint32_t block_average) {
+    SPCAccumulator *m = (SPCAccumulator *)malloc(sizeof(SPCAccumulator));
+    if (m == NULL) {
+        fprintf(stderr, "SPC : Unable to allocate resources for the spectra.\n");
+        return NULL;
+    }
+    memset(m, 0, sizeof(SPCAccumulator));
+    m->range_count = range_count;
+    m->fft_size = 2;
+    while (m->fft_size < MIN(fft_size, SPCMaxFFTSize)) {
+        m->fft_size <<= 1;
+    }
+    m->block_average = MAX(1, block_average);
+    const uint32_t N = m->fft_size;
+    m->block = (float *)malloc(N * range_count * 4 * sizeof(float));
+    m->spectra = (float *)malloc(2 * range_count * N * sizeof(float));
+    m->cs = (float *)malloc(N * sizeof(float));
+    m->bin = (uint32_t *)malloc(N * sizeof(uint32_t));
+    m->re = (float *)malloc(N * sizeof(float));
+    m->im = (float *)malloc(N * sizeof(float));
+    m->w = (float *)malloc(N * sizeof(float));
+    if (m->block == NULL || m->spectra == NULL || m->cs == NULL || m->bin == NULL || m->re == NULL || m->im == NULL || m->w == NULL) {
+        fprintf(stderr, "SPC : Unable to allocate the accumulators.\n");
+        SPC_free(m);
+        return NULL;
+    }
+    memset(m->spectra, 0, 2 * range_count * N * sizeof(float));
+    for (uint32_t k = 0; k < N / 2; k++) {
+        m->cs[2 * k] = (float)cos(-2.0 * M_PI * k / N);
+        m->cs[2 * k + 1] = (float)sin(-2.0 * M_PI * k / N);
+    }
+    for (uint32_t i = 0; i < N; i++) {
+        uint32_t j = 0;
+        for (uint32_t b = 1, r = N >> 1; b < N; b <<= 1, r >>= 1) {
+            if (i & b) {
+                j |= r;
+            }
+        }
+        m->bin[i] = j;
+    }
+
+    memcpy(&m->header.iq, header, sizeof(IQFileHeader));
+    memcpy(m->header.magic, SPCFileMagic, sizeof(m->header.magic));
+    m->header.version = SPCFileVersion;
+    m->header.range_count = range_count;
+    m->header.fft_size = N;
+    m->header.block_average = m->block_average;
+    m->header.window = SPCWindowHann;
+    m->header.record_offset = sizeof(SPCFileHeader);
+    m->header.record_size = sizeof(SPCRecordHeader) + 2 * range_count * N * sizeof(float);
+
+    m->fid = fopen(filename, "wb");
+    if (m->fid == NULL) {
+        fprintf(stderr, "SPC : Unable to create %s.\n", filename);
+        SPC_free(m);
+        return NULL;
+    }
+    m->ok = fwrite(&m->header, sizeof(SPCFileHeader), 1, m->fid) == 1;
+    return (SPCHandle)m;
+}
+
+
+void SPC_add_pulse(SPCHandle in, const IQPulseHeader *header, const uint32_t dwell, const float *samples) {
+    SPCAccumulator *m = (SPCAccumulator *)in;
+
+    // A new dwell ends the record
+    if (dwell != m->dwell && (m->count || m->record.block_count)) {
+        SPC_add_block(m);
+        SPC_write_record(m);
+    }
+    if (m->count == 0 && m->record.block_count == 0) {
+        m->dwell = dwell;
+        m->record.time = header->time;
+        m->record.el_deg = header->el_deg;
+        m->record.az_deg = header->az_deg;
+        m->record.sweep = header->sweep;
+        m->record.dwell = dwell;
+    }
+    memcpy(&m->block[m->count * m->range_count * 4], samples, m->range_count * 4 * sizeof(float));
+    if (++m->count == m->fft_size) {
+        SPC_add_block(m);
+        if (m->record.block_count == m->block_average) {
+            SPC_write_record(m);
+        }
+    }
+}
+
+
+long SPC_free(SPCHandle in) {
+    SPCAccumulator *m = (SPCAccumulator *)in;
+    long size = -1;
+    if (m->fid) {
+        SPC_add_block(m);
+        SPC_write_record(m);
+        if (m->ok && (fseek(m->fid, 0, SEEK_SET) || fwrite(&m->header, sizeof(SPCFileHeader), 1, m->fid) != 1)) {
+            fprintf(stderr, "SPC : Unable to write the header.\n");
+            m->ok = false;
+        }
+        if (fclose(m->fid)) {
+            m->ok = false;
+        }
+        if (m->ok) {
+            size = m->header.record_offset + m->header.record_count * m->header.record_size;
+        }
+    }
+    free(m->block);
+    free(m->spectra);
+    free(m->cs);
+    free(m->bin);
+    free(m->re);
+    free(m->im);
+    free(m->w);
+    free(m);
+    return size;
+}
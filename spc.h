@@ -0,0 +1,67 @@
+//
+//  spc.h
+//  Radar Simulation Framework
+//
+//  Doppler spectra of the pulses, accumulated over each dwell as the pulses are made
+//
+
+#ifndef spc_h
+#define spc_h
+
+#include "iq.h"
+
+#define SPCFileMagic           "SIMRSPC"
+#define SPCFileVersion         1
+#define SPCFileExtension       "spc"
+#define SPCMaxFFTSize          4096
+
+// A file for each simulation:
+//
+//   SPCFileHeader
+//   record_count x (SPCRecordHeader, float[2][range_count][fft_size])   @ record_offset
+//
+// A record is the average of the periodograms of up to block_average blocks of fft_size pulses of a dwell, H then V.
+// Each block is Hann windowed over its pulses and zero padded to fft_size, so the last block of a dwell may be
+// shorter. Bin i is the velocity -va + 2 va i / fft_size (m/s), positive away from the radar, and the bins of a gate
+// add up to its mean power.
+
+enum SPCWindow {
+    SPCWindowHann
+};
+
+typedef union spcfileheader {
+    char raw[4096];
+    struct {
+        IQFileHeader  iq;                 // Header of the simulation, as in the IQ files
+        char          magic[8];           // SPCFileMagic
+        uint32_t      version;            // SPCFileVersion
+        uint32_t      record_count;       // Records in the file
+        uint32_t      range_count;        // Gates of each spectrum
+        uint32_t      fft_size;           // Bins of each spectrum
+        uint32_t      block_average;      // Blocks of a full record
+        uint32_t      window;             // SPCWindow
+        uint64_t      record_offset;      // Offset of the first record
+        uint64_t      record_size;        // Bytes from one record to the next
+    };
+} SPCFileHeader;
+
+typedef union spcrecordheader {
+    char raw[32];
+    struct {
+        float      time;          // Time of the first pulse
+        float      el_deg;        // Angles of the first pulse
+        float      az_deg;
+        uint32_t   sweep;
+        uint32_t   dwell;
+        uint32_t   pulse_count;   // Pulses in this record
+        uint32_t   block_count;   // Periodograms averaged
+    };
+} SPCRecordHeader;
+
+typedef void * SPCHandle;
+
+SPCHandle SPC_init(const char *filename, const IQFileHeader *header, const uint32_t range_count, const uint32_t fft_size, const uint32_t block_average);
+void SPC_add_pulse(SPCHandle, const IQPulseHeader *header, const uint32_t dwell, const float *samples);
+long SPC_free(SPCHandle);
+
+#endif /* spc_h */
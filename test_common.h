@@ -0,0 +1,30 @@
+//
+//  test_common.h
+//  Radar Simulation Framework
+//
+//  Fixture shared by the test programs, the same radar & scan box so that their populations are alike
+//
+
+#ifndef test_common_h
+#define test_common_h
+
+#include "rs.h"
+
+#define GREEN_COLOR       "\033[38;5;118m"
+#define RED_COLOR         "\033[38;5;203m"
+#define NO_COLOR          "\033[0m"
+
+// Seed, density, antenna, pulse and a scan box of 1.5 - 2.1 km, -4 - 4 deg azimuth and 1 - 5 deg elevation
+static void test_set_radar(RSHandle *H, const float density) {
+    RS_set_random_seed(H, 1000);
+    RS_set_density(H, density);
+    RS_set_antenna_params(H, 1.0f, 44.5f);
+    RS_set_tx_params(H, 0.2e-6f, 50.0e3f);
+    RSBox box;
+    box.origin.r = 1.5e3f;    box.size.r = 0.6e3f;
+    box.origin.a = -4.0f;     box.size.a = 8.0f;
+    box.origin.e = 1.0f;      box.size.e = 4.0f;
+    RS_set_scan_box(H, box);
+}
+
+#endif
@@ -0,0 +1,561 @@
+/*
+ *
+ * Cross-check the OpenCL kernels against the native engine
+ *
+ * Both handles are populated from the same seed so every scatterer starts out
+ * identical. Each kernel stage is then run on both and the host arrays are
+ * compared element by element, along with the time each side took.
+ *
+ */
+
+#include <float.h>
+#include "rs.h"
+#include "rs_priv.h"
+#include "test_common.h"
+
+#define OUTLIER_FRACTION  1.0e-4
+
+typedef struct _test_stat {
+    int        count;
+    int        failed;
+    float      tolerance;
+    char       verb;
+} TestStat;
+
+static const char *pass_2_names[] = {"group", "range", "local"};      // Indexed by RS_CL_PASS_2_*
+
+
+// Relative error of a cl_float4 array against a reference, normalized by the larger of the element and 1/1000 of the peak
+static void check(TestStat *T, const char *kernel, const char *name,
+                  const cl_float4 *ref, const cl_float4 *out, const size_t count, const int comps,
+                  const double t_native, const double t_device) {
+    size_t i;
+    int c;
+    float peak = 0.0f;
+    for (i = 0; i < count; i++) {
+        for (c = 0; c < comps; c++) {
+            peak = MAX(peak, fabsf(ref[i].s[c]));
+        }
+    }
+    const float floor = MAX(1.0e-3f * peak, FLT_MIN);
+
+    double err, max_err = 0.0;
+    size_t outliers = 0;
+    for (i = 0; i < count; i++) {
+        err = 0.0;
+        for (c = 0; c < comps; c++) {
+            err = MAX(err, fabsf(out[i].s[c] - ref[i].s[c]) / MAX(fabsf(ref[i].s[c]), floor));
+            if (isnan(out[i].s[c]) != isnan(ref[i].s[c])) {
+                err = INFINITY;
+            }
+        }
+        if (err > T->tolerance) {
+            if (T->verb > 1 && outliers < 5) {
+                printf("    %s[%zu] = [ %.4e %.4e %.4e %.4e ]  native [ %.4e %.4e %.4e %.4e ]\n", name, i,
+                       out[i].s0, out[i].s1, out[i].s2, out[i].s3, ref[i].s0, ref[i].s1, ref[i].s2, ref[i].s3);
+            }
+            outliers++;
+        } else {
+            max_err = MAX(max_err, err);
+        }
+    }
+
+    const char pass = count > 0 && outliers <= (size_t)(OUTLIER_FRACTION * count);
+
+    printf("%-14s %-6s  err = %.2e   outliers = %6s / %-10s   native = %8.3f ms   device = %8.3f ms   %s\n",
+           kernel, name, max_err, commaint(outliers), commaint(count), 1.0e3 * t_native, 1.0e3 * t_device,
+           pass ? GREEN_COLOR "PASS" NO_COLOR : RED_COLOR "FAIL" NO_COLOR);
+
+    T->count++;
+    if (!pass) {
+        T->failed++;
+    }
+}
+
+
+static void setup(RSHandle *H, const RSSimulationConcept concept, const float density, const size_t debris_count, const char analytic) {
+    RS_set_concept(H, concept);
+    test_set_radar(H, density);
+    if (analytic) {
+        RS_set_vel_data_to_rankine_vortex(H, (cl_float4){{0.0f, 0.0f, 0.0f, 0.0f}}, 40.0f, 50.0f, (cl_float4){{5.0f, 2.0f, 0.0f, 0.0f}});
+    } else {
+        RS_set_vel_data_to_cube27(H);
+    }
+    RS_set_dsd_to_mp(H);
+    if (debris_count) {
+        RS_set_debris_count(H, 1, debris_count);
+    }
+    RS_revise_population(H);
+    RS_populate(H);
+}
+
+
+// Background attributes of a simulation concept on a fresh pair of handles, el_atts for the dragged background and
+// fp_atts for fixed positions, compared after the last step
+static void check_concept(TestStat *T, const RSSimulationConcept concept, const char use_cpu, const uint8_t gpu_mask,
+                          const float density, const char analytic, const int steps) {
+    int i, k;
+    struct timeval t1, t2;
+    double t_native = 0.0, t_device = 0.0;
+    const char *kernel = concept == RSSimulationConceptDraggedBackground ? "el_atts" : "fp_atts";
+
+    RSHandle *D = use_cpu ? RS_init_for_cpu_verbose(0) : RS_init_for_selected_gpu(gpu_mask, 0);
+    if (D == NULL) {
+        fprintf(stderr, "No OpenCL device to test.\n");
+        exit(EXIT_FAILURE);
+    }
+    RSHandle *R = RS_init_native_for_selected_threads((uint8_t)((1 << D->num_workers) - 1), 0);
+    if (R == NULL) {
+        fprintf(stderr, "Unable to initialize the native engine.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    setup(D, concept, density, 0, analytic);
+    setup(R, concept, density, 0, analytic);
+
+    if (D->num_scats != R->num_scats || memcmp(D->offset, R->offset, sizeof(D->offset))) {
+        fprintf(stderr, "Populations differ: %s vs %s scatterers.\n", commaint(D->num_scats), commaint(R->num_scats));
+        exit(EXIT_FAILURE);
+    }
+
+    for (k = 0; k < steps; k++) {
+        gettimeofday(&t1, NULL);
+        RS_advance_time(R);
+        gettimeofday(&t2, NULL);
+        t_native += DTIME(t1, t2);
+
+        gettimeofday(&t1, NULL);
+        RS_advance_time(D);
+        gettimeofday(&t2, NULL);
+        t_device += DTIME(t1, t2);
+    }
+    RS_download(D);
+
+    printf("--- %s (%s), step %d\n", kernel, RS_simulation_concept_string(D), steps - 1);
+    for (i = 0; i < D->num_workers; i++) {
+        const size_t origin = D->offset[i] + D->workers[i].origins[0];
+        const size_t count = D->workers[i].counts[0];
+        if (concept == RSSimulationConceptDraggedBackground) {
+            check(T, kernel, "pos", R->scat_pos + origin, D->scat_pos + origin, count, 3, t_native / steps, t_device / steps);
+        } else {
+            check(T, kernel, "rcs", R->scat_rcs + origin, D->scat_rcs + origin, count, 4, t_native / steps, t_device / steps);
+        }
+        check(T, kernel, "vel", R->scat_vel + origin, D->scat_vel + origin, count, 3, t_native / steps, t_device / steps);
+    }
+
+    RS_free(R);
+    RS_free(D);
+}
+
+
+// Per-group partial sums that pass 1 of worker 0 left in the work buffer against a host sum of the same signal
+static void check_pass_1(TestStat *T, RSHandle *H, const int iterations) {
+
+    int i;
+    unsigned int g, k, l, m;
+    size_t size;
+    cl_event event;
+    struct timeval t1, t2;
+
+    RSWorker *C = &H->workers[0];
+    RSMakePulseParams P = C->make_pulse_params;
+
+    const unsigned int range_count = P.range_count;
+    const unsigned int group_count = P.group_counts[0];
+    const unsigned int local_size = (unsigned int)P.local[0];
+    const unsigned int n = P.entry_counts[0];
+    const size_t entries = (size_t)group_count * range_count;
+
+    // Inputs as the kernel sees them, including the padding it reads past the last scatterer
+    clGetMemObjectInfo(C->scat_sig, CL_MEM_SIZE, sizeof(size_t), &size, NULL);
+    const size_t numel = size / sizeof(cl_float4);
+    cl_float4 *sig = (cl_float4 *)malloc(numel * sizeof(cl_float4));
+    cl_float4 *aux = (cl_float4 *)malloc(numel * sizeof(cl_float4));
+    clEnqueueReadBuffer(C->que, C->scat_sig, CL_TRUE, 0, numel * sizeof(cl_float4), sig, 0, NULL, NULL);
+    clEnqueueReadBuffer(C->que, C->scat_aux, CL_TRUE, 0, numel * sizeof(cl_float4), aux, 0, NULL, NULL);
+
+    const float xs = C->range_weight_desc.s[RSTable1DDescriptionScale];
+    const float x0 = C->range_weight_desc.s[RSTable1DDescriptionOrigin];
+    const float xm = C->range_weight_desc.s[RSTable1DDescriptionMaximum];
+    float *w = (float *)malloc(((size_t)xm + 1) * sizeof(float));
+    clEnqueueReadBuffer(C->que, C->range_weight, CL_TRUE, 0, ((size_t)xm + 1) * sizeof(float), w, 0, NULL, NULL);
+
+    cl_float4 *work = (cl_float4 *)malloc(entries * sizeof(cl_float4));
+    cl_float4 *ref = (cl_float4 *)malloc(entries * sizeof(cl_float4));
+    clEnqueueReadBuffer(C->que, C->work, CL_TRUE, 0, entries * sizeof(cl_float4), work, 0, NULL, NULL);
+
+    // Group g takes the pairs (i, i + local_size) for i = g * 2L + l + m * 2L * G, same as the kernel
+    gettimeofday(&t1, NULL);
+    memset(ref, 0, entries * sizeof(cl_float4));
+    for (g = 0; g < group_count; g++) {
+        for (l = 0; l < local_size; l++) {
+            for (m = g * 2 * local_size + l; m < n; m += 2 * local_size * group_count) {
+                const size_t pair[2] = {m, (size_t)m + local_size};
+                for (i = 0; i < 2; i++) {
+                    if (pair[i] >= numel) {
+                        continue;
+                    }
+                    const cl_float4 s = sig[pair[i]];
+                    const float a = aux[pair[i]].s3;
+                    for (k = 0; k < range_count; k++) {
+                        const float f = MIN(MAX((aux[pair[i]].s0 - (P.range_start + (float)k * P.range_delta)) * xs + x0, 0.0f), xm);
+                        const unsigned int f0 = (unsigned int)f;
+                        const float v = w[f0] + (f - (float)f0) * (w[MIN(f0 + 1, (unsigned int)xm)] - w[f0]);
+                        cl_float4 *r = &ref[g * range_count + k];
+                        r->s0 += v * a * s.s0;
+                        r->s1 += v * a * s.s1;
+                        r->s2 += v * a * s.s2;
+                        r->s3 += v * a * s.s3;
+                    }
+                }
+            }
+        }
+    }
+    gettimeofday(&t2, NULL);
+    const double t_host = DTIME(t1, t2);
+
+    // The kernel overwrites the work buffer so running it again leaves the same partial sums for RS_make_pulse()
+    gettimeofday(&t1, NULL);
+    for (i = 0; i < iterations; i++) {
+        clEnqueueNDRangeKernel(C->que, C->kern_make_pulse_pass_1, 1, NULL, &P.global[0], &P.local[0], 0, NULL, &event);
+        clWaitForEvents(1, &event);
+        clReleaseEvent(event);
+    }
+    gettimeofday(&t2, NULL);
+    const double t_device = DTIME(t1, t2) / iterations;
+
+    check(T, "pass_1", "work", ref, work, entries, 4, t_host, t_device);
+
+    free(sig);
+    free(aux);
+    free(w);
+    free(work);
+    free(ref);
+}
+
+
+// Runs one of the pass 2 variants on the pass 1 output of worker 0 with the global / local sizes RS_make_pulse_params() would pick for it
+static void check_pass_2(TestStat *T, RSHandle *H, const unsigned int method, const int iterations) {
+
+    int i;
+    size_t k;
+    cl_int ret;
+    cl_event event;
+    struct timeval t1, t2;
+
+    RSWorker *C = &H->workers[0];
+    RSMakePulseParams P = C->make_pulse_params;
+
+    const unsigned int range_count = P.range_count;
+    const unsigned int entries = P.entry_counts[1];
+    const unsigned int group_count = P.group_counts[0];
+    const unsigned int work_items = MAX(1, entries / (range_count * 2));
+
+    size_t max_work_group_size;
+    clGetDeviceInfo(C->dev, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(size_t), &max_work_group_size, NULL);
+
+    size_t global, local, local_mem_size;
+    cl_kernel kernel;
+    if (method == RS_CL_PASS_2_IN_RANGE) {
+        kernel = C->kern_make_pulse_pass_2_range;
+        global = range_count;
+        local = 1;
+        local_mem_size = sizeof(cl_float4);
+    } else {
+        kernel = method == RS_CL_PASS_2_IN_LOCAL ? C->kern_make_pulse_pass_2_local : C->kern_make_pulse_pass_2_group;
+        global = work_items;
+        local = work_items;
+        local_mem_size = work_items * sizeof(cl_float4);
+        if (work_items > max_work_group_size ||
+            (method == RS_CL_PASS_2_UNIVERSAL && P.local[0] % range_count != 0) ||
+            (method == RS_CL_PASS_2_IN_LOCAL && group_count < 2 * range_count)) {
+            printf("pass_2_%-7s skipped, not applicable to %s groups x %s gates\n",
+                   pass_2_names[method], commaint(group_count), commaint(range_count));
+            return;
+        }
+    }
+
+    // Host reduction of what pass 1 left in the work buffer
+    cl_float4 *work = (cl_float4 *)malloc(entries * sizeof(cl_float4));
+    cl_float4 *ref = (cl_float4 *)malloc(range_count * sizeof(cl_float4));
+    clEnqueueReadBuffer(C->que, C->work, CL_TRUE, 0, entries * sizeof(cl_float4), work, 0, NULL, NULL);
+    gettimeofday(&t1, NULL);
+    memset(ref, 0, range_count * sizeof(cl_float4));
+    for (k = 0; k < entries; k++) {
+        ref[k % range_count].s0 += work[k].s0;
+        ref[k % range_count].s1 += work[k].s1;
+        ref[k % range_count].s2 += work[k].s2;
+        ref[k % range_count].s3 += work[k].s3;
+    }
+    gettimeofday(&t2, NULL);
+    const double t_host = DTIME(t1, t2);
+
+    // The output is padded with NaN so a write past the last gate shows up
+    const size_t padded_count = MAX(global, range_count) + RS_CL_GROUP_ITEMS;
+    cl_float4 *out = (cl_float4 *)malloc(padded_count * sizeof(cl_float4));
+    for (k = 0; k < padded_count; k++) {
+        out[k] = (cl_float4){{NAN, NAN, NAN, NAN}};
+    }
+    cl_mem pulse = clCreateBuffer(C->context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, padded_count * sizeof(cl_float4), out, &ret);
+    if (ret != CL_SUCCESS) {
+        rsprint("ERROR: Unable to create the pass 2 output buffer.  ret = %d", ret);
+        exit(EXIT_FAILURE);
+    }
+    ret = CL_SUCCESS;
+    ret |= clSetKernelArg(kernel, 0, sizeof(cl_mem),       &pulse);
+    ret |= clSetKernelArg(kernel, 1, sizeof(cl_mem),       &C->work);
+    ret |= clSetKernelArg(kernel, 2, local_mem_size,       NULL);
+    ret |= clSetKernelArg(kernel, 3, sizeof(unsigned int), &range_count);
+    ret |= clSetKernelArg(kernel, 4, sizeof(unsigned int), &entries);
+    if (ret != CL_SUCCESS) {
+        rsprint("ERROR: Failed to set arguments for kernel make_pulse_pass_2_%s().", pass_2_names[method]);
+        exit(EXIT_FAILURE);
+    }
+
+    gettimeofday(&t1, NULL);
+    for (i = 0; i < iterations; i++) {
+        clEnqueueNDRangeKernel(C->que, kernel, 1, NULL, &global, &local, 0, NULL, &event);
+        clWaitForEvents(1, &event);
+        clReleaseEvent(event);
+    }
+    gettimeofday(&t2, NULL);
+    const double t_device = DTIME(t1, t2) / iterations;
+
+    clEnqueueReadBuffer(C->que, pulse, CL_TRUE, 0, padded_count * sizeof(cl_float4), out, 0, NULL, NULL);
+
+    char name[32];
+    snprintf(name, sizeof(name), "pass_2_%s", pass_2_names[method]);
+    check(T, name, "pulse", ref, out, range_count, 4, t_host, t_device);
+
+    size_t overrun = 0;
+    for (k = range_count; k < padded_count; k++) {
+        overrun += !isnan(out[k].s0);
+    }
+    if (overrun) {
+        printf("%-14s wrote %s cells past the last gate   %s\n", name, commaint(overrun), RED_COLOR "FAIL" NO_COLOR);
+        T->failed++;
+    }
+
+    clReleaseMemObject(pulse);
+    free(work);
+    free(ref);
+    free(out);
+
+    // Leave the kernel the way RS_make_pulse() expects it
+    clSetKernelArg(kernel, 0, sizeof(cl_mem), &C->pulse);
+    clSetKernelArg(kernel, 2, C->make_pulse_params.local_mem_size[1], NULL);
+}
+
+
+int main(int argc, char **argv)
+{
+    char c;
+    int i, k;
+
+    char verb = 0;
+    char use_cpu = 0;
+    char analytic = 0;
+    uint8_t gpu_mask = 0x01;
+    int steps = 10;
+    int iterations = 100;
+    float density = 1.0f;
+    size_t debris_count = 1000;
+
+    struct timeval t1, t2;
+    double t_native, t_device;
+
+    TestStat T;
+    memset(&T, 0, sizeof(TestStat));
+    T.tolerance = 1.0e-3f;
+
+    while ((c = getopt(argc, argv, "acg:d:D:n:s:t:vh?")) != -1) {
+        switch (c) {
+            case 'a':
+                analytic = 1;
+                break;
+            case 'c':
+                use_cpu = 1;
+                break;
+            case 'g':
+                gpu_mask = (uint8_t)strtol(optarg, NULL, 0);
+                break;
+            case 'd':
+                density = atof(optarg);
+                break;
+            case 'D':
+                debris_count = (size_t)atol(optarg);
+                break;
+            case 'n':
+                iterations = MAX(1, atoi(optarg));
+                break;
+            case 's':
+                steps = MAX(1, atoi(optarg));
+                break;
+            case 't':
+                T.tolerance = atof(optarg);
+                break;
+            case 'v':
+                verb++;
+                break;
+            case 'h':
+            case '?':
+                printf("%s\n\n"
+                       "%s [OPTIONS]\n\n"
+                       "    -a     analytic Rankine vortex instead of the cube27 wind table\n"
+                       "    -c     use the OpenCL CPU device (e.g. pocl) instead of the GPU\n"
+                       "    -g M   GPU mask (default 0x01)\n"
+                       "    -d D   population density (default 1.0)\n"
+                       "    -D N   debris count (default 1000)\n"
+                       "    -n N   iterations for the pass 2 speed test (default 100)\n"
+                       "    -s N   time steps to compare (default 10)\n"
+                       "    -t T   relative error tolerance (default 1.0e-3)\n"
+                       "    -v     increases verbosity\n"
+                       "\n",
+                       argv[0], argv[0]);
+                return EXIT_FAILURE;
+            default:
+                fprintf(stderr, "Unknown option character `\\x%x'.\n", optopt);
+                break;
+        }
+    }
+    T.verb = verb;
+
+    RSHandle *D = use_cpu ? RS_init_for_cpu_verbose(verb) : RS_init_for_selected_gpu(gpu_mask, verb);
+    if (D == NULL) {
+        fprintf(stderr, "No OpenCL device to test.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Same number of workers so both handles lay out the population the same way
+    RSHandle *R = RS_init_native_for_selected_threads((uint8_t)((1 << D->num_workers) - 1), verb);
+    if (R == NULL) {
+        fprintf(stderr, "Unable to initialize the native engine.\n");
+        return EXIT_FAILURE;
+    }
+
+    setup(D, RSSimulationConceptNull, density, debris_count, analytic);
+    setup(R, RSSimulationConceptNull, density, debris_count, analytic);
+
+    if (D->num_scats != R->num_scats || memcmp(D->offset, R->offset, sizeof(D->offset))) {
+        fprintf(stderr, "Populations differ: %s vs %s scatterers.\n", commaint(D->num_scats), commaint(R->num_scats));
+        return EXIT_FAILURE;
+    }
+
+    printf("%s scatterers (%s debris) on %d worker%s\n",
+           commaint(D->num_scats), commaint(debris_count), D->num_workers, D->num_workers > 1 ? "s" : "");
+
+    // Ranges of the background and the debris within the host arrays
+    size_t origins[2][RS_MAX_WORKERS], counts[2][RS_MAX_WORKERS];
+    for (i = 0; i < D->num_workers; i++) {
+        origins[0][i] = D->offset[i] + D->workers[i].origins[0];
+        counts[0][i] = D->workers[i].counts[0];
+        origins[1][i] = D->offset[i] + D->workers[i].origins[1];
+        counts[1][i] = D->num_types > 1 ? D->workers[i].counts[1] : 0;
+    }
+
+    //
+    // Attributes: bg_atts and db_atts, compared after every step
+    //
+    for (k = 0; k < steps; k++) {
+        gettimeofday(&t1, NULL);
+        RS_advance_time(R);
+        gettimeofday(&t2, NULL);
+        t_native = DTIME(t1, t2);
+
+        gettimeofday(&t1, NULL);
+        RS_advance_time(D);
+        RS_download(D);
+        gettimeofday(&t2, NULL);
+        t_device = DTIME(t1, t2);
+
+        if (verb == 0 && k < steps - 1) {
+            continue;
+        }
+        printf("--- step %d\n", k);
+        for (i = 0; i < D->num_workers; i++) {
+            check(&T, "bg_atts", "pos", R->scat_pos + origins[0][i], D->scat_pos + origins[0][i], counts[0][i], 3, t_native, t_device);
+            check(&T, "bg_atts", "vel", R->scat_vel + origins[0][i], D->scat_vel + origins[0][i], counts[0][i], 3, t_native, t_device);
+            if (counts[1][i]) {
+                check(&T, "db_atts", "pos", R->scat_pos + origins[1][i], D->scat_pos + origins[1][i], counts[1][i], 3, t_native, t_device);
+                check(&T, "db_atts", "vel", R->scat_vel + origins[1][i], D->scat_vel + origins[1][i], counts[1][i], 3, t_native, t_device);
+                check(&T, "db_atts", "ori", R->scat_ori + origins[1][i], D->scat_ori + origins[1][i], counts[1][i], 4, t_native, t_device);
+            }
+        }
+    }
+
+    //
+    // Signal: scat_sig_aux
+    //
+    RS_set_beam_pos(R, 0.0f, 3.0f);
+    RS_set_beam_pos(D, 0.0f, 3.0f);
+
+    gettimeofday(&t1, NULL);
+    RS_update_auxiliary_attributes(R);
+    gettimeofday(&t2, NULL);
+    t_native = DTIME(t1, t2);
+
+    gettimeofday(&t1, NULL);
+    RS_update_auxiliary_attributes(D);
+    RS_download(D);
+    gettimeofday(&t2, NULL);
+    t_device = DTIME(t1, t2);
+
+    printf("--- signal\n");
+    check(&T, "scat_sig_aux", "aux", R->scat_aux, D->scat_aux, D->num_scats, 4, t_native, t_device);
+    check(&T, "scat_sig_aux", "sig", R->scat_sig, D->scat_sig, D->num_scats, 4, t_native, t_device);
+
+    //
+    // Pulse: db_rcs, scat_sig_aux, make_pulse_pass_1 and the pass 2 variant RS_make_pulse_params() picked
+    //
+    R->status |= RSStatusDebrisRCSNeedsUpdate;
+    D->status |= RSStatusDebrisRCSNeedsUpdate;
+
+    gettimeofday(&t1, NULL);
+    RS_make_pulse(R);
+    RS_download(R);
+    gettimeofday(&t2, NULL);
+    t_native = DTIME(t1, t2);
+
+    gettimeofday(&t1, NULL);
+    RS_make_pulse(D);
+    RS_download(D);
+    gettimeofday(&t2, NULL);
+    t_device = DTIME(t1, t2);
+
+    printf("--- pulse\n");
+    for (i = 0; i < D->num_workers; i++) {
+        if (counts[1][i]) {
+            check(&T, "db_rcs", "rcs", R->scat_rcs + origins[1][i], D->scat_rcs + origins[1][i], counts[1][i], 4, t_native, t_device);
+        }
+    }
+    check(&T, "make_pulse", "pulse", R->pulse, D->pulse, D->params.range_count, 4, t_native, t_device);
+
+    //
+    // Pass 1 partial sums of the pulse above
+    //
+    printf("--- pass 1 (%s groups x %s gates)\n", commaint(D->workers[0].make_pulse_params.group_counts[0]),
+           commaint(D->workers[0].make_pulse_params.range_count));
+    check_pass_1(&T, D, iterations);
+
+    //
+    // Every pass 2 variant against a host reduction of the same pass 1 output
+    //
+    printf("--- pass 2 (%s, worker 0 picked %s)\n", commaint(D->workers[0].make_pulse_params.entry_counts[1]),
+           pass_2_names[D->workers[0].make_pulse_params.cl_pass_2_method]);
+    check_pass_2(&T, D, RS_CL_PASS_2_UNIVERSAL, iterations);
+    check_pass_2(&T, D, RS_CL_PASS_2_IN_LOCAL, iterations);
+    check_pass_2(&T, D, RS_CL_PASS_2_IN_RANGE, iterations);
+
+    RS_free(R);
+    RS_free(D);
+
+    //
+    // The background kernels of the other concepts
+    //
+    check_concept(&T, RSSimulationConceptDraggedBackground, use_cpu, gpu_mask, density, analytic, steps);
+    check_concept(&T, RSSimulationConceptFixedScattererPosition, use_cpu, gpu_mask, density, analytic, steps);
+
+    printf("%d checks, %s%d failed%s\n", T.count, T.failed ? RED_COLOR : GREEN_COLOR, T.failed, NO_COLOR);
+
+    return T.failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,360 @@
+/*
+ *
+ * Check the refined wind grids
+ *
+ * The outer wind is uniform and a refined grid of another uniform wind covers
+ * part of the domain. After a time step every background scatterer should
+ * carry the wind of the grid it is in, on the native engine and on the
+ * OpenCL devices, in single and in half precision.
+ *
+ * A synthetic LES, written to a temporary home folder, then feeds both the
+ * outer table and a refined grid over half of the domain. Its frames take
+ * turns between two winds, so after the table advances every background
+ * scatterer should carry the wind of the next frame, the refined grid too.
+ *
+ */
+
+#include <sys/stat.h>
+#include "rs.h"
+#include "rs_priv.h"
+#include "test_common.h"
+
+// Outer wind & the wind of the refined grid, both exact in half precision
+static const cl_float4 outer_vel = {{1.0f, 0.0f, 0.0f, 0.0f}};
+static const cl_float4 nest_vel = {{5.0f, 2.0f, -1.0f, 0.0f}};
+
+// 21 x 21 x 11 cells of 10 m, i.e., x in [-100, 100], y in [1700, 1900] and z in [0, 100] m
+#define NEST_NX       21
+#define NEST_NY       21
+#define NEST_NZ       11
+#define NEST_DX       10.0f
+#define NEST_X0       -100.0f
+#define NEST_Y0       1700.0f
+
+// Raw winds of the even & odd frames of the synthetic LES, scaled by v0 = 100 of the flat configuration
+static const float les_raw[2][3] = {{0.0625f, 0.03125f, -0.015625f}, {-0.03125f, 0.0625f, 0.015625f}};
+
+// 45 x 45 x 4 cells of 100 m, i.e., +/- 2.2 km and up to 300 m, the refined grid of it starts at x = LES_NEST_X0
+#define LES_NX        45
+#define LES_NY        45
+#define LES_NZ        4
+#define LES_DX        100.0f
+#define LES_FRAMES    10
+#define LES_NEST_X0   0.0f
+
+
+static void setup(RSHandle *H, const char half) {
+    test_set_radar(H, 1.0f);
+    RS_set_vel_data_to_analytic_uniform(H, outer_vel);
+    RS_set_vel_data_half_precision(H, half);
+
+    RSTable3D nest = RS_table3d_init(NEST_NX * NEST_NY * NEST_NZ);
+    nest.x_ = NEST_NX;    nest.xs = 1.0f / NEST_DX;    nest.xo = -NEST_X0 / NEST_DX;    nest.xm = NEST_NX - 1;
+    nest.y_ = NEST_NY;    nest.ys = 1.0f / NEST_DX;    nest.yo = -NEST_Y0 / NEST_DX;    nest.ym = NEST_NY - 1;
+    nest.z_ = NEST_NZ;    nest.zs = 1.0f / NEST_DX;    nest.zo = 0.0f;                  nest.zm = NEST_NZ - 1;
+    for (int k = 0; k < NEST_NX * NEST_NY * NEST_NZ; k++) {
+        nest.uvwt[k] = nest_vel;
+    }
+    RS_add_vel_data_nest(H, nest);
+    RS_table3d_free(nest);
+
+    RS_set_dsd_to_mp(H);
+    RS_revise_population(H);
+    RS_populate(H);
+}
+
+
+// Which side of the static grid a position is on, -1 for too close to its edges to tell
+static int side_of_nest(const cl_float4 pos) {
+    // Cell indices of the grid, the kernels sample the grid from the first to the last cell center
+    const float x = (pos.x - NEST_X0) / NEST_DX;
+    const float y = (pos.y - NEST_Y0) / NEST_DX;
+    const float z = pos.z / NEST_DX;
+    const float m = fminf(fminf(fminf(x, NEST_NX - 1 - x), fminf(y, NEST_NY - 1 - y)), fminf(z, NEST_NZ - 1 - z));
+    if (fabsf(m) < 1.0e-3f) {
+        return -1;
+    }
+    return m > 0.0f;
+}
+
+
+// The refined grid of the LES covers the domain from x = LES_NEST_X0 on
+static int side_of_les_nest(const cl_float4 pos) {
+    if (fabsf(pos.x - LES_NEST_X0) < 1.0e-3f * LES_DX) {
+        return -1;
+    }
+    return pos.x > LES_NEST_X0;
+}
+
+
+// Background scatterers outside / inside a grid against the wind they should have, refs[0] outside and refs[1] inside
+static int check(RSHandle *H, const char *name, int (*side)(const cl_float4), const cl_float4 *refs) {
+    int i;
+    size_t k, counts[2] = {0, 0}, errors[2] = {0, 0};
+
+    RS_advance_time(H);
+    RS_download(H);
+
+    for (i = 0; i < H->num_workers; i++) {
+        const size_t origin = H->offset[i] + H->workers[i].origins[0];
+        for (k = origin; k < origin + H->workers[i].counts[0]; k++) {
+            const cl_float4 pos = H->scat_pos[k];
+            const cl_float4 vel = H->scat_vel[k];
+            const int inside = side(pos);
+            // Scatterers that left the domain in this step are drawn again at rest
+            if (inside < 0 || (vel.x == 0.0f && vel.y == 0.0f && vel.z == 0.0f)) {
+                continue;
+            }
+            const cl_float4 ref = refs[inside];
+            counts[inside]++;
+            if (fabsf(vel.x - ref.x) > 1.0e-3f || fabsf(vel.y - ref.y) > 1.0e-3f || fabsf(vel.z - ref.z) > 1.0e-3f) {
+                if (errors[inside]++ < 3 && H->verb) {
+                    printf("    [%zu] @ (%.2f, %.2f, %.2f) = (%.3f, %.3f, %.3f)   expected (%.3f, %.3f, %.3f)\n", k,
+                           pos.x, pos.y, pos.z, vel.x, vel.y, vel.z, ref.x, ref.y, ref.z);
+                }
+            }
+        }
+    }
+
+    int failed = 0;
+    for (i = 1; i >= 0; i--) {
+        const char pass = counts[i] > 0 && errors[i] == 0;
+        printf("%-24s %-8s  errors = %8s / %-10s   %s\n", name, i ? "inside" : "outside",
+               commaint(errors[i]), commaint(counts[i]), pass ? GREEN_COLOR "PASS" NO_COLOR : RED_COLOR "FAIL" NO_COLOR);
+        failed += !pass;
+    }
+    return failed;
+}
+
+
+static int check_static(RSHandle *H, const char *name) {
+    const cl_float4 refs[2] = {outer_vel, nest_vel};
+    return check(H, name, side_of_nest, refs);
+}
+
+
+#pragma mark - Synthetic LES
+
+static char les_home[] = "/tmp/test_nests.XXXXXX";
+static char les_dirs[4][256];
+
+
+static int write_les_file(const char *name, const void *data, const size_t size) {
+    char filename[512];
+    snprintf(filename, sizeof(filename), "%s/%s", les_dirs[3], name);
+    FILE *fid = fopen(filename, "wb");
+    if (fid == NULL) {
+        fprintf(stderr, "Unable to create %s.\n", filename);
+        return -1;
+    }
+    const size_t count = fwrite(data, 1, size, fid);
+    fclose(fid);
+    return count == size ? 0 : -1;
+}
+
+
+// The grid and the frames of the flat configuration in $HOME/Documents/tables/les/flat, HOME is pointed to a
+// temporary folder so that nothing of the user is picked up, the caches neither
+static int make_les(void) {
+    int k, f, v;
+    size_t i;
+    const size_t nn = LES_NX * LES_NY * LES_NZ;
+
+    if (mkdtemp(les_home) == NULL) {
+        fprintf(stderr, "Unable to create a temporary folder.\n");
+        return -1;
+    }
+    snprintf(les_dirs[0], sizeof(les_dirs[0]), "%s/Documents", les_home);
+    snprintf(les_dirs[1], sizeof(les_dirs[1]), "%s/tables", les_dirs[0]);
+    snprintf(les_dirs[2], sizeof(les_dirs[2]), "%s/les", les_dirs[1]);
+    snprintf(les_dirs[3], sizeof(les_dirs[3]), "%s/%s", les_dirs[2], LESConfigFlat);
+    for (k = 0; k < 4; k++) {
+        if (mkdir(les_dirs[k], 0700)) {
+            fprintf(stderr, "Unable to create %s.\n", les_dirs[k]);
+            return -1;
+        }
+    }
+    setenv("HOME", les_home, 1);
+    unsetenv(LESCachePathVariable);
+    unsetenv(LESWindowPathVariable);
+
+    // Header of rev, nx, ny & nz, then x, y & z of every cell in km, each after two words of record markers
+    const size_t grid_size = 4 * sizeof(uint32_t) + 3 * (2 + nn) * sizeof(float);
+    uint32_t *grid = (uint32_t *)malloc(grid_size);
+    // Version, then (time, 2 markers) and (u, v, w, p, t, each with 2 markers) of every frame
+    const size_t frame_words = 3 + 5 * (nn + 2);
+    const size_t data_size = (1 + LES_FRAMES * frame_words) * sizeof(float);
+    float *data = (float *)malloc(data_size);
+    if (grid == NULL || data == NULL) {
+        fprintf(stderr, "Unable to allocate memory for the synthetic LES.\n");
+        free(grid);
+        free(data);
+        return -1;
+    }
+    memset(grid, 0, grid_size);
+    memset(data, 0, data_size);
+
+    grid[1] = LES_NX;
+    grid[2] = LES_NY;
+    grid[3] = LES_NZ;
+    float *x = (float *)&grid[4] + 2;
+    float *y = x + nn + 2;
+    float *z = y + nn + 2;
+    for (i = 0; i < nn; i++) {
+        x[i] = 1.0e-3f * LES_DX * (float)(i % LES_NX);
+        y[i] = 1.0e-3f * LES_DX * (float)(i / LES_NX % LES_NY);
+        z[i] = 1.0e-3f * LES_DX * (float)(i / (LES_NX * LES_NY));
+    }
+
+    for (f = 0; f < LES_FRAMES; f++) {
+        float *frame = data + 1 + f * frame_words;
+        frame[0] = (float)f;
+        for (v = 0; v < 3; v++) {
+            float *plane = frame + 3 + v * (nn + 2);
+            for (i = 0; i < nn; i++) {
+                plane[i] = les_raw[f % 2][v];
+            }
+        }
+    }
+
+    int ret = write_les_file("fort.10_2", grid, grid_size) || write_les_file("LES_mean_1_6_fnum1.dat", data, data_size);
+    free(grid);
+    free(data);
+    return ret;
+}
+
+
+static void remove_les(void) {
+    char filename[512];
+    snprintf(filename, sizeof(filename), "%s/fort.10_2", les_dirs[3]);
+    remove(filename);
+    snprintf(filename, sizeof(filename), "%s/LES_mean_1_6_fnum1.dat", les_dirs[3]);
+    remove(filename);
+    for (int k = 3; k >= 0; k--) {
+        rmdir(les_dirs[k]);
+    }
+    rmdir(les_home);
+}
+
+
+static void setup_les(RSHandle *H, const char half) {
+    test_set_radar(H, 1.0f);
+    RS_set_vel_data_half_precision(H, half);
+    RS_set_vel_data_to_config(H, LESConfigFlat);
+    // Centered 2.2 km to the east, so the grid starts at x = 0 m
+    RS_add_vel_data_nest_from_config(H, LESConfigFlat, LES_NEST_X0 + 0.5f * (LES_NX - 1) * LES_DX, 0.0f);
+    RS_set_dsd_to_mp(H);
+    RS_revise_population(H);
+    RS_populate(H);
+}
+
+
+// Two steps, the outer table and the refined grid take the next frame before the second
+static int check_les(RSHandle *H, const char *name) {
+    int f, failed = 0;
+    char label[64];
+    for (f = 0; f < 2; f++) {
+        const cl_float4 vel = {{100.0f * les_raw[f][0], 100.0f * les_raw[f][1], 100.0f * les_raw[f][2], 0.0f}};
+        const cl_float4 refs[2] = {vel, vel};
+        snprintf(label, sizeof(label), "%s frame %d", name, f);
+        failed += check(H, label, side_of_les_nest, refs);
+        // Straight to the time of the next frame
+        H->sim_tic = H->sim_toc;
+    }
+    return failed;
+}
+
+
+int main(int argc, char **argv)
+{
+    char c;
+    char verb = 0;
+    char native_only = 0;
+    uint8_t gpu_mask = 0x01;
+    int failed = 0;
+    RSHandle *H;
+
+    while ((c = getopt(argc, argv, "g:nvh?")) != -1) {
+        switch (c) {
+            case 'g':
+                gpu_mask = (uint8_t)strtol(optarg, NULL, 0);
+                break;
+            case 'n':
+                native_only = 1;
+                break;
+            case 'v':
+                verb++;
+                break;
+            case 'h':
+            case '?':
+                printf("%s\n\n"
+                       "%s [OPTIONS]\n\n"
+                       "    -g M   GPU mask (default 0x01)\n"
+                       "    -n     native engine only\n"
+                       "    -v     increases verbosity\n"
+                       "\n",
+                       argv[0], argv[0]);
+                return EXIT_FAILURE;
+            default:
+                fprintf(stderr, "Unknown option character `\\x%x'.\n", optopt);
+                break;
+        }
+    }
+
+    H = RS_init_native_for_selected_threads(0x03, verb);
+    if (H == NULL) {
+        fprintf(stderr, "Unable to initialize the native engine.\n");
+        return EXIT_FAILURE;
+    }
+    setup(H, 0);
+    failed += check_static(H, "native");
+    RS_free(H);
+
+    if (!native_only) {
+        for (char half = 0; half < 2; half++) {
+            H = RS_init_for_selected_gpu(gpu_mask, verb);
+            if (H == NULL) {
+                fprintf(stderr, "No OpenCL device to test.\n");
+                return EXIT_FAILURE;
+            }
+            setup(H, half);
+            failed += check_static(H, half ? "device (half)" : "device");
+            RS_free(H);
+        }
+    }
+
+    if (make_les()) {
+        remove_les();
+        return EXIT_FAILURE;
+    }
+
+    H = RS_init_native_for_selected_threads(0x03, verb);
+    if (H == NULL) {
+        fprintf(stderr, "Unable to initialize the native engine.\n");
+        remove_les();
+        return EXIT_FAILURE;
+    }
+    setup_les(H, 0);
+    failed += check_les(H, "LES native");
+    RS_free(H);
+
+    if (!native_only) {
+        for (char half = 0; half < 2; half++) {
+            H = RS_init_for_selected_gpu(gpu_mask, verb);
+            if (H == NULL) {
+                fprintf(stderr, "No OpenCL device to test.\n");
+                remove_les();
+                return EXIT_FAILURE;
+            }
+            setup_les(H, half);
+            failed += check_les(H, half ? "LES device (half)" : "LES device");
+            RS_free(H);
+        }
+    }
+
+    remove_les();
+
+    printf("%s%d failed%s\n", failed ? RED_COLOR : GREEN_COLOR, failed, NO_COLOR);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}